@@ -0,0 +1,383 @@
+//###########################################################################
+//
+// FILE:   BenchSuite.c
+//
+// TITLE:  Benchmark cases of the receive, transmit and codec kernels
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "BenchSuite.h"
+#include "BufferDecode.h"
+#include "Eye.h"
+#include "LineCode.h"
+#include "ManchesterRx.h"
+#include "ManchesterWord.h"
+#include "Pam4Rx.h"
+#include "Prbs.h"
+#ifndef HOST_BUILD
+#include "CpuFilter.h"
+#include "Telemetry.h"
+#endif
+
+#if BENCH_ENABLE
+
+//
+// Defines
+//
+#define BENCH_HIGH              3000
+#define BENCH_LOW               1000
+#define BENCH_THRESHOLD         2048
+#define BENCH_HYSTERESIS        64
+#define BENCH_PRBS_BITS         256
+
+//
+// Globals
+//
+// BenchSignal  Manchester waveform of BENCH_SUITE_BITS PRBS bits
+// BenchEdge    manchester_rx_t.crossed for every sample, locked
+// BenchLevels  the test signal sliced at the threshold, a bit vector
+// BenchPam4    PAM-4 waveform of the same PRBS, two bits per symbol
+//
+static Uint16 BenchSignal[BENCH_SUITE_SAMPLES];
+static Uint16 BenchPam4[BENCH_SUITE_SAMPLES];
+static Uint16 BenchEdge[BENCH_SUITE_SAMPLES];
+static Uint16 BenchLevels[BITVEC_WORDS(BENCH_SUITE_SAMPLES)];
+static Uint16 BenchDecoded[BITVEC_WORDS(BENCH_SUITE_BITS)];
+static Uint16 BenchBits[BENCH_PRBS_BITS];
+static Uint32 BenchWords[BENCH_SUITE_BYTES];
+static Uint16 BenchBytes[BENCH_SUITE_BYTES];
+static Uint16 BenchChips[LINE_CHIP_WORDS(BENCH_SUITE_BYTES)];
+static line_code_t BenchLine;
+static manchester_rx_t BenchRx;
+static pam4_rx_t BenchPam4Rx;
+static eye_t BenchEye;
+static prbs_t BenchPrbs;
+static prbs_checker_t BenchChecker;
+#ifndef HOST_BUILD
+static telemetry_t BenchTelemetry;
+static Uint16 BenchPayload[BENCH_SUITE_BYTES * 2];
+#endif
+
+//
+// Function Prototypes
+//
+static void bench_rx(void);
+static void bench_buffer_decode(void);
+static void bench_pam4_rx(void);
+static void bench_eye_setup(void);
+static void bench_eye(void);
+static void bench_prbs(void);
+static void bench_checker(void);
+static void bench_encode(void);
+static void bench_decode(void);
+static void bench_line_setup(void);
+static void bench_line_encode(void);
+static void bench_line_decode(void);
+#ifndef HOST_BUILD
+static void bench_telemetry_setup(void);
+static void bench_telemetry(void);
+#if CPU_FILTER_CHANNELS > 0
+static void bench_cpu_filter(void);
+#endif
+#endif
+
+//
+// bench_suite_run - Time every kernel calls times, returns the number of
+// results written to r (at most BENCH_SUITE_CASES)
+//
+Uint16
+bench_suite_run(bench_result_t *r, Uint16 calls)
+{
+    bench_result_t *first = r;
+    Uint16 i, j;
+    Uint16 bit, high;
+
+    bench_init();
+
+    //
+    // The test signal, a 1 is low then high (ManchesterRx.h), and the
+    // decoder locked on it
+    //
+    prbs_init(&BenchPrbs, PRBS_ORDER_7);
+    for(i = 0; i < BENCH_SUITE_BITS; i++)
+    {
+        bit = prbs_next_bit(&BenchPrbs);
+        for(j = 0; j < BENCH_SUITE_SPB; j++)
+        {
+            high = j < BENCH_SUITE_SPB / 2 ? !bit : bit;
+            BenchSignal[i * BENCH_SUITE_SPB + j] = high ? BENCH_HIGH :
+                                                          BENCH_LOW;
+            BITVEC_PUT(BenchLevels, i * BENCH_SUITE_SPB + j, high);
+        }
+    }
+    manchester_rx_init(&BenchRx, BENCH_THRESHOLD, BENCH_HYSTERESIS,
+                       BENCH_SUITE_SPB);
+    for(j = 0; j < 4; j++)
+    {
+        for(i = 0; i < BENCH_SUITE_SAMPLES; i++)
+        {
+            manchester_rx_sample(&BenchRx, BenchSignal[i]);
+            BenchEdge[i] = BenchRx.crossed;
+        }
+    }
+    eye_init(&BenchEye, BENCH_THRESHOLD, 4096, BENCH_SUITE_SPB);
+
+    //
+    // Level 0 to 3 evenly from BENCH_LOW to BENCH_HIGH, run until the
+    // PAM-4 decoder has trained on it
+    //
+    prbs_init(&BenchPrbs, PRBS_ORDER_7);
+    for(i = 0; i < BENCH_SUITE_BITS; i++)
+    {
+        bit  = prbs_next_bit(&BenchPrbs) << 1;
+        bit |= prbs_next_bit(&BenchPrbs);
+        high = BENCH_LOW + (BENCH_HIGH - BENCH_LOW) / 3 * (bit ^ (bit >> 1));
+        for(j = 0; j < BENCH_SUITE_SPB; j++)
+        {
+            BenchPam4[i * BENCH_SUITE_SPB + j] = high;
+        }
+    }
+    pam4_rx_init(&BenchPam4Rx, 0, 4095, BENCH_HYSTERESIS, BENCH_SUITE_SPB);
+    for(j = 0; j < 2 * PAM4_RX_TRAIN_SYMBOLS / BENCH_SUITE_BITS; j++)
+    {
+        bench_pam4_rx();
+    }
+
+    prbs_init(&BenchPrbs, PRBS_ORDER_7);
+    for(i = 0; i < BENCH_PRBS_BITS; i++)
+    {
+        BenchBits[i] = prbs_next_bit(&BenchPrbs);
+    }
+    prbs_checker_init(&BenchChecker, PRBS_ORDER_7);
+
+    bench_run(r++, "manchester_rx_sample", "sample", BENCH_SUITE_SAMPLES,
+              0, bench_rx, calls);
+    bench_run(r++, "buffer_decode", "sample", BENCH_SUITE_SAMPLES,
+              0, bench_buffer_decode, calls);
+    bench_run(r++, "pam4_rx_sample", "sample", BENCH_SUITE_SAMPLES,
+              0, bench_pam4_rx, calls);
+    bench_run(r++, "eye_sample", "sample", BENCH_SUITE_SAMPLES,
+              bench_eye_setup, bench_eye, calls);
+    bench_run(r++, "prbs_next_bit", "bit", BENCH_PRBS_BITS,
+              0, bench_prbs, calls);
+    bench_run(r++, "prbs_checker_push", "bit", BENCH_PRBS_BITS,
+              0, bench_checker, calls);
+    bench_run(r++, "encode_manchester", "byte", BENCH_SUITE_BYTES,
+              0, bench_encode, calls);
+    bench_run(r++, "decode_manchester", "byte", BENCH_SUITE_BYTES,
+              0, bench_decode, calls);
+    for(i = 0; i < BENCH_SUITE_BYTES; i++)
+    {
+        BenchBytes[i] = (i * 7) & 0x00FF;
+    }
+    line_code_init(&BenchLine, LINE_8B10B, 0);
+    bench_run(r++, "line_encode", "byte", BENCH_SUITE_BYTES,
+              bench_line_setup, bench_line_encode, calls);
+    bench_run(r++, "line_decode", "byte", BENCH_SUITE_BYTES,
+              bench_line_setup, bench_line_decode, calls);
+#ifndef HOST_BUILD
+    for(i = 0; i < BENCH_SUITE_BYTES * 2; i++)
+    {
+        BenchPayload[i] = (i * 37) & 0x00FF;
+    }
+    bench_run(r++, "telemetry_send", "byte", BENCH_SUITE_BYTES * 2,
+              bench_telemetry_setup, bench_telemetry, calls);
+#if CPU_FILTER_CHANNELS > 0
+    bench_run(r++, "cpu_filter_run", "sample", 1, 0, bench_cpu_filter, calls);
+#endif
+#endif
+
+    return r - first;
+}
+
+//
+// bench_rx - Decode the test signal
+//
+static void
+bench_rx(void)
+{
+    Uint16 i;
+
+    for(i = 0; i < BENCH_SUITE_SAMPLES; i++)
+    {
+        manchester_rx_sample(&BenchRx, BenchSignal[i]);
+    }
+}
+
+//
+// bench_buffer_decode - Decode the sliced test signal as one buffer, as
+// process_buffer() of the CLONE project does
+//
+static void
+bench_buffer_decode(void)
+{
+    buffer_decode(BenchLevels, BENCH_SUITE_SAMPLES, BENCH_SUITE_SPB,
+                  BenchDecoded, BENCH_SUITE_BITS);
+}
+
+//
+// bench_pam4_rx - Decode the PAM-4 test signal
+//
+static void
+bench_pam4_rx(void)
+{
+    Uint16 i;
+
+    for(i = 0; i < BENCH_SUITE_SAMPLES; i++)
+    {
+        pam4_rx_sample(&BenchPam4Rx, BenchPam4[i]);
+    }
+}
+
+//
+// bench_eye_setup - Keep the eye folding, a full window stops it
+//
+static void
+bench_eye_setup(void)
+{
+    if(BenchEye.ready)
+    {
+        eye_restart(&BenchEye);
+    }
+}
+
+//
+// bench_eye - Fold the test signal on the locked decoder
+//
+static void
+bench_eye(void)
+{
+    Uint16 i;
+
+    for(i = 0; i < BENCH_SUITE_SAMPLES; i++)
+    {
+        eye_sample(&BenchEye, &BenchRx, BenchSignal[i], BenchEdge[i]);
+    }
+}
+
+//
+// bench_prbs - Generate PRBS bits
+//
+static void
+bench_prbs(void)
+{
+    Uint16 i;
+
+    for(i = 0; i < BENCH_PRBS_BITS; i++)
+    {
+        BenchBits[i] = prbs_next_bit(&BenchPrbs);
+    }
+}
+
+//
+// bench_checker - Check PRBS bits, in sync after the first call
+//
+static void
+bench_checker(void)
+{
+    Uint16 i;
+
+    for(i = 0; i < BENCH_PRBS_BITS; i++)
+    {
+        prbs_checker_push(&BenchChecker, BenchBits[i]);
+    }
+}
+
+//
+// bench_encode - Encode one word per byte value
+//
+static void
+bench_encode(void)
+{
+    Uint16 i;
+
+    for(i = 0; i < BENCH_SUITE_BYTES; i++)
+    {
+        BenchWords[i] = encode_manchester(i * 7);
+    }
+}
+
+//
+// bench_decode - Decode the words of bench_encode()
+//
+static void
+bench_decode(void)
+{
+    Uint16 i;
+
+    for(i = 0; i < BENCH_SUITE_BYTES; i++)
+    {
+        BenchWords[i] = decode_manchester(BenchWords[i]);
+    }
+}
+
+//
+// bench_line_setup - Start every frame at the same running disparity
+//
+static void
+bench_line_setup(void)
+{
+    line_code_restart(&BenchLine);
+}
+
+//
+// bench_line_encode - Encode the test bytes as one 8B10B frame, the code
+// with the most work per byte
+//
+static void
+bench_line_encode(void)
+{
+    line_encode(&BenchLine, BenchBytes, BENCH_SUITE_BYTES, BenchChips);
+}
+
+//
+// bench_line_decode - Decode the chips of bench_line_encode()
+//
+static void
+bench_line_decode(void)
+{
+    line_decode(&BenchLine, BenchChips,
+                BENCH_SUITE_BYTES * BenchLine.chips_per_byte, BenchBytes);
+}
+
+#ifndef HOST_BUILD
+//
+// bench_telemetry_setup - Empty the frame buffer, nothing is sent
+//
+static void
+bench_telemetry_setup(void)
+{
+    BenchTelemetry.head = 0;
+    BenchTelemetry.tail = 0;
+}
+
+//
+// bench_telemetry - Frame one payload (CRC and COBS)
+//
+static void
+bench_telemetry(void)
+{
+    telemetry_send(&BenchTelemetry, TELEMETRY_SAMPLES, BenchPayload,
+                   BENCH_SUITE_BYTES * 2);
+}
+
+#if CPU_FILTER_CHANNELS > 0
+//
+// bench_cpu_filter - Filter the C28x channels of the last ADC results
+//
+static void
+bench_cpu_filter(void)
+{
+    cpu_filter_run();
+}
+#endif
+#endif
+
+#endif // BENCH_ENABLE
+
+//
+// End of File
+//
@@ -0,0 +1,53 @@
+//###########################################################################
+//
+// FILE:   BenchSuite.h
+//
+// TITLE:  Benchmark cases of the receive, transmit and codec kernels
+//
+//###########################################################################
+
+#ifndef BENCH_SUITE_H
+#define BENCH_SUITE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "Bench.h"
+
+//
+// Defines
+//
+// bench_suite_run() times the kernels that build both on the target and
+// on the host (host/bench.c), plus the target only ones that do not
+// need the interrupts: the telemetry framing and the C28x filter. The
+// ISRs and the CLA task are timed by the main file, which owns them.
+//
+// The receive kernels run on BENCH_SUITE_BITS Manchester bits of a
+// PRBS-7, BENCH_SUITE_SPB samples per bit, on a 12-bit scale; the PAM-4
+// decoder on as many symbols. buffer_decode() gets the same signal
+// sliced at the threshold, as one buffer.
+//
+#define BENCH_SUITE_CASES       12
+#define BENCH_SUITE_BITS        16
+#define BENCH_SUITE_SPB         10
+#define BENCH_SUITE_SAMPLES     (BENCH_SUITE_BITS * BENCH_SUITE_SPB)
+#define BENCH_SUITE_BYTES       32
+
+//
+// Function Prototypes
+//
+Uint16 bench_suite_run(bench_result_t *r, Uint16 calls);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of BENCH_SUITE_H definition
+
+//
+// End of File
+//
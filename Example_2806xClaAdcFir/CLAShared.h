@@ -59,10 +59,254 @@ extern "C" {
 //
   #define FILTER_LEN          5       
 
+//
+// RX_CHANNELS is the number of receiver inputs sampled on every ePWM1 SOC
+// trigger. Each channel has its own FIR delay line.
+// At 1 MHz in ADC non-overlap mode one SOC takes ~0.45 us, which limits
+// this to 2 channels; the CLA Task 7 budget is about the same.
+//
+  #define RX_CHANNELS         2
+
+//
+// OVERSAMPLE is the number of back-to-back SOCs per channel on every 
+// trigger. CLA Task 7 sums them before the FIR (a first order CIC 
+// decimator with R = OVERSAMPLE), so the filter outputs are on a
+// 4096 * OVERSAMPLE scale and carry log2(OVERSAMPLE)/2 extra bits of
+// resolution for white noise. The CPU still sees one sample per trigger.
+// Channel ch uses SOC1 + ch * OVERSAMPLE .. SOC<(ch + 1) * OVERSAMPLE>.
+//
+// All RX_CHANNELS * OVERSAMPLE SOCs (~0.45 us each in non-overlap mode)
+// must complete within one trigger period.
+//
+  #define OVERSAMPLE          1
+
+  #if RX_CHANNELS * OVERSAMPLE > 15
+  #error "RX_CHANNELS * OVERSAMPLE SOCs do not fit in SOC1 .. SOC15"
+  #endif
+  #if RX_CHANNELS > 4 || OVERSAMPLE > 4
+  #error "CLA Task 7 handles up to 4 channels and 4x oversampling"
+  #endif
+
+//
+// CPU_FILTER_CHANNELS is the number of receiver channels filtered by the
+// C28x in fixed point (CpuFilter.c) instead of the CLA; they are the last
+// ones. With 0 CLA Task 7 runs the whole receive filter. With any channel
+// on the C28x the ADC interrupt goes to the CPU as well, which filters
+// its channels while the CLA filters the others, then combines them all.
+// RX_CHANNELS leaves the CLA unused, for F2806x parts without one.
+//
+  #define CPU_FILTER_CHANNELS 0
+  #define CLA_FILTER_CHANNELS (RX_CHANNELS - CPU_FILTER_CHANNELS)
+
+  #if CPU_FILTER_CHANNELS > RX_CHANNELS
+  #error "CPU_FILTER_CHANNELS is more than RX_CHANNELS"
+  #endif
+
+//
+// Set CLA_PIPELINE to 1 to run the slicer, the clock recovery and the bit
+// packing on the CLA as well (Tasks 4..6 chained after Task 7, see
+// CLA_FIR.asm and ClaPipe.c). The CPU then only reads packed bits. The
+// bits are decided on the half bit sums about each mid-bit edge, as in
+// ManchesterRx.c, but the CLA clock takes every mid-bit edge at full
+// weight. The sums run over a ring of the last 2 * ClaHalf samples in
+// the CLA to CPU message RAM, which leaves room for at most
+// CLA_RX_MAX_HALF samples on each side of the edge (the whole bit up to
+// 12 samples per bit); above that only those are summed.
+// CLA_STAGES is the number of pipeline stages including the filter;
+// CLA_BIT_RING is the size of the packed bit ring in words (a power of 2).
+//
+  #define CLA_PIPELINE        0
+  #define CLA_STAGES          4
+  #define CLA_BIT_RING        16
+  #define CLA_RX_MAX_HALF     6
+
+  #if CLA_PIPELINE && CPU_FILTER_CHANNELS > 0
+  #error "CLA_PIPELINE needs the whole filter on the CLA"
+  #endif
+
+//
+// Set CARRIER_DETECT to 1 to run the receiver only while a carrier is
+// there (Carrier.c). Without one, ePWM1 starts no conversions, so the
+// CLA filter and the sample ISR are idle, and CLA Task 1 watches the
+// first receiver input on SOC0 every CARRIER_DIV sample periods instead.
+//
+  #define CARRIER_DETECT      0
+  #define CARRIER_DIV         8
+
+  #if CARRIER_DETECT && CLA_FILTER_CHANNELS == 0
+  #error "CARRIER_DETECT runs its detector on the CLA"
+  #endif
+
+//
+// Set CLA_EQUALIZER to 1 to run an adaptive LMS equalizer of EQ_TAPS taps
+// on the combined output in CLA Task 7, before VoltFilt (Equalizer.c).
+// Its output is EQ_DELAY samples behind its input. It takes 6 CLA cycles
+// per tap and about 30 more per sample on top of the filter, which two
+// channels at 1 MHz do not leave; use it with one channel or a lower
+// sample rate. The taps and the delay line take 4 * EQ_TAPS + 6 words of
+// the CLA to CPU message RAM.
+//
+// EqMode values:
+// EQ_OFF         VoltFilt is the combined output, nothing is adapted
+// EQ_TRAIN       the reference is the sign of the equalizer input
+// EQ_TRACK       the reference is the sign of the equalizer output
+//                (decision directed)
+//
+  #define CLA_EQUALIZER       0
+  #define EQ_TAPS             5
+  #define EQ_DELAY            (EQ_TAPS / 2)
+
+  #define EQ_OFF              0
+  #define EQ_TRAIN            1
+  #define EQ_TRACK            2
+
+  #if CLA_EQUALIZER && CPU_FILTER_CHANNELS > 0
+  #error "CLA_EQUALIZER needs the whole combiner on the CLA"
+  #endif
+  #if EQ_TAPS < 3 || EQ_TAPS > 8
+  #error "CLA Task 7 handles 3 to 8 equalizer taps"
+  #endif
+
   extern Uint16  VoltFilt;
-  extern float32  X[FILTER_LEN];
+  extern float32  X[RX_CHANNELS][FILTER_LEN];
   extern float32 A[FILTER_LEN];
 
+//
+// Diversity combining, CLA to CPU:
+// VoltFiltCh   per channel FIR output
+// YCh          per channel FIR output (float, scratch for the combiner)
+// CombAbsSum   running sum of |y - CombMid| per channel
+// CombSqSum    running sum of (y - CombMid)^2 per channel
+// CombAbsSnap  CombAbsSum at the end of the last window
+// CombSqSnap   CombSqSum at the end of the last window
+// CombCount    samples in the current window
+// CombSeq      incremented every time the snapshots are updated
+//
+// CPU to CLA:
+// CombWeight   combining weight per channel, VoltFilt = sum(w * y)
+// CombWindow   window length in samples
+// CombMid      signal mid level (slicer threshold) in ADC codes
+//
+// When the C28x filters any channel it runs the combiner, so VoltFilt and
+// the Comb statistics are then written by the CPU, and VoltFiltCh / YCh
+// only hold the CLA channels (CpuFilter.out / .y hold the others).
+//
+  extern Uint16  VoltFiltCh[RX_CHANNELS];
+  extern float32 YCh[RX_CHANNELS];
+  extern float32 CombAbsSum[RX_CHANNELS];
+  extern float32 CombSqSum[RX_CHANNELS];
+  extern float32 CombAbsSnap[RX_CHANNELS];
+  extern float32 CombSqSnap[RX_CHANNELS];
+  extern float32 CombCount;
+  extern Uint16  CombSeq;
+  extern float32 CombWeight[RX_CHANNELS];
+  extern float32 CombWindow;
+  extern float32 CombMid;
+
+//
+// Receive pipeline mailboxes (CLA_PIPELINE), CLA to CPU:
+// ClaLevel       sliced level, slicer to clock recovery
+// ClaEdge        1 if ClaLevel changed on this sample
+// ClaCount       samples since the last mid-bit edge
+// ClaLocked      1 while the bit clock is locked
+// ClaBit         last bit, clock recovery to bit packing
+// ClaBitValid    1 if this sample completed ClaBit
+// ClaHist        last 2 * ClaHistHalf filtered samples, a ring
+// ClaHistHead    oldest ClaHist entry, the next one written
+// ClaHistHalf    ClaHalf the ring was filled for, a change clears it
+// ClaEarly       sum of the ClaHalf samples before the last ClaHalf
+// ClaLate        sum of the last ClaHalf samples
+// ClaPending     a mid-bit edge waits for its later half bit
+// ClaEdgeLevel   ClaLevel after that edge, breaks a tie of the sums
+// ClaBits        decoded bits since Task 8
+// ClaSyncLosses  number of times the lock was lost
+// ClaBitWord     bits being packed, LSB first
+// ClaBitN        bits in ClaBitWord
+// ClaBitRing     packed words, 16 bits each, the first bit in bit 0
+// ClaBitHead     next ClaBitRing entry to be written
+// ClaBitWords    words written since Task 8, modulo 2^16
+// ClaCycles      cycles of the last run of each stage, [CLA_STAGES] is
+//                Task 7 start to the end of the last stage
+// ClaCyclesMax   highest ClaCycles since Task 8
+// ClaStageStart  ePWM2 count at the start of the running stage
+// ClaPipeStart   ePWM2 count at the start of Task 7
+//
+// CPU to CLA:
+// ClaSliceHi     level goes to 1 above this
+// ClaSliceLo     level goes to 0 below this
+// ClaEdgeWindow  3/4 bit in samples
+// ClaLostWindow  5/4 bit in samples
+// ClaHalf        samples per half bit sum, 2 to CLA_RX_MAX_HALF
+//
+  extern Uint16  ClaLevel;
+  extern Uint16  ClaEdge;
+  extern Uint16  ClaCount;
+  extern Uint16  ClaLocked;
+  extern Uint16  ClaBit;
+  extern Uint16  ClaBitValid;
+  extern Uint16  ClaHist[2 * CLA_RX_MAX_HALF];
+  extern Uint16  ClaHistHead;
+  extern Uint16  ClaHistHalf;
+  extern int32   ClaEarly;
+  extern int32   ClaLate;
+  extern Uint16  ClaPending;
+  extern Uint16  ClaEdgeLevel;
+  extern Uint32  ClaBits;
+  extern Uint32  ClaSyncLosses;
+  extern Uint16  ClaBitWord;
+  extern Uint16  ClaBitN;
+  extern Uint16  ClaBitRing[CLA_BIT_RING];
+  extern Uint16  ClaBitHead;
+  extern Uint16  ClaBitWords;
+  extern Uint16  ClaCycles[CLA_STAGES + 1];
+  extern Uint16  ClaCyclesMax[CLA_STAGES + 1];
+  extern Uint16  ClaStageStart;
+  extern Uint16  ClaPipeStart;
+  extern Uint16  ClaSliceHi;
+  extern Uint16  ClaSliceLo;
+  extern Uint16  ClaEdgeWindow;
+  extern Uint16  ClaLostWindow;
+  extern Uint16  ClaHalf;
+
+//
+// Carrier detector (CARRIER_DETECT), CLA to CPU:
+// CarrierLast    last detector sample
+// CarrierSum     sum of |x[n] - x[n - 1]| over the current window
+// CarrierCount   detector samples in the current window
+// CarrierEnergy  CarrierSum of the last complete window
+//
+// CPU to CLA:
+// CarrierWindow  window length in detector samples
+// CarrierLevel   CarrierEnergy above this is a carrier
+//
+  extern float32 CarrierLast;
+  extern float32 CarrierSum;
+  extern float32 CarrierCount;
+  extern float32 CarrierEnergy;
+  extern float32 CarrierWindow;
+  extern float32 CarrierLevel;
+
+//
+// Adaptive equalizer (CLA_EQUALIZER), CLA to CPU:
+// EqW            taps, EqW[k] weighs the input of k samples ago
+// EqX            input delay line, y - CombMid, EqX[k + 1] is the input
+//                of k samples ago after Task 7 (EqX[0] is scratch)
+// EqErrSum       running sum of the squared error e = d - z
+// EqErrSnap      EqErrSum at the end of the last CombWindow
+//
+// CPU to CLA:
+// EqMode         EQ_OFF, EQ_TRAIN or EQ_TRACK
+// EqMu           LMS step, w[k] += EqMu * e * x[n - k]
+// EqLevel        reference level d, +-EqLevel around CombMid
+//
+  extern float32 EqW[EQ_TAPS];
+  extern float32 EqX[EQ_TAPS + 1];
+  extern float32 EqErrSum;
+  extern float32 EqErrSnap;
+  extern Uint16  EqMode;
+  extern float32 EqMu;
+  extern float32 EqLevel;
+
 //
 // The following are symbols defined in the CLA assembly code
 // Including them in the shared header file makes them 
@@ -22,20 +22,24 @@ _Cla1Prog_Start
        .align       2
 
 
+    .if CARRIER_DETECT == 0
 _Cla1Task1:
     MSTOP
     MNOP
     MNOP
     MNOP
 _Cla1T1End:
+    .endif
 
 
+    .if CLA_EQUALIZER == 0
 _Cla1Task2:
     MSTOP
     MNOP
     MNOP
     MNOP
 _Cla1T2End:
+    .endif
 
 _Cla1Task3:
     MSTOP
@@ -45,6 +49,488 @@ _Cla1Task3:
 _Cla1T3End:
     
 
+;//==============================================
+;// Receive pipeline, CLA_PIPELINE == 1
+;//==============================================
+;
+; Task 7 (filter) -> Task 4 (slicer) -> Task 5 (clock recovery)
+;                                    -> Task 6 (bit packing, on a bit)
+;
+; The CLA can not write MIFRC, so a stage starts the next one by forcing
+; the interrupt of an idle ePWM: Task 4..6 are triggered by EPWM4..6INT
+; (ClaPipe.c sets them up). Tasks 4..6 have a higher priority than Task 7,
+; so a sample is through the pipeline before the next one is filtered.
+;
+; Every stage times itself on the free running ePWM2 counter (1 count
+; per SYSCLKOUT) into ClaCycles[stage] and ClaCyclesMax[stage];
+; ClaCycles[CLA_STAGES] is the time from the start of Task 7 to the end
+; of the last stage that ran.
+;
+PIPE_TBCTR .set 0x04                          ; ePWM register offsets
+PIPE_ETCLR .set 0x1C
+PIPE_ETFRC .set 0x1D
+
+; Clear the ePWM interrupt flag that started this task, so the next
+; force raises the interrupt again
+;
+STAGE_ACK .macro EPWM
+    MMOVIZ     MR0, #0.0
+    MMOVXI     MR0, #1
+    MMOV16     @EPWM+PIPE_ETCLR, MR0
+    .endm
+
+; Start the next stage (on EPWM) once this task ends. Uses MR1
+;
+STAGE_NEXT .macro EPWM
+    MMOVIZ     MR1, #0.0
+    MMOVXI     MR1, #1
+    MMOV16     @EPWM+PIPE_ETFRC, MR1
+    .endm
+
+STAGE_BEGIN .macro
+    MMOVZ16    MR0, @_EPwm2Regs+PIPE_TBCTR
+    MMOV16     @_ClaStageStart, MR0
+    .endm
+
+; MR1 = max(MR1, ClaCyclesMax[IDX]), stored back. Uses MR3
+;
+STAGE_MAX .macro IDX
+    MMOV16     @_ClaCycles+IDX, MR1
+    MMOVZ16    MR3, @_ClaCyclesMax+IDX
+    MCMP32     MR1, MR3
+    MSWAPF     MR1, MR3, LT
+    MMOV16     @_ClaCyclesMax+IDX, MR1
+    .endm
+
+; Cycles since STAGE_BEGIN and since the start of Task 7, modulo 2^16
+;
+STAGE_END .macro STAGE
+    MMOVZ16    MR0, @_EPwm2Regs+PIPE_TBCTR
+    MMOVIZ     MR2, #0.0
+    MMOVXI     MR2, #0xFFFF
+    MMOVZ16    MR1, @_ClaStageStart
+    MSUB32     MR1, MR0, MR1
+    MAND32     MR1, MR1, MR2
+    STAGE_MAX  STAGE
+    MMOVZ16    MR1, @_ClaPipeStart
+    MSUB32     MR1, MR0, MR1
+    MAND32     MR1, MR1, MR2
+    STAGE_MAX  CLA_STAGES
+    .endm
+
+; Empty the half bit sum ring, MR0 = 0
+;
+HIST_CLEAR .macro
+    .asg       0, HIST_K
+    .loop      2 * CLA_RX_MAX_HALF
+    MMOV16     @_ClaHist+HIST_K, MR0
+    .eval      HIST_K + 1, HIST_K
+    .endloop
+    MMOV16     @_ClaHistHead, MR0
+    MMOV32     @_ClaEarly, MR0
+    MMOV32     @_ClaLate, MR0
+    MMOV16     @_ClaPending, MR0
+    .endm
+
+;//==============================================
+;// Carrier detector, CARRIER_DETECT == 1
+;//==============================================
+;
+; Task 1 is triggered by ADCINT1 (end of SOC0), which ePWM7 starts every
+; CARRIER_DIV sample periods while the receive pipeline is off. It sums
+; |x[n] - x[n-1]| of the first receiver input over CarrierWindow
+; samples: a Manchester carrier changes level between most samples, a
+; steady or slowly drifting background hardly at all. A window sum above
+; CarrierLevel forces EPWM8INT, on which the C28x starts the pipeline
+; (Carrier.c).
+;
+    .if CARRIER_DETECT == 1
+
+_Cla1Task1:
+    .if CLA_DEBUG == 1
+    MDEBUGSTOP
+    .endif
+    MMOV32     MR1, @_CarrierLast            ;1 MR1 = x[n-1]
+    MMOV32     MR2, @_CarrierSum             ;2
+    MMOV32     MR3, @_CarrierCount           ;3
+    MNOP                                     ;4 Wait till I8 to read result
+    MNOP                                     ;5 Wait till I8 to read result
+    MNOP                                     ;6 Wait till I8 to read result
+    MNOP                                     ;7 Wait till I8 to read result
+    MUI16TOF32 MR0, @_AdcResult+0            ;8 MR0 = x[n], ADCRESULT0
+    MADDF32    MR3, #1.0, MR3                ; CarrierCount + 1
+    MSUBF32    MR1, MR0, MR1                 ; MR1 = x[n] - x[n-1]
+    MMOV32     @_CarrierLast, MR0
+    MABSF32    MR1, MR1
+    MADDF32    MR2, MR2, MR1                 ; MR2 = CarrierSum + |d|
+    MMOV32     MR1, @_CarrierWindow
+    MMOV32     @_CarrierCount, MR3
+
+;
+; Only stores and MNOPs between MCMPF32 and the branches
+;
+    MCMPF32    MR3, MR1
+    MMOV32     @_CarrierSum, MR2
+    MNOP
+    MNOP
+    MBCNDD     _Cla1T1Done, LT
+    MNOP
+    MNOP
+    MNOP
+
+    MMOV32     @_CarrierEnergy, MR2          ; end of the window
+    MMOV32     MR1, @_CarrierLevel
+    MMOVIZ     MR0, #0.0
+    MCMPF32    MR2, MR1
+    MMOV32     @_CarrierSum, MR0
+    MMOV32     @_CarrierCount, MR0
+    MNOP
+    MBCNDD     _Cla1T1Done, LEQ
+    MNOP
+    MNOP
+    MNOP
+    STAGE_NEXT _EPwm8Regs                    ; carrier, tell the C28x
+
+_Cla1T1Done:
+    MSTOP
+_Cla1T1End:
+
+    .endif
+
+;//==============================================
+;// Adaptive equalizer, CLA_EQUALIZER == 1
+;//==============================================
+;
+; Task 7 runs the combined output through an LMS adaptive FIR of EQ_TAPS
+; taps (EQ_RUN below). Task 2, forced by the C28x, and Task 8 put it back
+; to a delay of EQ_DELAY samples: every tap 0 but EqW[EQ_DELAY], the
+; delay line and the error sum cleared (Equalizer.c).
+;
+; Set the tap K and clear its delay line entry. MR0 must hold 0.0, MR1
+; 1.0
+;
+EQ_INIT_TAP .macro K
+    .if K == EQ_DELAY
+    MMOV32     @_EqW+K*2, MR1
+    .else
+    MMOV32     @_EqW+K*2, MR0
+    .endif
+    MMOV32     @_EqX+K*2+2, MR0
+    .endm
+
+EQ_RESET .macro
+    MMOVIZ     MR0, #0.0
+    MMOVIZ     MR1, #1.0
+    MMOV32     @_EqX+0, MR0
+    .asg       0, EQ_K
+    .loop      EQ_TAPS
+    EQ_INIT_TAP EQ_K
+    .eval      EQ_K + 1, EQ_K
+    .endloop
+    MMOV32     @_EqErrSum, MR0
+    .endm
+
+    .if CLA_EQUALIZER == 1
+
+_Cla1Task2:
+    .if CLA_DEBUG == 1
+    MDEBUGSTOP
+    .endif
+    EQ_RESET
+    MSTOP
+_Cla1T2End:
+
+    .endif
+
+    .if CLA_PIPELINE == 1
+
+_Cla1Task4:
+
+;==============================================
+; Half bit sums, as manchester_rx_sample():
+; ClaLate is the sum of the last ClaHalf
+; samples, ClaEarly of the ClaHalf before them.
+; VoltFilt goes into the ring of 2 * ClaHalf
+; samples in place of the one a bit back; the
+; one half a bit back moves from ClaLate to
+; ClaEarly. A new ClaHalf (rate change) empties
+; the ring first.
+;
+; Slicer: VoltFilt against the hysteresis band
+; ClaSliceLo .. ClaSliceHi. ClaLevel is the
+; sliced level, ClaEdge is 1 if it changed.
+;==============================================
+    .if CLA_DEBUG == 1
+    MDEBUGSTOP
+    .endif
+    STAGE_ACK  _EPwm4Regs
+    STAGE_BEGIN
+    MMOVZ16    MR1, @_ClaHalf                ; MR1 = half
+    MMOVZ16    MR2, @_ClaHistHalf
+    MCMP32     MR1, MR2
+    MNOP
+    MNOP
+    MNOP
+    MBCNDD     _Cla1T4Sums, EQ
+    MNOP
+    MNOP
+    MNOP
+    MMOVIZ     MR0, #0.0
+    HIST_CLEAR
+    MMOV16     @_ClaHistHalf, MR1
+
+_Cla1T4Sums:
+    MMOVZ16    MR0, @_ClaHistHead            ; MR0 = head
+    MADD32     MR2, MR0, MR1                 ; MR2 = head + half
+    MLSL32     MR1, #1                       ; MR1 = ring length
+    MSUB32     MR3, MR2, MR1
+    MCMP32     MR2, MR1
+    MSWAPF     MR2, MR3, GEQ                 ; MR2 = half a bit back
+    MMOV16     MAR0, MR0, #_ClaHist          ; MAR0 = &ClaHist[head]
+    MMOVIZ     MR3, #0.0
+    MMOVXI     MR3, #1
+    MMOV16     MAR1, MR2, #_ClaHist          ; MAR1 = &ClaHist[mid]
+    MADD32     MR0, MR0, MR3                 ; MR0 = head + 1
+    MMOVIZ     MR3, #0.0
+    MCMP32     MR0, MR1
+    MSWAPF     MR0, MR3, GEQ                 ; wrap round
+    MMOV16     @_ClaHistHead, MR0
+    MMOVZ16    MR0, @_VoltFilt               ; MR0 = x
+    MMOVZ16    MR1, *MAR0[#0]++              ; MR1 = x a bit back
+    MMOVZ16    MR2, *MAR1[#0]++              ; MR2 = x half a bit back
+    MMOV16     *MAR0[#0]++, MR0              ; x in its place
+    MSUB32     MR1, MR2, MR1
+    MSUB32     MR2, MR0, MR2
+    MMOV32     MR3, @_ClaEarly
+    MADD32     MR3, MR3, MR1                 ; early += mid - oldest
+    MMOV32     @_ClaEarly, MR3
+    MMOV32     MR3, @_ClaLate
+    MADD32     MR3, MR3, MR2                 ; late += x - mid
+    MMOV32     @_ClaLate, MR3
+
+    MMOVZ16    MR0, @_VoltFilt
+    MMOVZ16    MR3, @_ClaLevel               ; MR3 = old level
+    MMOVZ16    MR1, @_ClaSliceHi
+    MMOVIZ     MR2, #0.0
+    MMOVXI     MR2, #1
+    MCMP32     MR0, MR1
+    MSWAPF     MR3, MR2, GT                  ; above the band: 1
+    MMOVZ16    MR1, @_ClaSliceLo
+    MMOVIZ     MR2, #0.0
+    MCMP32     MR0, MR1
+    MSWAPF     MR3, MR2, LT                  ; below the band: 0
+    MMOVZ16    MR1, @_ClaLevel
+    MXOR32     MR1, MR1, MR3                 ; 1 on a level change
+    MMOV16     @_ClaLevel, MR3
+    MMOV16     @_ClaEdge, MR1
+    STAGE_NEXT _EPwm5Regs
+    STAGE_END  1
+    MSTOP
+_Cla1T4End:
+
+_Cla1Task5:
+
+;==============================================
+; Clock recovery, as manchester_rx_sample()
+; without its clock gain: an edge at least
+; ClaEdgeWindow samples after the last mid-bit
+; edge is the next mid-bit edge. Edges before
+; that are bit boundaries, ignored once locked.
+; No edge for ClaLostWindow samples loses the
+; lock.
+;
+; The bit is decided ClaHalf - 1 samples after
+; its mid-bit edge, when ClaLate holds the half
+; bit after the edge and ClaEarly the one
+; before: a 1 if ClaLate is larger, a 0 if it
+; is smaller, else the level after the edge.
+;==============================================
+    .if CLA_DEBUG == 1
+    MDEBUGSTOP
+    .endif
+    STAGE_ACK  _EPwm5Regs
+    STAGE_BEGIN
+    MMOVZ16    MR0, @_ClaCount
+    MMOVIZ     MR1, #0.0
+    MMOVXI     MR1, #1
+    MADD32     MR0, MR0, MR1                 ; MR0 = count + 1
+    MMOVXI     MR1, #0xFFFF
+    MCMP32     MR0, MR1
+    MSWAPF     MR0, MR1, GT                  ; saturate at 0xFFFF
+    MMOVZ16    MR2, @_ClaEdge
+    MMOVZ16    MR1, @_ClaEdgeWindow
+    MMOVIZ     MR3, #0.0                     ; MR3 = 0 up to the decision
+    MCMP32     MR2, MR3
+    MMOV16     @_ClaBitValid, MR3            ; no bit unless decided
+    MNOP
+    MNOP
+    MBCNDD     _Cla1T5NoEdge, EQ
+    MNOP
+    MNOP
+    MNOP
+    MCMP32     MR0, MR1                      ; count - edge window
+    MNOP
+    MNOP
+    MNOP
+    MBCNDD     _Cla1T5Boundary, LT
+    MNOP
+    MNOP
+    MNOP
+
+    MMOVZ16    MR2, @_ClaLevel               ; mid-bit edge
+    MMOV16     @_ClaEdgeLevel, MR2
+    MMOVXI     MR3, #1
+    MMOV16     @_ClaPending, MR3
+    MMOV16     @_ClaLocked, MR3
+    MMOVIZ     MR0, #0.0                     ; count = 0
+    MBCNDD     _Cla1T5Decide, UNC
+    MNOP
+    MNOP
+    MNOP
+
+_Cla1T5Boundary:
+    MMOVZ16    MR2, @_ClaLocked
+    MCMP32     MR2, MR3
+    MNOP
+    MNOP
+    MNOP
+    MBCNDD     _Cla1T5Decide, NEQ            ; locked: bit boundary
+    MNOP
+    MNOP
+    MNOP
+    MMOVIZ     MR0, #0.0                     ; unlocked: restart the count
+    MBCNDD     _Cla1T5Decide, UNC
+    MNOP
+    MNOP
+    MNOP
+
+_Cla1T5NoEdge:
+    MMOVZ16    MR2, @_ClaLocked
+    MMOVZ16    MR1, @_ClaLostWindow
+    MCMP32     MR2, MR3
+    MNOP
+    MNOP
+    MNOP
+    MBCNDD     _Cla1T5Decide, EQ             ; not locked
+    MNOP
+    MNOP
+    MNOP
+    MCMP32     MR0, MR1                      ; count - lost window
+    MNOP
+    MNOP
+    MNOP
+    MBCNDD     _Cla1T5Decide, LEQ
+    MNOP
+    MNOP
+    MNOP
+    MMOV16     @_ClaLocked, MR3              ; lock lost
+    MMOV16     @_ClaPending, MR3
+    MMOVXI     MR3, #1
+    MMOV32     MR2, @_ClaSyncLosses
+    MADD32     MR2, MR2, MR3
+    MMOV32     @_ClaSyncLosses, MR2
+
+_Cla1T5Decide:
+    MMOVZ16    MR2, @_ClaPending
+    MMOVIZ     MR3, #0.0
+    MCMP32     MR2, MR3
+    MNOP
+    MNOP
+    MNOP
+    MBCNDD     _Cla1T5Done, EQ               ; no bit waiting
+    MNOP
+    MNOP
+    MNOP
+    MMOVZ16    MR1, @_ClaHalf
+    MMOVXI     MR3, #1
+    MSUB32     MR1, MR1, MR3                 ; MR1 = half - 1
+    MCMP32     MR0, MR1
+    MNOP
+    MNOP
+    MNOP
+    MBCNDD     _Cla1T5Done, LT               ; later half not in yet
+    MNOP
+    MNOP
+    MNOP
+
+    MMOV32     MR1, @_ClaLate
+    MMOV32     MR2, @_ClaEarly
+    MMOVZ16    MR3, @_ClaEdgeLevel           ; a tie: the edge direction
+    MCMP32     MR1, MR2
+    MMOVIZ     MR1, #0.0
+    MMOVIZ     MR2, #0.0
+    MMOVXI     MR2, #1
+    MSWAPF     MR3, MR2, GT                  ; later half larger: 1
+    MSWAPF     MR3, MR1, LT                  ; later half smaller: 0
+    MMOV16     @_ClaBit, MR3
+    MMOVIZ     MR3, #0.0
+    MMOV16     @_ClaPending, MR3
+    MMOVXI     MR3, #1
+    MMOV16     @_ClaBitValid, MR3
+    MMOV32     MR2, @_ClaBits
+    MADD32     MR2, MR2, MR3
+    MMOV32     @_ClaBits, MR2
+    STAGE_NEXT _EPwm6Regs                    ; pack the bit
+
+_Cla1T5Done:
+    MMOV16     @_ClaCount, MR0
+    STAGE_END  2
+    MSTOP
+_Cla1T5End:
+
+_Cla1Task6:
+
+;==============================================
+; Bit packing: ClaBit is shifted in LSB first,
+; every 16 bits the word goes to ClaBitRing and
+; ClaBitHead / ClaBitWords move on.
+;==============================================
+    .if CLA_DEBUG == 1
+    MDEBUGSTOP
+    .endif
+    STAGE_ACK  _EPwm6Regs
+    STAGE_BEGIN
+    MMOVZ16    MR0, @_ClaBitWord
+    MMOVZ16    MR1, @_ClaBit
+    MLSR32     MR0, #1
+    MLSL32     MR1, #15
+    MOR32      MR0, MR0, MR1                 ; word = word >> 1 | bit << 15
+    MMOVZ16    MR1, @_ClaBitN
+    MMOVIZ     MR2, #0.0
+    MMOVXI     MR2, #1
+    MADD32     MR1, MR1, MR2                 ; MR1 = bits in the word
+    MMOVXI     MR2, #16
+    MCMP32     MR1, MR2
+    MMOV16     @_ClaBitWord, MR0
+    MMOV16     @_ClaBitN, MR1
+    MNOP
+    MBCNDD     _Cla1T6Done, LT
+    MNOP
+    MNOP
+    MNOP
+
+    MMOVZ16    MR1, @_ClaBitHead
+    MMOV16     MAR0, MR1, #_ClaBitRing
+    MMOVIZ     MR2, #0.0
+    MMOV16     @_ClaBitN, MR2
+    MMOVXI     MR2, #1
+    MMOV16     *MAR0[#0]++, MR0              ; ClaBitRing[head] = word
+    MADD32     MR1, MR1, MR2
+    MMOVXI     MR2, #CLA_BIT_RING - 1
+    MAND32     MR1, MR1, MR2
+    MMOV16     @_ClaBitHead, MR1
+    MMOVZ16    MR1, @_ClaBitWords
+    MMOVXI     MR2, #1
+    MADD32     MR1, MR1, MR2
+    MMOV16     @_ClaBitWords, MR1            ; published last
+
+_Cla1T6Done:
+    STAGE_END  3
+    MSTOP
+_Cla1T6End:
+
+    .else
+
 _Cla1Task4:
     MSTOP
     MNOP
@@ -67,55 +553,21 @@ _Cla1Task6:
     MNOP
 _Cla1T6End:    
 
-_Cla1Task7:
-
-        .if CLA_DEBUG == 1
-        MDEBUGSTOP
-       .endif
+    .endif
 
 ;//==============================================
-;// CLA Task 7
-;//
-;// This task:
-;// 
-;// 1. Is triggered by the early ADC interrupt. 
-;//    This interrupt occurs at the end of the
-;//    sample & hold window 
-;// 2. Reads the ADC RESULT1 register as soon
-;//    as it is available
-;// 3. It will then run a FIR filter and places the 
-;//    result into VoltFilt.
-;// 4. The main CPU will take an interrupt at the
-;//    end of the task.  It will log the
-;//    ADC RESULT1 register for comparison as 
-;//    well as the CLA generated VoltFilt value
-;// 
-;// Before starting the ADC conversions, force 
-;// Task 8 to initialize the filter states and 
-;// coefficients.
-;//
+;// Per channel FIR and combiner macros
 ;//==============================================
 
-
-; X and A are arrays of 32-bit float (i.e. 2 words)
-; Use these defines to make the code easier to read
+; X is an array of RX_CHANNELS delay lines of FILTER_LEN 32-bit floats
+; (2 words each). FIR_WORDS is the size of one delay line in words.
 ;
-_X4  .set _X+8  
-_X3  .set _X+6  
-_X2  .set _X+4  
-_X1  .set _X+2  
-_X0  .set _X+0  
+FIR_WORDS  .set FILTER_LEN*2
 
-_A4  .set _A+8  
-_A3  .set _A+6  
-_A2  .set _A+4  
-_A1  .set _A+2  
-_A0  .set _A+0 
-
-; CLA 5-tap FIR Filter
+; CLA 5-tap FIR Filter for channel CH
 ;
 ; Coefficients A[0, 1, 2, 3, 4]
-; Data         X[0, 1, 2, 3, 4] (Delay Line - X[0] is newest value)
+; Data         X[CH][0, 1, 2, 3, 4] (Delay Line - X[CH][0] is newest value)
 ;
 ; Equations
 ;
@@ -129,40 +581,334 @@ _A0  .set _A+0
 ; X1 = X0
 ; Y = Y = A0 * X0
 ;
-    MMOV32     MR0,@_X4                      ;1 Load MR0 with X4
-    MMOV32     MR1,@_A4                      ;2 Load MR1 with A4
+; The filter input is the sum of the OVERSAMPLE ADC results of the
+; channel, ADCRESULT<1 + CH * OVERSAMPLE> onwards (AdcResult holds the
+; results as consecutive 16-bit words). The filter output is stored as 
+; Uint16 in VoltFiltCh[CH] and as float in YCh[CH].
+;
+FIR_CH .macro CH
+    MMOV32     MR0,@_X+CH*FIR_WORDS+8        ;1 Load MR0 with X4
+    MMOV32     MR1,@_A+8                     ;2 Load MR1 with A4
+    .if RX_CHANNELS == 1
     MNOP                                     ;3 Wait till I8 to read result
     MNOP                                     ;4 Wait till I8 to read result
     MNOP                                     ;5 Wait till I8 to read result
     MNOP                                     ;6 Wait till I8 to read result
     MNOP                                     ;7 Wait till I8 to read result
-    MUI16TOF32 MR2,  @_AdcResult.ADCRESULT1  ;8 Read ADCRESULT1 and convert to float
+    .endif
+    MUI16TOF32 MR2,  @_AdcResult+1+CH*OVERSAMPLE   ;8 Read result and convert to float
+    .if OVERSAMPLE > 1
+    MUI16TOF32 MR3,  @_AdcResult+2+CH*OVERSAMPLE   ; Sum the oversampled results
+    MADDF32    MR2, MR2, MR3
+    .endif
+    .if OVERSAMPLE > 2
+    MUI16TOF32 MR3,  @_AdcResult+3+CH*OVERSAMPLE
+    MADDF32    MR2, MR2, MR3
+    .endif
+    .if OVERSAMPLE > 3
+    MUI16TOF32 MR3,  @_AdcResult+4+CH*OVERSAMPLE
+    MADDF32    MR2, MR2, MR3
+    .endif
 
     MMPYF32    MR2, MR1, MR0                 ; MR2 (Y) = MR1 (A4) * MR0 (X4)
- || MMOV32     @_X0, MR2
+ || MMOV32     @_X+CH*FIR_WORDS+0, MR2
+
+    MMOVD32    MR0,@_X+CH*FIR_WORDS+6        ; Load MR0 with X3, Load X4 with X3
+    MMOV32     MR1,@_A+6                     ; Load MR1 with A3
 
-    MMOVD32    MR0,@_X3                      ; Load MR0 with X3, Load X4 with X3
-    MMOV32     MR1,@_A3                      ; Load MR1 with A3
-                                          
     MMPYF32    MR3, MR1, MR0                 ; MR3 (Y) = MR1 (A3) * MR0 (X3)
- || MMOV32     MR1,@_A2                      ; Load MR1 with A2
-    MMOVD32    MR0,@_X2                      ; Load MR0 with X2, Load X3 with X2
+ || MMOV32     MR1,@_A+4                     ; Load MR1 with A2
+    MMOVD32    MR0,@_X+CH*FIR_WORDS+4        ; Load MR0 with X2, Load X3 with X2
 
     MMACF32    MR3, MR2, MR2, MR1, MR0       ; MR3 = A3*X3 + A4*X4
- || MMOV32     MR1,@_A1                      ; MR2 = MR1 (A2) * MR0 (X2)
-    MMOVD32    MR0,@_X1                      ; Load MR0 with X1, Load X2 with X1
+ || MMOV32     MR1,@_A+2                     ; MR2 = MR1 (A2) * MR0 (X2)
+    MMOVD32    MR0,@_X+CH*FIR_WORDS+2        ; Load MR0 with X1, Load X2 with X1
 
     MMACF32    MR3, MR2, MR2, MR1, MR0       ; MR3 = A2*X2 + (A3*X3 + A4*X4)
- || MMOV32     MR1,@_A0                      ; MR2 = MR1 (A1) * MR0 (X1)
-    MMOVD32    MR0,@_X0                      ; Load MR0 with X0, Load X1 with X0 
+ || MMOV32     MR1,@_A+0                     ; MR2 = MR1 (A1) * MR0 (X1)
+    MMOVD32    MR0,@_X+CH*FIR_WORDS+0        ; Load MR0 with X0, Load X1 with X0
 
     MMACF32    MR3, MR2, MR2, MR1, MR0       ; MR3 = A1*X1 + (A2*X2 +A3*X3 + A4*X4)
- || MMOV32     MR1,@_A0                      ; MR2 = MR1 (A0) * MR0 (X0)
+ || MMOV32     MR1,@_A+0                     ; MR2 = MR1 (A0) * MR0 (X0)
 
     MADDF32    MR3, MR3, MR2                 ; MR3 = A0*X0 + (A1*X1 + A2*X2 +A3*X3 + A4*X4)
 
-	MF32TOUI16 MR2, MR3                      ; Get back to Uint16 value
-    MMOV16     @_VoltFilt, MR2               ; Output
+    MF32TOUI16 MR2, MR3                      ; Get back to Uint16 value
+    MMOV16     @_VoltFiltCh+CH, MR2          ; Per channel output
+    MMOV32     @_YCh+CH*2, MR3               ; Float copy for the combiner
+    .endm
+
+; Combiner and signal statistics for channel CH
+;
+; MR0 holds the running combined output sum(w * y).
+; d = y - CombMid; CombAbsSum[CH] += |d|; CombSqSum[CH] += d^2
+;
+COMB_CH .macro CH
+    MMOV32     MR1,@_YCh+CH*2                ; MR1 = y
+    MMOV32     MR2,@_CombWeight+CH*2         ; MR2 = w
+    MMPYF32    MR2, MR2, MR1                 ; MR2 = w * y
+ || MMOV32     MR3,@_CombMid                 ; MR3 = mid
+    MADDF32    MR0, MR0, MR2                 ; MR0 += w * y
+    MSUBF32    MR1, MR1, MR3                 ; MR1 = d
+    MABSF32    MR2, MR1                      ; MR2 = |d|
+    MMPYF32    MR1, MR1, MR1                 ; MR1 = d^2
+ || MMOV32     MR3,@_CombAbsSum+CH*2
+    MADDF32    MR2, MR2, MR3                 ; MR2 = CombAbsSum + |d|
+ || MMOV32     MR3,@_CombSqSum+CH*2
+    MADDF32    MR1, MR1, MR3                 ; MR1 = CombSqSum + d^2
+ || MMOV32     @_CombAbsSum+CH*2, MR2
+    MMOV32     @_CombSqSum+CH*2, MR1
+    .endm
+
+; Copy the window sums of channel CH to the snapshots and clear them.
+; MR3 must hold 0.0
+;
+SNAP_CH .macro CH
+    MMOV32     MR1,@_CombAbsSum+CH*2
+    MMOV32     MR2,@_CombSqSum+CH*2
+    MMOV32     @_CombAbsSnap+CH*2, MR1
+    MMOV32     @_CombSqSnap+CH*2, MR2
+    MMOV32     @_CombAbsSum+CH*2, MR3
+    MMOV32     @_CombSqSum+CH*2, MR3
+    .endm
+
+; One tap of the equalizer FIR, from the oldest input to the newest.
+; MR1 holds w[K], MR2 the product of the tap before and MR3 the sum so
+; far. MMOVD32 moves x[n-K] on to EqX[K + 1] for the next sample.
+;
+EQ_FIR .macro K
+    MMOVD32    MR0,@_EqX+K*2                 ; MR0 = x[n-K], EqX[K+1] = x[n-K]
+    .if K > 0
+    MMACF32    MR3, MR2, MR2, MR1, MR0       ; MR3 += MR2, MR2 = w[K] * x[n-K]
+ || MMOV32     MR1,@_EqW+K*2-2               ; MR1 = w[K-1]
+    .else
+    MMACF32    MR3, MR2, MR2, MR1, MR0       ; MR3 += MR2, MR2 = w[0] * x[n]
+ || MMOV32     MR1,@_CombMid                 ; MR1 = mid
+    .endif
+    .endm
+
+; LMS update of tap K, w[K] += g * x[n-K]. MR3 holds g = EqMu * e
+;
+EQ_LMS .macro K
+    MMOV32     MR1,@_EqX+K*2+2               ; MR1 = x[n-K]
+    MMPYF32    MR1, MR1, MR3                 ; MR1 = g * x[n-K]
+ || MMOV32     MR2,@_EqW+K*2                 ; MR2 = w[K]
+    MADDF32    MR2, MR2, MR1
+    MMOV32     @_EqW+K*2, MR2
+    .endm
+
+; Clear the delay line of channel CH. MR0 must hold 0.0
+;
+ZERO_CH .macro CH
+    MMOV32     @_X+CH*FIR_WORDS+0, MR0
+    MMOV32     @_X+CH*FIR_WORDS+2, MR0
+    MMOV32     @_X+CH*FIR_WORDS+4, MR0
+    MMOV32     @_X+CH*FIR_WORDS+6, MR0
+    MMOV32     @_X+CH*FIR_WORDS+8, MR0
+    .if CPU_FILTER_CHANNELS == 0
+    MMOV32     @_CombAbsSum+CH*2, MR0
+    MMOV32     @_CombSqSum+CH*2, MR0
+    .endif
+    .endm
+
+_Cla1Task7:
+
+        .if CLA_DEBUG == 1
+        MDEBUGSTOP
+       .endif
+    .if CLA_PIPELINE == 1
+    STAGE_BEGIN
+    MMOV16     @_ClaPipeStart, MR0
+    .endif
+
+;//==============================================
+;// CLA Task 7
+;//
+;// This task:
+;// 
+;// 1. Is triggered by the early ADC interrupt of
+;//    the last receiver SOC. This interrupt 
+;//    occurs at the end of its sample & hold 
+;//    window, the earlier SOCs are done by then.
+;// 2. Sums the OVERSAMPLE results of every 
+;//    receiver channel and runs the FIR filter on
+;//    it. The last channel is filtered last so 
+;//    its results are available when read.
+;// 3. Combines the channels with the weights from
+;//    the CPU and places the result into VoltFilt.
+;// 4. Accumulates per channel signal statistics
+;//    and publishes them every CombWindow samples.
+;// 5. The main CPU will take an interrupt at the
+;//    end of the task.  It will log the
+;//    ADC RESULT1 register for comparison as 
+;//    well as the CLA generated VoltFilt value
+;// 
+;// With CPU_FILTER_CHANNELS > 0 only the first
+;// CLA_FILTER_CHANNELS channels are filtered here
+;// and steps 3 to 5 are done by the CPU
+;// (CpuFilter.c), the ADC interrupt is then the
+;// late one.
+;// 
+;// With CLA_EQUALIZER == 1 the combined output
+;// goes through the adaptive equalizer before
+;// VoltFilt, which also adapts its taps.
+;// 
+;// With CLA_PIPELINE == 1 the task also starts
+;// the slicer (Task 4) on VoltFilt and times
+;// itself as pipeline stage 0.
+;// 
+;// Before starting the ADC conversions, force 
+;// Task 8 to initialize the filter states and 
+;// coefficients.
+;//
+;//==============================================
+
+    .if CLA_FILTER_CHANNELS > 0
+    FIR_CH     0
+    .endif
+    .if CLA_FILTER_CHANNELS > 1
+    FIR_CH     1
+    .endif
+    .if CLA_FILTER_CHANNELS > 2
+    FIR_CH     2
+    .endif
+    .if CLA_FILTER_CHANNELS > 3
+    FIR_CH     3
+    .endif
+
+;
+; With channels filtered on the C28x the CPU combines (CpuFilter.c)
+;
+    .if CPU_FILTER_CHANNELS == 0
+    MMOVIZ     MR0, #0.0                     ; MR0 = combined output
+    .if RX_CHANNELS == 1
+    MNOP                                     ; YCh[0] was just written
+    MNOP
+    MNOP
+    .endif
+    COMB_CH    0
+    .if RX_CHANNELS > 1
+    COMB_CH    1
+    .endif
+    .if RX_CHANNELS > 2
+    COMB_CH    2
+    .endif
+    .if RX_CHANNELS > 3
+    COMB_CH    3
+    .endif
+
+    .if CLA_EQUALIZER == 1
+;
+; Equalizer, skipped in EQ_OFF:
+;
+;   x[n] = combined - CombMid
+;   z    = sum of EqW[k] * x[n-k], k = 0 .. EQ_TAPS - 1
+;   d    = +-EqLevel, the sign of x[n - EQ_DELAY] in EQ_TRAIN, of z in
+;          EQ_TRACK
+;   e    = d - z, EqErrSum += e^2
+;   EqW[k] += EqMu * e * x[n-k]
+;
+; and z + CombMid goes on in MR0. 2 cycles per tap for the FIR, 4 for the
+; update.
+;
+    MUI16TOF32 MR1,@_EqMode
+    MCMPF32    MR1, #0.0                     ; EQ_OFF
+    MNOP
+    MNOP
+    MNOP
+    MBCNDD     _Cla1T7EqDone, EQ
+    MNOP
+    MNOP
+    MNOP
+
+    MMOV32     MR2,@_CombMid
+    MSUBF32    MR0, MR0, MR2                 ; MR0 = x[n]
+ || MMOV32     MR1,@_EqW+EQ_TAPS*2-2         ; MR1 = w[EQ_TAPS-1]
+    MMOVIZ     MR2, #0.0
+    MMOVIZ     MR3, #0.0
+    MMOV32     @_EqX+0, MR0
+    .eval      EQ_TAPS - 1, EQ_K
+    .loop      EQ_TAPS
+    EQ_FIR     EQ_K
+    .eval      EQ_K - 1, EQ_K
+    .endloop
+    MADDF32    MR3, MR3, MR2                 ; MR3 = z
+    MADDF32    MR0, MR3, MR1                 ; MR0 = z + mid, the output
+
+    MMOV32     MR2,@_EqX+EQ_DELAY*2+2        ; MR2 = x[n - EQ_DELAY]
+    MUI16TOF32 MR1,@_EqMode
+    MCMPF32    MR1, #1.0                     ; EQ_TRAIN
+    MMOV32     MR2, MR3, NEQ                 ; decide on z unless training
+    MMOV32     MR1,@_EqLevel
+    MCMPF32    MR2, #0.0
+    MNEGF32    MR1, MR1, LT                  ; MR1 = d
+    MSUBF32    MR1, MR1, MR3                 ; MR1 = e
+    MMPYF32    MR2, MR1, MR1                 ; MR2 = e^2
+ || MMOV32     MR3,@_EqErrSum
+    MADDF32    MR3, MR3, MR2                 ; MR3 = EqErrSum + e^2
+ || MMOV32     MR2,@_EqMu
+    MMPYF32    MR3, MR2, MR1                 ; MR3 = g = EqMu * e
+ || MMOV32     @_EqErrSum, MR3
+    .asg       0, EQ_K
+    .loop      EQ_TAPS
+    EQ_LMS     EQ_K
+    .eval      EQ_K + 1, EQ_K
+    .endloop
+
+_Cla1T7EqDone:
+    .endif
+
+    MF32TOUI16 MR0, MR0                      ; Get back to Uint16 value
+    MMOV16     @_VoltFilt, MR0               ; Output
+    .if CLA_PIPELINE == 1
+    STAGE_NEXT _EPwm4Regs                    ; slice it after this task
+    .endif
+
+;
+; Count the sample and publish the statistics at the end of the window.
+; Only stores and MNOPs between MCMPF32 and the branch so the flags
+; are not disturbed.
+;
+    MMOV32     MR0,@_CombCount
+    MADDF32    MR0, #1.0, MR0
+    MMOV32     MR1,@_CombWindow
+    MCMPF32    MR0, MR1
+    MMOV32     @_CombCount, MR0
+    MNOP
+    MNOP
+    MBCNDD     _Cla1T7Done, LT
+    MNOP
+    MNOP
+    MNOP
+
+    MMOVIZ     MR3, #0.0
+    SNAP_CH    0
+    .if RX_CHANNELS > 1
+    SNAP_CH    1
+    .endif
+    .if RX_CHANNELS > 2
+    SNAP_CH    2
+    .endif
+    .if RX_CHANNELS > 3
+    SNAP_CH    3
+    .endif
+    .if CLA_EQUALIZER == 1
+    MMOV32     MR1,@_EqErrSum
+    MMOV32     @_EqErrSnap, MR1
+    MMOV32     @_EqErrSum, MR3
+    .endif
+    MMOV32     @_CombCount, MR3
+    MMOVZ16    MR0,@_CombSeq                 ; CombSeq++
+    MMOVIZ     MR1, #0.0
+    MMOVXI     MR1, #1
+    MADD32     MR0, MR0, MR1
+    MMOV16     @_CombSeq, MR0
+    .endif
+
+_Cla1T7Done:
+    .if CLA_PIPELINE == 1
+    STAGE_END  0
+    .endif
 	MSTOP                                    ; End task
 _Cla1T7End:
           
@@ -170,18 +916,63 @@ _Cla1Task8:
 
 ;==============================================
 ; This task initializes the filter input delay 
-; line (X0 to X4) to zero 
+; lines (X[ch][0] to X[ch][4]), the combiner
+; statistics and the window count to zero 
+; (the statistics only if the CLA combines),
+; and resets the equalizer
 ;==============================================
     .if CLA_DEBUG == 1
     MDEBUGSTOP
     .endif
     MMOVIZ       MR0, #0.0
     MUI16TOF32   MR0, MR0          
-    MMOV32       @_X0, MR0       
-    MMOV32       @_X1, MR0       
-    MMOV32       @_X2, MR0       
-    MMOV32       @_X3, MR0       
-    MMOV32       @_X4, MR0
+    .if CLA_FILTER_CHANNELS > 0
+    ZERO_CH      0
+    .endif
+    .if CLA_FILTER_CHANNELS > 1
+    ZERO_CH      1
+    .endif
+    .if CLA_FILTER_CHANNELS > 2
+    ZERO_CH      2
+    .endif
+    .if CLA_FILTER_CHANNELS > 3
+    ZERO_CH      3
+    .endif
+    .if CPU_FILTER_CHANNELS == 0
+    MMOV32       @_CombCount, MR0
+    MMOV16       @_CombSeq, MR0
+    .endif
+    .if CLA_PIPELINE == 1
+    MMOV16       @_ClaLevel, MR0
+    MMOV16       @_ClaEdge, MR0
+    MMOV16       @_ClaCount, MR0
+    MMOV16       @_ClaLocked, MR0
+    MMOV16       @_ClaBitValid, MR0
+    HIST_CLEAR
+    MMOV16       @_ClaHistHalf, MR0
+    MMOV16       @_ClaEdgeLevel, MR0
+    MMOV32       @_ClaBits, MR0
+    MMOV32       @_ClaSyncLosses, MR0
+    MMOV16       @_ClaBitWord, MR0
+    MMOV16       @_ClaBitN, MR0
+    MMOV16       @_ClaBitHead, MR0
+    MMOV16       @_ClaBitWords, MR0
+    MMOV16       @_ClaCyclesMax+0, MR0
+    MMOV16       @_ClaCyclesMax+1, MR0
+    MMOV16       @_ClaCyclesMax+2, MR0
+    MMOV16       @_ClaCyclesMax+3, MR0
+    MMOV16       @_ClaCyclesMax+4, MR0
+    .endif
+    .if CARRIER_DETECT == 1
+    MMOV32       @_CarrierLast, MR0
+    MMOV32       @_CarrierSum, MR0
+    MMOV32       @_CarrierCount, MR0
+    MMOV32       @_CarrierEnergy, MR0
+    .endif
+    .if CLA_EQUALIZER == 1
+    MMOV32       @_EqErrSnap, MR0
+    EQ_RESET
+    .endif
     MSTOP
 _Cla1T8End:
 
@@ -0,0 +1,190 @@
+//###########################################################################
+//
+// FILE:   Carrier.c
+//
+// TITLE:  Carrier detector, runs the full rate receiver only while a
+//         carrier is there
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Carrier.h"
+#include "RateConfig.h"
+#include "Trace.h"
+
+#if CARRIER_DETECT
+
+//
+// Called for every carrier window, runs from RAM in flash builds (Boot.h)
+//
+#pragma CODE_SECTION(carrier_isr, "ramfuncs");
+
+//
+// Globals
+//
+// CarrierRx is the detector carrier_isr() switches
+//
+static carrier_t *CarrierRx;
+
+//
+// carrier_init - Set up the detector: SOC0 on ePWM7, CLA Task 1 on
+// ADCINT1 and EPWM8INT to the C28x
+//
+// level is the mean step between detector samples, in ADC codes, above
+// which a window counts as a carrier; window is its length in detector
+// samples. Call after init_cla() and init_adc(), with TBCLKSYNC = 0. The
+// receiver samples at the full rate until carrier_detect().
+//
+void
+carrier_init(carrier_t *c, Uint16 adc_channel, Uint16 level, Uint16 window)
+{
+    CarrierRx  = c;
+    c->active  = 1;
+    c->silence = 0;
+    c->timeout = 0xFFFF;
+    c->found   = 0;
+    c->lost    = 0;
+
+    CarrierWindow = (float32)window;
+    CarrierLevel  = (float32)level * window;
+
+    EALLOW;
+
+    //
+    // The CLA can not clear ADCINT1, so it runs in continuous mode
+    //
+    AdcRegs.ADCSOC0CTL.bit.CHSEL    = adc_channel;
+    AdcRegs.ADCSOC0CTL.bit.TRIGSEL  = CARRIER_ADC_TRIG_EPWM7A;
+    AdcRegs.ADCSOC0CTL.bit.ACQPS    = 6;
+    AdcRegs.INTSEL1N2.bit.INT1SEL   = 0;
+    AdcRegs.INTSEL1N2.bit.INT1E     = 1;
+    AdcRegs.INTSEL1N2.bit.INT1CONT  = 1;
+
+    Cla1Regs.MVECT1 = (Uint16) (&Cla1Task1 - &Cla1Prog_Start)*sizeof(Uint32);
+    Cla1Regs.MPISRCSEL1.bit.PERINT1SEL = CARRIER_CLA_ADCINT1;
+    Cla1Regs.MIER.bit.INT1 = 1;
+
+    PieVectTable.EPWM8_INT = &carrier_isr;
+    EDIS;
+
+    //
+    // ePWM7 starts SOC0 at CTR = 0, its period is set by
+    // carrier_set_rate(). ePWM8 never counts, the CLA forces its
+    // interrupt.
+    //
+    EPwm7Regs.TBCTL.bit.CTRMODE   = TB_COUNT_UP;
+    EPwm7Regs.TBCTL.bit.FREE_SOFT = 3;
+    EPwm7Regs.ETSEL.bit.SOCASEL   = ET_CTR_ZERO;
+    EPwm7Regs.ETPS.bit.SOCAPRD    = ET_1ST;
+    EPwm7Regs.ETSEL.bit.SOCAEN    = 0;
+
+    EPwm8Regs.TBCTL.bit.CTRMODE   = TB_FREEZE;
+    EPwm8Regs.TBCTR               = 0;
+    EPwm8Regs.TBPRD               = 0xFFFF;
+    EPwm8Regs.ETSEL.bit.INTSEL    = ET_CTR_PRD;
+    EPwm8Regs.ETPS.bit.INTPRD     = ET_1ST;
+    EPwm8Regs.ETCLR.bit.INT       = 1;
+    EPwm8Regs.ETSEL.bit.INTEN     = 1;
+
+    PieCtrlRegs.PIEIER3.bit.INTx8 = 1;
+    IER |= M_INT3;
+}
+
+//
+// carrier_set_rate - Size the detector period and the timeout for a new
+// rate
+//
+// Sets the ePWM7 period straight away, call between rate_sync_begin() and
+// rate_sync_end() when the time bases run. timeout_bits is the time
+// without lock after which the receiver goes back to detect.
+//
+void
+carrier_set_rate(carrier_t *c, Uint16 adc_tbprd, Uint16 samples_per_bit,
+                 Uint16 timeout_bits)
+{
+    Uint32 prd = (adc_tbprd + 1UL) * CARRIER_DIV - 1;
+    Uint32 timeout = (Uint32)timeout_bits * samples_per_bit;
+
+    c->tbprd   = prd > 0xFFFF ? 0xFFFF : (Uint16)prd;
+    c->timeout = timeout > 0xFFFF ? 0xFFFF : (Uint16)timeout;
+    rate_apply_epwm(&EPwm7Regs, c->tbprd);
+}
+
+//
+// carrier_detect - Stop the full rate sampling and start the detector
+//
+// A sample already being converted is still filtered and logged.
+//
+void
+carrier_detect(carrier_t *c)
+{
+    EPwm1Regs.ETSEL.bit.SOCAEN = 0;
+    EPwm7Regs.ETSEL.bit.SOCAEN = 1;
+    c->active = 0;
+    TRACE(TRACE_STATE, TRACE_SRC_CARRIER, 0);
+}
+
+//
+// carrier_receive - Stop the detector and start the full rate sampling
+//
+void
+carrier_receive(carrier_t *c)
+{
+    EPwm7Regs.ETSEL.bit.SOCAEN = 0;
+    EPwm1Regs.ETSEL.bit.SOCAEN = 1;
+    c->silence = 0;
+    c->found++;
+    c->active = 1;
+    TRACE(TRACE_STATE, TRACE_SRC_CARRIER, 1);
+}
+
+//
+// carrier_sample - Count a decoded sample, go back to detect after
+// timeout samples in a row without lock
+//
+void
+carrier_sample(carrier_t *c, Uint16 locked)
+{
+    if(!c->active)
+    {
+        return;
+    }
+    if(locked)
+    {
+        c->silence = 0;
+        return;
+    }
+    c->silence++;
+    if(c->silence >= c->timeout)
+    {
+        c->lost++;
+        carrier_detect(c);
+    }
+}
+
+//
+// carrier_isr - EPWM8INT, forced by CLA Task 1 at the end of a window
+// with a carrier
+//
+// Task 1 may finish one more window while the switch is made, so a
+// second interrupt finds the receiver running already.
+//
+__interrupt void
+carrier_isr(void)
+{
+    EPwm8Regs.ETCLR.bit.INT = 1;
+    if(!CarrierRx->active)
+    {
+        carrier_receive(CarrierRx);
+    }
+
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP3;
+}
+
+#endif // CARRIER_DETECT
+
+//
+// End of File
+//
@@ -0,0 +1,82 @@
+//###########################################################################
+//
+// FILE:   Carrier.h
+//
+// TITLE:  Carrier detector, runs the full rate receiver only while a
+//         carrier is there
+//
+//###########################################################################
+
+#ifndef CARRIER_H
+#define CARRIER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "CLAShared.h"
+
+//
+// Defines
+//
+// Two modes:
+//
+//      detect      ePWM1 starts no conversions: no CLA Task 7, no sample
+//                  ISR, the main loop gets no samples. ePWM7 starts SOC0
+//                  on the first receiver input every CARRIER_DIV sample
+//                  periods and CLA Task 1 sums the sample to sample
+//                  steps over CarrierWindow samples (CLA_FIR.asm). A sum
+//                  above CarrierLevel forces EPWM8INT, carrier_isr()
+//                  switches to receive.
+//      receive     ePWM1 samples at the full rate as without the
+//                  detector, ePWM7 is quiet. carrier_sample(), called
+//                  for every decoded sample, goes back to detect after
+//                  timeout samples without decoder lock.
+//
+// A carrier is seen CARRIER_DIV * CarrierWindow sample periods after it
+// starts at the latest; frames need that much preamble on top of the
+// decoder lock time. CARRIER_DIV should not be a multiple of the samples
+// per bit, or the detector sees the same bit phase every time and takes
+// an idle pattern of constant bits for silence.
+//
+// The project must not use ePWM7, ePWM8, SOC0 or ADCINT1 itself.
+//
+#define CARRIER_ADC_TRIG_EPWM7A 0x11    // ADCSOCxCTL.TRIGSEL
+#define CARRIER_CLA_ADCINT1     0       // MPISRCSEL1.PERINT1SEL
+
+//
+// Typedefs
+//
+typedef struct {
+    volatile Uint16 active;     // 1 while the full rate receiver runs
+    Uint16 silence;             // samples without lock while active
+    Uint16 timeout;             // silence that goes back to detect
+    Uint16 tbprd;               // ePWM7 period, CARRIER_DIV samples
+    Uint32 found;               // switches to receive
+    Uint32 lost;                // switches back to detect on timeout
+} carrier_t;
+
+//
+// Function Prototypes
+//
+void carrier_init(carrier_t *c, Uint16 adc_channel, Uint16 level,
+                  Uint16 window);
+void carrier_set_rate(carrier_t *c, Uint16 adc_tbprd,
+                      Uint16 samples_per_bit, Uint16 timeout_bits);
+void carrier_detect(carrier_t *c);
+void carrier_receive(carrier_t *c);
+void carrier_sample(carrier_t *c, Uint16 locked);
+__interrupt void carrier_isr(void);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of CARRIER_H definition
+
+//
+// End of File
+//
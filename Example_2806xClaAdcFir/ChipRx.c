@@ -0,0 +1,230 @@
+//###########################################################################
+//
+// FILE:   ChipRx.c
+//
+// TITLE:  Sample domain slicer, chip clock recovery and line code decoder
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "ChipRx.h"
+
+//
+// Called for every sample and every chip, runs from RAM in flash builds
+// (Boot.h)
+//
+#pragma CODE_SECTION(chip_rx_sample, "ramfuncs");
+#pragma CODE_SECTION(chip_rx_chip, "ramfuncs");
+
+//
+// Function Prototypes
+//
+static int16 chip_rx_chip(chip_rx_t *rx);
+
+//
+// chip_rx_init - Set up the slicer, the chip clock and the decoder of
+// the line code code for a stream with samples_per_bit samples per
+// ePWM3 bit period, two chips
+//
+// Returns the line_code_init() status, rx is only set up on LINE_OK.
+//
+Uint16
+chip_rx_init(chip_rx_t *rx, Uint16 threshold, Uint16 hysteresis,
+             Uint16 samples_per_bit, Uint16 code, Uint16 vppm_width)
+{
+    Uint16 status;
+
+    status = line_code_init(&rx->code, code, vppm_width);
+    if(status != LINE_OK)
+    {
+        return status;
+    }
+
+    rx->threshold   = threshold;
+    rx->hysteresis  = hysteresis;
+    rx->nominal     = (int32)samples_per_bit << 7;
+    rx->chip_period = rx->nominal;
+    rx->level       = 0;
+    rx->locked      = 0;
+    rx->since       = 0;
+    rx->phase       = 0;
+    rx->sum         = 0;
+    rx->count       = 0;
+    rx->chip        = 0;
+    rx->run         = 0;
+    rx->fill        = 0;
+    rx->slip        = 0;
+    rx->groups      = 0;
+    rx->bad         = 0;
+    rx->chips       = 0;
+    rx->bytes       = 0;
+    rx->slips       = 0;
+    rx->sync_losses = 0;
+
+    return LINE_OK;
+}
+
+//
+// chip_rx_sample - Slice one filtered sample and run the chip clock
+//
+// Unlocked: the first edge starts a chip half a sample before this one.
+// Locked:   an edge at least half a chip after the last one taken is the
+// nearest chip boundary; its error from the clock, wrapped to +-half a
+// chip, is taken out of the phase and the period in part (ChipRx.h).
+// Each time the clock passes a chip boundary the samples summed since
+// the last one make a chip (chip_rx_chip()).
+//
+// Returns the decoded byte (0 to 255) or CHIP_RX_NO_BYTE.
+//
+int16
+chip_rx_sample(chip_rx_t *rx, Uint16 sample)
+{
+    Uint16 level = rx->level;
+    int16 byte = CHIP_RX_NO_BYTE;
+    int32 err;
+
+    if(sample > rx->threshold + rx->hysteresis)
+    {
+        level = 1;
+    }
+    else if(sample < rx->threshold - rx->hysteresis)
+    {
+        level = 0;
+    }
+
+    if(!rx->locked)
+    {
+        if(level == rx->level)
+        {
+            return CHIP_RX_NO_BYTE;
+        }
+        rx->level       = level;
+        rx->locked      = 1;
+        rx->chip_period = rx->nominal;
+        rx->phase       = 0x80;
+        rx->since       = 0;
+        rx->sum         = 0;
+        rx->count       = 0;
+        rx->chip        = level;
+        rx->run         = 0;
+        rx->fill        = 0;
+        rx->slip        = 0;
+        rx->groups      = 0;
+        rx->bad         = 0;
+    }
+    else
+    {
+        rx->phase += 0x100;
+        if(rx->since < 0x7FFF)
+        {
+            rx->since++;
+        }
+        if(level != rx->level)
+        {
+            rx->level = level;
+            if(((int32)rx->since << 9) >= rx->chip_period)
+            {
+                rx->since = 0;
+                err = rx->phase - 0x80;
+                if(err >= rx->chip_period / 2)
+                {
+                    err -= rx->chip_period;
+                }
+                rx->phase -= err >> CHIP_RX_GAIN_SHIFT;
+                rx->chip_period += err >> CHIP_RX_FREQ_SHIFT;
+                if(rx->chip_period > rx->nominal + (rx->nominal >> 4))
+                {
+                    rx->chip_period = rx->nominal + (rx->nominal >> 4);
+                }
+                else if(rx->chip_period < rx->nominal - (rx->nominal >> 4))
+                {
+                    rx->chip_period = rx->nominal - (rx->nominal >> 4);
+                }
+            }
+        }
+        if(rx->phase >= rx->chip_period)
+        {
+            rx->phase -= rx->chip_period;
+            byte = chip_rx_chip(rx);
+            if(!rx->locked)
+            {
+                return byte;
+            }
+        }
+    }
+
+    rx->sum += sample;
+    rx->count++;
+
+    return byte;
+}
+
+//
+// chip_rx_chip - Decide the chip that has just ended and add it to the
+// byte being collected
+//
+// Returns the byte it completes, or CHIP_RX_NO_BYTE.
+//
+static int16
+chip_rx_chip(chip_rx_t *rx)
+{
+    Uint32 errors;
+    Uint16 chip;
+    Uint16 byte;
+
+    chip = rx->count != 0 ?
+           rx->sum > (Uint32)rx->threshold * rx->count : rx->level;
+    rx->sum   = 0;
+    rx->count = 0;
+    rx->chips++;
+
+    if(chip != rx->chip)
+    {
+        rx->chip = chip;
+        rx->run  = 1;
+    }
+    else if(++rx->run > rx->code.max_run + CHIP_RX_RUN_SLACK)
+    {
+        rx->locked = 0;
+        rx->sync_losses++;
+        return CHIP_RX_NO_BYTE;
+    }
+
+    if(rx->slip)
+    {
+        rx->slip = 0;
+        return CHIP_RX_NO_BYTE;
+    }
+    BITVEC_PUT(rx->group, rx->fill, chip);
+    if(++rx->fill < rx->code.chips_per_byte)
+    {
+        return CHIP_RX_NO_BYTE;
+    }
+    rx->fill = 0;
+
+    errors = rx->code.code_errors + rx->code.disparity_errors;
+    line_decode(&rx->code, rx->group, rx->code.chips_per_byte, &byte);
+    rx->bytes++;
+    if(rx->code.code_errors + rx->code.disparity_errors != errors)
+    {
+        rx->bad++;
+    }
+    if(++rx->groups == CHIP_RX_ALIGN_GROUPS)
+    {
+        if(rx->bad >= CHIP_RX_ALIGN_ERRORS)
+        {
+            rx->slip = 1;
+            rx->slips++;
+        }
+        rx->groups = 0;
+        rx->bad    = 0;
+    }
+
+    return (int16)byte;
+}
+
+//
+// End of File
+//
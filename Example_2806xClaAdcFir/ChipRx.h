@@ -0,0 +1,99 @@
+//###########################################################################
+//
+// FILE:   ChipRx.h
+//
+// TITLE:  Sample domain slicer, chip clock recovery and line code decoder
+//
+//###########################################################################
+
+#ifndef CHIP_RX_H
+#define CHIP_RX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+#include "BitBuf.h"
+#include "LineCode.h"
+
+//
+// Defines
+//
+// The receiver of the line codes of LineCode.h, chips sent two to a bit
+// period by ManchesterTx.c. chip_rx_sample() returns CHIP_RX_NO_BYTE for
+// every sample that does not complete a byte.
+//
+// Chip clock: a slicer edge is a chip boundary and pulls the clock
+// 1/2^CHIP_RX_GAIN_SHIFT of the way to it, as the mid-bit edges do in
+// ManchesterRx.c; an edge within half a chip of the last one taken is
+// noise on that crossing and is not used. Each edge also trims the chip
+// period by 1/2^CHIP_RX_FREQ_SHIFT of its error, within 1/16 of the
+// nominal period, so the clock learns the transmitter rate. Between
+// edges it runs on at that period and holds over the runs without an
+// edge of 4B5B (4 chips) and 8B10B (5 chips), and the longer ones of
+// VPPM. A run of more than max_run (LineCode.h) plus CHIP_RX_RUN_SLACK
+// equal chips is not the code, the lock is lost.
+//
+// Chips are decided by integrate and dump, the sum of the samples of the
+// chip against the threshold, so every sample counts as in ManchesterRx.
+//
+// Bytes: the chips go to line_decode() in groups of one byte. Groups
+// out of step with the bytes decode as codes that do not exist; when
+// CHIP_RX_ALIGN_ERRORS of CHIP_RX_ALIGN_GROUPS groups have a code or
+// disparity error, one chip is dropped to try the next alignment.
+//
+#define CHIP_RX_NO_BYTE         (-1)
+#define CHIP_RX_GAIN_SHIFT      2
+#define CHIP_RX_FREQ_SHIFT      7
+#define CHIP_RX_RUN_SLACK       1
+#define CHIP_RX_ALIGN_GROUPS    8
+#define CHIP_RX_ALIGN_ERRORS    2
+
+//
+// Typedefs
+//
+typedef struct {
+    Uint16 threshold;       // slicer decision level (ADC codes)
+    Uint16 hysteresis;      // +/- band around threshold with no decision
+    int32 nominal;          // samples per chip, Q8
+    int32 chip_period;      // as recovered, Q8
+    Uint16 level;           // last sliced level, 0 or 1
+    Uint16 locked;          // 1 once an edge has given the chip phase
+    Uint16 since;           // samples since the last edge taken
+    int32 phase;            // this sample after the chip start, Q8
+    Uint32 sum;             // samples of the chip so far
+    Uint16 count;           // and their number
+    Uint16 chip;            // last chip decided
+    Uint16 run;             // equal chips up to and with the last one
+    Uint16 group[BITVEC_WORDS(LINE_CHIPS_MAX)];     // chips of a byte
+    Uint16 fill;            // chips in group[]
+    Uint16 slip;            // drop the next chip
+    Uint16 groups;          // groups decoded in the alignment window
+    Uint16 bad;             // groups of those with a code error
+    line_code_t code;       // decoder state and error counts
+    Uint32 chips;           // total decided chips
+    Uint32 bytes;           // total decoded bytes
+    Uint32 slips;           // chips dropped to find the bytes
+    Uint32 sync_losses;     // number of times lock was lost
+} chip_rx_t;
+
+//
+// Function Prototypes
+//
+Uint16 chip_rx_init(chip_rx_t *rx, Uint16 threshold, Uint16 hysteresis,
+                    Uint16 samples_per_bit, Uint16 code, Uint16 vppm_width);
+int16 chip_rx_sample(chip_rx_t *rx, Uint16 sample);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of CHIP_RX_H definition
+
+//
+// End of File
+//
@@ -0,0 +1,169 @@
+//###########################################################################
+//
+// FILE:   ClaPipe.c
+//
+// TITLE:  CPU side of the CLA receive pipeline (slicer, clock recovery and
+//         bit packing on CLA Tasks 4..6)
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "ClaPipe.h"
+
+#if CLA_PIPELINE
+
+//
+// Globals
+//
+// Share of the sample period of each stage in 1/16, and of the whole
+// pipeline (filter, slice and half bit sums, timing, pack, all)
+//
+static const Uint16 ClaPipeShare[CLA_STAGES + 1] = {7, 4, 3, 2, 16};
+
+//
+// cla_pipe_init - Set the slicer band and clear the CPU read position
+//
+// Call before Task 8 runs, which clears the CLA side of the pipeline.
+//
+void
+cla_pipe_init(cla_pipe_t *pipe, Uint16 threshold, Uint16 hysteresis)
+{
+    ClaSliceHi      = threshold + hysteresis;
+    ClaSliceLo      = threshold - hysteresis;
+    pipe->tail      = 0;
+    pipe->words     = 0;
+    pipe->overflows = 0;
+    pipe->over      = 0;
+}
+
+//
+// cla_pipe_init_epwm - Set up the ePWMs the pipeline runs on
+//
+// ePWM2 counts SYSCLKOUT cycles for the stage timing. ePWM4..6 never
+// count, they only raise EPWM4..6INT when the CLA writes ETFRC, which
+// starts CLA Task 4..6. Call with TBCLKSYNC = 0.
+//
+void
+cla_pipe_init_epwm(void)
+{
+    volatile struct EPWM_REGS *const stage[3] =
+        {&EPwm4Regs, &EPwm5Regs, &EPwm6Regs};
+    Uint16 i;
+
+    EPwm2Regs.TBPRD               = 0xFFFF;
+    EPwm2Regs.TBCTR               = 0;
+    EPwm2Regs.TBCTL.bit.HSPCLKDIV = TB_DIV1;
+    EPwm2Regs.TBCTL.bit.CLKDIV    = TB_DIV1;
+    EPwm2Regs.TBCTL.bit.FREE_SOFT = 3;
+    EPwm2Regs.TBCTL.bit.CTRMODE   = TB_COUNT_UP;
+
+    for(i = 0; i < 3; i++)
+    {
+        stage[i]->TBCTL.bit.CTRMODE = TB_FREEZE;
+        stage[i]->TBCTR             = 0;
+        stage[i]->TBPRD             = 0xFFFF;
+        stage[i]->ETSEL.bit.INTSEL  = ET_CTR_PRD;
+        stage[i]->ETPS.bit.INTPRD   = ET_1ST;
+        stage[i]->ETCLR.bit.INT     = 1;
+        stage[i]->ETSEL.bit.INTEN   = 1;
+    }
+}
+
+//
+// cla_pipe_set_rate - Size the clock recovery windows, the half bit sums
+// and the cycle budgets for a new rate
+//
+// sample_cycles is the sample period in SYSCLKOUT cycles. The maxima are
+// not reset, a rate change keeps the worst case seen so far. A new
+// ClaHalf makes Task 4 clear its sample ring, the sums then build up
+// again over the next bit.
+//
+void
+cla_pipe_set_rate(cla_pipe_t *pipe, Uint16 samples_per_bit,
+                  Uint32 sample_cycles)
+{
+    Uint32 b;
+    Uint16 s;
+
+    ClaEdgeWindow = (samples_per_bit * 3) / 4;
+    ClaLostWindow = (samples_per_bit * 5) / 4;
+    ClaHalf       = samples_per_bit / 2 < CLA_RX_MAX_HALF ?
+                    samples_per_bit / 2 : CLA_RX_MAX_HALF;
+
+    for(s = 0; s <= CLA_STAGES; s++)
+    {
+        b = sample_cycles * ClaPipeShare[s] / 16;
+        pipe->budget[s] = b > 0xFFFF ? 0xFFFF : (Uint16)b;
+    }
+    pipe->over = 0;
+}
+
+//
+// cla_pipe_read - Take the next packed word (16 bits, first bit in bit 0)
+//
+// If the CLA got more than the ring ahead the oldest words are dropped
+// and counted in overflows. Returns 1 if a word was read.
+//
+Uint16
+cla_pipe_read(cla_pipe_t *pipe, Uint16 *word)
+{
+    Uint16 pending = ClaBitWords - pipe->words;
+
+    if(pending == 0)
+    {
+        return 0;
+    }
+    if(pending > CLA_BIT_RING)
+    {
+        pipe->overflows += pending - CLA_BIT_RING;
+        pipe->words     += pending - CLA_BIT_RING;
+        pipe->tail       = (pipe->tail + pending - CLA_BIT_RING) &
+                           (CLA_BIT_RING - 1);
+    }
+    *word = ClaBitRing[pipe->tail];
+    pipe->tail = (pipe->tail + 1) & (CLA_BIT_RING - 1);
+    pipe->words++;
+    return 1;
+}
+
+//
+// cla_pipe_status - Copy the CLA decoder state into rx, so the counters
+// read the same as with the CPU decoder
+//
+void
+cla_pipe_status(manchester_rx_t *rx)
+{
+    rx->level       = ClaLevel;
+    rx->count       = ClaCount;
+    rx->locked      = ClaLocked;
+    rx->bits        = ClaBits;
+    rx->sync_losses = ClaSyncLosses;
+}
+
+//
+// cla_pipe_check - Compare the worst case stage times with the budgets
+//
+// Returns the stages over budget, bit s for stage s.
+//
+Uint16
+cla_pipe_check(cla_pipe_t *pipe)
+{
+    Uint16 s;
+
+    for(s = 0; s <= CLA_STAGES; s++)
+    {
+        if(ClaCyclesMax[s] > pipe->budget[s])
+        {
+            pipe->over |= 1 << s;
+        }
+    }
+    return pipe->over;
+}
+
+#endif // CLA_PIPELINE
+
+//
+// End of File
+//
@@ -0,0 +1,70 @@
+//###########################################################################
+//
+// FILE:   ClaPipe.h
+//
+// TITLE:  CPU side of the CLA receive pipeline (slicer, clock recovery and
+//         bit packing on CLA Tasks 4..6)
+//
+//###########################################################################
+
+#ifndef CLA_PIPE_H
+#define CLA_PIPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "CLAShared.h"
+#include "ManchesterRx.h"
+
+//
+// Defines
+//
+// Pipeline stages, the index into ClaCycles / ClaCyclesMax and budget.
+// CLA_STAGE_ALL is the whole pipeline, Task 7 start to the last stage.
+//
+#define CLA_STAGE_FILTER        0
+#define CLA_STAGE_SLICE         1
+#define CLA_STAGE_TIMING        2
+#define CLA_STAGE_PACK          3
+#define CLA_STAGE_ALL           CLA_STAGES
+
+//
+// Typedefs
+//
+// budget[] is in SYSCLKOUT cycles. The whole pipeline has to finish
+// within one sample period; cla_pipe_set_rate() gives each stage its
+// share of it. Bit s of over is set once ClaCyclesMax[s] exceeds
+// budget[s].
+//
+typedef struct {
+    Uint16 tail;                        // next ClaBitRing entry to read
+    Uint16 words;                       // ClaBitWords at tail
+    Uint32 overflows;                   // words lost to ring overruns
+    Uint16 budget[CLA_STAGES + 1];
+    Uint16 over;
+} cla_pipe_t;
+
+//
+// Function Prototypes
+//
+void cla_pipe_init(cla_pipe_t *pipe, Uint16 threshold, Uint16 hysteresis);
+void cla_pipe_init_epwm(void);
+void cla_pipe_set_rate(cla_pipe_t *pipe, Uint16 samples_per_bit,
+                       Uint32 sample_cycles);
+Uint16 cla_pipe_read(cla_pipe_t *pipe, Uint16 *word);
+void cla_pipe_status(manchester_rx_t *rx);
+Uint16 cla_pipe_check(cla_pipe_t *pipe);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of CLA_PIPE_H definition
+
+//
+// End of File
+//
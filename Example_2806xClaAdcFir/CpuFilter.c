@@ -0,0 +1,274 @@
+//###########################################################################
+//
+// FILE:   CpuFilter.c
+//
+// TITLE:  Fixed point C28x receive filter and combiner (CLA Task 7 on the
+//         CPU)
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "CpuFilter.h"
+
+#if CPU_FILTER_CHANNELS > 0
+
+//
+// The filter runs in the ADC interrupt on every sample, keep it in RAM
+// (Boot.h)
+//
+#pragma CODE_SECTION(cpu_filter_fir, "ramfuncs");
+#pragma CODE_SECTION(cpu_filter_iir, "ramfuncs");
+#pragma CODE_SECTION(cpu_filter_run, "ramfuncs");
+
+//
+// Defines
+//
+#define SAT16(v)    ((v) > 32767 ? 32767 : ((v) < -32768 ? -32768 : (v)))
+
+//
+// Globals
+//
+cpu_filter_t CpuFilter;
+
+//
+// Function Prototypes
+//
+static int32 cpu_filter_fir(const int16 *h, int16 *x, int16 in);
+static int16 cpu_filter_iir(Uint16 c, int16 in);
+
+//
+// cpu_filter_init - Convert A[] to Q15 and clear the C28x delay lines and
+// the combiner statistics
+//
+// Call after A[] is set and before the ADC is started. The CLA delay
+// lines are left to Task 8.
+//
+void
+cpu_filter_init(void)
+{
+    int32 q;
+    Uint16 c, i;
+
+    for(i = 0; i < CPU_FILTER_TAPS; i++)
+    {
+        q = i < FILTER_LEN ? _IQ15(A[i]) : 0;
+        CpuFilter.h[i] = (int16)SAT16(q);
+    }
+    for(c = 0; c < CPU_FILTER_CHANNELS; c++)
+    {
+        for(i = 0; i < CPU_FILTER_TAPS; i++)
+        {
+            CpuFilter.x[c][i] = 0;
+        }
+        CpuFilter.iir_x[c][0] = 0;
+        CpuFilter.iir_x[c][1] = 0;
+        CpuFilter.iir_y[c][0] = 0;
+        CpuFilter.iir_y[c][1] = 0;
+        CpuFilter.out[c] = 0;
+        CpuFilter.y[c]   = 0.0f;
+    }
+    CpuFilter.iir_on    = 0;
+    CpuFilter.cla_waits = 0;
+
+    for(c = 0; c < RX_CHANNELS; c++)
+    {
+        CombAbsSum[c] = 0.0f;
+        CombSqSum[c]  = 0.0f;
+    }
+    CombCount = 0.0f;
+    CombSeq   = 0;
+}
+
+//
+// cpu_filter_set_iir - Enable the biquad after the FIR, or disable it
+// with b == 0
+//
+//      y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+//
+// a points to a1, a2 (a0 is 1). The biquad state is cleared.
+//
+void
+cpu_filter_set_iir(const float32 *b, const float32 *a)
+{
+    int32 q;
+    Uint16 c, i;
+
+    CpuFilter.iir_on = 0;
+    if(b == 0)
+    {
+        return;
+    }
+    for(i = 0; i < 3; i++)
+    {
+        q = _IQ14(b[i]);
+        CpuFilter.b[i] = (int16)SAT16(q);
+    }
+    for(i = 0; i < 2; i++)
+    {
+        q = _IQ14(a[i]);
+        CpuFilter.a[i] = (int16)SAT16(q);
+    }
+    for(c = 0; c < CPU_FILTER_CHANNELS; c++)
+    {
+        CpuFilter.iir_x[c][0] = 0;
+        CpuFilter.iir_x[c][1] = 0;
+        CpuFilter.iir_y[c][0] = 0;
+        CpuFilter.iir_y[c][1] = 0;
+    }
+    CpuFilter.iir_on = 1;
+}
+
+//
+// cpu_filter_fir - Shift a sample into a delay line, returns the FIR
+// output in Q15
+//
+// On the C28x each DMAC multiplies two coefficient / sample pairs into
+// two accumulators (the even and the odd taps).
+//
+static int32
+cpu_filter_fir(const int16 *h, int16 *x, int16 in)
+{
+    int32 acc = 0;
+    Uint16 i;
+
+    for(i = CPU_FILTER_TAPS - 1; i > 0; i--)
+    {
+        x[i] = x[i - 1];
+    }
+    x[0] = in;
+
+#ifdef __TMS320C28XX__
+    {
+        int32 odd = 0;
+
+        for(i = 0; i < CPU_FILTER_TAPS / 2; i++)
+        {
+            __dmac(((long *)h)[i], ((long *)x)[i], acc, odd, 0);
+        }
+        acc += odd;
+    }
+#else
+    for(i = 0; i < CPU_FILTER_TAPS; i++)
+    {
+        acc += (int32)h[i] * x[i];
+    }
+#endif
+    return acc;
+}
+
+//
+// cpu_filter_iir - Run the biquad of C28x channel c on one FIR output
+//
+static int16
+cpu_filter_iir(Uint16 c, int16 in)
+{
+    int16 *xs = CpuFilter.iir_x[c];
+    int16 *ys = CpuFilter.iir_y[c];
+    int32 acc;
+    int16 out;
+
+    acc = (int32)CpuFilter.b[0] * in +
+          (int32)CpuFilter.b[1] * xs[0] +
+          (int32)CpuFilter.b[2] * xs[1] -
+          (int32)CpuFilter.a[0] * ys[0] -
+          (int32)CpuFilter.a[1] * ys[1];
+    acc >>= 14;
+    out = (int16)SAT16(acc);
+
+    xs[1] = xs[0];
+    xs[0] = in;
+    ys[1] = ys[0];
+    ys[0] = out;
+    return out;
+}
+
+//
+// cpu_filter_run - Filter the C28x channels of the current ADC results
+// and combine all channels, call on every ADCINT7
+//
+// The results are read as CLA Task 7 reads them, the combiner and the
+// window statistics match the CLA code. With channels on the CLA their
+// outputs are taken from YCh once Task 7 has finished.
+//
+void
+cpu_filter_run(void)
+{
+    const volatile Uint16 *res;
+    float32 y[RX_CHANNELS];
+    float32 comb = 0.0f;
+    float32 d;
+    int32 acc;
+    int16 sum;
+    Uint16 ch, c, k;
+
+    for(c = 0; c < CPU_FILTER_CHANNELS; c++)
+    {
+        ch  = CLA_FILTER_CHANNELS + c;
+        res = &AdcResult.ADCRESULT1 + ch * OVERSAMPLE;
+        sum = 0;
+        for(k = 0; k < OVERSAMPLE; k++)
+        {
+            sum += (int16)res[k];
+        }
+
+        acc = cpu_filter_fir(CpuFilter.h, CpuFilter.x[c], sum);
+        if(CpuFilter.iir_on)
+        {
+            acc >>= 15;
+            acc = (int32)cpu_filter_iir(c, (int16)SAT16(acc)) << 15;
+        }
+
+        //
+        // Truncate and saturate to Uint16 like MF32TOUI16
+        //
+        CpuFilter.out[c] = acc < 0 ? 0 : (Uint16)(acc >> 15);
+        CpuFilter.y[c]   = (float32)acc * (1.0f / 32768.0f);
+        y[ch] = CpuFilter.y[c];
+    }
+
+#if CLA_FILTER_CHANNELS > 0
+    if(Cla1Regs.MIFR.bit.INT7 || Cla1Regs.MIRUN.bit.INT7)
+    {
+        CpuFilter.cla_waits++;
+        while(Cla1Regs.MIFR.bit.INT7 || Cla1Regs.MIRUN.bit.INT7)
+        {
+        }
+    }
+    for(ch = 0; ch < CLA_FILTER_CHANNELS; ch++)
+    {
+        y[ch] = YCh[ch];
+    }
+#endif
+
+    for(ch = 0; ch < RX_CHANNELS; ch++)
+    {
+        comb += CombWeight[ch] * y[ch];
+        d = y[ch] - CombMid;
+        CombAbsSum[ch] += d < 0.0f ? -d : d;
+        CombSqSum[ch]  += d * d;
+    }
+    VoltFilt = comb <= 0.0f ? 0 :
+               (comb >= 65535.0f ? 65535 : (Uint16)comb);
+
+    CombCount += 1.0f;
+    if(CombCount >= CombWindow)
+    {
+        for(ch = 0; ch < RX_CHANNELS; ch++)
+        {
+            CombAbsSnap[ch] = CombAbsSum[ch];
+            CombSqSnap[ch]  = CombSqSum[ch];
+            CombAbsSum[ch]  = 0.0f;
+            CombSqSum[ch]   = 0.0f;
+        }
+        CombCount = 0.0f;
+        CombSeq++;
+    }
+}
+
+#endif // CPU_FILTER_CHANNELS > 0
+
+//
+// End of File
+//
@@ -0,0 +1,85 @@
+//###########################################################################
+//
+// FILE:   CpuFilter.h
+//
+// TITLE:  Fixed point C28x receive filter and combiner (CLA Task 7 on the
+//         CPU)
+//
+//###########################################################################
+
+#ifndef CPU_FILTER_H
+#define CPU_FILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "CLAShared.h"
+
+//
+// Defines
+//
+// The C28x filters the last CPU_FILTER_CHANNELS receiver channels (see
+// CLAShared.h) the way CLA Task 7 does: sum the OVERSAMPLE results, run
+// the A[] FIR, then combine all channels into VoltFilt and keep the
+// CombAbsSum / CombSqSum statistics for Diversity.c.
+//
+// The FIR runs in Q15 on 16-bit delay lines with the DMAC instruction,
+// two taps per cycle, so CPU_FILTER_TAPS is FILTER_LEN rounded up to an
+// even number (the extra tap is 0). The sample sum must fit an int16,
+// which holds for OVERSAMPLE <= 4.
+//
+// An optional biquad (Q14 coefficients) follows the FIR on the C28x
+// channels only. It is off after cpu_filter_init(); the sum of the
+// absolute values of its coefficients must stay below 8 so the 32-bit
+// accumulator can not overflow.
+//
+#define CPU_FILTER_TAPS         ((FILTER_LEN + 1) & ~1)
+
+#if CPU_FILTER_CHANNELS > 0
+
+//
+// Typedefs
+//
+// h and x are read two words at a time by DMAC and must be 32-bit
+// aligned; they are the first members and CPU_FILTER_TAPS is even.
+//
+typedef struct {
+    int16 h[CPU_FILTER_TAPS];                       // FIR, Q15
+    int16 x[CPU_FILTER_CHANNELS][CPU_FILTER_TAPS];  // x[ch][0] newest
+    int16 b[3];                                     // biquad b0 b1 b2, Q14
+    int16 a[2];                                     // biquad a1 a2, Q14
+    int16 iir_x[CPU_FILTER_CHANNELS][2];
+    int16 iir_y[CPU_FILTER_CHANNELS][2];
+    Uint16 iir_on;
+    Uint16 out[CPU_FILTER_CHANNELS];    // as VoltFiltCh
+    float32 y[CPU_FILTER_CHANNELS];     // as YCh
+    Uint32 cla_waits;                   // samples the CLA was still busy
+} cpu_filter_t;
+
+//
+// Globals
+//
+extern cpu_filter_t CpuFilter;
+
+//
+// Function Prototypes
+//
+void cpu_filter_init(void);
+void cpu_filter_set_iir(const float32 *b, const float32 *a);
+void cpu_filter_run(void);
+
+#endif // CPU_FILTER_CHANNELS > 0
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of CPU_FILTER_H definition
+
+//
+// End of File
+//
@@ -0,0 +1,130 @@
+//###########################################################################
+//
+// FILE:   Diversity.c
+//
+// TITLE:  Receiver diversity combining weights (CPU side)
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Diversity.h"
+
+//
+// Defines
+//
+// Floor for the noise variance estimate (ADC codes^2), keeps the SNR and
+// the MRC weights finite on a noiseless channel
+//
+#define DIVERSITY_MIN_VAR       1.0f
+
+//
+// Globals
+//
+diversity_t Diversity;
+
+//
+// diversity_init - Set the combining mode and the statistics window
+//
+// Must be called before the CLA starts (Task 8 clears the statistics).
+// Until the first window completes all channels get the same weight.
+//
+void
+diversity_init(Uint16 mode, Uint32 window, float32 mid)
+{
+    Uint16 ch;
+
+    Diversity.mode    = mode;
+    Diversity.seq     = 0;
+    Diversity.best    = 0;
+    Diversity.updates = 0;
+
+    for(ch = 0; ch < RX_CHANNELS; ch++)
+    {
+        Diversity.snr[ch] = 0.0f;
+        CombWeight[ch] = 1.0f / RX_CHANNELS;
+    }
+    CombWindow = (float32)window;
+    CombMid    = mid;
+}
+
+//
+// diversity_update - Recompute the combining weights once per window
+//
+// For a Manchester signal of amplitude a around CombMid, |y - mid| is
+// about a plus the noise, so over a window of n samples
+//      a     = CombAbsSnap / n
+//      var   = CombSqSnap / n - a^2
+//      snr   = a^2 / var
+// Selection puts all weight on the best channel. MRC weights each channel
+// by a / var. The weights are normalised to a sum of 1 so VoltFilt keeps
+// the same mid level as a single channel.
+//
+// Returns 1 if new weights were written.
+//
+Uint16
+diversity_update(void)
+{
+    float32 amp[RX_CHANNELS];
+    float32 var[RX_CHANNELS];
+    float32 w[RX_CHANNELS];
+    float32 sum = 0.0f;
+    Uint16 ch;
+
+    if(CombSeq == Diversity.seq)
+    {
+        return 0;
+    }
+    Diversity.seq = CombSeq;
+
+    for(ch = 0; ch < RX_CHANNELS; ch++)
+    {
+        amp[ch] = CombAbsSnap[ch] / CombWindow;
+        var[ch] = CombSqSnap[ch] / CombWindow - amp[ch] * amp[ch];
+        if(var[ch] < DIVERSITY_MIN_VAR)
+        {
+            var[ch] = DIVERSITY_MIN_VAR;
+        }
+        Diversity.snr[ch] = amp[ch] * amp[ch] / var[ch];
+    }
+
+    Diversity.best = 0;
+    for(ch = 1; ch < RX_CHANNELS; ch++)
+    {
+        if(Diversity.snr[ch] > Diversity.snr[Diversity.best])
+        {
+            Diversity.best = ch;
+        }
+    }
+
+    for(ch = 0; ch < RX_CHANNELS; ch++)
+    {
+        if(Diversity.mode == COMB_MRC)
+        {
+            w[ch] = amp[ch] / var[ch];
+        }
+        else
+        {
+            w[ch] = (ch == Diversity.best) ? 1.0f : 0.0f;
+        }
+        sum += w[ch];
+    }
+
+    if(sum <= 0.0f)
+    {
+        return 0;
+    }
+
+    for(ch = 0; ch < RX_CHANNELS; ch++)
+    {
+        CombWeight[ch] = w[ch] / sum;
+    }
+    Diversity.updates++;
+
+    return 1;
+}
+
+//
+// End of File
+//
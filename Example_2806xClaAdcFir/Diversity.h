@@ -0,0 +1,62 @@
+//###########################################################################
+//
+// FILE:   Diversity.h
+//
+// TITLE:  Receiver diversity combining weights (CPU side)
+//
+//###########################################################################
+
+#ifndef DIVERSITY_H
+#define DIVERSITY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "CLAShared.h"
+
+//
+// Defines
+//
+// COMB_SELECTION  only the channel with the best SNR is used
+// COMB_MRC        maximum-ratio combining, every channel is weighted by
+//                 amplitude / noise variance (all channels are assumed
+//                 to have the same polarity)
+//
+#define COMB_SELECTION          0
+#define COMB_MRC                1
+
+//
+// Typedefs
+//
+typedef struct {
+    Uint16 mode;                // COMB_SELECTION or COMB_MRC
+    Uint16 seq;                 // last CombSeq processed
+    Uint16 best;                // channel with the highest SNR
+    float32 snr[RX_CHANNELS];   // linear SNR estimate per channel
+    Uint32 updates;             // number of weight updates
+} diversity_t;
+
+//
+// Globals
+//
+extern diversity_t Diversity;
+
+//
+// Function Prototypes
+//
+void diversity_init(Uint16 mode, Uint32 window, float32 mid);
+Uint16 diversity_update(void);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of DIVERSITY_H definition
+
+//
+// End of File
+//
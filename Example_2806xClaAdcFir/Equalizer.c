@@ -0,0 +1,192 @@
+//###########################################################################
+//
+// FILE:   Equalizer.c
+//
+// TITLE:  Adaptive LMS equalizer on the CLA (CPU side)
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Equalizer.h"
+#include "Trace.h"
+
+#if CLA_EQUALIZER
+
+//
+// Called for every sample, runs from RAM in flash builds (Boot.h)
+//
+#pragma CODE_SECTION(eq_sample, "ramfuncs");
+
+//
+// Function Prototypes
+//
+static void eq_set_step(equalizer_t *eq, float32 mu);
+
+//
+// eq_init - Start with the taps at a delay and the step at 0
+//
+// level is the expected mean |y - CombMid| of the combined output until
+// the first combiner window has been seen. Call after init_cla(), whose
+// Task 8 resets the taps.
+//
+void
+eq_init(equalizer_t *eq, float32 level, float32 mu_train, float32 mu_track,
+        Uint16 train_bits)
+{
+    eq->train_bits = train_bits;
+    eq->left       = 0;
+    eq->locked     = 0;
+    eq->hold       = 0;
+    eq->seq        = CombSeq;
+    eq->mu_train   = mu_train;
+    eq->mu_track   = mu_track;
+    eq->level      = level;
+    eq->mse        = 0.0f;
+    eq->trainings  = 0;
+    eq->resets     = 0;
+
+    EqLevel = level;
+    EqMu    = 0.0f;
+    EqMode  = EQ_TRACK;
+
+    EALLOW;
+    Cla1Regs.MVECT2 = (Uint16) (&Cla1Task2 - &Cla1Prog_Start)*sizeof(Uint32);
+    Cla1Regs.MIER.bit.INT2 = 1;
+    EDIS;
+}
+
+//
+// eq_reset - Put the taps back to the delay and stop adapting
+//
+// Task 2 runs once the CLA is done with the sample in hand; EqMu is 0 by
+// then, so that sample does not move the taps either.
+//
+void
+eq_reset(equalizer_t *eq)
+{
+    eq->left = 0;
+    eq->resets++;
+    eq_set_step(eq, 0.0f);
+    EqMode = EQ_TRACK;
+    Cla1ForceTask2();
+    TRACE(TRACE_STATE, TRACE_SRC_EQ, 0);
+}
+
+//
+// eq_hold - Freeze the taps (1) or let them adapt again (0)
+//
+// The decisions are those of a two level signal: hold the taps while the
+// link runs PAM-4, they still equalize the channel.
+//
+void
+eq_hold(equalizer_t *eq, Uint16 hold)
+{
+    eq->hold = hold;
+    if(hold)
+    {
+        eq->left = 0;
+        EqMu   = 0.0f;
+        EqMode = EQ_TRACK;
+    }
+}
+
+//
+// eq_sample - Follow the decoder for one sample
+//
+// locked is the decoder lock, bit_valid 1 if the sample completed a bit.
+// A new lock starts the training on the preamble, which ends after
+// train_bits bits; a lost lock resets the taps.
+//
+void
+eq_sample(equalizer_t *eq, Uint16 locked, Uint16 bit_valid)
+{
+    if(locked != eq->locked)
+    {
+        eq->locked = locked;
+        if(eq->hold)
+        {
+            return;
+        }
+        if(locked)
+        {
+            eq->left = eq->train_bits;
+            eq->trainings++;
+            EqMode = EQ_TRAIN;
+            eq_set_step(eq, eq->mu_train);
+            TRACE(TRACE_STATE, TRACE_SRC_EQ, EQ_TRAIN);
+        }
+        else
+        {
+            eq_reset(eq);
+        }
+        return;
+    }
+
+    if(bit_valid && eq->left != 0 && --eq->left == 0)
+    {
+        EqMode = EQ_TRACK;
+        eq_set_step(eq, eq->mu_track);
+        TRACE(TRACE_STATE, TRACE_SRC_EQ, EQ_TRACK);
+    }
+}
+
+//
+// eq_update - Follow the signal level once per combiner window
+//
+// The level is only taken while the decoder is locked, without a signal
+// the window sums are noise. Returns 1 if the window was new.
+//
+Uint16
+eq_update(equalizer_t *eq)
+{
+    float32 level = 0.0f;
+    Uint16 ch;
+
+    if(CombSeq == eq->seq)
+    {
+        return 0;
+    }
+    eq->seq = CombSeq;
+
+    eq->mse = EqErrSnap / (CombWindow * eq->level * eq->level);
+
+    if(!eq->locked || eq->hold)
+    {
+        return 1;
+    }
+    for(ch = 0; ch < RX_CHANNELS; ch++)
+    {
+        level += CombWeight[ch] * CombAbsSnap[ch];
+    }
+    level /= CombWindow;
+    if(level < EQ_MIN_LEVEL)
+    {
+        return 1;
+    }
+
+    eq->level = level;
+    EqLevel   = level;
+    if(EqMu != 0.0f)
+    {
+        eq_set_step(eq, EqMode == EQ_TRAIN ? eq->mu_train : eq->mu_track);
+    }
+
+    return 1;
+}
+
+//
+// eq_set_step - Write EqMu for the normalised step mu
+//
+static void
+eq_set_step(equalizer_t *eq, float32 mu)
+{
+    EqMu = mu / (EQ_TAPS * eq->level * eq->level);
+}
+
+#endif // CLA_EQUALIZER
+
+//
+// End of File
+//
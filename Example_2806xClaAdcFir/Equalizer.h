@@ -0,0 +1,88 @@
+//###########################################################################
+//
+// FILE:   Equalizer.h
+//
+// TITLE:  Adaptive LMS equalizer on the CLA (CPU side)
+//
+//###########################################################################
+
+#ifndef EQUALIZER_H
+#define EQUALIZER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "CLAShared.h"
+
+//
+// Defines
+//
+// CLA Task 7 runs the combined output through an EQ_TAPS tap FIR whose
+// taps follow the LMS rule (CLA_FIR.asm)
+//      e      = d - z
+//      w[k]  += EqMu * e * x[n - k]
+// with d = +-EqLevel, the decision on a Manchester half bit. From a reset
+// the taps are a pure delay of EQ_DELAY samples, so the receiver sees the
+// same signal as without the equalizer, only later.
+//
+// The link has no training sequence the CLA could line up with, so the
+// known part of a frame is its preamble as the decoder sees it: once the
+// decoder locks, the equalizer trains for train_bits bits with d the sign
+// of its own input EQ_DELAY samples back. That signal is good enough for
+// the decoder to lock, and it does not depend on the taps being right.
+// Then it goes decision directed (EQ_TRACK) with d the sign of its output
+// and a smaller step. A loss of lock puts the taps back to the delay, so
+// a bad set of taps never keeps the receiver from locking again.
+//
+// The steps are normalised: EqMu = mu / (EQ_TAPS * level^2), level being
+// the mean |y - CombMid| of the combined output over the last combiner
+// window, so mu does not depend on the signal swing. Around 0.1 is fast
+// and still stable; host simulations with a one pole channel lose no bit
+// at 4 to 6 samples per bit where the static filter alone does.
+//
+// The CPU can not write the taps (they are in the CLA to CPU message
+// RAM); eq_reset() forces CLA Task 2 to do it. ADCINT2 is never enabled,
+// so Task 2 only runs when forced.
+//
+#define EQ_MIN_LEVEL            16.0f   // level below this is no signal
+
+//
+// Typedefs
+//
+typedef struct {
+    Uint16 train_bits;          // bits of training after lock
+    Uint16 left;                // training bits still to go
+    Uint16 locked;              // decoder lock at the last sample
+    Uint16 hold;                // taps frozen, e.g. in PAM-4
+    Uint16 seq;                 // last CombSeq processed
+    float32 mu_train;           // normalised step in EQ_TRAIN
+    float32 mu_track;           // normalised step in EQ_TRACK
+    float32 level;              // EqLevel in use
+    float32 mse;                // mean e^2 / level^2, last window
+    Uint32 trainings;           // times training started
+    Uint32 resets;              // times the taps were reset
+} equalizer_t;
+
+//
+// Function Prototypes
+//
+void eq_init(equalizer_t *eq, float32 level, float32 mu_train,
+             float32 mu_track, Uint16 train_bits);
+void eq_reset(equalizer_t *eq);
+void eq_hold(equalizer_t *eq, Uint16 hold);
+void eq_sample(equalizer_t *eq, Uint16 locked, Uint16 bit_valid);
+Uint16 eq_update(equalizer_t *eq);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of EQUALIZER_H definition
+
+//
+// End of File
+//
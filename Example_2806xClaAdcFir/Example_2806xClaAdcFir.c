@@ -8,29 +8,163 @@
 //!  <h1>CLA ADC FIR (cla_adc_fir)</h1>
 //!
 //! In this example ePWM1 is setup to generate a periodic ADC SOC. 
-//! One channel is converted: ADCINA2 and the results are placed in 
-//! the ADC RESULT1 register.
-//! When the ADC sample window ends and begins conversion, it will
-//! assert ADCINT7.
+//! RX_CHANNELS receiver channels (ADCINA2, ADCINA4, ...) are converted
+//! round-robin, OVERSAMPLE times each, on SOC1 onwards and the results
+//! are placed in the ADC RESULT1 .. RESULT<RX_CHANNELS * OVERSAMPLE> 
+//! registers.
+//! When the sample window of the last SOC ends and it begins conversion,
+//! it will assert ADCINT7.
 //! The CLA responds to ADCINT7 and executes CLA Task 7.
-//! CLA Task7 is an FIR filter.  The output from the filter is
-//! placed in VoltFilt.
+//! CLA Task7 sums the oversampled results (first order CIC decimation), 
+//! runs an FIR filter per channel and combines the channels
+//! (selection or maximum-ratio, see Diversity.c). The combined output 
+//! is placed in VoltFilt.
 //! When Task 7 completes, it fires the CLA1_INT7 interrupt to the
 //! main CPU.  
 //! The main CPU will clear the ADCINT flag, copy the CLA output to 
 //! a buffer and record the raw ADCRESULT1 value for comparison
-//! After ADC_BUF_LEN samples are collected, the code will halt on
-//! an embedded software breakpoint.
+//! AdcBuf and AdcFiltBuf are written round, they hold the last
+//! ADC_BUF_LEN samples for graphing.
 //! ePWM3 generates a square wave, which can be connected to the 
 //! ADC for testing.
 //!
+//! With BER_TEST set to 1, ePWM3 instead transmits a Manchester encoded
+//! PRBS-7 or PRBS-15 sequence. The main loop slices the CLA filter
+//! output to recover the bit clock, decides every Manchester bit on the
+//! sums of its two halves (ManchesterRx.c) and checks the bits against
+//! the same PRBS, counting bit errors continuously.
+//!
+//! With TELEMETRY set to 1, decimated raw and filtered samples, the 
+//! decoder counters and main loop load figures are streamed as COBS 
+//! framed binary records on SCI-A (GPIO28/29) at 1.40625 Mbit/s. 
+//! host/telemetry_decode.c turns the stream into CSV files.
+//!
+//! With EYE_CAPTURE set to 1, the filtered samples are folded on the
+//! recovered bit clock into a per phase histogram (Eye.c) in the
+//! background. Every EYE_WINDOW samples the eye opening, SNR and edge
+//! jitter are worked out and, with TELEMETRY, sent together with the
+//! histogram.
+//!
+//! With CPU_FILTER_CHANNELS (CLAShared.h) above 0 the last channels are
+//! filtered by the C28x in Q15 fixed point (CpuFilter.c) instead: the
+//! ADCINT7 interrupt also goes to the CPU, which filters its channels
+//! while CLA Task 7 filters the rest, then combines them. With all
+//! channels on the C28x the CLA is not used, as on the F2806x parts
+//! without one.
+//!
+//! With CLA_PIPELINE (CLAShared.h) set to 1 the CLA also slices the
+//! filtered samples, recovers the bit clock and packs the bits (Tasks 4
+//! to 6, started one after the other after Task 7). The main loop only
+//! reads packed words from the message RAM (ClaPipe.c); the time each
+//! stage takes is checked against its share of the sample period.
+//!
+//! Built with TRACE_ENABLE=1 (Trace.h) the ISRs, the main loop backlog,
+//! the decoder lock and rate changes are logged with timestamps in the
+//! Trace ring. A lost sample (ADCINT7 overflow, or a full sample buffer)
+//! freezes it; with TELEMETRY the frozen trace is then sent on SCI-A and
+//! recording starts again. host/isr_timeline.py turns it into a timeline.
+//!
+//! The sample ISR has priority over the BER transmitter ISR: with
+//! ISR_LEVEL_TX set, manchester_tx_isr runs with interrupts enabled and
+//! the sample ISR can preempt it (IsrNest.c). Both ISRs record their
+//! worst case latency; set ISR_LEVEL_TX to 0 to compare with the
+//! default, non nesting, behaviour.
+//!
+//! Built with BENCH_ENABLE=1 (Bench.h) the decoder, PRBS, eye, word
+//! codec and telemetry kernels, CLA Task 7 and the ISRs are timed on CPU
+//! timer 2 at start up, before the ePWMs start (BootUs includes it). The
+//! table is left in BenchResult and, with TELEMETRY, printed on SCI-A as
+//! CSV or JSON ahead of the telemetry frames. host/bench.c runs the same
+//! kernels on the PC; host/bench_compare.py flags regressions between two
+//! tables.
+//!
+//! With POWER_SAVE set to 1 the main loop sleeps in IDLE until the next
+//! sample, and when no carrier has been seen for a while it stops the
+//! ADC and ePWM1 and sleeps in STANDBY until COMP1 sees light on
+//! ADCINA2 (Power.c). The wake up and lock time is checked against the
+//! preamble of the frames.
+//!
+//! With CARRIER_DETECT (CLAShared.h) set to 1 the receiver only samples
+//! at the full rate while there is a carrier (Carrier.c). Otherwise CLA
+//! Task 1 checks the first receiver input every CARRIER_DIV sample
+//! periods for the level steps of a carrier and the CLA filter, the
+//! sample ISR and the decoder are idle. The full rate sampling stops
+//! again after CARRIER_TIMEOUT_BITS bits without decoder lock.
+//!
+//! With PAM4_MODE set to 1 the BER link doubles its bit rate when the
+//! signal allows: ePWM3 then drives a four level line through a two
+//! resistor DAC on EPWM3A and EPWM3B (Pam4Tx.c), one symbol of two Gray
+//! coded bits per bit period, and the receiver slices the CLA filter
+//! output against four learnt levels (Pam4Rx.c). The link starts in
+//! Manchester and tries PAM-4 when the Manchester eye is wide open; it
+//! falls back when the PAM-4 decoder loses lock or its margin gets too
+//! small, and tries again after a growing number of eye windows
+//! (LinkMode.c).
+//!
+//! With CLA_EQUALIZER (CLAShared.h) set to 1 CLA Task 7 runs the combined
+//! output through an adaptive LMS equalizer before VoltFilt, against the
+//! edge smearing of a band limited LED or coupler at the higher bit
+//! rates (Equalizer.c). It trains on the preamble from the decoder lock
+//! on, then follows the signal decision directed; the taps are left in
+//! the message RAM.
+//!
+//! The Debug configuration runs from RAM under the debugger. The Flash
+//! configuration (F28069_CLA_FLASH_lnk.cmd) boots stand alone; the ISRs
+//! and the per sample decoder path are copied to RAM at start up, the CLA
+//! program is copied to its program RAM by init_cla().
+//!
 //! \b External \b Connections \n
 //! - connect a jumper between to ADCINA2 and EPWM3A (GPIO4)
+//! - with PAM4_MODE, connect EPWM3A (GPIO4) through R and EPWM3B (GPIO5)
+//!   through 2R to ADCINA2 instead, e.g. 10k and 20k
+//! - connect the other receiver inputs to ADCINA4 (and up)
 //!
 //! \b Watch \b Variables \n
 //! - Uint16 AdcBuf[ADC_BUF_LEN]      - Buffer of raw ADC RESULT1 values
 //! - Uint16 AdcFiltBuf[ADC_BUF_LEN]  - Buffer of CLA FIR filter outputs                 
 //! - Uint16 SampleCount              - Current sample number
+//! - Uint32 SampleOverruns           - Times the decoder fell a whole
+//!                                     ADC_BUF_LEN buffer behind
+//! - Uint16 CommsBuffer[]            - Last COMMS_BUF_BITS decoded bits,
+//!                                     16 per word, CommsBits written
+//! - prbs_checker_t BerChecker       - BER test bit and error counters
+//! - manchester_rx_t ManchesterRx    - Decoder lock state and counters
+//! - Uint16 LineRequest              - Line code of the BER link, set
+//!                                     LineChangePending to apply
+//! - chip_rx_t ChipRx                - Line code decoder lock, slips and
+//!                                     code errors (BER_TEST)
+//! - diversity_t Diversity           - Per channel SNR and best channel
+//! - rate_request_t RateRequest      - Bit rate and samples per bit, set
+//!                                     RateChangePending to apply
+//! - rate_config_t RateConfig        - Rates in use
+//! - eye_t Eye                       - Eye histogram, opening, SNR and
+//!                                     jitter of the last window
+//! - Uint32 BootUs                   - Start up time, main() to main loop
+//! - cpu_filter_t CpuFilter          - C28x filter outputs and the number
+//!                                     of samples it waited for the CLA
+//! - cla_pipe_t ClaPipe              - CLA pipeline stage budgets and
+//!                                     stages over budget
+//! - Uint16 ClaCyclesMax[]           - Worst case cycles per CLA stage
+//! - trace_t Trace                   - Last ISR and decoder events
+//!                                     (TRACE_ENABLE)
+//! - isr_nest_t SampleIsr            - Sample ISR latency in cycles
+//!                                     since the SOC, last and worst
+//! - isr_nest_t ManchesterTx.isr     - Transmitter ISR latency in
+//!                                     cycles since ePWM3 CTR = 0
+//! - bench_result_t BenchResult[]    - Cycles per kernel (BENCH_ENABLE)
+//! - power_t Power                   - Wake up latency, lock time and
+//!                                     preamble margin (POWER_SAVE)
+//! - link_mode_t Link                - Link mode, PAM-4 upgrades and
+//!                                     fallbacks (PAM4_MODE)
+//! - pam4_rx_t Pam4Rx                - PAM-4 levels, noise, lock and
+//!                                     counters (PAM4_MODE)
+//! - carrier_t Carrier               - Receiver mode, detections and
+//!                                     timeouts (CARRIER_DETECT)
+//! - float32 CarrierEnergy           - Detector level steps summed over
+//!                                     the last window
+//! - equalizer_t Equalizer           - Equalizer level, error and
+//!                                     trainings (CLA_EQUALIZER)
+//! - float32 EqW[]                   - Equalizer taps
 //
 //###########################################################################
 // $TI Release:  $
@@ -78,6 +212,27 @@
 // CLA assembly code)
 //
 #include "CLAShared.h"
+#include "BenchSuite.h"
+#include "Boot.h"
+#include "ClaPipe.h"
+#include "BitBuf.h"
+#include "Carrier.h"
+#include "ChipRx.h"
+#include "CpuFilter.h"
+#include "Diversity.h"
+#include "Equalizer.h"
+#include "Eye.h"
+#include "IsrNest.h"
+#include "LinkMode.h"
+#include "ManchesterRx.h"
+#include "ManchesterTx.h"
+#include "Pam4Rx.h"
+#include "Pam4Tx.h"
+#include "Power.h"
+#include "Prbs.h"
+#include "RateConfig.h"
+#include "Telemetry.h"
+#include "Trace.h"
 #include "string.h"
 #include <stdlib.h>
 //
@@ -92,31 +247,224 @@
 #define HIGHPASS            0
 
 //  
-// ADC_SAMPLE_PERIOD is used to configure ePWM1 in 
-// up count mode with TBPRD = 1/2 SYSCLKOUT = 40 MHz
-// 
-//      An ADC SOC will be started every ePWM1 period. 
-//      For a 10 KHz sampling rate:
-//      -> Tpwm = 2 x TBPRD x (1/40 MHz)
-//      -> TBPRD = (40MHz)/(2*1MHz) = 20
+// BIT_RATE and SAMPLES_PER_BIT are the rates used at start up. ePWM1 
+// starts an ADC SOC every sample period, BIT_RATE * SAMPLES_PER_BIT per
+// second. Both can be changed at run time through RateRequest, the
+// register values are worked out by rate_compute() (RateConfig.c):
+//      -> TBCLK = 1/2 SYSCLKOUT = 45 MHz, up count mode
+//      -> TBPRD = 45 MHz / (100 kbit/s * 10) - 1 = 44
+//
+//      Every trigger converts each receiver channel OVERSAMPLE times
+//      and yields one (decimated) sample, so this is the output rate
+//      seen by the CPU. See OVERSAMPLE in CLAShared.h.
 // 
-// PWM_PERIOD is the period for ePWM3. This will be sampled by the ADC.  
+// PWM_PERIOD is the period of the ePWM3 test square wave, sent when
+// BER_TEST is 0. ePWM3 counts up and down on TBCLK = 45 MHz, so 200 is
+// a 112.5 kHz square wave, whatever the sample rate.
 // 
 // PWM_DUTY_CYCLE is the duty cycle for ePWM3.  This will be used for the 
 // compare A value
 //
-// ADC_BUF_LEN is the number of samples we will gather before stopping.
+// ADC_BUF_LEN is the length of AdcBuf and AdcFiltBuf. The ISR writes
+// them round, the main loop decodes the samples behind it.
 //
 // FILTER_LEN is the FIR filter length
 //
-#define ADC_SAMPLE_PERIOD   20 //sampling rate of 1 MHz
-#define PWM_PERIOD          200 //low pwm freq of
+#define BIT_RATE            100000UL //Manchester bit rate at start up
+#define PWM_PERIOD          200
 #define PWM_DUTY_CYCLE      100
 #define ADC_BUF_LEN         160 //holds 2 bytes with 10 samples per bit
 //
+// COMMS_BUF_BITS is the number of decoded bits kept in CommsBuffer, a
+// power of 2. They are packed 16 to a word (BitBuf.h), so 2048 bits take
+// 128 words.
+//
+#define COMMS_BUF_BITS      2048
+//
 //Defines for Manchester detection
+//The CLA output is on a 4096 * OVERSAMPLE scale
+//
+#define THRESHOLD_MANCHESTER (2048 * OVERSAMPLE)
+#define HYSTERESIS_MANCHESTER (64 * OVERSAMPLE)
+#define SAMPLES_PER_BIT     10
+
+//
+// If you want ePWM3 to transmit a Manchester encoded PRBS for bit error 
+// rate measurements, set BER_TEST to 1. BER_PRBS_ORDER selects PRBS-7 or
+// PRBS-15.
+//
+// In BER test mode ePWM3 is the Manchester transmitter (ManchesterTx.c).
+// It counts up with the same time base as ePWM1 and its period is one
+// Manchester bit, i.e. samples_per_bit ADC sample periods. The main loop 
+// keeps the transmit queue filled with BER_FRAME_BYTES byte PRBS frames.
+//
+#define BER_TEST            0
+#define BER_PRBS_ORDER      PRBS_ORDER_7
+#define BER_FRAME_BYTES     MANCHESTER_TX_MAX_BYTES
+
+//
+// The BER link sends its bytes in a line code of LineCode.h picked at
+// run time: set LineRequest (LINE_xxx) and LineVppmWidth, then
+// LineChangePending to 1; LineStatus is the set_line_code() result.
+// LINE_4B5B and LINE_8B10B carry 60 % more bits than Manchester on the
+// same ePWM3 bit period. ChipRx decodes them; Manchester stays with
+// ManchesterRx and what follows it (eye, equalizer, CLA pipeline).
+// LINE_START is the code at start up, LINE_VPPM_WIDTH the dimming of
+// LINE_VPPM.
+//
+#define LINE_START          LINE_MANCHESTER
+#define LINE_VPPM_WIDTH     (LINE_VPPM_SLOTS / 2)
+
+//
+// The diversity combiner re-weights the receiver channels once per frame
+// (COMB_WINDOW_BITS bits). COMB_MODE is the initial mode, Diversity.mode
+// can be changed at run time.
+//
+#define COMB_WINDOW_BITS    (MANCHESTER_TX_MAX_BYTES * 8UL)
+#define COMB_MODE           COMB_MRC
+
+//
+// Set TELEMETRY to 1 to stream on SCI-A (Telemetry.c). Every
+// TELEMETRY_DECIMATION-th sample is logged, TELEMETRY_SNAP_LEN samples
+// per frame. A counters and a profile frame follow every
+// TELEMETRY_COUNTER_SNAPS sample frames. At the start up sample rate
+// of 1 MHz this is about 67 kbyte/s of the 140 kbyte/s the link carries.
+//
+#define TELEMETRY               0
+#define TELEMETRY_DECIMATION    64
+#define TELEMETRY_SNAP_LEN      32
+#define TELEMETRY_COUNTER_SNAPS 8
+
 //
-#define THRESHOLD_MANCHESTER 2048
+// A frozen trace goes out TRACE_FRAME_RECORDS records per
+// TELEMETRY_TRACE frame
+//
+#define TRACE_FRAME_RECORDS     30
+
+//
+// With BENCH_ENABLE every kernel is called BENCH_CALLS times, the table
+// goes out in BENCH_FORMAT (BENCH_CSV or BENCH_JSON)
+//
+#define BENCH_CALLS             32
+#define BENCH_FORMAT            BENCH_CSV
+
+//
+// Set EYE_CAPTURE to 1 to fold the filtered samples into an eye diagram
+// (Eye.c). The folding costs a few cycles per sample while a window is
+// being captured; the figures are worked out in the main loop once per
+// window.
+//
+#define EYE_CAPTURE             0
+
+#if CLA_PIPELINE && EYE_CAPTURE
+#error "EYE_CAPTURE folds on the CPU decoder, clear it for CLA_PIPELINE"
+#endif
+
+//
+// Interrupt levels (IsrNest.h), 1 is the highest. A lower level ISR is
+// preempted by the higher ones, 0 turns nesting off for that ISR. The
+// sample ISR has nothing above it and never nests.
+//
+#define ISR_LEVEL_SAMPLE        1
+#define ISR_LEVEL_TX            2
+
+//
+// Set POWER_SAVE to 1 to save power in the main loop (Power.h): it
+// sleeps in IDLE until the next sample, and after POWER_SILENCE_BITS
+// bits without decoder lock, with nothing left to transmit, it stops the
+// ADC and ePWM1 and sleeps in POWER_SLEEP_MODE until light comes back.
+// COMP1 compares ADCINA2 with the slicer threshold on its DAC and drives
+// the wake pin POWER_WAKE_GPIO (GPIO1, COMP1OUT). Transmitters send
+// POWER_PREAMBLE_BITS bits ahead of a frame; Power.margin_bits is what
+// the slowest wake up and lock left of them. With BER_TEST the link is
+// never silent, only the IDLE between samples happens.
+//
+#define POWER_SAVE              0
+#define POWER_SLEEP_MODE        POWER_STANDBY
+#define POWER_SILENCE_BITS      64
+#define POWER_PREAMBLE_BITS     32
+#define POWER_WAKE_GPIO         1
+
+//
+// With CARRIER_DETECT (CLAShared.h) a window of CARRIER_WINDOW detector
+// samples whose mean step is above CARRIER_LEVEL ADC codes is a carrier.
+// A Manchester carrier of swing S steps by about S/2 per sample, noise
+// of rms n by about 1.1 n. The receiver goes back to detect after
+// CARRIER_TIMEOUT_BITS bits without lock.
+//
+#define CARRIER_LEVEL           128
+#define CARRIER_WINDOW          32
+#define CARRIER_TIMEOUT_BITS    64
+
+#if CARRIER_DETECT && POWER_SAVE
+#error "CARRIER_DETECT and POWER_SAVE both stop the sampling, set one"
+#endif
+
+//
+// Set PAM4_MODE to 1 to let the BER link switch to PAM-4 (LinkMode.h).
+// It tries PAM-4 on a Manchester eye Q of LINK_MIN_Q and stays while
+// pam4_rx_margin() is LINK_MIN_MARGIN (Q4) or more. The slicer alone
+// would do with 5; below 6 the symbol clock starts to slip on noisy
+// crossings (host/channel.c at 10 samples per symbol). The PAM-4 decoder
+// takes HYSTERESIS_MANCHESTER as the band around its middle level.
+//
+#define PAM4_MODE               0
+#define LINK_MIN_Q              12.0f
+#define LINK_MIN_MARGIN         96
+
+#if PAM4_MODE && !BER_TEST
+#error "PAM4_MODE switches the BER transmitter, set BER_TEST"
+#endif
+#if PAM4_MODE && !EYE_CAPTURE
+#error "PAM4_MODE upgrades on the Manchester eye, set EYE_CAPTURE"
+#endif
+#if PAM4_MODE && CLA_PIPELINE
+#error "PAM4_MODE decodes on the CPU, clear CLA_PIPELINE"
+#endif
+#if PAM4_MODE && PAM4_TX_MAX_BYTES < BER_FRAME_BYTES
+#error "BER_FRAME_BYTES does not fit a PAM-4 frame"
+#endif
+
+//
+// With CLA_EQUALIZER (CLAShared.h) the equalizer trains for
+// EQ_TRAIN_BITS bits of the preamble (POWER_PREAMBLE_BITS) from the
+// decoder lock on, at the normalised step EQ_MU_TRAIN, then tracks at
+// EQ_MU_TRACK (Equalizer.h). EQ_LEVEL is the mean distance of the
+// combined output from its middle until the first combiner window.
+//
+#define EQ_TRAIN_BITS           24
+#define EQ_MU_TRAIN             0.1f
+#define EQ_MU_TRACK             0.01f
+#define EQ_LEVEL                (1024.0f * OVERSAMPLE)
+
+#if CLA_EQUALIZER && CLA_PIPELINE
+#error "CLA_EQUALIZER follows the CPU decoder, clear CLA_PIPELINE"
+#endif
+
+//
+// The receiver and transmitter of the link mode and line code in use
+//
+#if BER_TEST
+#define LINE_LOCKED         (LineCode == LINE_MANCHESTER ?                  \
+                             ManchesterRx.locked : ChipRx.locked)
+#else
+#define LINE_LOCKED         ManchesterRx.locked
+#endif
+#if PAM4_MODE
+#define RX_LOCKED           (Link.mode == LINK_PAM4 ? Pam4Rx.locked :       \
+                                                      LINE_LOCKED)
+#define TX_FREE()           (Link.mode == LINK_PAM4 ? pam4_tx_free() :      \
+                                                      manchester_tx_free())
+#define TX_SEND(data, n)    (Link.mode == LINK_PAM4 ? pam4_tx_send(data, n) :\
+                                                 manchester_tx_send(data, n))
+#define TX_BUSY()           (Link.mode == LINK_PAM4 ? pam4_tx_busy() :      \
+                                                      manchester_tx_busy())
+#else
+#define RX_LOCKED           LINE_LOCKED
+#define TX_FREE()           manchester_tx_free()
+#define TX_SEND(data, n)    manchester_tx_send(data, n)
+#define TX_BUSY()           manchester_tx_busy()
+#endif
 
 //
 //Typedef of state machine to detect manchester signal
@@ -135,17 +483,70 @@ void init_epwm1(void);
 void init_epwm3(void);
 void init_cla(void);
 void init_adc(void);
+#if POWER_SAVE
+void init_comp1(void);
+#endif
+Uint16 apply_rates(void);
+#if PAM4_MODE
+void set_link_mode(Uint16 mode);
+#endif
+#if BER_TEST
+Uint16 set_line_code(Uint16 code, Uint16 vppm_width);
+#endif
+#if TELEMETRY
+void log_sample(Uint16 raw, Uint16 filt);
+void log_counters(void);
+#if EYE_CAPTURE
+Uint16 log_eye(void);
+#endif
+#if TRACE_ENABLE
+void log_trace(void);
+#endif
+#endif
+#if BENCH_ENABLE
+void run_bench(void);
+#endif
 
 // 
 // Function Prototypes for interrupt functions
 // The main CPU will service this interrupt every every time task 7 completes.
+// With channels filtered on the C28x it services ADCINT7 instead.
 //
+#if CPU_FILTER_CHANNELS == 0
 __interrupt void cla1_isr7(void);
+#else
+__interrupt void adc_isr7(void);
+#endif
+#if TRACE_ENABLE
+Uint16 trace_adc_overrun(void);
+#endif
+
+//
+// The ISR and the per sample work of the main loop run from RAM in the
+// Flash configuration
+//
+#if CPU_FILTER_CHANNELS == 0
+#pragma CODE_SECTION(cla1_isr7, "ramfuncs");
+#else
+#pragma CODE_SECTION(adc_isr7, "ramfuncs");
+#endif
+#if TELEMETRY
+#pragma CODE_SECTION(log_sample, "ramfuncs");
+#endif
+#if TRACE_ENABLE
+#pragma CODE_SECTION(trace_adc_overrun, "ramfuncs");
+#endif
 
 // 
 // Globals
 //
 
+//
+// RxAdcChannel is the ADC input of each receiver channel, converted on
+// SOC1 + channel
+//
+const Uint16 RxAdcChannel[RX_CHANNELS] = {2, 4};
+
 //
 // SampleCount The current sample
 //
@@ -155,10 +556,158 @@ __interrupt void cla1_isr7(void);
 // AdcFiltBuf  holds a log of the CLA filter output as passed from the CLA 
 //             to the main CPU through the message RAM
 //
-Uint16 SampleCount;
+// ReadIndex   next sample of AdcFiltBuf to be decoded by the main loop
+//
+// SampleOverruns  times the sample ISR caught up with ReadIndex: the
+//             decoder was a whole buffer behind and ADC_BUF_LEN samples
+//             were lost each time
+//
+volatile Uint16 SampleCount;
+volatile Uint16 ReadIndex;
+volatile Uint32 SampleOverruns;
 Uint16 AdcBuf[ADC_BUF_LEN];
 Uint16 AdcFiltBuf[ADC_BUF_LEN]; //temporary buffer... only to watch avg value over time
-Uint16 CommsBuffer[ADC_BUF_LEN]; //buffer that will hold the capture manchester bits
+Uint16 CommsBuffer[BITVEC_WORDS(COMMS_BUF_BITS)]; //decoded manchester bits
+Uint16 CommsBits; //bits written to CommsBuffer, modulo 2^16
+
+//
+// ManchesterRx decodes the filtered samples into bits
+//
+// BerTx       generates the transmitted PRBS
+// BerFrame    one PRBS frame, packed LSB first for TX_SEND
+// BerChecker  compares the decoded bits against the PRBS and counts errors
+//
+manchester_rx_t ManchesterRx;
+#if BER_TEST
+prbs_t BerTx;
+Uint16 BerFrame[BER_FRAME_BYTES];
+prbs_checker_t BerChecker;
+#endif
+
+//
+// LineCode           line code in use on the BER link (LINE_xxx)
+// LineRequest        line code to switch to, may be edited at run time;
+//                    set LineChangePending to 1 to apply it
+// LineVppmWidth      pulse slots of LINE_VPPM in the request
+// LineStatus         result of the last request, LINE_OK if it was applied
+// ChipRx             decoder of the filtered samples in the codes but
+//                    Manchester
+//
+#if BER_TEST
+Uint16 LineCode;
+Uint16 LineRequest;
+Uint16 LineVppmWidth;
+Uint16 LineStatus;
+volatile Uint16 LineChangePending;
+chip_rx_t ChipRx;
+#endif
+
+//
+// Pam4Rx             PAM-4 decoder of the filtered samples
+// Link               link mode in use and when to switch
+// LinkEyeWindows     Eye.windows already weighed by link_mode_eye()
+//
+#if PAM4_MODE
+pam4_rx_t Pam4Rx;
+link_mode_t Link;
+Uint32 LinkEyeWindows;
+#endif
+
+//
+// RateRequest        bit rate and samples per bit, may be edited at run 
+//                    time; set RateChangePending to 1 to apply it
+// RateConfig         register values of the rates in use
+// RateStatus         result of the last request, RATE_OK if it was applied
+//
+rate_request_t RateRequest;
+rate_config_t RateConfig;
+Uint16 RateStatus;
+volatile Uint16 RateChangePending;
+
+//
+// Telemetry          SCI-A telemetry stream
+// TelemetryPayload   frame being built
+// TelemetryFill      samples in the sample frame being built
+// TelemetrySnaps     sample frames since the last counters frame
+// SampleTotal        samples decoded since start
+// LoopCount          main loop passes since start
+// MaxBacklog         most samples waiting for the decoder, seen by the
+//                    main loop, at most ADC_BUF_LEN - 1; samples lost
+//                    to a full buffer are counted in SampleOverruns
+//
+//
+// Eye                eye diagram capture on the recovered bit clock
+// EyeRows            eye frames of the current window sent so far
+//
+#if EYE_CAPTURE
+eye_t Eye;
+#if TELEMETRY
+Uint16 EyeRows;
+#endif
+#endif
+
+//
+// ClaPipe            CPU side of the CLA receive pipeline
+//
+#if CLA_PIPELINE
+cla_pipe_t ClaPipe;
+#endif
+
+//
+// SampleIsr          level and latency of cla1_isr7 / adc_isr7
+//
+isr_nest_t SampleIsr;
+
+//
+// Power              sleep, wake up latency and preamble margin
+// PowerSilence       samples decoded without lock
+//
+#if POWER_SAVE
+power_t Power;
+Uint16 PowerSilence;
+#endif
+
+//
+// Carrier            carrier detector and receiver mode
+//
+#if CARRIER_DETECT
+carrier_t Carrier;
+#endif
+
+//
+// Equalizer          equalizer training and level
+//
+#if CLA_EQUALIZER
+equalizer_t Equalizer;
+#endif
+
+//
+// BenchResult        kernel timings of run_bench()
+// BenchCount         results in BenchResult
+//
+#if BENCH_ENABLE
+bench_result_t BenchResult[BENCH_SUITE_CASES + 3 + PAM4_MODE +
+                           2 * CLA_EQUALIZER];
+Uint16 BenchCount;
+#endif
+
+//
+// TraceSent          records of the frozen trace sent so far
+//
+#if TELEMETRY && TRACE_ENABLE
+Uint16 TraceSent;
+#endif
+
+#if TELEMETRY
+telemetry_t Telemetry;
+Uint16 TelemetryPayload[TELEMETRY_MAX_PAYLOAD];
+Uint16 TelemetryFill;
+Uint16 TelemetrySnaps;
+Uint32 SampleTotal;
+Uint32 LoopCount;
+Uint16 MaxBacklog;
+#endif
+
 //
 // The DATA_SECTION pragma statements are used to place the variables in 
 // specific assembly sections.  These sections are linked to the message RAMs
@@ -168,24 +717,177 @@ Uint16 CommsBuffer[ADC_BUF_LEN]; //buffer that will hold the capture manchester
 // The CLA can write to and read from this RAM.  The main CPU can only 
 // read from it
 //
-// X is the filter sample delay line.  These will be populated by the CLA
-// from the ADC RESULT1 register
+// X is the filter sample delay line of each channel.  These will be 
+// populated by the CLA from the ADC RESULT registers
 //
 // VoltFilt is the output from the CLA after the FIR filter
-// Basically it is the filtered value
+// Basically it is the filtered value, combined over the channels
+//
+// The remaining variables are the per channel outputs and the combiner
+// statistics, see CLAShared.h
+//
+// The CPU can not write the message RAM, so whatever it computes itself
+// (CPU_FILTER_CHANNELS above 0) is left in ordinary RAM.
 //  
+#if CLA_FILTER_CHANNELS > 0
 #pragma DATA_SECTION(X,          "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(VoltFiltCh, "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(YCh,        "Cla1ToCpuMsgRAM");
+#endif
+#if CPU_FILTER_CHANNELS == 0
 #pragma DATA_SECTION(VoltFilt,   "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(CombAbsSum, "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(CombSqSum,  "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(CombAbsSnap,"Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(CombSqSnap, "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(CombCount,  "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(CombSeq,    "Cla1ToCpuMsgRAM");
+#endif
 
-float32 X[FILTER_LEN];
+float32 X[RX_CHANNELS][FILTER_LEN];
 Uint16 VoltFilt;
+Uint16 VoltFiltCh[RX_CHANNELS];
+float32 YCh[RX_CHANNELS];
+float32 CombAbsSum[RX_CHANNELS];
+float32 CombSqSum[RX_CHANNELS];
+float32 CombAbsSnap[RX_CHANNELS];
+float32 CombSqSnap[RX_CHANNELS];
+float32 CombCount;
+Uint16 CombSeq;
+
+//
+// CLA receive pipeline mailboxes and stage timing, see CLAShared.h
+//
+#if CLA_PIPELINE
+#pragma DATA_SECTION(ClaLevel,      "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaEdge,       "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaCount,      "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaLocked,     "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaBit,        "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaBitValid,   "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaHist,       "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaHistHead,   "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaHistHalf,   "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaEarly,      "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaLate,       "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaPending,    "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaEdgeLevel,  "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaBits,       "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaSyncLosses, "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaBitWord,    "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaBitN,       "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaBitRing,    "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaBitHead,    "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaBitWords,   "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaCycles,     "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaCyclesMax,  "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaStageStart, "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(ClaPipeStart,  "Cla1ToCpuMsgRAM");
+
+Uint16 ClaLevel;
+Uint16 ClaEdge;
+Uint16 ClaCount;
+Uint16 ClaLocked;
+Uint16 ClaBit;
+Uint16 ClaBitValid;
+Uint16 ClaHist[2 * CLA_RX_MAX_HALF];
+Uint16 ClaHistHead;
+Uint16 ClaHistHalf;
+int32 ClaEarly;
+int32 ClaLate;
+Uint16 ClaPending;
+Uint16 ClaEdgeLevel;
+Uint32 ClaBits;
+Uint32 ClaSyncLosses;
+Uint16 ClaBitWord;
+Uint16 ClaBitN;
+Uint16 ClaBitRing[CLA_BIT_RING];
+Uint16 ClaBitHead;
+Uint16 ClaBitWords;
+Uint16 ClaCycles[CLA_STAGES + 1];
+Uint16 ClaCyclesMax[CLA_STAGES + 1];
+Uint16 ClaStageStart;
+Uint16 ClaPipeStart;
+#endif
+
+//
+// Carrier detector window sums, see CLAShared.h
+//
+#if CARRIER_DETECT
+#pragma DATA_SECTION(CarrierLast,   "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(CarrierSum,    "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(CarrierCount,  "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(CarrierEnergy, "Cla1ToCpuMsgRAM");
+
+float32 CarrierLast;
+float32 CarrierSum;
+float32 CarrierCount;
+float32 CarrierEnergy;
+#endif
+
+//
+// Equalizer taps, delay line and error, see CLAShared.h
+//
+#if CLA_EQUALIZER
+#pragma DATA_SECTION(EqW,       "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(EqX,       "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(EqErrSum,  "Cla1ToCpuMsgRAM");
+#pragma DATA_SECTION(EqErrSnap, "Cla1ToCpuMsgRAM");
+
+float32 EqW[EQ_TAPS];
+float32 EqX[EQ_TAPS + 1];
+float32 EqErrSum;
+float32 EqErrSnap;
+#endif
 
 //
 // The following will be placed in the CPU to CLA message RAM. 
 // The main CPU can write to and read from this RAM.  The CLA can only read 
 // from it. A is the filter coefficients passed by the main CPU to the CLA. 
+// CombWeight, CombWindow and CombMid configure the diversity combiner.
 //
+#if CLA_FILTER_CHANNELS > 0
 #pragma DATA_SECTION(A,          "CpuToCla1MsgRAM");
+#pragma DATA_SECTION(CombWeight, "CpuToCla1MsgRAM");
+#pragma DATA_SECTION(CombWindow, "CpuToCla1MsgRAM");
+#pragma DATA_SECTION(CombMid,    "CpuToCla1MsgRAM");
+#endif
+
+float32 CombWeight[RX_CHANNELS];
+float32 CombWindow;
+float32 CombMid;
+
+#if CLA_PIPELINE
+#pragma DATA_SECTION(ClaSliceHi,    "CpuToCla1MsgRAM");
+#pragma DATA_SECTION(ClaSliceLo,    "CpuToCla1MsgRAM");
+#pragma DATA_SECTION(ClaEdgeWindow, "CpuToCla1MsgRAM");
+#pragma DATA_SECTION(ClaLostWindow, "CpuToCla1MsgRAM");
+#pragma DATA_SECTION(ClaHalf,       "CpuToCla1MsgRAM");
+
+Uint16 ClaSliceHi;
+Uint16 ClaSliceLo;
+Uint16 ClaEdgeWindow;
+Uint16 ClaLostWindow;
+Uint16 ClaHalf;
+#endif
+
+#if CARRIER_DETECT
+#pragma DATA_SECTION(CarrierWindow, "CpuToCla1MsgRAM");
+#pragma DATA_SECTION(CarrierLevel,  "CpuToCla1MsgRAM");
+
+float32 CarrierWindow;
+float32 CarrierLevel;
+#endif
+
+#if CLA_EQUALIZER
+#pragma DATA_SECTION(EqMode,  "CpuToCla1MsgRAM");
+#pragma DATA_SECTION(EqMu,    "CpuToCla1MsgRAM");
+#pragma DATA_SECTION(EqLevel, "CpuToCla1MsgRAM");
+
+Uint16 EqMode;
+float32 EqMu;
+float32 EqLevel;
+#endif
 
 #if LOWPASS
     //
@@ -215,6 +917,26 @@ extern Uint16 Cla1funcsLoadSize;
 void main(void)
 {
     Uint16 i = 0; //counter variable
+#if BER_TEST
+    Uint16 j;
+    Uint16 nbytes;
+#endif
+#if CLA_PIPELINE
+    Uint16 word;
+#else
+    int16 bit;
+#endif
+#if PAM4_MODE
+    Uint16 link;
+#endif
+#if TELEMETRY
+    Uint16 brr;
+    Uint16 backlog;
+#endif
+#if TRACE_ENABLE
+    Uint16 pending;
+    Uint16 locked = 0;
+#endif
     state_machine_t state_t = IDLE; //state variable to monitor de state machine. Starts at IDLE
 
     //
@@ -224,6 +946,12 @@ void main(void)
     //
     InitSysCtrl();
 
+    //
+    // Copy the RAM functions and set up the flash wait states (flash
+    // build), start timing the boot
+    //
+    boot_start();
+
     //
     // Step 2. Initialize GPIO:
     // This example function is found in the F2806x_Gpio.c file and
@@ -252,6 +980,23 @@ void main(void)
     GpioCtrlRegs.GPADIR.bit.GPIO18 = 1;
     EDIS;  
 
+#if TELEMETRY
+    //
+    // SCI-A on GPIO28/29 carries the telemetry
+    //
+    InitSciaGpio();
+    if(rate_sci_brr(TELEMETRY_BAUD, &brr) != RATE_OK)
+    {
+        __asm(" ESTOP0");
+    }
+    telemetry_init(&Telemetry, &SciaRegs, brr);
+    TelemetryFill  = 0;
+    TelemetrySnaps = 0;
+    SampleTotal    = 0;
+    LoopCount      = 0;
+    MaxBacklog     = 0;
+#endif
+
     //
     // Step 3. Clear all interrupts and initialize PIE vector table:
     // Disable CPU interrupts
@@ -289,7 +1034,14 @@ void main(void)
     // EDIS: is needed to disable write to EALLOW protected registers
     //
     EALLOW;  
+#if CPU_FILTER_CHANNELS == 0
     PieVectTable.CLA1_INT7 = &cla1_isr7;   
+#else
+    PieVectTable.ADCINT7 = &adc_isr7;
+#endif
+#if BER_TEST
+    PieVectTable.EPWM3_INT = &manchester_tx_isr;
+#endif
     EDIS;    
 
     //
@@ -308,8 +1060,47 @@ void main(void)
     // Enable Global interrupts with INTM
     // Enable Global realtime interrupts with DBGM
     //
+#if CPU_FILTER_CHANNELS == 0
     PieCtrlRegs.PIEIER11.bit.INTx7 = 1;      
     IER |= M_INT11;                         
+#else
+    //
+    // Enable INT 10.7 in the PIE (ADCINT7) instead, the CPU filters
+    //
+    PieCtrlRegs.PIEIER10.bit.INTx7 = 1;
+    IER |= M_INT10;
+#endif
+#if BER_TEST
+    //
+    // Enable INT 3.3 in the PIE (ePWM3, BER transmitter)
+    //
+    PieCtrlRegs.PIEIER3.bit.INTx3 = 1;
+    IER |= M_INT3;
+#endif
+
+    //
+    // Interrupt priorities, the sample ISR first
+    //
+#if CPU_FILTER_CHANNELS == 0
+    isr_nest_add(&SampleIsr, 11, 7, ISR_LEVEL_SAMPLE);
+#else
+    isr_nest_add(&SampleIsr, 10, 7, ISR_LEVEL_SAMPLE);
+#endif
+#if BER_TEST
+    isr_nest_add(&ManchesterTx.isr, 3, 3, ISR_LEVEL_TX);
+#endif
+#if PAM4_MODE
+    isr_nest_add(&Pam4Tx.isr, 3, 3, ISR_LEVEL_TX);
+#endif
+    TRACE_INIT();
+#if TRACE_ENABLE && TELEMETRY
+    TraceSent = 0;
+#endif
+#if POWER_SAVE
+    power_init(&Power, POWER_WAKE_GPIO, POWER_PREAMBLE_BITS,
+               RATE_SYSCLK_HZ / BIT_RATE);
+    PowerSilence = 0;
+#endif
     EINT;
     ERTM;
 
@@ -322,8 +1113,69 @@ void main(void)
         AdcFiltBuf[i] = 0x0000;
     } 
 
+    //
+    // Work out the start up rates. The ADC has to convert every SOC of
+    // a sample within one sample period.
+    //
+    RateRequest.bit_rate        = BIT_RATE;
+    RateRequest.samples_per_bit = SAMPLES_PER_BIT;
+    RateRequest.sample_clock    = RATE_CLOCK_EPWM;
+    RateRequest.adc_socs        = RX_CHANNELS * OVERSAMPLE;
+    RateRequest.sci_baud        = 0;
+    RateChangePending           = 0;
+    RateStatus = rate_compute(&RateRequest, &RateConfig);
+    if(RateStatus != RATE_OK)
+    {
+        __asm(" ESTOP0");
+    }
+
+    diversity_init(COMB_MODE, COMB_WINDOW_BITS * SAMPLES_PER_BIT,
+                   THRESHOLD_MANCHESTER);
+    manchester_rx_init(&ManchesterRx, THRESHOLD_MANCHESTER,
+                       HYSTERESIS_MANCHESTER, SAMPLES_PER_BIT);
+#if PAM4_MODE
+    pam4_rx_init(&Pam4Rx, 0, 4095 * OVERSAMPLE, HYSTERESIS_MANCHESTER,
+                 SAMPLES_PER_BIT);
+    link_mode_init(&Link, LINK_MIN_MARGIN, LINK_MIN_Q);
+    LinkEyeWindows = 0;
+#endif
+#if EYE_CAPTURE
+    eye_init(&Eye, THRESHOLD_MANCHESTER, 4096 * OVERSAMPLE, SAMPLES_PER_BIT);
+#endif
+#if BER_TEST
+    prbs_init(&BerTx, BER_PRBS_ORDER);
+    prbs_checker_init(&BerChecker, BER_PRBS_ORDER);
+    LineCode          = LINE_MANCHESTER;
+    LineRequest       = LINE_START;
+    LineVppmWidth     = LINE_VPPM_WIDTH;
+    LineStatus        = LINE_OK;
+    LineChangePending = LINE_START != LINE_MANCHESTER;
+    chip_rx_init(&ChipRx, THRESHOLD_MANCHESTER, HYSTERESIS_MANCHESTER,
+                 SAMPLES_PER_BIT, LINE_MANCHESTER, 0);
+#endif
+#if CLA_PIPELINE
+    cla_pipe_init(&ClaPipe, THRESHOLD_MANCHESTER, HYSTERESIS_MANCHESTER);
+    cla_pipe_set_rate(&ClaPipe, SAMPLES_PER_BIT,
+                      (RATE_SYSCLK_HZ / RATE_TBCLK_HZ) *
+                      (RateConfig.adc_tbprd + 1UL));
+#endif
+
+#if CPU_FILTER_CHANNELS > 0
+    cpu_filter_init();
+#endif
+#if CLA_FILTER_CHANNELS > 0
     init_cla();  
+#endif
+#if CLA_EQUALIZER
+    eq_init(&Equalizer, EQ_LEVEL, EQ_MU_TRAIN, EQ_MU_TRACK, EQ_TRAIN_BITS);
+#endif
     init_adc();
+#if POWER_SAVE
+    init_comp1();
+#endif
+#if CARRIER_DETECT
+    carrier_init(&Carrier, RxAdcChannel[0], CARRIER_LEVEL, CARRIER_WINDOW);
+#endif
 
     //                                         
     // Assumes ePWM1 clock is already enabled in InitSysCtrl();
@@ -338,6 +1190,20 @@ void main(void)
 
     init_epwm1();
     init_epwm3();
+#if CLA_PIPELINE
+    cla_pipe_init_epwm();
+#endif
+#if CARRIER_DETECT
+    //
+    // Listen for a carrier first
+    //
+    carrier_set_rate(&Carrier, RateConfig.adc_tbprd, SAMPLES_PER_BIT,
+                     CARRIER_TIMEOUT_BITS);
+    carrier_detect(&Carrier);
+#endif
+#if BENCH_ENABLE
+    run_bench();
+#endif
 
     //
     // Start the ePWM counters                   
@@ -354,26 +1220,281 @@ void main(void)
     //
     // In the meantime the main CPU can do other work
     //
-    // After the CLA has fired ADC_BUF_LEN interrupts, the main CPU  will 
-    // halt here 
+    // The ISR keeps the last ADC_BUF_LEN samples in AdcBuf and AdcFiltBuf
     //
     // You can view the results by graphing AdcBuf and AdcFiltBuf.
     // Both are unsigned int arrays. 
     //
+    // Every new filtered sample is passed to the Manchester decoder. In
+    // BER test mode the decoded bits are checked against the PRBS; watch
+    // BerChecker.bits and BerChecker.errors.
+    //
     SampleCount = 0; 
+    CommsBits = 0;
+    boot_done();
     for(;;)
     {
-        if(SampleCount == ADC_BUF_LEN-1)
+#if TELEMETRY
+        telemetry_poll(&Telemetry);
+        LoopCount++;
+        backlog = (SampleCount + ADC_BUF_LEN - ReadIndex) % ADC_BUF_LEN;
+        if(backlog > MaxBacklog)
         {
-            //inline assembly used to halt processor
-            //__asm(" ESTOP0");
-            //do something with the buffer?
+            MaxBacklog = backlog;
+        }
+#endif
+#if BER_TEST
+        //
+        // VPPM frames are shorter, the chips of a frame are limited
+        //
+        nbytes = manchester_tx_max_bytes();
+        if(nbytes > BER_FRAME_BYTES)
+        {
+            nbytes = BER_FRAME_BYTES;
+        }
+        while(TX_FREE())
+        {
+            for(i = 0; i < nbytes; i++)
+            {
+                BerFrame[i] = 0;
+                for(j = 0; j < 8; j++)
+                {
+                    BerFrame[i] |= prbs_next_bit(&BerTx) << j;
+                }
+            }
+            TX_SEND(BerFrame, nbytes);
+        }
+#endif
+
+        if(RateChangePending)
+        {
+            RateStatus = apply_rates();
+            RateChangePending = 0;
+            TRACE(TRACE_STATE, TRACE_SRC_RATE, RateStatus);
+        }
+#if BER_TEST
+        if(LineChangePending)
+        {
+            LineStatus = set_line_code(LineRequest, LineVppmWidth);
+            LineChangePending = 0;
+        }
+#endif
 
+        diversity_update();
+#if CLA_EQUALIZER
+        eq_update(&Equalizer);
+#endif
 
+#if EYE_CAPTURE
+        if(Eye.ready)
+        {
+#if TELEMETRY
+            if(log_eye())
+            {
+                eye_restart(&Eye);
+            }
+#else
+            eye_compute(&Eye);
+            eye_restart(&Eye);
+#endif
         }
+#if PAM4_MODE
+        if(Eye.windows != LinkEyeWindows)
+        {
+            LinkEyeWindows = Eye.windows;
+            if(link_mode_eye(&Link, Eye.q) == LINK_PAM4)
+            {
+                set_link_mode(LINK_PAM4);
+            }
+        }
+#endif
+#endif
+
+#if CLA_PIPELINE
+        //
+        // The CLA has decoded the bits already, take the packed words
+        //
+        while(cla_pipe_read(&ClaPipe, &word))
+        {
+            BITVEC_WORD(CommsBuffer, CommsBits & (COMMS_BUF_BITS - 1)) = word;
+            CommsBits += 16;
+#if BER_TEST
+            for(j = 0; j < 16; j++)
+            {
+                prbs_checker_push(&BerChecker, (word >> j) & 1);
+            }
+#endif
+        }
+        cla_pipe_status(&ManchesterRx);
+        cla_pipe_check(&ClaPipe);
+#endif
+
+#if TRACE_ENABLE
+        //
+        // Samples waiting for the decoder; a full buffer means the ISR is
+        // about to overwrite samples not decoded yet
+        //
+        pending = (SampleCount + ADC_BUF_LEN - ReadIndex) % ADC_BUF_LEN;
+        if(pending != 0)
+        {
+            TRACE(TRACE_FIFO, TRACE_SRC_MAIN, pending);
+            if(pending == ADC_BUF_LEN - 1)
+            {
+                TRACE(TRACE_OVERRUN, TRACE_SRC_MAIN, pending);
+                TRACE_FREEZE();
+            }
+        }
+#endif
+
+#if PAM4_MODE
+        link = Link.mode;
+#endif
+        while(ReadIndex != SampleCount)
+        {
+#if !CLA_PIPELINE
+#if PAM4_MODE
+            if(Link.mode == LINK_PAM4)
+            {
+                //
+                // Two bits per symbol, the first one in bit 1
+                //
+                bit = pam4_rx_sample(&Pam4Rx, AdcFiltBuf[ReadIndex]);
+                if(bit != PAM4_RX_NO_SYMBOL)
+                {
+                    for(j = 2; j-- != 0;)
+                    {
+                        BITVEC_PUT(CommsBuffer,
+                                   CommsBits & (COMMS_BUF_BITS - 1),
+                                   (bit >> j) & 1);
+                        CommsBits++;
+                        prbs_checker_push(&BerChecker, (bit >> j) & 1);
+                    }
+                }
+                if(link == LINK_PAM4)
+                {
+                    link = link_mode_sample(&Link, &Pam4Rx);
+                }
+            }
+            else
+#endif
+#if BER_TEST
+            if(LineCode != LINE_MANCHESTER)
+            {
+                //
+                // A byte at a time, LSB first as it was sent
+                //
+                bit = chip_rx_sample(&ChipRx, AdcFiltBuf[ReadIndex]);
+                if(bit != CHIP_RX_NO_BYTE)
+                {
+                    for(j = 0; j < 8; j++)
+                    {
+                        BITVEC_PUT(CommsBuffer,
+                                   CommsBits & (COMMS_BUF_BITS - 1),
+                                   (bit >> j) & 1);
+                        CommsBits++;
+                        prbs_checker_push(&BerChecker, (bit >> j) & 1);
+                    }
+                }
+            }
+            else
+#endif
+            {
+                bit = manchester_rx_sample(&ManchesterRx,
+                                           AdcFiltBuf[ReadIndex]);
+#if EYE_CAPTURE
+                eye_sample(&Eye, &ManchesterRx, AdcFiltBuf[ReadIndex],
+                           ManchesterRx.crossed);
+#endif
+#if CLA_EQUALIZER
+                eq_sample(&Equalizer, ManchesterRx.locked,
+                          bit != MANCHESTER_RX_NO_BIT);
+#endif
+                if(bit != MANCHESTER_RX_NO_BIT)
+                {
+                    BITVEC_PUT(CommsBuffer, CommsBits & (COMMS_BUF_BITS - 1),
+                               bit);
+                    CommsBits++;
+#if BER_TEST
+                    prbs_checker_push(&BerChecker, (Uint16)bit);
+#endif
+                }
+            }
+#endif
+#if TELEMETRY
+            log_sample(AdcBuf[ReadIndex], AdcFiltBuf[ReadIndex]);
+#endif
+#if POWER_SAVE
+            if(RX_LOCKED)
+            {
+                PowerSilence = 0;
+            }
+            else if(PowerSilence != 0xFFFF)
+            {
+                PowerSilence++;
+            }
+#endif
+#if CARRIER_DETECT
+            carrier_sample(&Carrier, RX_LOCKED);
+#endif
+            ReadIndex++;
+            if(ReadIndex == ADC_BUF_LEN)
+            {
+                ReadIndex = 0;
+            }
+        }
+#if PAM4_MODE
+        if(link != Link.mode)
+        {
+            set_link_mode(link);
+        }
+#endif
+
+#if TRACE_ENABLE
+        if(RX_LOCKED != locked)
+        {
+            locked = RX_LOCKED;
+            TRACE(TRACE_STATE, TRACE_SRC_RX, locked);
+        }
+#if TELEMETRY
+        if(!Trace.on)
+        {
+            log_trace();
+        }
+#endif
+#endif
+
+#if POWER_SAVE
+        //
+        // Sleep until light comes back if the line has been silent, else
+        // until the next sample
+        //
+        if(RX_LOCKED)
+        {
+            power_locked(&Power);
+        }
+        else if(PowerSilence >= POWER_SILENCE_BITS *
+                                RateConfig.req.samples_per_bit
+#if BER_TEST
+                && !TX_BUSY()
+#endif
+#if TELEMETRY
+                && Telemetry.head == Telemetry.tail
+#endif
+               )
+        {
+            power_gate(&Power, POWER_SLEEP_MODE, POWER_PCLKCR0_ADC,
+                       POWER_PCLKCR1_EPWM(1));
+            PowerSilence = 0;
+        }
+        if(ReadIndex == SampleCount)
+        {
+            power_idle();
+        }
+#endif
     }
 }
 
+#if CPU_FILTER_CHANNELS == 0
 //
 // cla1_isr7 - ISR for Task 7. This interrupt will be taken by the main CPU 
 // when CLA task 7 completes.
@@ -381,6 +1502,22 @@ void main(void)
 __interrupt void
 cla1_isr7()
 {
+    Uint16 pieier;
+#if TRACE_ENABLE
+    Uint16 lost;
+#endif
+
+    //
+    // ePWM1 started the conversions at CTR = 0, the latency includes
+    // the conversions and CLA Task 7
+    //
+    ISR_LATENCY(&SampleIsr, EPwm1Regs.TBCTR * 2);
+    pieier = isr_nest_enter(&SampleIsr);
+#if TRACE_ENABLE
+    TRACE_ISR_ENTER(TRACE_SRC_ADC);
+    lost = trace_adc_overrun();
+#endif
+
     // 
     // Clear the ADC interrupt flag so the next SOC can occur
     // Clear the IACK bits so another interrupt
@@ -414,7 +1551,522 @@ cla1_isr7()
     {
         SampleCount = 0;
     }
+    if(SampleCount == ReadIndex)
+    {
+        SampleOverruns++;
+    }
+
+#if TRACE_ENABLE
+    TRACE_ISR_EXIT(TRACE_SRC_ADC);
+    if(lost)
+    {
+        TRACE_FREEZE();
+    }
+#endif
+    isr_nest_exit(&SampleIsr, pieier);
 }
+#else
+//
+// adc_isr7 - ISR for ADCINT7 when the C28x filters. It runs at the same
+// time as CLA Task 7 (if any channel is left on the CLA), finishes the
+// filter in cpu_filter_run() and logs the samples like cla1_isr7.
+//
+__interrupt void
+adc_isr7(void)
+{
+    Uint16 pieier;
+#if TRACE_ENABLE
+    Uint16 lost;
+#endif
+
+    ISR_LATENCY(&SampleIsr, EPwm1Regs.TBCTR * 2);
+    pieier = isr_nest_enter(&SampleIsr);
+#if TRACE_ENABLE
+    TRACE_ISR_ENTER(TRACE_SRC_ADC);
+    lost = trace_adc_overrun();
+#endif
+
+    AdcRegs.ADCINTFLGCLR.bit.ADCINT7 = 1;
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP10;
+    GpioDataRegs.GPATOGGLE.bit.GPIO18 = 1;
+
+    cpu_filter_run();
+
+    AdcBuf[SampleCount] = AdcResult.ADCRESULT1;
+    AdcFiltBuf[SampleCount] = VoltFilt;
+    SampleCount++;
+    if(SampleCount == ADC_BUF_LEN)
+    {
+        SampleCount = 0;
+    }
+    if(SampleCount == ReadIndex)
+    {
+        SampleOverruns++;
+    }
+
+#if TRACE_ENABLE
+    TRACE_ISR_EXIT(TRACE_SRC_ADC);
+    if(lost)
+    {
+        TRACE_FREEZE();
+    }
+#endif
+    isr_nest_exit(&SampleIsr, pieier);
+}
+#endif
+
+#if TRACE_ENABLE
+//
+// trace_adc_overrun - Log a missed sample deadline, returns 1 if there
+// was one
+//
+// ADCINTOVF is set when ADCINT7 fired again before the ISR cleared the
+// flag; that conversion was never filtered or logged.
+//
+Uint16
+trace_adc_overrun(void)
+{
+    if(!AdcRegs.ADCINTOVF.bit.ADCINT7)
+    {
+        return 0;
+    }
+    AdcRegs.ADCINTOVFCLR.bit.ADCINT7 = 1;
+    TRACE(TRACE_OVERRUN, TRACE_SRC_ADC, 1);
+    return 1;
+}
+#endif
+
+//
+// apply_rates - Switch to the rates in RateRequest
+//
+// The ePWM time bases are stopped while ePWM1 (sampling) and ePWM3 
+// (transmitter) are reprogrammed, so both restart in phase at the new
+// rate. The decoder and the combiner window are then sized for the new
+// samples per bit. Bits in flight during the switch are lost, the BER
+// checker resyncs by itself. The current rates are kept if the request
+// is rejected.
+//
+// Returns the rate_compute() status.
+//
+Uint16
+apply_rates(void)
+{
+    rate_config_t cfg;
+    Uint16 status;
+
+    RateRequest.adc_socs = RX_CHANNELS * OVERSAMPLE;
+    status = rate_compute(&RateRequest, &cfg);
+    if(status != RATE_OK)
+    {
+        return status;
+    }
+
+    rate_sync_begin();
+    rate_apply_epwm(&EPwm1Regs, cfg.adc_tbprd);
+#if PAM4_MODE
+    if(Link.mode == LINK_PAM4)
+    {
+        pam4_tx_init(cfg.bit_tbprd);
+    }
+    else
+#endif
+#if BER_TEST
+    manchester_tx_set_bit_period(cfg.bit_tbprd);
+#endif
+#if CARRIER_DETECT
+    carrier_set_rate(&Carrier, cfg.adc_tbprd, cfg.req.samples_per_bit,
+                     CARRIER_TIMEOUT_BITS);
+#endif
+    rate_sync_end();
+    RateConfig = cfg;
+#if POWER_SAVE
+    Power.bit_cycles = (RATE_SYSCLK_HZ / RATE_TBCLK_HZ) *
+                       (cfg.bit_tbprd + 1UL);
+#endif
+
+    manchester_rx_init(&ManchesterRx, THRESHOLD_MANCHESTER,
+                       HYSTERESIS_MANCHESTER, cfg.req.samples_per_bit);
+#if BER_TEST
+    chip_rx_init(&ChipRx, THRESHOLD_MANCHESTER, HYSTERESIS_MANCHESTER,
+                 cfg.req.samples_per_bit, ChipRx.code.code,
+                 ChipRx.code.vppm_width);
+#endif
+#if PAM4_MODE
+    pam4_rx_init(&Pam4Rx, 0, 4095 * OVERSAMPLE, HYSTERESIS_MANCHESTER,
+                 cfg.req.samples_per_bit);
+    link_mode_set(&Link, Link.mode, cfg.req.samples_per_bit);
+    LinkEyeWindows = 0;
+#endif
+    CombWindow = (float32)(COMB_WINDOW_BITS * cfg.req.samples_per_bit);
+#if CLA_EQUALIZER
+    eq_reset(&Equalizer);
+#endif
+#if CLA_PIPELINE
+    cla_pipe_set_rate(&ClaPipe, cfg.req.samples_per_bit,
+                      (RATE_SYSCLK_HZ / RATE_TBCLK_HZ) * (cfg.adc_tbprd + 1UL));
+#endif
+#if EYE_CAPTURE
+    eye_init(&Eye, THRESHOLD_MANCHESTER, 4096 * OVERSAMPLE,
+             cfg.req.samples_per_bit);
+#if TELEMETRY
+    EyeRows = 0;
+#endif
+#endif
+
+    return RATE_OK;
+}
+
+#if PAM4_MODE
+//
+// set_link_mode - Switch the BER link to Manchester or PAM-4
+//
+// ePWM3 is handed to the transmitter of the new mode with the time bases
+// stopped, as for a rate change, and the receiver of the new mode starts
+// from scratch at the same symbol rate. Frames queued or in flight are
+// lost, the BER checker resyncs by itself.
+//
+void
+set_link_mode(Uint16 mode)
+{
+    rate_sync_begin();
+    EALLOW;
+    if(mode == LINK_PAM4)
+    {
+        pam4_tx_init(RateConfig.bit_tbprd);
+        PieVectTable.EPWM3_INT = &pam4_tx_isr;
+    }
+    else
+    {
+        manchester_tx_init(RateConfig.bit_tbprd);
+        PieVectTable.EPWM3_INT = &manchester_tx_isr;
+    }
+    EDIS;
+    rate_sync_end();
+
+    if(mode == LINK_PAM4)
+    {
+        pam4_rx_init(&Pam4Rx, 0, 4095 * OVERSAMPLE, HYSTERESIS_MANCHESTER,
+                     RateConfig.req.samples_per_bit);
+    }
+    else
+    {
+        manchester_rx_init(&ManchesterRx, THRESHOLD_MANCHESTER,
+                           HYSTERESIS_MANCHESTER,
+                           RateConfig.req.samples_per_bit);
+        eye_init(&Eye, THRESHOLD_MANCHESTER, 4096 * OVERSAMPLE,
+                 RateConfig.req.samples_per_bit);
+#if TELEMETRY
+        EyeRows = 0;
+#endif
+        LinkEyeWindows = 0;
+    }
+    link_mode_set(&Link, mode, RateConfig.req.samples_per_bit);
+#if CLA_EQUALIZER
+    eq_hold(&Equalizer, mode == LINK_PAM4);
+#endif
+    TRACE(TRACE_STATE, TRACE_SRC_LINK, mode);
+}
+#endif
+
+#if BER_TEST
+//
+// set_line_code - Switch the BER link to the line code code (LineCode.h)
+//
+// The transmitter sends the frames queued from now on in the new code
+// and its receiver, ChipRx or for Manchester ManchesterRx, starts from
+// scratch at the same bit rate. Frames queued before go out in the old
+// code and are lost, the BER checker resyncs by itself. The PAM-4 link
+// and the CLA pipeline only carry Manchester.
+//
+// Returns LINE_OK, or why the code is refused, in which case the link
+// is left as it was.
+//
+Uint16
+set_line_code(Uint16 code, Uint16 vppm_width)
+{
+    Uint16 status;
+
+#if CLA_PIPELINE
+    if(code != LINE_MANCHESTER)
+    {
+        return LINE_ERR_LINK;
+    }
+#endif
+#if PAM4_MODE
+    if(Link.mode == LINK_PAM4 && code != LINE_MANCHESTER)
+    {
+        return LINE_ERR_LINK;
+    }
+#endif
+    status = chip_rx_init(&ChipRx, THRESHOLD_MANCHESTER,
+                          HYSTERESIS_MANCHESTER,
+                          RateConfig.req.samples_per_bit, code, vppm_width);
+    if(status != LINE_OK)
+    {
+        return status;
+    }
+
+    manchester_tx_set_code(code, vppm_width);
+    if(code == LINE_MANCHESTER)
+    {
+        manchester_rx_init(&ManchesterRx, THRESHOLD_MANCHESTER,
+                           HYSTERESIS_MANCHESTER,
+                           RateConfig.req.samples_per_bit);
+    }
+    LineCode = code;
+    TRACE(TRACE_STATE, TRACE_SRC_LINE, code);
+
+    return LINE_OK;
+}
+#endif
+
+#if TELEMETRY
+//
+// log_sample - Add every TELEMETRY_DECIMATION-th sample to the sample
+// frame, send it when full
+//
+void
+log_sample(Uint16 raw, Uint16 filt)
+{
+    Uint16 *p;
+
+    if(SampleTotal % TELEMETRY_DECIMATION == 0)
+    {
+        if(TelemetryFill == 0)
+        {
+            p = telemetry_pack16(TelemetryPayload, TELEMETRY_DECIMATION);
+            telemetry_pack32(p, SampleTotal);
+        }
+        p = telemetry_pack16(&TelemetryPayload[7 + 4 * TelemetryFill], raw);
+        telemetry_pack16(p, filt);
+        TelemetryFill++;
+
+        if(TelemetryFill == TELEMETRY_SNAP_LEN)
+        {
+            TelemetryPayload[6] = TELEMETRY_SNAP_LEN;
+            telemetry_send(&Telemetry, TELEMETRY_SAMPLES, TelemetryPayload,
+                           7 + 4 * TELEMETRY_SNAP_LEN);
+            TelemetryFill = 0;
+            TelemetrySnaps++;
+            if(TelemetrySnaps == TELEMETRY_COUNTER_SNAPS)
+            {
+                log_counters();
+                TelemetrySnaps = 0;
+            }
+        }
+    }
+    SampleTotal++;
+}
+
+//
+// log_counters - Send the decoder counters and the main loop profile
+//
+void
+log_counters(void)
+{
+    Uint16 *p = TelemetryPayload;
+    Uint16 ch;
+
+    p = telemetry_pack32(p, ManchesterRx.bits);
+    p = telemetry_pack32(p, ManchesterRx.sync_losses);
+#if BER_TEST
+    p = telemetry_pack32(p, BerChecker.bits);
+    p = telemetry_pack32(p, BerChecker.errors);
+    p = telemetry_pack32(p, BerChecker.resyncs);
+    p = telemetry_pack32(p, ManchesterTx.frames_sent);
+#else
+    p = telemetry_pack32(p, 0);
+    p = telemetry_pack32(p, 0);
+    p = telemetry_pack32(p, 0);
+    p = telemetry_pack32(p, 0);
+#endif
+    *p++ = Diversity.best;
+    *p++ = RX_CHANNELS;
+    for(ch = 0; ch < RX_CHANNELS; ch++)
+    {
+        p = telemetry_packf(p, Diversity.snr[ch]);
+    }
+    telemetry_send(&Telemetry, TELEMETRY_COUNTERS, TelemetryPayload,
+                   p - TelemetryPayload);
+
+    p = TelemetryPayload;
+    p = telemetry_pack32(p, LoopCount);
+    p = telemetry_pack16(p, MaxBacklog);
+    p = telemetry_pack32(p, Telemetry.drops);
+    p = telemetry_pack32(p, Telemetry.bytes);
+    p = telemetry_pack32(p, SampleOverruns);
+    telemetry_send(&Telemetry, TELEMETRY_PROFILE, TelemetryPayload,
+                   p - TelemetryPayload);
+    MaxBacklog = 0;
+}
+
+#if EYE_CAPTURE
+//
+// log_eye - Work out the figures of a complete eye window and send them,
+// then its histogram one phase per frame
+//
+// The whole histogram does not fit in the telemetry buffer, so only the
+// rows that fit are queued per call; the capture stays paused until the
+// last one is out. Returns 1 once the window is fully sent.
+//
+Uint16
+log_eye(void)
+{
+    Uint16 *p = TelemetryPayload;
+    Uint16 ph, b;
+
+    if(EyeRows == 0)
+    {
+        eye_compute(&Eye);
+        p = telemetry_pack32(p, Eye.windows);
+        p = telemetry_packf(p, RateConfig.sample_rate);
+        *p++ = Eye.phases;
+        *p++ = Eye.best_phase;
+        p = telemetry_pack16(p, (Uint16)Eye.opening);
+        p = telemetry_packf(p, Eye.q);
+        p = telemetry_packf(p, Eye.snr_db);
+        p = telemetry_packf(p, Eye.period);
+        p = telemetry_packf(p, Eye.jitter);
+        telemetry_send(&Telemetry, TELEMETRY_EYE, TelemetryPayload,
+                       p - TelemetryPayload);
+        EyeRows = 1;
+    }
+
+    while(EyeRows <= Eye.phases &&
+          telemetry_room(&Telemetry, 6 + 2 * EYE_BINS))
+    {
+        ph = EyeRows - 1;
+        p = telemetry_pack32(TelemetryPayload, Eye.windows);
+        *p++ = ph;
+        *p++ = EYE_BINS;
+        for(b = 0; b < EYE_BINS; b++)
+        {
+            p = telemetry_pack16(p, Eye.hist[ph][b]);
+        }
+        telemetry_send(&Telemetry, TELEMETRY_EYE_ROW, TelemetryPayload,
+                       p - TelemetryPayload);
+        EyeRows++;
+    }
+
+    if(EyeRows <= Eye.phases)
+    {
+        return 0;
+    }
+    EyeRows = 0;
+    return 1;
+}
+#endif
+
+#if TRACE_ENABLE
+//
+// log_trace - Send the frozen trace, as many records per call as fit in
+// the telemetry buffer, and start recording again once all are out
+//
+void
+log_trace(void)
+{
+    trace_rec_t rec;
+    Uint16 *p;
+    Uint16 total = trace_records();
+    Uint16 n, i;
+
+    while(TraceSent < total)
+    {
+        n = total - TraceSent;
+        if(n > TRACE_FRAME_RECORDS)
+        {
+            n = TRACE_FRAME_RECORDS;
+        }
+        if(!telemetry_room(&Telemetry, 7 + 8 * n))
+        {
+            return;
+        }
+
+        p = telemetry_pack32(TelemetryPayload, Trace.count);
+        p = telemetry_pack16(p, TraceSent);
+        *p++ = n;
+        for(i = 0; i < n; i++)
+        {
+            trace_get(TraceSent + i, &rec);
+            p = telemetry_pack32(p, rec.time);
+            *p++ = rec.event >> 8;
+            *p++ = rec.event & 0xFF;
+            p = telemetry_pack16(p, rec.data);
+        }
+        telemetry_send(&Telemetry, TELEMETRY_TRACE, TelemetryPayload,
+                       p - TelemetryPayload);
+        TraceSent += n;
+    }
+
+    TraceSent = 0;
+    trace_init();
+}
+#endif
+#endif
+
+#if BENCH_ENABLE
+//
+// run_bench - Time the kernels, CLA Task 7 and the ISRs, and print the
+// table on SCI-A
+//
+// Runs at start up with the ePWM time bases stopped, so the forced ISRs
+// are the only ones. The BER transmitter is given a frame so its ISR
+// takes the path of a bit being sent, and is reset afterwards.
+//
+void
+run_bench(void)
+{
+    Uint16 n;
+
+    n = bench_suite_run(BenchResult, BENCH_CALLS);
+#if CLA_EQUALIZER
+    //
+    // Task 7 with the equalizer skipped, then running with a step of 0
+    // (the same code, the taps kept): the difference per tap is what the
+    // equalizer costs per sample and tap
+    //
+    EqMode = EQ_OFF;
+    bench_cla_task(&BenchResult[n], "cla_task7_eq_off", 7, BENCH_CALLS);
+    EqMode = EQ_TRACK;
+    bench_cla_task(&BenchResult[n + 1], "cla_task7", 7, BENCH_CALLS);
+    bench_diff(&BenchResult[n + 2], "cla_equalizer", "tap", EQ_TAPS,
+               &BenchResult[n + 1], &BenchResult[n]);
+    n += 3;
+#elif CLA_FILTER_CHANNELS > 0
+    bench_cla_task(&BenchResult[n++], "cla_task7", 7, BENCH_CALLS);
+#endif
+#if CPU_FILTER_CHANNELS == 0
+    bench_isr(&BenchResult[n++], "cla1_isr7", &SampleIsr, BENCH_CALLS);
+#else
+    bench_isr(&BenchResult[n++], "adc_isr7", &SampleIsr, BENCH_CALLS);
+#endif
+#if BER_TEST
+    manchester_tx_send(BerFrame, BER_FRAME_BYTES);
+    bench_isr(&BenchResult[n++], "manchester_tx_isr", &ManchesterTx.isr,
+              BENCH_CALLS);
+#if PAM4_MODE
+    pam4_tx_init(RateConfig.bit_tbprd);
+    EALLOW;
+    PieVectTable.EPWM3_INT = &pam4_tx_isr;
+    EDIS;
+    pam4_tx_send(BerFrame, BER_FRAME_BYTES);
+    bench_isr(&BenchResult[n++], "pam4_tx_isr", &Pam4Tx.isr, BENCH_CALLS);
+    EALLOW;
+    PieVectTable.EPWM3_INT = &manchester_tx_isr;
+    EDIS;
+#endif
+    manchester_tx_init(RateConfig.bit_tbprd);
+#endif
+    BenchCount = n;
+
+    SampleCount = 0;
+    isr_nest_clear();
+    TRACE_INIT();
+#if TELEMETRY
+    bench_write_sci(&SciaRegs, BenchResult, BenchCount, BENCH_FORMAT);
+#endif
+}
+#endif
 
 //
 // init_adc - EPWM1 will be used to generate the ADC Start of conversion
@@ -422,6 +2074,10 @@ cla1_isr7()
 void
 init_adc(void)
 {
+    volatile union ADCSOCxCTL_REG *soc = &AdcRegs.ADCSOC1CTL;
+    Uint16 ch;
+    Uint16 k;
+
     //
     // Assumes ADC clock is already enabled in InitSysCtrl();
     //
@@ -441,7 +2097,8 @@ init_adc(void)
     // ADC interrupt will trigger early - before the ADC conversion starts
     // Enable ADCINT7
     // Disable ADC 7 continuous mode
-    // Set the SOC1 channel select to ADCINTA2.  
+    // Set the SOC1 .. SOC<RX_CHANNELS> channel selects to the receiver
+    // inputs in RxAdcChannel.
     // This interrupt triggers task 7
     // which is where the CLA FIR filter is located
     //
@@ -449,24 +2106,42 @@ init_adc(void)
 
     //
     // ADC interrupt comes early (end of sample window)
-    // SOC1 will trigger ADCINT7
+    // The last receiver SOC will trigger ADCINT7
     // Enable ADCINT7
     // Disable ADCINT7 Continuous mode
     //
     AdcRegs.ADCCTL2.bit.ADCNONOVERLAP = 1;  // Enable non-overlap mode
+#if CPU_FILTER_CHANNELS == 0
     AdcRegs.ADCCTL1.bit.INTPULSEPOS = 0;
-    AdcRegs.INTSEL7N8.bit.INT7SEL   = 1;
+#else
+    //
+    // The CPU ISR may read the last result sooner than the CLA would, so
+    // interrupt when it is latched instead
+    //
+    AdcRegs.ADCCTL1.bit.INTPULSEPOS = 1;
+#endif
+    AdcRegs.INTSEL7N8.bit.INT7SEL   = RX_CHANNELS * OVERSAMPLE;
     AdcRegs.INTSEL7N8.bit.INT7E     = 1;
     AdcRegs.INTSEL7N8.bit.INT7CONT  = 0;
 
     //
-    // set SOC1 channel select to ADCINA2
-    // set SOC1 start trigger on EPWM1A interrupt
-    // set SOC1 S/H Window to 7 ADC Clock Cycles, (6 ACQPS plus 1)
+    // For each receiver channel:
+    // set SOCn channel select to its ADC input
+    // set SOCn start trigger on EPWM1A interrupt
+    // set SOCn S/H Window to 7 ADC Clock Cycles, (6 ACQPS plus 1)
+    // All SOCs share the trigger and are converted round-robin from SOC1,
+    // OVERSAMPLE consecutive SOCs per channel. The shortest S/H window 
+    // keeps the burst short; its extra noise is averaged out by the CLA.
     //
-    AdcRegs.ADCSOC1CTL.bit.CHSEL    = 2;   
-    AdcRegs.ADCSOC1CTL.bit.TRIGSEL  = 5;     
-    AdcRegs.ADCSOC1CTL.bit.ACQPS    = 6;
+    for(ch = 0; ch < RX_CHANNELS; ch++)
+    {
+        for(k = 0; k < OVERSAMPLE; k++)
+        {
+            soc[ch * OVERSAMPLE + k].bit.CHSEL   = RxAdcChannel[ch];
+            soc[ch * OVERSAMPLE + k].bit.TRIGSEL = 5;
+            soc[ch * OVERSAMPLE + k].bit.ACQPS   = 6;
+        }
+    }
     EDIS;
 }          
 
@@ -487,11 +2162,11 @@ init_epwm1(void)
     EALLOW;
 
     //
-    // Set the period for ePWM1  
+    // Set the period for ePWM1 to one sample period
     // By default TBPRD = 1/2 SYSCLKOUT 
     // Set the counter for up count mode
     //
-    EPwm1Regs.TBPRD             = ADC_SAMPLE_PERIOD;
+    EPwm1Regs.TBPRD             = RateConfig.adc_tbprd;
     EPwm1Regs.TBCTL.bit.CTRMODE = TB_COUNT_UP;
     EPwm1Regs.ETSEL.bit.SOCAEN  = 1;
     EPwm1Regs.ETSEL.bit.SOCASEL = ET_CTR_ZERO;
@@ -521,8 +2196,20 @@ init_epwm3(void)
     //
     EALLOW;
     GpioCtrlRegs.GPAMUX1.bit.GPIO4 = 1;
+#if PAM4_MODE
+    //
+    // GPIO5 is EPWM3B, the low bit of the PAM-4 DAC
+    //
+    GpioCtrlRegs.GPAMUX1.bit.GPIO5 = 1;
+#endif
     EDIS;
 
+#if BER_TEST
+    //
+    // BER test mode: ePWM3 is the Manchester transmitter
+    //
+    manchester_tx_init(RateConfig.bit_tbprd);
+#else
     //
     // Disable the timer (counter mode is halt)
     // Set the free/soft emulation bits to ignore the
@@ -550,6 +2237,7 @@ init_epwm3(void)
     EPwm3Regs.AQCTLA.bit.CAU = AQ_SET;
     EPwm3Regs.AQCTLA.bit.CAD = AQ_CLEAR;
     EPwm3Regs.TBCTL.bit.CTRMODE = TB_COUNT_UPDOWN;
+#endif
 } 
 
 //
@@ -595,6 +2283,19 @@ init_cla()
     //
     Cla1Regs.MPISRCSEL1.bit.PERINT7SEL = CLA_INT7_ADCINT7; 
 
+#if CLA_PIPELINE
+    //
+    // The pipeline stages, Task 4 to 6, are started by ePWM4 to 6
+    // interrupts that the CLA forces itself
+    //
+    Cla1Regs.MVECT4 = (Uint16) (&Cla1Task4 - &Cla1Prog_Start)*sizeof(Uint32);
+    Cla1Regs.MVECT5 = (Uint16) (&Cla1Task5 - &Cla1Prog_Start)*sizeof(Uint32);
+    Cla1Regs.MVECT6 = (Uint16) (&Cla1Task6 - &Cla1Prog_Start)*sizeof(Uint32);
+    Cla1Regs.MPISRCSEL1.bit.PERINT4SEL = CLA_INT4_EPWM4INT;
+    Cla1Regs.MPISRCSEL1.bit.PERINT5SEL = CLA_INT5_EPWM5INT;
+    Cla1Regs.MPISRCSEL1.bit.PERINT6SEL = CLA_INT6_EPWM6INT;
+#endif
+
     // 
     // Copy the CLA program code from its load address to the CLA program 
     // memory. Once done, assign the program memory to the CLA
@@ -607,10 +2308,14 @@ init_cla()
 
     //
     // Enable the IACK instruction to start a task
-    // Enable the CLA interrupt 8 and interrupt 7
+    // Enable the CLA interrupt 8 and interrupt 7 (and the pipeline stages)
     //
     Cla1Regs.MCTL.bit.IACKE = 1;            
+#if CLA_PIPELINE
+    Cla1Regs.MIER.all = (M_INT8 | M_INT7 | M_INT6 | M_INT5 | M_INT4);
+#else
     Cla1Regs.MIER.all = (M_INT8 | M_INT7);
+#endif
 
     //
     // Force CLA task 8 using the IACK instruction
@@ -623,7 +2328,29 @@ init_cla()
     Cla1ForceTask8(); 
 }
 
-
+#if POWER_SAVE
+//
+// init_comp1 - COMP1 compares ADCINA2 (the first receiver channel) with
+// the slicer threshold and drives COMP1OUT on the wake pin
+//
+// The output is not synchronized to SYSCLKOUT, so the pin follows the
+// light in STANDBY too. The DAC is 10 bits over the same 3.3 V as the
+// 12 bit ADC.
+//
+void
+init_comp1(void)
+{
+    EALLOW;
+    SysCtrlRegs.PCLKCR3.bit.COMP1ENCLK = 1;
+    Comp1Regs.COMPCTL.bit.COMPDACEN  = 1;
+    Comp1Regs.COMPCTL.bit.COMPSOURCE = 0;   // internal DAC
+    Comp1Regs.COMPCTL.bit.SYNCSEL    = 0;   // asynchronous output
+    Comp1Regs.COMPCTL.bit.QUALSEL    = 0;
+    Comp1Regs.DACVAL.bit.DACVAL      = THRESHOLD_MANCHESTER / OVERSAMPLE / 4;
+    GpioCtrlRegs.GPAMUX1.bit.GPIO1   = 3;   // COMP1OUT
+    EDIS;
+}
+#endif
 
 //
 // End of File
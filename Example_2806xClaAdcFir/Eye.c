@@ -0,0 +1,223 @@
+//###########################################################################
+//
+// FILE:   Eye.c
+//
+// TITLE:  Eye diagram and signal quality capture on the recovered clock
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Eye.h"
+#include <math.h>
+
+//
+// eye_sample() is on the per sample path, keep it in RAM (Boot.h)
+//
+#pragma CODE_SECTION(eye_sample, "ramfuncs");
+
+//
+// Defines
+//
+// EYE_MIN_RAIL is the fewest samples on a rail for its statistics to
+// count; EYE_MIN_SIGMA keeps the SNR finite on a noiseless signal
+//
+#define EYE_MIN_RAIL        8
+#define EYE_MIN_SIGMA       1.0f
+
+//
+// eye_init - Set up the capture for the current rates and start it
+//
+// full_scale is the largest filter output + 1 (4096 * OVERSAMPLE).
+// Call again after the samples per bit change.
+//
+void
+eye_init(eye_t *eye, Uint16 threshold, Uint16 full_scale,
+         Uint16 samples_per_bit)
+{
+    eye->threshold = threshold;
+    eye->phases = samples_per_bit < EYE_MAX_PHASES ?
+                  samples_per_bit : EYE_MAX_PHASES;
+    eye->shift = 0;
+    while(((Uint32)full_scale - 1) >> eye->shift >= EYE_BINS)
+    {
+        eye->shift++;
+    }
+    eye->windows    = 0;
+    eye->best_phase = 0;
+    eye->opening    = 0;
+    eye->q          = 0.0f;
+    eye->snr_db     = 0.0f;
+    eye->period     = 0.0f;
+    eye->jitter     = 0.0f;
+    eye_restart(eye);
+}
+
+//
+// eye_restart - Clear the window and fold the next one
+//
+void
+eye_restart(eye_t *eye)
+{
+    Uint16 p, b;
+
+    for(p = 0; p < EYE_MAX_PHASES; p++)
+    {
+        for(b = 0; b < EYE_BINS; b++)
+        {
+            eye->hist[p][b] = 0;
+        }
+        eye->sum_hi[p] = 0.0f;
+        eye->sq_hi[p]  = 0.0f;
+        eye->sum_lo[p] = 0.0f;
+        eye->sq_lo[p]  = 0.0f;
+        eye->n_hi[p]   = 0;
+        eye->n_lo[p]   = 0;
+    }
+    eye->per_sum   = 0.0f;
+    eye->per_sq    = 0.0f;
+    eye->per_n     = 0;
+    eye->have_edge = 0;
+    eye->count     = 0;
+    eye->ready     = 0;
+    eye->enabled   = 1;
+}
+
+//
+// eye_sample - Fold one sample, call right after manchester_rx_sample()
+// with the same sample and manchester_rx_t.crossed, 1 if the decoder
+// took it as a mid-bit edge (the bit of that edge comes out later)
+//
+// Nothing is folded while the decoder is unlocked or once the window is
+// full, so the cost outside a capture window is a couple of tests.
+//
+void
+eye_sample(eye_t *eye, const manchester_rx_t *rx, Uint16 sample, Uint16 edge)
+{
+    Uint16 p;
+    Uint16 b;
+    Uint16 prev = eye->prev;
+    float32 d;
+    float32 frac;
+
+    eye->prev = sample;
+    if(!eye->enabled)
+    {
+        return;
+    }
+    if(!rx->locked)
+    {
+        eye->have_edge = 0;
+        return;
+    }
+
+    eye->since_edge++;
+    if(edge)
+    {
+        //
+        // Threshold crossing between the previous and this sample, as a
+        // fraction of a sample before this one
+        //
+        frac = 0.0f;
+        if(sample != prev)
+        {
+            frac = ((float32)sample - (float32)eye->threshold) /
+                   ((float32)sample - (float32)prev);
+            frac = frac < 0.0f ? 0.0f : (frac > 1.0f ? 1.0f : frac);
+        }
+        if(eye->have_edge)
+        {
+            d = (float32)eye->since_edge - frac + eye->edge_frac;
+            eye->per_sum += d;
+            eye->per_sq  += d * d;
+            eye->per_n++;
+        }
+        eye->edge_frac  = frac;
+        eye->since_edge = 0;
+        eye->have_edge  = 1;
+    }
+
+    p = rx->count;
+    if(p >= eye->phases)
+    {
+        return;
+    }
+    b = sample >> eye->shift;
+    eye->hist[p][b < EYE_BINS ? b : EYE_BINS - 1]++;
+    if(sample >= eye->threshold)
+    {
+        eye->sum_hi[p] += (float32)sample;
+        eye->sq_hi[p]  += (float32)sample * (float32)sample;
+        eye->n_hi[p]++;
+    }
+    else
+    {
+        eye->sum_lo[p] += (float32)sample;
+        eye->sq_lo[p]  += (float32)sample * (float32)sample;
+        eye->n_lo[p]++;
+    }
+
+    eye->count++;
+    if(eye->count == EYE_WINDOW)
+    {
+        eye->enabled = 0;
+        eye->ready   = 1;
+    }
+}
+
+//
+// eye_compute - Work out the eye figures of a complete window
+//
+// For each phase with enough samples on both rails:
+//      opening = (mu1 - 3 sigma1) - (mu0 + 3 sigma0)
+// The best phase is the widest opening, Q and SNR are taken there:
+//      Q   = (mu1 - mu0) / (sigma1 + sigma0)
+//      SNR = ((mu1 - mu0) / 2)^2 / ((sigma1^2 + sigma0^2) / 2)
+// The histogram is left in place for export; call eye_restart() after.
+//
+void
+eye_compute(eye_t *eye)
+{
+    Uint16 p;
+    float32 mu1, mu0, s1, s0, open;
+    float32 best = -65536.0f;
+    float32 m;
+
+    for(p = 0; p < eye->phases; p++)
+    {
+        if(eye->n_hi[p] < EYE_MIN_RAIL || eye->n_lo[p] < EYE_MIN_RAIL)
+        {
+            continue;
+        }
+        mu1 = eye->sum_hi[p] / eye->n_hi[p];
+        mu0 = eye->sum_lo[p] / eye->n_lo[p];
+        s1  = eye->sq_hi[p] / eye->n_hi[p] - mu1 * mu1;
+        s0  = eye->sq_lo[p] / eye->n_lo[p] - mu0 * mu0;
+        s1  = s1 > EYE_MIN_SIGMA * EYE_MIN_SIGMA ? sqrtf(s1) : EYE_MIN_SIGMA;
+        s0  = s0 > EYE_MIN_SIGMA * EYE_MIN_SIGMA ? sqrtf(s0) : EYE_MIN_SIGMA;
+        open = (mu1 - 3.0f * s1) - (mu0 + 3.0f * s0);
+        if(open > best)
+        {
+            best = open;
+            eye->best_phase = p;
+            eye->opening = (int16)open;
+            eye->q = (mu1 - mu0) / (s1 + s0);
+            eye->snr_db = 10.0f * log10f(0.5f * (mu1 - mu0) * (mu1 - mu0) /
+                                         (s1 * s1 + s0 * s0));
+        }
+    }
+
+    if(eye->per_n != 0)
+    {
+        m = eye->per_sum / eye->per_n;
+        eye->period = m;
+        m = eye->per_sq / eye->per_n - m * m;
+        eye->jitter = m > 0.0f ? sqrtf(m) : 0.0f;
+    }
+    eye->windows++;
+}
+
+//
+// End of File
+//
@@ -0,0 +1,100 @@
+//###########################################################################
+//
+// FILE:   Eye.h
+//
+// TITLE:  Eye diagram and signal quality capture on the recovered clock
+//
+//###########################################################################
+
+#ifndef EYE_H
+#define EYE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+#include "ManchesterRx.h"
+
+//
+// Defines
+//
+// The eye is folded on the phase recovered by ManchesterRx: phase 0 is
+// the sample of the recovered mid-bit edge, so phase p is p samples
+// after it. EYE_MAX_PHASES limits the samples per bit that can
+// be folded; EYE_BINS is the number of amplitude bins over the full
+// ADC scale.
+//
+// EYE_WINDOW is the number of samples folded before the statistics are
+// ready. It must stay below 65536 so the histogram counts can not wrap.
+//
+#define EYE_MAX_PHASES      16
+#define EYE_BINS            32
+#define EYE_WINDOW          16384
+
+//
+// Typedefs
+//
+// Per phase the samples above and below the slicer threshold are kept
+// apart (the "1" and "0" rails); their means and variances give the eye
+// opening and SNR. Mid-bit edge times are interpolated between the two
+// samples around the threshold crossing for the jitter estimate.
+//
+typedef struct {
+    Uint16 threshold;
+    Uint16 phases;              // phases folded, samples per bit
+    Uint16 shift;               // sample >> shift is the amplitude bin
+    Uint16 enabled;
+    Uint16 ready;               // window complete, call eye_compute()
+    Uint16 count;               // samples folded in this window
+
+    Uint16 hist[EYE_MAX_PHASES][EYE_BINS];
+    float32 sum_hi[EYE_MAX_PHASES];
+    float32 sq_hi[EYE_MAX_PHASES];
+    float32 sum_lo[EYE_MAX_PHASES];
+    float32 sq_lo[EYE_MAX_PHASES];
+    Uint16 n_hi[EYE_MAX_PHASES];
+    Uint16 n_lo[EYE_MAX_PHASES];
+
+    Uint16 prev;                // previous sample
+    Uint16 since_edge;          // samples since the last mid-bit edge
+    Uint16 have_edge;
+    float32 edge_frac;          // last edge, fraction of a sample early
+    float32 per_sum;
+    float32 per_sq;
+    Uint16 per_n;
+
+    //
+    // Results of the last window
+    //
+    Uint16 best_phase;          // phase with the widest opening
+    int16 opening;              // 3 sigma vertical opening, ADC codes
+    float32 q;                  // (mu1 - mu0) / (sigma1 + sigma0)
+    float32 snr_db;
+    float32 period;             // mean mid-bit edge spacing, samples
+    float32 jitter;             // rms edge spacing deviation, samples
+    Uint32 windows;
+} eye_t;
+
+//
+// Function Prototypes
+//
+void eye_init(eye_t *eye, Uint16 threshold, Uint16 full_scale,
+              Uint16 samples_per_bit);
+void eye_sample(eye_t *eye, const manchester_rx_t *rx, Uint16 sample,
+                Uint16 edge);
+void eye_compute(eye_t *eye);
+void eye_restart(eye_t *eye);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of EYE_H definition
+
+//
+// End of File
+//
@@ -0,0 +1,115 @@
+/*
+//###########################################################################
+//
+// FILE:    F28069_CLA_FLASH_lnk.cmd
+//
+// TITLE:   Linker Command File For the CLA ADC FIR example, flash build
+//
+//###########################################################################
+//
+// Used by the Flash build configuration instead of 28069_RAM_CLA_lnk.cmd.
+// Everything loads to flash so the board boots stand alone (boot to
+// flash, GPIO34/37 boot pins):
+//
+//      ramfuncs    loads to FLASHD, copied to RAML0 by boot_start()
+//      Cla1Prog    loads to FLASHD, copied to RAML3 by init_cla() and
+//                  then handed to the CLA
+//
+// The message RAMs and the CLA program RAM are at the same addresses as
+// in the RAM build. F2806x_Headers_nonBIOS.cmd places the peripheral
+// register frames as before.
+//
+//###########################################################################
+*/
+
+MEMORY
+{
+PAGE 0 :    /* Program Memory */
+   RAML0       : origin = 0x008000, length = 0x000800     /* ramfuncs */
+   RAML3       : origin = 0x009000, length = 0x001000     /* CLA program RAM */
+   OTP         : origin = 0x3D7800, length = 0x000400
+   FLASHH      : origin = 0x3D8000, length = 0x004000
+   FLASHG      : origin = 0x3DC000, length = 0x004000
+   FLASHF      : origin = 0x3E0000, length = 0x004000
+   FLASHE      : origin = 0x3E4000, length = 0x004000
+   FLASHD      : origin = 0x3E8000, length = 0x004000
+   FLASHC      : origin = 0x3EC000, length = 0x004000
+   FLASHA_B    : origin = 0x3F0000, length = 0x007F80
+   CSM_RSVD    : origin = 0x3F7F80, length = 0x000076     /* Program with all 0x0000 when CSM is in use */
+   BEGIN       : origin = 0x3F7FF6, length = 0x000002     /* Boot to flash entry */
+   CSM_PWL_P0  : origin = 0x3F7FF8, length = 0x000008     /* CSM password locations */
+
+   FPUTABLES   : origin = 0x3FD860, length = 0x0006A0     /* FPU tables in Boot ROM */
+   IQTABLES    : origin = 0x3FDF00, length = 0x000B50     /* IQ math tables in Boot ROM */
+   IQTABLES2   : origin = 0x3FEA50, length = 0x00008C
+   IQTABLES3   : origin = 0x3FEADC, length = 0x0000AA
+
+   ROM         : origin = 0x3FF3B0, length = 0x000C10     /* Boot ROM */
+   RESET       : origin = 0x3FFFC0, length = 0x000002     /* part of boot ROM */
+   VECTORS     : origin = 0x3FFFC2, length = 0x00003E     /* part of boot ROM */
+
+PAGE 1 :    /* Data Memory */
+   BOOT_RSVD   : origin = 0x000000, length = 0x000050     /* Part of M0, BOOT rom will use this for stack */
+   RAMM0       : origin = 0x000050, length = 0x0003B0
+   RAMM1       : origin = 0x000400, length = 0x000400
+   CLA1_MSGRAMLOW  : origin = 0x001480, length = 0x000080
+   CLA1_MSGRAMHIGH : origin = 0x001500, length = 0x000080
+   RAML4       : origin = 0x00A000, length = 0x002000
+   RAML5       : origin = 0x00C000, length = 0x002000
+}
+
+SECTIONS
+{
+   /* Allocate program areas: */
+   .cinit           : > FLASHA_B,   PAGE = 0
+   .pinit           : > FLASHA_B,   PAGE = 0
+   .text            : > FLASHA_B,   PAGE = 0
+   codestart        : > BEGIN,      PAGE = 0
+   ramfuncs         : LOAD = FLASHD,
+                      RUN = RAML0,
+                      LOAD_START(_RamfuncsLoadStart),
+                      LOAD_END(_RamfuncsLoadEnd),
+                      RUN_START(_RamfuncsRunStart),
+                      LOAD_SIZE(_RamfuncsLoadSize),
+                      PAGE = 0
+   csmpasswds       : > CSM_PWL_P0, PAGE = 0
+   csm_rsvd         : > CSM_RSVD,   PAGE = 0
+
+   /* Allocate uninitalized data sections: */
+   .stack           : > RAMM1,      PAGE = 1
+   .ebss            : > RAML4,      PAGE = 1
+   .esysmem         : > RAML5,      PAGE = 1
+   .cio             : > RAML5,      PAGE = 1
+
+   /* Initalized sections go in Flash */
+   .econst          : > FLASHA_B,   PAGE = 0
+   .switch          : > FLASHA_B,   PAGE = 0
+
+   IQmath           : > FLASHA_B,   PAGE = 0
+   IQmathTables     : > IQTABLES,   PAGE = 0, TYPE = NOLOAD
+   FPUmathTables    : > FPUTABLES,  PAGE = 0, TYPE = NOLOAD
+
+   /* CLA program, loaded to flash, run from the CLA program RAM */
+   Cla1Prog         : LOAD = FLASHD,
+                      RUN = RAML3,
+                      LOAD_START(_Cla1funcsLoadStart),
+                      LOAD_END(_Cla1funcsLoadEnd),
+                      RUN_START(_Cla1funcsRunStart),
+                      LOAD_SIZE(_Cla1funcsLoadSize),
+                      PAGE = 0
+
+   Cla1ToCpuMsgRAM  : > CLA1_MSGRAMLOW,   PAGE = 1
+   CpuToCla1MsgRAM  : > CLA1_MSGRAMHIGH,  PAGE = 1
+
+   /* .reset is a standard section used by the compiler. It contains the */
+   /* the address of the start of _c_int00 for C Code. When using the    */
+   /* boot ROM this section and the CPU vector table is not needed.      */
+   .reset           : > RESET,      PAGE = 0, TYPE = DSECT
+   vectors          : > VECTORS,    PAGE = 0, TYPE = DSECT
+}
+
+/*
+//===========================================================================
+// End of file.
+//===========================================================================
+*/
@@ -0,0 +1,136 @@
+//###########################################################################
+//
+// FILE:   LinkMode.c
+//
+// TITLE:  Manchester / PAM-4 link mode selection
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "LinkMode.h"
+
+//
+// Called for every sample in PAM-4, runs from RAM in flash builds
+// (Boot.h)
+//
+#pragma CODE_SECTION(link_mode_sample, "ramfuncs");
+
+//
+// link_mode_init - Start in Manchester, ready to try PAM-4 on the first
+// good eye window
+//
+void
+link_mode_init(link_mode_t *lm, Uint16 min_margin, float32 min_q)
+{
+    lm->mode               = LINK_MANCHESTER;
+    lm->min_margin         = min_margin;
+    lm->min_q              = min_q;
+    lm->samples_per_symbol = 1;
+    lm->count              = 0;
+    lm->period             = 0;
+    lm->settling           = 0;
+    lm->symbols            = 0;
+    lm->checks             = 0;
+    lm->backoff            = 1;
+    lm->wait               = 0;
+    lm->upgrades           = 0;
+    lm->fallbacks          = 0;
+}
+
+//
+// link_mode_set - Note the mode the link has been switched to
+//
+// Call after every switch and rate change, with the receivers restarted.
+// A switch to PAM-4 starts the settling time again.
+//
+void
+link_mode_set(link_mode_t *lm, Uint16 mode, Uint16 samples_per_symbol)
+{
+    if(mode == LINK_PAM4 && lm->mode != LINK_PAM4)
+    {
+        lm->upgrades++;
+    }
+    lm->mode               = mode;
+    lm->samples_per_symbol = samples_per_symbol;
+    lm->count              = 0;
+    lm->period             = (Uint32)LINK_SETTLE_SYMBOLS * samples_per_symbol;
+    lm->settling           = 1;
+    lm->symbols            = 0;
+}
+
+//
+// link_mode_sample - Count a PAM-4 sample, check the decoder once per
+// check window
+//
+// Returns the mode the link should be in.
+//
+Uint16
+link_mode_sample(link_mode_t *lm, const pam4_rx_t *rx)
+{
+    Uint16 ok;
+
+    if(lm->mode != LINK_PAM4 || ++lm->count < lm->period)
+    {
+        return lm->mode;
+    }
+    lm->count = 0;
+
+    if(lm->settling)
+    {
+        lm->settling = 0;
+        lm->period   = (Uint32)LINK_CHECK_SYMBOLS * lm->samples_per_symbol;
+        lm->symbols  = rx->symbols;
+        return LINK_PAM4;
+    }
+
+    ok = rx->locked &&
+         rx->symbols - lm->symbols >= LINK_CHECK_SYMBOLS / 2 &&
+         pam4_rx_margin(rx) >= lm->min_margin;
+    lm->symbols = rx->symbols;
+
+    if(ok)
+    {
+        if(lm->checks < LINK_STABLE_CHECKS && ++lm->checks ==
+                                              LINK_STABLE_CHECKS)
+        {
+            lm->backoff = 1;
+        }
+        return LINK_PAM4;
+    }
+
+    lm->fallbacks++;
+    lm->checks = 0;
+    lm->wait   = lm->backoff;
+    if(lm->backoff < LINK_BACKOFF_MAX)
+    {
+        lm->backoff <<= 1;
+    }
+    return LINK_MANCHESTER;
+}
+
+//
+// link_mode_eye - Weigh a Manchester eye window
+//
+// Returns the mode the link should be in.
+//
+Uint16
+link_mode_eye(link_mode_t *lm, float32 q)
+{
+    if(lm->mode != LINK_MANCHESTER)
+    {
+        return lm->mode;
+    }
+    if(lm->wait != 0)
+    {
+        lm->wait--;
+        return LINK_MANCHESTER;
+    }
+
+    return q >= lm->min_q ? LINK_PAM4 : LINK_MANCHESTER;
+}
+
+//
+// End of File
+//
@@ -0,0 +1,85 @@
+//###########################################################################
+//
+// FILE:   LinkMode.h
+//
+// TITLE:  Manchester / PAM-4 link mode selection
+//
+//###########################################################################
+
+#ifndef LINK_MODE_H
+#define LINK_MODE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+#include "Pam4Rx.h"
+
+//
+// Defines
+//
+// The link starts in Manchester. Each eye window of the Manchester
+// receiver (Eye.h) is passed to link_mode_eye(); once the wait is over,
+// a window with an eye Q of min_q or more asks for PAM-4. With the same
+// swing the PAM-4 eyes are a third of the Manchester one, and their
+// slicer sees the noise of a whole symbol sum rather than of a sample,
+// so min_q is set well above the 3 or so a PAM-4 eye needs.
+//
+// In PAM-4 link_mode_sample() is called for every sample. After
+// LINK_SETTLE_SYMBOLS symbols, which covers the lock and the level
+// training, it checks every LINK_CHECK_SYMBOLS symbols that the decoder
+// is locked, put out at least half the symbols and has a margin
+// (pam4_rx_margin()) of min_margin or more. A failed check asks for
+// Manchester and doubles the number of eye windows to wait before the
+// next try, up to LINK_BACKOFF_MAX; LINK_STABLE_CHECKS passed checks in a
+// row bring it back to one.
+//
+#define LINK_MANCHESTER         0
+#define LINK_PAM4               1
+
+#define LINK_SETTLE_SYMBOLS     (2 * PAM4_RX_TRAIN_SYMBOLS)
+#define LINK_CHECK_SYMBOLS      256
+#define LINK_BACKOFF_MAX        64
+#define LINK_STABLE_CHECKS      16
+
+//
+// Typedefs
+//
+typedef struct {
+    Uint16 mode;                // LINK_xxx in use
+    Uint16 min_margin;          // pam4_rx_margin() to stay in PAM-4, Q4
+    float32 min_q;              // Manchester eye Q to try PAM-4
+    Uint16 samples_per_symbol;
+    Uint32 count;               // samples since the last check
+    Uint32 period;              // samples between checks
+    Uint16 settling;            // lock and training, no check yet
+    Uint32 symbols;             // pam4_rx_t.symbols at the last check
+    Uint16 checks;              // checks passed in a row
+    Uint16 backoff;             // eye windows to wait after a fallback
+    Uint16 wait;                // eye windows still to wait
+    Uint32 upgrades;            // switches to PAM-4
+    Uint32 fallbacks;           // switches back to Manchester
+} link_mode_t;
+
+//
+// Function Prototypes
+//
+void link_mode_init(link_mode_t *lm, Uint16 min_margin, float32 min_q);
+void link_mode_set(link_mode_t *lm, Uint16 mode,
+                   Uint16 samples_per_symbol);
+Uint16 link_mode_sample(link_mode_t *lm, const pam4_rx_t *rx);
+Uint16 link_mode_eye(link_mode_t *lm, float32 q);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of LINK_MODE_H definition
+
+//
+// End of File
+//
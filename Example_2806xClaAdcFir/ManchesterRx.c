@@ -0,0 +1,176 @@
+//###########################################################################
+//
+// FILE:   ManchesterRx.c
+//
+// TITLE:  Sample domain slicer and Manchester bit decoder
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "ManchesterRx.h"
+
+//
+// Called for every sample, runs from RAM in flash builds (Boot.h)
+//
+#pragma CODE_SECTION(manchester_rx_sample, "ramfuncs");
+
+//
+// manchester_rx_init - Set up the slicer and the clock recovery windows
+// for a stream with samples_per_bit samples per Manchester bit
+//
+void
+manchester_rx_init(manchester_rx_t *rx, Uint16 threshold, Uint16 hysteresis,
+                   Uint16 samples_per_bit)
+{
+    Uint16 i;
+
+    rx->threshold       = threshold;
+    rx->hysteresis      = hysteresis;
+    rx->edge_window     = (samples_per_bit * 3) / 4;
+    rx->lost_window     = (samples_per_bit * 5) / 4;
+    rx->samples_per_bit = samples_per_bit;
+    rx->level           = 0;
+    rx->count           = 0;
+    rx->locked          = 0;
+    rx->crossed         = 0;
+    rx->phase           = 0;
+    rx->half            = samples_per_bit / 2 < MANCHESTER_RX_MAX_HALF ?
+                          samples_per_bit / 2 : MANCHESTER_RX_MAX_HALF;
+    rx->head            = 0;
+    rx->pending         = 0;
+    rx->edge            = 0;
+    rx->late            = 0;
+    rx->early           = 0;
+    rx->bits            = 0;
+    rx->sync_losses     = 0;
+    for(i = 0; i < 2 * MANCHESTER_RX_MAX_HALF; i++)
+    {
+        rx->hist[i] = 0;
+    }
+}
+
+//
+// manchester_rx_sample - Slice one filtered sample and run clock recovery
+//
+// Every Manchester bit has an edge at mid-bit; an extra edge at the bit
+// boundary only appears between two equal bits. Mid-bit edges are therefore
+// always about one bit apart while boundary edges arrive after half a bit.
+//
+// Unlocked: the first edge that follows the previous edge by at least 3/4
+// of a bit can only be a mid-bit edge, which gives the bit phase.
+// Locked:   edges inside 3/4 of a bit from the last mid-bit edge are
+// boundary edges and are ignored. The next edge is the following mid-bit
+// edge; it moves the recovered edge a bit on from the last one, plus a
+// part of its error (MANCHESTER_RX_GAIN_SHIFT), so the clock follows
+// transmitter drift but not every noisy crossing. No edge within 5/4 of
+// a bit means the lock is lost.
+//
+// Half a bit after each recovered edge the bit is the larger of the two
+// half bit sums about it (ManchesterRx.h), a tie goes to the direction
+// of the edge.
+//
+// Returns the decoded bit (0 or 1) or MANCHESTER_RX_NO_BIT.
+//
+int16
+manchester_rx_sample(manchester_rx_t *rx, Uint16 sample)
+{
+    Uint16 level = rx->level;
+    Uint16 mid;
+    int16 bit = MANCHESTER_RX_NO_BIT;
+    int32 err;
+
+    //
+    // Running half bit sums: the sample half a bit back leaves the later
+    // half for the earlier one, the sample a bit back leaves that
+    //
+    mid = rx->head + rx->half;
+    if(mid >= 2 * rx->half)
+    {
+        mid -= 2 * rx->half;
+    }
+    mid = rx->hist[mid];
+    rx->early += (int32)mid - (int32)rx->hist[rx->head];
+    rx->late  += (int32)sample - (int32)mid;
+    rx->hist[rx->head] = sample;
+    if(++rx->head == 2 * rx->half)
+    {
+        rx->head = 0;
+    }
+
+    if(sample > rx->threshold + rx->hysteresis)
+    {
+        level = 1;
+    }
+    else if(sample < rx->threshold - rx->hysteresis)
+    {
+        level = 0;
+    }
+
+    if(rx->phase < 0x7FFF00L)
+    {
+        rx->phase += 0x100;
+    }
+    rx->count   = rx->phase < 0 ? 0 : (Uint16)(rx->phase >> 8);
+    rx->crossed = 0;
+
+    if(level != rx->level)
+    {
+        rx->level = level;
+
+        if(rx->count >= rx->edge_window)
+        {
+            //
+            // Mid-bit edge, either in lock or the one that acquires it.
+            // The recovered edge may still be ahead (phase < 0).
+            //
+            if(rx->locked)
+            {
+                err = rx->phase - ((int32)rx->samples_per_bit << 8);
+                rx->phase -= ((int32)rx->samples_per_bit << 8) +
+                             (err >> MANCHESTER_RX_GAIN_SHIFT);
+            }
+            else
+            {
+                rx->phase = 0;
+            }
+            rx->count   = rx->phase < 0 ? 0 : (Uint16)(rx->phase >> 8);
+            rx->locked  = 1;
+            rx->crossed = 1;
+            rx->pending = 1;
+            rx->edge    = level;
+        }
+        else if(!rx->locked)
+        {
+            //
+            // Still searching for the bit phase: measure from every edge
+            //
+            rx->phase = 0;
+            rx->count = 0;
+        }
+    }
+    else if(rx->locked && rx->count > rx->lost_window)
+    {
+        rx->locked  = 0;
+        rx->pending = 0;
+        rx->sync_losses++;
+    }
+
+    //
+    // The later half of the pending bit is in
+    //
+    if(rx->pending && rx->phase >= ((int32)rx->half - 1) << 8)
+    {
+        rx->pending = 0;
+        bit = rx->late == rx->early ? (int16)rx->edge :
+                                      (int16)(rx->late > rx->early);
+        rx->bits++;
+    }
+
+    return bit;
+}
+
+//
+// End of File
+//
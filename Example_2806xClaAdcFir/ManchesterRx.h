@@ -0,0 +1,91 @@
+//###########################################################################
+//
+// FILE:   ManchesterRx.h
+//
+// TITLE:  Sample domain slicer and Manchester bit decoder
+//
+//###########################################################################
+
+#ifndef MANCHESTER_RX_H
+#define MANCHESTER_RX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// Bits follow the IEEE 802.3 convention: a 1 is a low-to-high transition
+// at mid-bit, a 0 is a high-to-low transition at mid-bit.
+//
+// manchester_rx_sample() returns MANCHESTER_RX_NO_BIT for every sample
+// that does not complete a bit.
+//
+// The slicer only gives the timing. The bit is decided by integrate and
+// dump, the matched filter of a Manchester bit: the sum of the half bit
+// after the mid-bit edge against the sum of the half bit before it, a 1
+// if the later half is larger. Every sample of the bit counts instead of
+// the one the slicer flipped on, about 10*log10(samples_per_bit) dB
+// better against white noise. Both sums are kept running over the last
+// bit of samples (a sample in, one moved from the later to the earlier
+// half and one out), so the bit comes out half a bit after its edge. At
+// more than 2 * MANCHESTER_RX_MAX_HALF samples per bit only the
+// MANCHESTER_RX_MAX_HALF samples on each side of the edge are summed.
+//
+// For the sums to line up with the bits a noisy crossing must not move
+// the bit clock by its full error: each mid-bit edge pulls the clock
+// 1/2^MANCHESTER_RX_GAIN_SHIFT of the way to it. A 2 % transmitter
+// clock error then leaves under a sample of phase error at 10 samples
+// per bit.
+//
+#define MANCHESTER_RX_NO_BIT    (-1)
+#define MANCHESTER_RX_MAX_HALF  16
+#define MANCHESTER_RX_GAIN_SHIFT 2
+
+//
+// Typedefs
+//
+typedef struct {
+    Uint16 threshold;       // slicer decision level (ADC codes)
+    Uint16 hysteresis;      // +/- band around threshold with no decision
+    Uint16 edge_window;     // min samples between mid-bit edges (3/4 bit)
+    Uint16 lost_window;     // max samples between mid-bit edges (5/4 bit)
+    Uint16 samples_per_bit;
+    Uint16 level;           // last sliced level, 0 or 1
+    Uint16 count;           // samples since the last mid-bit edge
+    Uint16 locked;          // 1 once a mid-bit edge has been identified
+    Uint16 crossed;         // 1 if this sample was taken as a mid-bit edge
+    int32 phase;            // samples since the mid-bit edge, Q8
+    Uint16 half;            // samples summed per half bit
+    Uint16 head;            // oldest sample in hist[]
+    Uint16 pending;         // a mid-bit edge waits for its later half
+    Uint16 edge;            // level after that edge, breaks a tie
+    int32 late;             // sum of the last half samples
+    int32 early;            // sum of the half samples before those
+    Uint16 hist[2 * MANCHESTER_RX_MAX_HALF];
+    Uint32 bits;            // total decoded bits
+    Uint32 sync_losses;     // number of times lock was lost
+} manchester_rx_t;
+
+//
+// Function Prototypes
+//
+void manchester_rx_init(manchester_rx_t *rx, Uint16 threshold,
+                        Uint16 hysteresis, Uint16 samples_per_bit);
+int16 manchester_rx_sample(manchester_rx_t *rx, Uint16 sample);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of MANCHESTER_RX_H definition
+
+//
+// End of File
+//
@@ -0,0 +1,333 @@
+//###########################################################################
+//
+// FILE:   ManchesterTx.c
+//
+// TITLE:  ePWM3 Manchester and line code transmitter with hardware timed
+//         edges
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "ManchesterTx.h"
+#include "Trace.h"
+
+//
+// The ISR runs once per bit; it goes to RAM in flash builds (Boot.h)
+//
+#pragma CODE_SECTION(manchester_tx_isr, "ramfuncs");
+
+//
+// Defines
+//
+// ePWM3 counts up with a period of one Manchester bit, two chips.
+// EPWM3A toggles on CMPB at the start of the period when the first chip
+// differs from the level on the line, and on CMPA at mid-period when the
+// second chip differs from the first. Either is moved out of the counter
+// range when its edge is not needed. For Manchester chips the CMPA edge
+// is in every bit and the CMPB one only between equal bits. CMPA is
+// offset by the same amount as CMPB so both edges stay exactly half a
+// bit apart.
+//
+// EPWM3B makes the same edges, so through the PAM-4 resistor DAC
+// (Pam4Tx.h) the Manchester line swings from level 0 to level 3. AQCSFRC
+// holds CSFA in bits 1:0 and CSFB in bits 3:2, 1 forces low, 0 lets the
+// action qualifier drive.
+//
+#define MANCHESTER_TX_EDGE      1
+#define MANCHESTER_TX_NO_EDGE   0xFFFF
+#define MANCHESTER_TX_PARK      0x0005
+#define MANCHESTER_TX_RUN       0x0000
+
+//
+// Globals
+//
+manchester_tx_t ManchesterTx;
+
+//
+// manchester_tx_init - Configure ePWM3 as the Manchester line driver
+//
+// bit_period is the TBPRD value for one Manchester bit (up count mode).
+// The line code goes back to Manchester. The line is parked low by a
+// continuous software force until the first frame is queued. Call with
+// the ePWM time base clocks stopped (TBCLKSYNC = 0) so ePWM3 starts in
+// step with ePWM1.
+//
+void
+manchester_tx_init(Uint16 bit_period)
+{
+    ManchesterTx.head        = 0;
+    ManchesterTx.tail        = 0;
+    ManchesterTx.active      = 0;
+    ManchesterTx.chip        = 0;
+    ManchesterTx.level       = 0;
+    ManchesterTx.idle        = 1;
+    ManchesterTx.bit_period  = bit_period;
+    ManchesterTx.mid         = (bit_period + 1) / 2 + MANCHESTER_TX_EDGE;
+    ManchesterTx.frames_sent = 0;
+    line_code_init(&ManchesterTx.code, LINE_MANCHESTER, 0);
+
+    //
+    // Halt the counter, clear it and set the bit period
+    //
+    EPwm3Regs.TBCTL.bit.CTRMODE   = TB_FREEZE;
+    EPwm3Regs.TBCTL.bit.FREE_SOFT = 3;
+    EPwm3Regs.TBCTR               = 0x0000;
+    EPwm3Regs.TBCTL.bit.PRDLD     = TB_IMMEDIATE;
+    EPwm3Regs.TBPRD               = bit_period;
+    EPwm3Regs.TBCTL.bit.PRDLD     = TB_SHADOW;
+    EPwm3Regs.TBPHS.half.TBPHS    = 0x0000;
+
+    //
+    // CMPA and CMPB are shadowed and loaded at CTR = 0, so a value written
+    // by the ISR during one bit takes effect at the start of the next bit
+    //
+    EPwm3Regs.CMPCTL.bit.SHDWAMODE = CC_SHADOW;
+    EPwm3Regs.CMPCTL.bit.SHDWBMODE = CC_SHADOW;
+    EPwm3Regs.CMPCTL.bit.LOADAMODE = CC_CTR_ZERO;
+    EPwm3Regs.CMPCTL.bit.LOADBMODE = CC_CTR_ZERO;
+    EPwm3Regs.CMPA.half.CMPA = MANCHESTER_TX_NO_EDGE;
+    EPwm3Regs.CMPB           = MANCHESTER_TX_NO_EDGE;
+
+    //
+    // Toggle EPWM3A and EPWM3B on CMPA and CMPB when counting up,
+    // nothing else
+    //
+    EPwm3Regs.AQCTLA.all     = 0x0000;
+    EPwm3Regs.AQCTLA.bit.CAU = AQ_TOGGLE;
+    EPwm3Regs.AQCTLA.bit.CBU = AQ_TOGGLE;
+    EPwm3Regs.AQCTLB.all     = 0x0000;
+    EPwm3Regs.AQCTLB.bit.CAU = AQ_TOGGLE;
+    EPwm3Regs.AQCTLB.bit.CBU = AQ_TOGGLE;
+
+    //
+    // Force the line low right away, then switch the continuous software
+    // force to shadow mode, loaded at CTR = 0
+    //
+    EPwm3Regs.AQSFRC.bit.RLDCSF = 3;
+    EPwm3Regs.AQCSFRC.all       = MANCHESTER_TX_PARK;
+    EPwm3Regs.AQSFRC.bit.RLDCSF = 0;
+
+    //
+    // Interrupt at every CTR = 0. It is only enabled while frames are
+    // queued.
+    //
+    EPwm3Regs.ETSEL.bit.INTSEL = ET_CTR_ZERO;
+    EPwm3Regs.ETPS.bit.INTPRD  = ET_1ST;
+    EPwm3Regs.ETSEL.bit.INTEN  = 0;
+    EPwm3Regs.ETCLR.bit.INT    = 1;
+
+    EPwm3Regs.TBCTL.bit.CTRMODE = TB_COUNT_UP;
+}
+
+//
+// manchester_tx_set_bit_period - Change the bit period of a running
+// transmitter
+//
+// Call with the ePWM time base clocks stopped (see rate_sync_begin()).
+// The counter restarts from zero at the next start of the clocks. A frame
+// being sent carries on at the new rate, the receiver has to resync.
+//
+void
+manchester_tx_set_bit_period(Uint16 bit_period)
+{
+    ManchesterTx.bit_period = bit_period;
+    ManchesterTx.mid        = (bit_period + 1) / 2 + MANCHESTER_TX_EDGE;
+
+    EPwm3Regs.TBCTL.bit.PRDLD = TB_IMMEDIATE;
+    EPwm3Regs.TBPRD           = bit_period;
+    EPwm3Regs.TBCTL.bit.PRDLD = TB_SHADOW;
+    EPwm3Regs.TBCTR           = 0x0000;
+
+    //
+    // The shadow would only load at the next CTR = 0, move a mid-period
+    // edge directly
+    //
+    EPwm3Regs.CMPCTL.bit.SHDWAMODE = CC_IMMEDIATE;
+    if(EPwm3Regs.CMPA.half.CMPA != MANCHESTER_TX_NO_EDGE)
+    {
+        EPwm3Regs.CMPA.half.CMPA = ManchesterTx.mid;
+    }
+    EPwm3Regs.CMPCTL.bit.SHDWAMODE = CC_SHADOW;
+}
+
+//
+// manchester_tx_set_code - Select the line code of the frames queued
+// from now on
+//
+// Frames already queued go out in the code they were queued in. The
+// chips stay two to a bit period, so 4B5B and 8B10B carry 8 bits in 5
+// bit periods where Manchester takes 8. Returns the line_code_init()
+// status, the code is kept if it is refused.
+//
+Uint16
+manchester_tx_set_code(Uint16 code, Uint16 vppm_width)
+{
+    return line_code_init(&ManchesterTx.code, code, vppm_width);
+}
+
+//
+// manchester_tx_max_bytes - Largest frame in the current line code
+//
+Uint16
+manchester_tx_max_bytes(void)
+{
+    Uint16 n = MANCHESTER_TX_MAX_CHIPS / ManchesterTx.code.chips_per_byte;
+
+    return n < MANCHESTER_TX_MAX_BYTES ? n : MANCHESTER_TX_MAX_BYTES;
+}
+
+//
+// manchester_tx_send - Encode and queue a frame of nbytes bytes
+//
+// Returns 1 if the frame was queued, 0 if the queue is full or the frame
+// is empty or too long (manchester_tx_max_bytes()). The data buffer can
+// be reused on return.
+//
+Uint16
+manchester_tx_send(const Uint16 *data, Uint16 nbytes)
+{
+    manchester_tx_frame_t *frame;
+    Uint16 next;
+
+    if(nbytes == 0 || nbytes > manchester_tx_max_bytes())
+    {
+        return 0;
+    }
+
+    next = ManchesterTx.tail + 1;
+    if(next == MANCHESTER_TX_QUEUE_LEN)
+    {
+        next = 0;
+    }
+    if(next == ManchesterTx.head)
+    {
+        return 0;
+    }
+
+    frame = &ManchesterTx.queue[ManchesterTx.tail];
+    frame->nchips = line_encode(&ManchesterTx.code, data, nbytes,
+                                frame->chips);
+
+    //
+    // Publish the frame, then make sure the ISR is running
+    //
+    ManchesterTx.tail = next;
+    EPwm3Regs.ETSEL.bit.INTEN = 1;
+
+    return 1;
+}
+
+//
+// manchester_tx_free - Number of frames that can still be queued
+//
+Uint16
+manchester_tx_free(void)
+{
+    Uint16 used;
+
+    used = (ManchesterTx.tail + MANCHESTER_TX_QUEUE_LEN - ManchesterTx.head) %
+           MANCHESTER_TX_QUEUE_LEN;
+
+    return MANCHESTER_TX_QUEUE_LEN - 1 - used;
+}
+
+//
+// manchester_tx_busy - 1 while frames are queued or being sent
+//
+Uint16
+manchester_tx_busy(void)
+{
+    return ManchesterTx.head != ManchesterTx.tail;
+}
+
+//
+// manchester_tx_isr - ISR for ePWM3 at CTR = 0
+//
+// At this point the shadow registers written by the previous call have
+// just been loaded for the bit period now on the line. Write the edges
+// (CMPB and CMPA) of the next two chips for the following one. The ISR
+// only has to complete within one bit period; its latency never moves an
+// edge. The latency is the counter value at entry, so with a level set
+// in ManchesterTx.isr the ISR can give way to the sample ISR
+// (IsrNest.h).
+//
+__interrupt void
+manchester_tx_isr(void)
+{
+    manchester_tx_t *tx = &ManchesterTx;
+    manchester_tx_frame_t *frame;
+    Uint16 first, second;
+    Uint16 pieier;
+
+    ISR_LATENCY(&tx->isr, EPwm3Regs.TBCTR * 2);
+    pieier = isr_nest_enter(&tx->isr);
+    TRACE_ISR_ENTER(TRACE_SRC_TX);
+
+    //
+    // Retire the frame whose last chips have just been loaded
+    //
+    if(tx->active && tx->chip == tx->queue[tx->head].nchips)
+    {
+        tx->head++;
+        if(tx->head == MANCHESTER_TX_QUEUE_LEN)
+        {
+            tx->head = 0;
+        }
+        tx->active = 0;
+        tx->frames_sent++;
+    }
+
+    if(!tx->active && tx->head != tx->tail)
+    {
+        tx->active = 1;
+        tx->chip   = 0;
+    }
+
+    if(tx->active)
+    {
+        frame = &tx->queue[tx->head];
+
+        //
+        // A chip needs an edge at its start when the line is not already
+        // at its level
+        //
+        first  = BITVEC_GET(frame->chips, tx->chip);
+        second = BITVEC_GET(frame->chips, tx->chip + 1);
+        EPwm3Regs.CMPB = first != tx->level ? MANCHESTER_TX_EDGE :
+                                              MANCHESTER_TX_NO_EDGE;
+        EPwm3Regs.CMPA.half.CMPA = second != first ? tx->mid :
+                                                     MANCHESTER_TX_NO_EDGE;
+        tx->level = second;
+
+        if(tx->idle)
+        {
+            EPwm3Regs.AQCSFRC.all = MANCHESTER_TX_RUN;
+            tx->idle = 0;
+        }
+        tx->chip += 2;
+    }
+    else
+    {
+        //
+        // Nothing left to send: park the line low from the next bit on
+        // and stop interrupting until the next frame is queued
+        //
+        EPwm3Regs.AQCSFRC.all = MANCHESTER_TX_PARK;
+        EPwm3Regs.CMPA.half.CMPA = MANCHESTER_TX_NO_EDGE;
+        EPwm3Regs.CMPB = MANCHESTER_TX_NO_EDGE;
+        tx->idle  = 1;
+        tx->level = 0;
+        EPwm3Regs.ETSEL.bit.INTEN = 0;
+    }
+
+    EPwm3Regs.ETCLR.bit.INT = 1;
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP3;
+    TRACE_ISR_EXIT(TRACE_SRC_TX);
+    isr_nest_exit(&tx->isr, pieier);
+}
+
+//
+// End of File
+//
@@ -0,0 +1,94 @@
+//###########################################################################
+//
+// FILE:   ManchesterTx.h
+//
+// TITLE:  ePWM3 Manchester and line code transmitter with hardware timed
+//         edges
+//
+//###########################################################################
+
+#ifndef MANCHESTER_TX_H
+#define MANCHESTER_TX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+#include "IsrNest.h"
+#include "LineCode.h"
+
+//
+// Defines
+//
+// MANCHESTER_TX_QUEUE_LEN is the number of frames that can be queued.
+// MANCHESTER_TX_MAX_BYTES is the largest frame payload in bytes.
+// Bytes are sent LSB first (as on the SCI), one byte per Uint16 word.
+//
+// Frames go out in the line code of ManchesterTx.code (LineCode.h),
+// Manchester unless manchester_tx_set_code() picked another, two chips
+// per bit period. A frame holds up to MANCHESTER_TX_MAX_CHIPS chips,
+// MANCHESTER_TX_MAX_BYTES bytes of every code but VPPM, which has 4
+// times the chips of Manchester and fits a quarter of the bytes
+// (manchester_tx_max_bytes()).
+//
+#define MANCHESTER_TX_QUEUE_LEN     4
+#define MANCHESTER_TX_MAX_BYTES     32
+#define MANCHESTER_TX_MAX_CHIPS     (MANCHESTER_TX_MAX_BYTES * 16)
+
+//
+// Typedefs
+//
+// A queued frame is stored as its line_encode() chips, an even number.
+// The ISR turns each pair into the edges of one bit period against the
+// level left on the line, so a frame does not depend on the one before.
+//
+typedef struct {
+    Uint16 chips[BITVEC_WORDS(MANCHESTER_TX_MAX_CHIPS)];
+    Uint16 nchips;
+} manchester_tx_frame_t;
+
+typedef struct {
+    manchester_tx_frame_t queue[MANCHESTER_TX_QUEUE_LEN];
+    volatile Uint16 head;       // next frame to send, ISR only
+    volatile Uint16 tail;       // next free slot, manchester_tx_send only
+    Uint16 active;              // a frame is being clocked out
+    Uint16 chip;                // next chip of the active frame
+    Uint16 level;               // last chip on the line, 0 when idle
+    Uint16 idle;                // line is forced low
+    Uint16 bit_period;          // TBPRD value, one Manchester bit
+    Uint16 mid;                 // CMPA of the edge between two chips
+    line_code_t code;           // encoder of the frames queued next
+    Uint32 frames_sent;
+    isr_nest_t isr;             // level and latency of manchester_tx_isr
+} manchester_tx_t;
+
+//
+// Globals
+//
+extern manchester_tx_t ManchesterTx;
+
+//
+// Function Prototypes
+//
+void manchester_tx_init(Uint16 bit_period);
+void manchester_tx_set_bit_period(Uint16 bit_period);
+Uint16 manchester_tx_set_code(Uint16 code, Uint16 vppm_width);
+Uint16 manchester_tx_max_bytes(void);
+Uint16 manchester_tx_send(const Uint16 *data, Uint16 nbytes);
+Uint16 manchester_tx_free(void);
+Uint16 manchester_tx_busy(void);
+__interrupt void manchester_tx_isr(void);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of MANCHESTER_TX_H definition
+
+//
+// End of File
+//
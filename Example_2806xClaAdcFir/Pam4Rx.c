@@ -0,0 +1,310 @@
+//###########################################################################
+//
+// FILE:   Pam4Rx.c
+//
+// TITLE:  PAM-4 symbol decoder with adaptive levels
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Pam4Rx.h"
+
+//
+// Called for every sample, runs from RAM in flash builds (Boot.h)
+//
+#pragma CODE_SECTION(pam4_rx_sample, "ramfuncs");
+
+//
+// Function Prototypes
+//
+static void pam4_rx_spread(pam4_rx_t *rx, int32 low, int32 high);
+static void pam4_rx_thresholds(pam4_rx_t *rx);
+
+//
+// pam4_rx_init - Start the decoder on a stream with samples_per_symbol
+// samples per symbol
+//
+// low and high are the expected lowest and highest levels in sample
+// units. Only the middle level matters before the training, it finds
+// the first crossing. hysteresis is the band around the middle level
+// that does not count as a crossing.
+//
+void
+pam4_rx_init(pam4_rx_t *rx, Uint16 low, Uint16 high, Uint16 hysteresis,
+             Uint16 samples_per_symbol)
+{
+    rx->samples_per_symbol = samples_per_symbol;
+    rx->start       = samples_per_symbol / 4;
+    rx->stop        = rx->start + (samples_per_symbol + 1) / 2;
+    rx->span        = rx->stop - rx->start;
+    rx->hysteresis  = hysteresis;
+    rx->sum         = 0;
+    rx->noise       = 0;
+    rx->sum_min     = 0;
+    rx->sum_max     = 0;
+    rx->train       = 0;
+    rx->n           = 0;
+    rx->decided     = 0;
+    rx->prev        = 0;
+    rx->above       = PAM4_RX_SIDE_UNKNOWN;
+    rx->phase       = 0;
+    rx->freq        = 0;
+    rx->since_cross = 0;
+    rx->locked      = 0;
+    rx->symbols     = 0;
+    rx->sync_losses = 0;
+
+    pam4_rx_spread(rx, (int32)low * rx->span, (int32)high * rx->span);
+}
+
+//
+// pam4_rx_sample - Run one filtered sample through the symbol clock and
+// the integrator
+//
+// Returns the two bits of a completed symbol or PAM4_RX_NO_SYMBOL.
+// Nothing is decided until the first crossing of the middle level, nor
+// while the levels train.
+//
+int16
+pam4_rx_sample(pam4_rx_t *rx, Uint16 sample)
+{
+    Uint16 prev = rx->prev;
+    Uint16 above = rx->above;
+    Uint32 period = (Uint32)rx->samples_per_symbol << 16;
+    Uint16 n;
+    int32 frac, e, err;
+    Uint16 d;
+
+    rx->prev = sample;
+    if(sample > rx->mid + rx->hysteresis)
+    {
+        above = 1;
+    }
+    else if(sample < rx->mid - rx->hysteresis)
+    {
+        above = 0;
+    }
+
+    if(above != rx->above && rx->above == PAM4_RX_SIDE_UNKNOWN)
+    {
+        rx->above = above;
+    }
+    else if(above != rx->above)
+    {
+        rx->above = above;
+
+        //
+        // The crossing was frac samples before this one, Q16, interpolated
+        // between the last two samples
+        //
+        frac = ((int32)sample - rx->mid) << 16;
+        e = (int32)sample - prev;
+        frac = e != 0 ? frac / e : 0;
+        if(frac < 0)
+        {
+            frac = 0;
+        }
+        else if(frac > 0x10000)
+        {
+            frac = 0x10000;
+        }
+
+        if(!rx->locked)
+        {
+            rx->locked  = 1;
+            rx->since_cross = 0;
+            rx->phase   = (Uint32)frac;
+            rx->freq    = 0;
+            rx->sum     = 0;
+            rx->n       = 0;
+            rx->decided = 0;
+            rx->train   = PAM4_RX_TRAIN_SYMBOLS;
+            rx->sum_min = 0x7FFFFFFF;
+            rx->sum_max = 0;
+        }
+        else
+        {
+            //
+            // The crossing should be on the boundary, phase 0. One inside
+            // the integration window is noise, a wrong level or a clock
+            // gone wrong and does not count; otherwise move the clock
+            // 1/2^PAM4_RX_GAIN_SHIFT of the way to it and its rate by
+            // 1/2^PAM4_RX_FREQ_SHIFT of the error per sample.
+            //
+            e = (int32)rx->phase - frac;
+            if(e > (int32)(period >> 1))
+            {
+                e -= period;
+            }
+            else if(e < -(int32)(period >> 1))
+            {
+                e += period;
+            }
+            if(e < (int32)rx->start << 16 &&
+               e > -((int32)(rx->samples_per_symbol - rx->stop) << 16))
+            {
+                rx->since_cross = 0;
+                rx->freq -= e >> PAM4_RX_FREQ_SHIFT;
+                if(rx->freq > PAM4_RX_FREQ_MAX)
+                {
+                    rx->freq = PAM4_RX_FREQ_MAX;
+                }
+                else if(rx->freq < -PAM4_RX_FREQ_MAX)
+                {
+                    rx->freq = -PAM4_RX_FREQ_MAX;
+                }
+                e = (int32)rx->phase - (e >> PAM4_RX_GAIN_SHIFT);
+                if(e < 0)
+                {
+                    e += period;
+                }
+                else if(e >= (int32)period)
+                {
+                    e -= period;
+                    rx->decided = 0;
+                }
+                rx->phase = (Uint32)e;
+            }
+        }
+    }
+
+    if(!rx->locked)
+    {
+        return PAM4_RX_NO_SYMBOL;
+    }
+
+    n = (Uint16)(rx->phase >> 16);
+    if(n >= rx->start && n < rx->stop)
+    {
+        rx->sum += sample;
+        rx->n++;
+    }
+    rx->phase += 0x10000 + rx->freq;
+    if(rx->phase >= period)
+    {
+        rx->phase -= period;
+        rx->decided = 0;
+        if(++rx->since_cross > PAM4_RX_LOST_SYMBOLS)
+        {
+            rx->locked = 0;
+            rx->sync_losses++;
+        }
+    }
+    if(rx->decided || (rx->phase >> 16) < rx->stop || rx->n == 0)
+    {
+        return PAM4_RX_NO_SYMBOL;
+    }
+    rx->decided = 1;
+
+    //
+    // A clock correction can add or drop a sample of the window, scale
+    // the sum back to span samples
+    //
+    if(rx->n != rx->span)
+    {
+        rx->sum = rx->sum * rx->span / rx->n;
+    }
+    rx->n = 0;
+
+    if(rx->train != 0)
+    {
+        if(rx->sum < rx->sum_min)
+        {
+            rx->sum_min = rx->sum;
+        }
+        if(rx->sum > rx->sum_max)
+        {
+            rx->sum_max = rx->sum;
+        }
+        rx->sum = 0;
+        if(--rx->train == 0)
+        {
+            pam4_rx_spread(rx, rx->sum_min, rx->sum_max);
+        }
+        return PAM4_RX_NO_SYMBOL;
+    }
+
+    //
+    // End of the window: slice, then pull the level of the decision and
+    // the noise estimate towards the sum
+    //
+    d = (rx->sum > rx->thr[0]) + (rx->sum > rx->thr[1]) +
+        (rx->sum > rx->thr[2]);
+    err = rx->sum - rx->level[d];
+    rx->level[d] += err >> PAM4_RX_LEVEL_SHIFT;
+    rx->noise += ((err < 0 ? -err : err) - rx->noise) >> PAM4_RX_NOISE_SHIFT;
+    pam4_rx_thresholds(rx);
+    rx->sum = 0;
+    rx->symbols++;
+
+    return (int16)(d ^ (d >> 1));
+}
+
+//
+// pam4_rx_margin - Half the smallest level step over the noise estimate,
+// Q4
+//
+// With Gaussian noise the mean distance is 0.8 sigma, so a margin of m
+// puts the levels 0.8 m sigma from the slicer: 4 (64) is a symbol error
+// rate of about 1e-3, 5 (80) of 3e-5. 0 when two levels have merged.
+//
+Uint16
+pam4_rx_margin(const pam4_rx_t *rx)
+{
+    int32 step = rx->level[1] - rx->level[0];
+    int32 margin;
+    Uint16 k;
+
+    for(k = 2; k < PAM4_RX_LEVELS; k++)
+    {
+        if(rx->level[k] - rx->level[k - 1] < step)
+        {
+            step = rx->level[k] - rx->level[k - 1];
+        }
+    }
+    if(step <= 0)
+    {
+        return 0;
+    }
+    if(rx->noise <= 0)
+    {
+        return 0xFFFF;
+    }
+
+    margin = (step << 3) / rx->noise;
+    return margin > 0xFFFF ? 0xFFFF : (Uint16)margin;
+}
+
+//
+// pam4_rx_spread - Level estimates evenly from low to high, symbol sums
+//
+static void
+pam4_rx_spread(pam4_rx_t *rx, int32 low, int32 high)
+{
+    Uint16 k;
+
+    for(k = 0; k < PAM4_RX_LEVELS; k++)
+    {
+        rx->level[k] = low + (high - low) / (PAM4_RX_LEVELS - 1) * k;
+    }
+    rx->noise = 0;
+    pam4_rx_thresholds(rx);
+}
+
+//
+// pam4_rx_thresholds - Slicer levels halfway between the level estimates
+//
+static void
+pam4_rx_thresholds(pam4_rx_t *rx)
+{
+    rx->thr[0] = (rx->level[0] + rx->level[1]) >> 1;
+    rx->thr[1] = (rx->level[1] + rx->level[2]) >> 1;
+    rx->thr[2] = (rx->level[2] + rx->level[3]) >> 1;
+    rx->mid    = (Uint16)(rx->thr[1] / rx->span);
+}
+
+//
+// End of File
+//
@@ -0,0 +1,117 @@
+//###########################################################################
+//
+// FILE:   Pam4Rx.h
+//
+// TITLE:  PAM-4 symbol decoder with adaptive levels
+//
+//###########################################################################
+
+#ifndef PAM4_RX_H
+#define PAM4_RX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// A symbol is one of four levels held for a whole symbol period and
+// carries two bits, Gray coded so that the likely error, a neighbouring
+// level, costs one bit:
+//
+//      level   0       1       2       3       (0 lowest)
+//      bits    00      01      11      10      (first bit on the left)
+//
+// pam4_rx_sample() returns PAM4_RX_NO_SYMBOL for every sample that does
+// not complete a symbol, else the two bits, the first one in bit 1.
+//
+// The samples of the middle half of a symbol are summed (integrate and
+// dump) and the sum is sliced against the midpoints of the four level
+// estimates. After lock the first PAM4_RX_TRAIN_SYMBOLS sums only train
+// the estimates: they are spread evenly between the smallest and the
+// largest sum. From then on each decision moves the estimate of its
+// level by 1/2^PAM4_RX_LEVEL_SHIFT of the difference, so the slicer
+// follows the swing, offset and non-linearity of the link; the mean
+// distance of the sums from their level is the noise estimate.
+//
+// Symbol timing comes from the crossings of the middle slicer level,
+// placed between two samples by linear interpolation. A crossing should
+// be on a symbol boundary; one that falls in the integration window is
+// taken as noise and ignored. The others pull the symbol clock
+// 1/2^PAM4_RX_GAIN_SHIFT of the way to them, and its rate by
+// 1/2^PAM4_RX_FREQ_SHIFT of the error, up to PAM4_RX_FREQ_MAX (Q16, about
+// 4 %), so a transmitter clock a few percent off is followed without a
+// lasting phase error. A transition that is not symmetric about the middle
+// (0 to 2, 1 to 3) crosses it off the boundary, either way with equal
+// odds, and averages out.
+//
+// Without a crossing outside the window for PAM4_RX_LOST_SYMBOLS symbols
+// the decoder drops lock and takes the next crossing as a boundary
+// again. The first sample only tells the side of the middle level it
+// starts on.
+//
+#define PAM4_RX_NO_SYMBOL       (-1)
+#define PAM4_RX_LEVELS          4
+#define PAM4_RX_TRAIN_SYMBOLS   64
+#define PAM4_RX_LEVEL_SHIFT     5
+#define PAM4_RX_NOISE_SHIFT     6
+#define PAM4_RX_GAIN_SHIFT      2
+#define PAM4_RX_FREQ_SHIFT      10
+#define PAM4_RX_FREQ_MAX        0x0A00
+#define PAM4_RX_LOST_SYMBOLS    32
+#define PAM4_RX_SIDE_UNKNOWN    2       // above, before the first sample
+
+//
+// Typedefs
+//
+// level[], thr[] and noise are in units of the symbol sum, span samples.
+//
+typedef struct {
+    Uint16 samples_per_symbol;
+    Uint16 start;               // first phase summed
+    Uint16 stop;                // phase after the last summed, decision
+    Uint16 span;                // samples summed per symbol
+    Uint16 hysteresis;          // +/- band around the middle, ADC codes
+    int32 level[PAM4_RX_LEVELS];
+    int32 thr[PAM4_RX_LEVELS - 1];
+    int32 sum;
+    Uint16 n;                   // samples in sum
+    Uint16 decided;             // the symbol of this period is out
+    int32 noise;                // mean |sum - level| of the decisions
+    int32 sum_min;              // sum range while training
+    int32 sum_max;
+    Uint16 train;               // training sums still to come
+    Uint16 mid;                 // middle slicer level, ADC codes
+    Uint16 prev;                // previous sample
+    Uint16 above;               // last side of the middle level, 1 above
+    Uint32 phase;               // samples since the symbol boundary, Q16
+    int32 freq;                 // clock correction per sample, Q16
+    Uint16 since_cross;         // symbols since the last crossing counted
+    Uint16 locked;
+    Uint32 symbols;
+    Uint32 sync_losses;
+} pam4_rx_t;
+
+//
+// Function Prototypes
+//
+void pam4_rx_init(pam4_rx_t *rx, Uint16 low, Uint16 high,
+                  Uint16 hysteresis, Uint16 samples_per_symbol);
+int16 pam4_rx_sample(pam4_rx_t *rx, Uint16 sample);
+Uint16 pam4_rx_margin(const pam4_rx_t *rx);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of PAM4_RX_H definition
+
+//
+// End of File
+//
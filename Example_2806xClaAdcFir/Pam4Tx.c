@@ -0,0 +1,223 @@
+//###########################################################################
+//
+// FILE:   Pam4Tx.c
+//
+// TITLE:  ePWM3 PAM-4 transmitter through a two bit resistor DAC
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Pam4Tx.h"
+#include "Trace.h"
+
+//
+// The ISR runs once per symbol; it goes to RAM in flash builds (Boot.h)
+//
+#pragma CODE_SECTION(pam4_tx_isr, "ramfuncs");
+
+//
+// Defines
+//
+// ePWM3 counts up with a period of one symbol and has no action
+// qualifier events: both outputs are held by the continuous software
+// forces, shadowed and loaded at CTR = 0. The ISR at CTR = 0 writes the
+// forces of the next symbol, so the levels change on the counter, not on
+// the ISR. AQCSFRC holds CSFA in bits 1:0 and CSFB in bits 3:2, 1 forces
+// low and 2 high.
+//
+#define PAM4_TX_FORCE_LOW       0x0005
+#define PAM4_TX_FORCE_A         0x0001  // add to force EPWM3A high
+#define PAM4_TX_FORCE_B         0x0004  // add to force EPWM3B high
+
+//
+// Globals
+//
+pam4_tx_t Pam4Tx;
+
+//
+// pam4_tx_init - Configure ePWM3 as the PAM-4 line driver
+//
+// symbol_period is the TBPRD value for one symbol (up count mode). Any
+// queued frame is dropped and the line is held at level 0 until the
+// next one. Call with the ePWM time base clocks stopped (TBCLKSYNC = 0)
+// so ePWM3 starts in step with ePWM1; it takes ePWM3 over from
+// ManchesterTx.c, manchester_tx_init() gives it back.
+//
+void
+pam4_tx_init(Uint16 symbol_period)
+{
+    Pam4Tx.head          = 0;
+    Pam4Tx.tail          = 0;
+    Pam4Tx.active        = 0;
+    Pam4Tx.symbol        = 0;
+    Pam4Tx.symbol_period = symbol_period;
+    Pam4Tx.frames_sent   = 0;
+
+    EPwm3Regs.TBCTL.bit.CTRMODE   = TB_FREEZE;
+    EPwm3Regs.TBCTL.bit.FREE_SOFT = 3;
+    EPwm3Regs.TBCTL.bit.PRDLD     = TB_IMMEDIATE;
+    EPwm3Regs.TBPRD               = symbol_period;
+    EPwm3Regs.TBCTL.bit.PRDLD     = TB_SHADOW;
+    EPwm3Regs.TBCTR               = 0x0000;
+    EPwm3Regs.TBPHS.half.TBPHS    = 0x0000;
+
+    EPwm3Regs.AQCTLA.all = 0x0000;
+    EPwm3Regs.AQCTLB.all = 0x0000;
+
+    //
+    // Level 0 right away, then shadowed forces from the next CTR = 0
+    //
+    EPwm3Regs.AQSFRC.bit.RLDCSF = 3;
+    EPwm3Regs.AQCSFRC.all       = PAM4_TX_FORCE_LOW;
+    EPwm3Regs.AQSFRC.bit.RLDCSF = 0;
+
+    //
+    // Interrupt at every CTR = 0 while frames are queued
+    //
+    EPwm3Regs.ETSEL.bit.INTSEL = ET_CTR_ZERO;
+    EPwm3Regs.ETPS.bit.INTPRD  = ET_1ST;
+    EPwm3Regs.ETSEL.bit.INTEN  = 0;
+    EPwm3Regs.ETCLR.bit.INT    = 1;
+
+    EPwm3Regs.TBCTL.bit.CTRMODE = TB_COUNT_UP;
+}
+
+//
+// pam4_tx_send - Queue a frame of nbytes bytes
+//
+// Returns 1 if the frame was queued, 0 if the queue is full or the frame
+// is empty or too long. The data buffer can be reused on return.
+//
+Uint16
+pam4_tx_send(const Uint16 *data, Uint16 nbytes)
+{
+    pam4_tx_frame_t *frame;
+    Uint16 next;
+    Uint16 i;
+
+    if(nbytes == 0 || nbytes > PAM4_TX_MAX_BYTES)
+    {
+        return 0;
+    }
+
+    next = Pam4Tx.tail + 1;
+    if(next == PAM4_TX_QUEUE_LEN)
+    {
+        next = 0;
+    }
+    if(next == Pam4Tx.head)
+    {
+        return 0;
+    }
+
+    frame = &Pam4Tx.queue[Pam4Tx.tail];
+    for(i = 0; i < nbytes; i++)
+    {
+        frame->data[i] = data[i] & 0x00FF;
+    }
+    frame->nsymbols = nbytes * 4;
+
+    //
+    // Publish the frame, then make sure the ISR is running
+    //
+    Pam4Tx.tail = next;
+    EPwm3Regs.ETSEL.bit.INTEN = 1;
+
+    return 1;
+}
+
+//
+// pam4_tx_free - Number of frames that can still be queued
+//
+Uint16
+pam4_tx_free(void)
+{
+    Uint16 used;
+
+    used = (Pam4Tx.tail + PAM4_TX_QUEUE_LEN - Pam4Tx.head) %
+           PAM4_TX_QUEUE_LEN;
+
+    return PAM4_TX_QUEUE_LEN - 1 - used;
+}
+
+//
+// pam4_tx_busy - 1 while frames are queued or being sent
+//
+Uint16
+pam4_tx_busy(void)
+{
+    return Pam4Tx.head != Pam4Tx.tail;
+}
+
+//
+// pam4_tx_isr - ISR for ePWM3 at CTR = 0
+//
+// The forces written by the previous call have just been loaded for the
+// symbol now on the line; write those of the following symbol. As in
+// manchester_tx_isr() the latency never moves a level change and the
+// ISR can give way to the sample ISR (IsrNest.h).
+//
+__interrupt void
+pam4_tx_isr(void)
+{
+    pam4_tx_t *tx = &Pam4Tx;
+    pam4_tx_frame_t *frame;
+    Uint16 pair, level;
+    Uint16 pieier;
+
+    ISR_LATENCY(&tx->isr, EPwm3Regs.TBCTR * 2);
+    pieier = isr_nest_enter(&tx->isr);
+    TRACE_ISR_ENTER(TRACE_SRC_TX);
+
+    if(tx->active && tx->symbol == tx->queue[tx->head].nsymbols)
+    {
+        tx->head++;
+        if(tx->head == PAM4_TX_QUEUE_LEN)
+        {
+            tx->head = 0;
+        }
+        tx->active = 0;
+        tx->frames_sent++;
+    }
+
+    if(!tx->active && tx->head != tx->tail)
+    {
+        tx->active = 1;
+        tx->symbol = 0;
+    }
+
+    if(tx->active)
+    {
+        //
+        // The first bit of the pair is the more significant one of the
+        // Gray code, which for two bits is its own inverse
+        //
+        frame = &tx->queue[tx->head];
+        pair  = frame->data[tx->symbol >> 2] >> ((tx->symbol & 3) << 1);
+        pair  = ((pair & 1) << 1) | ((pair >> 1) & 1);
+        level = pair ^ (pair >> 1);
+        EPwm3Regs.AQCSFRC.all = PAM4_TX_FORCE_LOW +
+                                ((level & 2) ? PAM4_TX_FORCE_A : 0) +
+                                ((level & 1) ? PAM4_TX_FORCE_B : 0);
+        tx->symbol++;
+    }
+    else
+    {
+        //
+        // Nothing left to send: level 0 from the next symbol on
+        //
+        EPwm3Regs.AQCSFRC.all = PAM4_TX_FORCE_LOW;
+        EPwm3Regs.ETSEL.bit.INTEN = 0;
+    }
+
+    EPwm3Regs.ETCLR.bit.INT = 1;
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP3;
+    TRACE_ISR_EXIT(TRACE_SRC_TX);
+    isr_nest_exit(&tx->isr, pieier);
+}
+
+//
+// End of File
+//
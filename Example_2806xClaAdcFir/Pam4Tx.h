@@ -0,0 +1,85 @@
+//###########################################################################
+//
+// FILE:   Pam4Tx.h
+//
+// TITLE:  ePWM3 PAM-4 transmitter through a two bit resistor DAC
+//
+//###########################################################################
+
+#ifndef PAM4_TX_H
+#define PAM4_TX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+#include "IsrNest.h"
+
+//
+// Defines
+//
+// The F28069 has no DAC pin, so the four levels come from EPWM3A (GPIO4)
+// and EPWM3B (GPIO5) summed by a resistor DAC into the receiver input:
+//
+//      EPWM3A --- R ----+
+//      EPWM3B --- 2R ---+---- ADCINA2
+//
+// EPWM3A is the high bit of the level, EPWM3B the low one, so the levels
+// are 0, 1/3, 2/3 and 3/3 of 3.3 V into a high impedance input. The
+// resistors need not be matched: the receiver learns the levels
+// (Pam4Rx.h). A symbol carries two bits, Gray coded as in Pam4Rx.h, the
+// first bit of a byte (its LSB) first.
+//
+// PAM4_TX_QUEUE_LEN is the number of frames that can be queued.
+// PAM4_TX_MAX_BYTES is the largest frame payload in bytes, one byte per
+// Uint16 word.
+//
+#define PAM4_TX_QUEUE_LEN       4
+#define PAM4_TX_MAX_BYTES       32
+
+//
+// Typedefs
+//
+typedef struct {
+    Uint16 data[PAM4_TX_MAX_BYTES];
+    Uint16 nsymbols;
+} pam4_tx_frame_t;
+
+typedef struct {
+    pam4_tx_frame_t queue[PAM4_TX_QUEUE_LEN];
+    volatile Uint16 head;       // next frame to send, ISR only
+    volatile Uint16 tail;       // next free slot, pam4_tx_send only
+    Uint16 active;              // a frame is being clocked out
+    Uint16 symbol;              // next symbol of the active frame
+    Uint16 symbol_period;       // TBPRD value, one symbol
+    Uint32 frames_sent;
+    isr_nest_t isr;             // level and latency of pam4_tx_isr
+} pam4_tx_t;
+
+//
+// Globals
+//
+extern pam4_tx_t Pam4Tx;
+
+//
+// Function Prototypes
+//
+void pam4_tx_init(Uint16 symbol_period);
+Uint16 pam4_tx_send(const Uint16 *data, Uint16 nbytes);
+Uint16 pam4_tx_free(void);
+Uint16 pam4_tx_busy(void);
+__interrupt void pam4_tx_isr(void);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of PAM4_TX_H definition
+
+//
+// End of File
+//
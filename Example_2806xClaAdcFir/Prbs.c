@@ -0,0 +1,120 @@
+//###########################################################################
+//
+// FILE:   Prbs.c
+//
+// TITLE:  PRBS-7 / PRBS-15 sequence generator and bit-error checker
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Prbs.h"
+
+//
+// One call per bit on both the transmit and the check side; run from
+// RAM in flash builds (Boot.h)
+//
+#pragma CODE_SECTION(prbs_next_bit, "ramfuncs");
+#pragma CODE_SECTION(prbs_checker_push, "ramfuncs");
+
+//
+// prbs_init - Seed the LFSR with all ones. Any non-zero seed works, all
+// ones is the conventional start of the sequence.
+//
+void
+prbs_init(prbs_t *prbs, Uint16 order)
+{
+    prbs->order = order;
+    prbs->mask  = (Uint16)((1UL << order) - 1);
+    prbs->state = prbs->mask;
+}
+
+//
+// prbs_next_bit - Advance the LFSR by one step and return the new bit
+//
+Uint16
+prbs_next_bit(prbs_t *prbs)
+{
+    Uint16 bit;
+
+    bit = ((prbs->state >> (prbs->order - 1)) ^
+           (prbs->state >> (prbs->order - 2))) & 0x0001;
+    prbs->state = ((prbs->state << 1) | bit) & prbs->mask;
+
+    return bit;
+}
+
+//
+// prbs_checker_init - Start a checker in the acquiring state
+//
+void
+prbs_checker_init(prbs_checker_t *chk, Uint16 order)
+{
+    prbs_init(&chk->ref, order);
+    chk->locked        = 0;
+    chk->fill          = 0;
+    chk->window_bits   = 0;
+    chk->window_errors = 0;
+    chk->bits          = 0;
+    chk->errors        = 0;
+    chk->resyncs       = 0;
+}
+
+//
+// prbs_checker_push - Feed one received bit to the checker
+//
+// While acquiring, the received bits are shifted straight into the
+// reference LFSR. After 'order' bits the reference holds the transmitter
+// state and every following bit can be predicted. Since the reference
+// only ever shifts in its own prediction, a single line error is counted
+// once and does not propagate.
+//
+void
+prbs_checker_push(prbs_checker_t *chk, Uint16 bit)
+{
+    prbs_t *ref = &chk->ref;
+
+    if(!chk->locked)
+    {
+        ref->state = ((ref->state << 1) | (bit & 0x0001)) & ref->mask;
+        chk->fill++;
+        if(chk->fill >= ref->order && ref->state != 0)
+        {
+            chk->locked        = 1;
+            chk->window_bits   = 0;
+            chk->window_errors = 0;
+        }
+        return;
+    }
+
+    if(prbs_next_bit(ref) != (bit & 0x0001))
+    {
+        chk->errors++;
+        chk->window_errors++;
+    }
+    chk->bits++;
+    chk->window_bits++;
+
+    if(chk->window_bits == PRBS_CHECK_WINDOW)
+    {
+        if(chk->window_errors > PRBS_CHECK_MAX_ERRORS)
+        {
+            //
+            // Sequence alignment lost, discard this window from the
+            // totals and re-acquire
+            //
+            chk->errors -= chk->window_errors;
+            chk->bits   -= chk->window_bits;
+            chk->locked  = 0;
+            chk->fill    = 0;
+            chk->resyncs++;
+        }
+        chk->window_bits   = 0;
+        chk->window_errors = 0;
+    }
+}
+
+//
+// End of File
+//
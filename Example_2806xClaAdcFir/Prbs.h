@@ -0,0 +1,76 @@
+//###########################################################################
+//
+// FILE:   Prbs.h
+//
+// TITLE:  PRBS-7 / PRBS-15 sequence generator and bit-error checker
+//
+//###########################################################################
+
+#ifndef PRBS_H
+#define PRBS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// Both sequences use a two-tap Fibonacci LFSR with taps at n and n-1:
+//      PRBS-7  : x^7  + x^6  + 1   (period 127)
+//      PRBS-15 : x^15 + x^14 + 1   (period 32767)
+//
+#define PRBS_ORDER_7            7
+#define PRBS_ORDER_15           15
+
+//
+// The checker counts errors over windows of PRBS_CHECK_WINDOW bits.
+// More than PRBS_CHECK_MAX_ERRORS errors in one window means the checker
+// is no longer aligned with the received sequence (bit slip or lost
+// decoder lock) and it will re-acquire from the incoming bits.
+//
+#define PRBS_CHECK_WINDOW       128
+#define PRBS_CHECK_MAX_ERRORS   32
+
+//
+// Typedefs
+//
+typedef struct {
+    Uint16 order;           // 7 or 15
+    Uint16 mask;            // (1 << order) - 1
+    Uint16 state;           // LFSR state, never zero
+} prbs_t;
+
+typedef struct {
+    prbs_t ref;             // local copy of the expected sequence
+    Uint16 locked;          // 1 once ref has been seeded from the line
+    Uint16 fill;            // bits shifted in while acquiring
+    Uint16 window_bits;     // bits checked in the current window
+    Uint16 window_errors;   // errors in the current window
+    Uint32 bits;            // total bits checked while locked
+    Uint32 errors;          // total bit errors while locked
+    Uint32 resyncs;         // number of times lock was lost
+} prbs_checker_t;
+
+//
+// Function Prototypes
+//
+void prbs_init(prbs_t *prbs, Uint16 order);
+Uint16 prbs_next_bit(prbs_t *prbs);
+void prbs_checker_init(prbs_checker_t *chk, Uint16 order);
+void prbs_checker_push(prbs_checker_t *chk, Uint16 bit);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of PRBS_H definition
+
+//
+// End of File
+//
@@ -26,7 +26,22 @@
 //! \b Watch \b Variables \n
 //!  - Xint1Count - XINT1 interrupt count
 //!  - Xint2Count - XINT2 interrupt count
-//!  - LoopCount  - idle loop count
+//!  - LoopCount  - idle loop count, one per wake up from IDLE
+//!  - BootUs     - start up time up to the idle loop
+//!  - Trace      - timestamped ISR entries and exits and the sample
+//!                 buffer fill (TRACE_ENABLE), read it with the
+//!                 debugger, see Trace.h
+//!  - ClkIsr, Xint1Isr - latency of the sample timer and XINT1 ISRs in
+//!                 cycles, last and worst case
+//!  - msg_data, msg_bits - bits of the last full sample buffer, packed
+//!                 16 to a word, the first bit in bit 0 (BufferDecode.c)
+//!
+//! The sample timer ISR has priority over XINT1: xint1_isr lets it in
+//! while it runs (IsrNest.h). Set ISR_LEVEL_XINT1 to 0 to compare the
+//! latencies with the default, non nesting, behaviour.
+//!
+//! The Flash configuration boots stand alone from flash, with the ISRs
+//! copied to RAM at start up (ramfuncs, see Boot.h).
 //
 //###########################################################################
 // $TI Release:  $
@@ -70,15 +85,46 @@
 #include "DSP28x_Project.h"     // Device Headerfile and Examples Include File
 #include "F2806x_Device.h"     // Headerfile Include File
 #include "F2806x_Examples.h"
+#include "Boot.h"
+#include "IsrNest.h"
+#include "Power.h"
+#include "Trace.h"
+#include "RateConfig.h"
+#include "BufferDecode.h"
 
 //
 // Define
 //
 #define DELAY (CPU_RATE/1000*6*510)  //Qual period at 6 samples
 #define GPIO_TOGGLE
-#define MSG_SIZE 80
 #define THRESHOLD 500
 
+//
+// The sample ISR keeps one bit per sample, the ADC result sliced at
+// THRESHOLD, in the packed message buffer (BitBuf.h): MSG_SIZE samples
+// take MSG_SIZE / 16 words, a 16 times longer window than one Uint32
+// per sample in half the RAM. MSG_BITS is the most bits one buffer
+// decodes to, at RATE_MIN_SAMPLES_PER_BIT.
+//
+#define MSG_SIZE 1280
+#define MSG_BITS (MSG_SIZE / RATE_MIN_SAMPLES_PER_BIT)
+
+//
+// Timer0 samples the ADC BIT_RATE * SAMPLES_PER_BIT times per second
+// (100 kHz). The period is worked out by rate_compute() (RateConfig.c)
+// in SYSCLKOUT cycles; a new rate can be requested at run time through
+// RateRequest and RateChangePending.
+//
+#define BIT_RATE 10000UL
+#define SAMPLES_PER_BIT 10
+
+//
+// Interrupt levels (IsrNest.h), both in PIE group 1. The Timer0 samples
+// come first, a level of 0 turns nesting off.
+//
+#define ISR_LEVEL_CLK   1
+#define ISR_LEVEL_XINT1 2
+
 //
 // Function Prototypes
 //
@@ -88,7 +134,15 @@ __interrupt void timerWIN_isr(void);
 void InitInterrupts(void);
 void ConfigMyTimer0(void);
 void configADC(void);
-Uint32 process_buffer(void);
+void process_buffer(void);
+Uint16 apply_rates(void);
+
+//
+// The ISRs run from RAM in the Flash configuration
+//
+#pragma CODE_SECTION(xint1_isr, "ramfuncs");
+#pragma CODE_SECTION(timerCLK_isr, "ramfuncs");
+#pragma CODE_SECTION(timerWIN_isr, "ramfuncs");
 
 //
 // Globals
@@ -96,10 +150,29 @@ Uint32 process_buffer(void);
 volatile Uint32 Xint1Count;
 volatile Uint32 timer1Count;
 volatile Uint32 buffer_full = 0;
-volatile Uint32 message[MSG_SIZE];
-volatile Uin32 msg_char = 0;
+volatile Uint16 message[BITVEC_WORDS(MSG_SIZE)];
+Uint16 msg_data[BITVEC_WORDS(MSG_BITS)];
+Uint16 msg_bits = 0;                 // bits decoded into msg_data
 Uint32 LoopCount;
 
+//
+// ClkIsr             level and latency of timerCLK_isr (TINT0)
+// Xint1Isr           level and latency of xint1_isr
+//
+isr_nest_t ClkIsr;
+isr_nest_t Xint1Isr;
+
+//
+// RateRequest        bit rate and samples per bit of the Timer0 sampling
+// RateConfig         timer period in use
+// RateStatus         result of the last request, RATE_OK if it was applied
+// RateChangePending  set to 1 to apply RateRequest
+//
+rate_request_t RateRequest;
+rate_config_t RateConfig;
+Uint16 RateStatus;
+volatile Uint16 RateChangePending = 0;
+
 
 //
 // Main
@@ -110,7 +183,7 @@ void main(void)
     Uint32 i = 0;
 
     //zeroing aux array
-    for(i=0;i<MSG_SIZE;i++)
+    for(i=0;i<BITVEC_WORDS(MSG_SIZE);i++)
     {
         message[i] = 0;
     }
@@ -122,6 +195,14 @@ void main(void)
     //
     InitSysCtrl();
 
+    //
+    // InitCpuTimers() resets CPU timer 2, so it goes before the boot
+    // timer is started. boot_start() copies the RAM functions and sets
+    // up the flash in the Flash build.
+    //
+    InitCpuTimers();
+    boot_start();
+
     //
     // Step 2. Initalize GPIO:
     // This example function is found in the F2806x_Gpio.c file and
@@ -143,8 +224,13 @@ void main(void)
     // This function is found in the F2806x_PieCtrl.c file.
     //
     InitPieCtrl();
-    InitCpuTimers();
-    ConfigCpuTimer(&CpuTimer0, 22.5, 10);
+    ConfigCpuTimer(&CpuTimer0, 90, 10);
+    RateRequest.bit_rate        = BIT_RATE;
+    RateRequest.samples_per_bit = SAMPLES_PER_BIT;
+    RateRequest.sample_clock    = RATE_CLOCK_CPU_TIMER;
+    RateRequest.adc_socs        = 1;
+    RateRequest.sci_baud        = 0;
+    RateStatus = apply_rates();
     ConfigCpuTimer(&CpuTimer1, 22.5, 300);
     InitAdc();  // For this example, init the ADC
     AdcOffsetSelfCal();
@@ -164,6 +250,7 @@ void main(void)
     // This function is found in F2806x_PieVect.c.
     //
     InitPieVectTable();
+    TRACE_INIT();
     InitInterrupts();
     //
     // Step 4. Initialize all the Device Peripherals:
@@ -186,15 +273,24 @@ void main(void)
     Xint1Count = 0;     // Count XINT1 interrupts
     timer1Count = 0;    //dummy variable to check timer1 CLK manchester
     LoopCount = 0;      // Count times through idle loop
-    sample = 0;
-
 
+    boot_done();
     for(;;)
     {
         //just to see if interruption is triggereed
         //GpioDataRegs.GPBSET.bit.GPIO32 = 1; // Lower GPIO32, trigger XINT1
         if(timer1Count >= MSG_SIZE) timer1Count = 0;
-        if(buffer_full) msg_char = process_buffer();
+        if(buffer_full) process_buffer();
+        if(RateChangePending)
+        {
+            RateStatus = apply_rates();
+            RateChangePending = 0;
+        }
+
+        //
+        // Sleep until the next sample or edge interrupt
+        //
+        power_idle();
         LoopCount++;
 
     }
@@ -208,35 +304,83 @@ void main(void)
 __interrupt void
 xint1_isr(void)
 {
-    GpioDataRegs.GPATOGGLE.bit.GPIO3= 1
+    Uint16 pieier;
+
+    //
+    // XINT1CTR counts SYSCLKOUT cycles from the edge
+    //
+    ISR_LATENCY(&Xint1Isr, XIntruptRegs.XINT1CTR);
+    pieier = isr_nest_enter(&Xint1Isr);
+    TRACE_ISR_ENTER(TRACE_SRC_XINT1);
+    GpioDataRegs.GPATOGGLE.bit.GPIO3= 1;
     Xint1Count++;
     CpuTimer0Regs.TCR.bit.TSS = 0; //start timer
     //
     // Acknowledge this interrupt to get more from group 1
     //
     PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+    TRACE_ISR_EXIT(TRACE_SRC_XINT1);
+    isr_nest_exit(&Xint1Isr, pieier);
 }
 
 __interrupt void timerCLK_isr(void)
 {
+    Uint16 pieier;
+
+    //
+    // Timer0 reloaded PRD when it interrupted and counts down since
+    //
+    ISR_LATENCY(&ClkIsr, (Uint16)(CpuTimer0Regs.PRD.all -
+                                  CpuTimer0Regs.TIM.all));
+    pieier = isr_nest_enter(&ClkIsr);
+    TRACE_ISR_ENTER(TRACE_SRC_TIMER0);
 
     GpioDataRegs.GPATOGGLE.bit.GPIO4= 1;
     AdcRegs.ADCSOCFRC1.bit.SOC0 = 1; //start conversion
     //sample = AdcResult.ADCRESULT0;
-    message[timer1Count] = AdcResult.ADCRESULT0;
+    BITVEC_PUT(message, timer1Count, AdcResult.ADCRESULT0 > THRESHOLD);
     timer1Count++;
     if(timer1Count == MSG_SIZE) buffer_full = 1;
+    TRACE(TRACE_FIFO, TRACE_SRC_TIMER0, timer1Count);
 
 
     //
     // Acknowledge this interrupt to receive more interrupts from group 1
     //
     PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+    TRACE_ISR_EXIT(TRACE_SRC_TIMER0);
+    isr_nest_exit(&ClkIsr, pieier);
 }
 
 __interrupt void timerWIN_isr(void)
 {
+    TRACE_ISR_ENTER(TRACE_SRC_TIMER1);
     CpuTimer0Regs.TCR.bit.TSS = 1; //stop timer
+    TRACE_ISR_EXIT(TRACE_SRC_TIMER1);
+}
+
+//
+// apply_rates - Set the Timer0 sample period from RateRequest
+//
+// Timer0 keeps running, the new period takes effect right away. The
+// current period is kept if the request is rejected.
+//
+Uint16
+apply_rates(void)
+{
+    rate_config_t cfg;
+    Uint16 status;
+
+    status = rate_compute(&RateRequest, &cfg);
+    if(status != RATE_OK)
+    {
+        return status;
+    }
+
+    rate_apply_cpu_timer(&CpuTimer0, cfg.timer_period);
+    RateConfig = cfg;
+
+    return RATE_OK;
 }
 
 void InitInterrupts(void)
@@ -256,6 +400,8 @@ void InitInterrupts(void)
     PieCtrlRegs.PIECTRL.bit.ENPIE = 1;          // Enable the PIE block
     PieCtrlRegs.PIEIER1.bit.INTx4 = 1;          // Enable PIE Group 1 INT4 (XINT1)
     PieCtrlRegs.PIEIER1.bit.INTx7 = 1;          // Enable PIE Group 1 INT7 (timer)
+    isr_nest_add(&ClkIsr, 1, 7, ISR_LEVEL_CLK);
+    isr_nest_add(&Xint1Isr, 1, 4, ISR_LEVEL_XINT1);
     IER |= M_INT1;                              // Enable CPU INT1
     EINT;                                       // Enable Global Interrupts
 
@@ -340,25 +486,15 @@ void configADC(void)
     EDIS;
 }
 
-Uint32 process_buffer(void)
+//
+// process_buffer - Decode the full sample buffer (BufferDecode.c) into
+// msg_data
+//
+void process_buffer(void)
 {
-    Uint32 i = 0;
-    Uint32 result = 0;
-    Uint32 sample = 0;
-    Uint32 last_sample = 0;
-
-    for(i=1; i < MSG_SIZE; i++)
-    {
-        sample = message[i];
-        last_sample = message[i-1]
-        if(sample > THRESHOLD && last_sample < THRESHOLD && sample < last_sample )
-            result << 0;
-        else
-        if(sample > THRESHOLD && last_sample < THRESHOLD && sample > last_sample)
-            result << 1;
-    }
-    //write code
-
+    msg_bits = buffer_decode(message, MSG_SIZE,
+                             RateConfig.req.samples_per_bit, msg_data,
+                             MSG_BITS);
     buffer_full = 0;
 }
 
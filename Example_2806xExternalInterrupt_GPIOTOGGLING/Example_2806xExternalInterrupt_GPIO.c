@@ -26,7 +26,13 @@
 //! \b Watch \b Variables \n
 //!  - Xint1Count - XINT1 interrupt count
 //!  - Xint2Count - XINT2 interrupt count
-//!  - LoopCount  - idle loop count
+//!  - LoopCount  - idle loop count, one per wake up from IDLE
+//!  - BootUs     - start up time up to the idle loop
+//!  - Trace      - timestamped ISR entries and exits (TRACE_ENABLE),
+//!                 read it with the debugger, see Trace.h
+//!
+//! The Flash configuration boots stand alone from flash, with the ISRs
+//! copied to RAM at start up (ramfuncs, see Boot.h).
 //
 //###########################################################################
 // $TI Release:  $
@@ -70,6 +76,10 @@
 #include "DSP28x_Project.h"     // Device Headerfile and Examples Include File
 #include "F2806x_Device.h"     // Headerfile Include File
 #include "F2806x_Examples.h"
+#include "Boot.h"
+#include "Power.h"
+#include "Trace.h"
+#include "XintBits.h"
 
 //
 // Define
@@ -85,6 +95,12 @@ __interrupt void xint1_isr(void);
 __interrupt void xint2_isr(void);
 void InitInterrupts(void);
 
+//
+// The ISRs run from RAM in the Flash configuration
+//
+#pragma CODE_SECTION(xint1_isr, "ramfuncs");
+#pragma CODE_SECTION(xint2_isr, "ramfuncs");
+
 //
 // Globals
 //
@@ -119,6 +135,12 @@ void main(void)
     //
     InitSysCtrl();
 
+    //
+    // Copy the RAM functions and set up the flash (Flash build), start
+    // timing the boot
+    //
+    boot_start();
+
     //
     // Step 2. Initalize GPIO:
     // This example function is found in the F2806x_Gpio.c file and
@@ -155,6 +177,7 @@ void main(void)
     // This function is found in F2806x_PieVect.c.
     //
     InitPieVectTable();
+    TRACE_INIT();
     InitInterrupts();
     //
     // Step 4. Initialize all the Device Peripherals:
@@ -176,11 +199,16 @@ void main(void)
     //
 
 
-
+    boot_done();
     for(;;)
     {
         //just to see if interruption is triggereed
         //GpioDataRegs.GPBSET.bit.GPIO32 = 1; // Lower GPIO32, trigger XINT1
+
+        //
+        // Everything happens in the XINT ISRs, sleep until the next edge
+        //
+        power_idle();
         LoopCount++;
 
     }
@@ -194,18 +222,19 @@ void main(void)
 __interrupt void
 xint1_isr(void)
 {
+    TRACE_ISR_ENTER(TRACE_SRC_XINT1);
 
     //GpioDataRegs.GPATOGGLE.bit.GPIO4= 1;
 
     GpioDataRegs.GPATOGGLE.bit.GPIO4 = 1;
-    var_char = var_char << 1; //appends 0 to var char
-    var_char |= 1; //transforms appended 0 to 1
+    var_char = XINT_BITS_PUSH(var_char, XINT_BIT_RISING);
 
     Xint1Count++;
     //
     // Acknowledge this interrupt to get more from group 1
     //
     PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+    TRACE_ISR_EXIT(TRACE_SRC_XINT1);
 }
 
 
@@ -213,13 +242,15 @@ xint1_isr(void)
 __interrupt void
 xint2_isr(void)
 {
+    TRACE_ISR_ENTER(TRACE_SRC_XINT2);
     GpioDataRegs.GPATOGGLE.bit.GPIO3= 1;
-    var_char = var_char << 1; //apends 0 to var_char
+    var_char = XINT_BITS_PUSH(var_char, XINT_BIT_FALLING);
     Xint2Count++;
     //
     // Acknowledge this interrupt to get more from group 1
     //
     PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+    TRACE_ISR_EXIT(TRACE_SRC_XINT2);
 }
 
 
@@ -0,0 +1,42 @@
+//###########################################################################
+//
+// FILE:   XintBits.h
+//
+// TITLE:  Bit assembly of the XINT1/XINT2 edge interrupts
+//
+//###########################################################################
+
+#ifndef XINT_BITS_H
+#define XINT_BITS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// Every edge on the line shifts one bit into the word, the first one
+// ends up in the MSB: XINT1 (GPIO0, rising) shifts in a 1 and XINT2
+// (GPIO1, falling) a 0. The host test harness (host/golden.c) builds
+// the same words from its waveforms with this macro.
+//
+#define XINT_BIT_RISING         1
+#define XINT_BIT_FALLING        0
+
+#define XINT_BITS_PUSH(w, bit)  (((w) << 1) | (bit))
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of XINT_BITS_H definition
+
+//
+// End of File
+//
@@ -42,6 +42,18 @@
 //!  \b Watch \b Variables \n
 //!  - \b LoopCount, for the number of characters sent
 //!  - ErrorCount
+//!  - BootUs, start up time up to the SCIB link negotiation
+//!  - Trace, last scib_isr events (TRACE_ENABLE)
+//!  - ScibIsr, scib_isr latency in cycles, last and worst case (IsrNest.h)
+//!
+//!  The Flash configuration boots stand alone from flash; scib_isr runs
+//!  from RAM (ramfuncs, see Boot.h). The boot time is printed with the
+//!  greeting.
+//!
+//!  Built with TRACE_ENABLE=1 (Trace.h), scib_isr logs its entry, exit
+//!  and receive FIFO level in the Trace ring. A FIFO overflow freezes the
+//!  ring and the main loop prints it on the console for
+//!  host/isr_timeline.py.
 //!
 //! \b External \b Connections \n
 //!  Connect the SCI-A port to a PC via a transceiver and cable.
@@ -89,39 +101,48 @@
 //
 #include "DSP28x_Project.h"     // Device Headerfile and Examples Include File
 #include <stdint.h>
+#include "BitBuf.h"
+#include "Boot.h"
+#include "IsrNest.h"
+#include "ManchesterWord.h"
+#include "RateConfig.h"
+#include "SciBaud.h"
+#include "Trace.h"
 
 //defines to activate certain functions
 #define GPIO_TOGGLE //configs and toggles gpio for monitoring
 
-//these values are for a 100'000 baud rat e (#todo verify this)
-//#define LOW_DATA_RATE_REG 0x001c
-//#define HIGH_DATA_RATE_REG 0x0000
-
-//these values are for a 200'000 baud rate
-#define LOW_DATA_RATE_REG 0x000d
-#define HIGH_DATA_RATE_REG 0x0000
-
-//these values are test values for 9600 bps
-//#define HIGH_DATA_RATE_REG 0x0001;
-//#define LOW_DATA_RATE_REG 0x0024;
-
-//these values are test values for 115 200 bps
-//#define HIGH_DATA_RATE_REG 0x0000
-//#define LOW_DATA_RATE_REG 0x0017
-
-//thse values are the test values for 937 500 bps (aprox. 1 MHz)
-//#define HIGH_DATA_RATE_REG 0x0000
-//#define LOW_DATA_RATE_REG 0x0002
-
+//baud rate of the SCIB link between the MCUs at start up
+//the BRR register value is worked out by rate_sci_brr() (RateConfig.c),
+//BRR = LSPCLK / (baud * 8) - 1 with LSPCLK = 22.5 MHz
+//200 000 bps -> 0x000d, 100 000 bps -> 0x001c, 9600 bps -> 0x0124,
+//937 500 bps (aprox. 1 MHz) -> 0x0002
+//it can be changed at run time by writing ScibBaudRequest
+#define SCIB_BAUD 200000UL
+
+//set SCIB_AUTOBAUD to 1 to lock onto the remote rate and negotiate the
+//fastest error free rate at start up (SciBaud.c). Each board then needs
+//its role in its own build configuration, there is no default: one is
+//built with SCIB_ROLE=SCI_BAUD_INITIATOR (starts at SCIB_BAUD), the
+//other with SCIB_ROLE=SCI_BAUD_RESPONDER (follows the remote rate).
+//Without an answer within SCIB_LINK_TIMEOUT_US, or after
+//SCIB_LINK_TRIES failed negotiations, the link stays at SCIB_BAUD
+#define SCIB_AUTOBAUD 0
+#define SCIB_LINK_TIMEOUT_US 5000000UL
+#define SCIB_LINK_TRIES 3
+
+#if SCIB_AUTOBAUD && !defined(SCIB_ROLE)
+#error "SCIB_AUTOBAUD needs SCIB_ROLE set per board (SCI_BAUD_INITIATOR or SCI_BAUD_RESPONDER)"
+#endif
 
-//utilize these defines to control the data rate of the console-pc application
-//for now it is 115 200 bps
-#define CONSOLE_HIGH_DATA_RATE_REG 0x0000
-#define CONSOLE_LOW_DATA_RATE_REG  0x0017
+//utilize this define to control the data rate of the console-pc application
+//for now it is 115 200 bps (0x0017)
+#define CONSOLE_BAUD 115200UL
 
-//define max length of word buffer
+//define max length of word buffer in bytes
 //raw buffer, that is, its lenght is 2x the manchester words
-#define MAX_LEN 50
+//the bytes are packed two to a word (BitBuf.h), MAX_LEN / 2 words
+#define MAX_LEN 100
 
 //
 // Function Prototypes
@@ -133,7 +154,10 @@ void scib_fifo_init(void);
 void scia_xmit(int a);
 void scia_msg(char *msg);
 void show_init_msg();
+Uint16 scib_set_baud(Uint32 baud);
+void scib_link_up(void);
 __interrupt void scib_isr(void);
+void scia_msg_u32(Uint32 v);
 
 
 #ifdef GPIO_TOGGLE
@@ -141,19 +165,38 @@ void init_gpio_toggle();
 void gpio0_toggle();
 #endif
 
-Uint32 encode_manchester(Uint32 input);
-Uint32 decode_manchester(Uint32 input);
 Uint32 wrap_manchester_symbol(char lsb, char msb);
 
 //
 // Globals
 //
 //
-char arraymessage[MAX_LEN]; //stores raw bits received
+Uint16 arraymessage[BYTEBUF_WORDS(MAX_LEN)]; //stores raw bytes received
 Uint32 symbol_handler_flag = 0x0000;
 Uint32 msg_handler_flag = 0x0000;
 Uint32 dummy = 0;
 
+//ScibBaud         baud rate in use on SCIB
+//ScibBaudRequest  write a new baud rate here to change SCIB at run time
+//ScibBaudStatus   result of the last change, RATE_OK if it was applied
+Uint32 ScibBaud = SCIB_BAUD;
+volatile Uint32 ScibBaudRequest = 0;
+Uint16 ScibBaudStatus = RATE_OK;
+
+//ScibIsr         latency of scib_isr, scib_isr is the only interrupt and
+//                never nests
+//ScibCharCycles  SYSCLKOUT cycles per SCIB character at ScibBaud
+isr_nest_t ScibIsr;
+Uint32 ScibCharCycles = 10 * RATE_SYSCLK_HZ / SCIB_BAUD;
+
+//ScibLink  auto-baud and negotiation state, see SciBaud.h
+#if SCIB_AUTOBAUD
+sci_baud_t ScibLink;
+#endif
+
+//runs from RAM in the Flash build configuration
+#pragma CODE_SECTION(scib_isr, "ramfuncs");
+
 // Main
 //
 void main(void)
@@ -162,7 +205,7 @@ void main(void)
     Uint32 i;
 
     //zeroing the array
-    for(i = 0; i < MAX_LEN; i++)
+    for(i = 0; i < BYTEBUF_WORDS(MAX_LEN); i++)
     {
         arraymessage[i] = 0;
     }
@@ -174,6 +217,12 @@ void main(void)
     //
     InitSysCtrl();
 
+    //
+    // Copy the RAM functions and set up the flash (Flash build), start
+    // timing the boot
+    //
+    boot_start();
+
     //
     // Step 2. Initalize GPIO:
     // This example function is found in the F2806x_Gpio.c file and
@@ -217,6 +266,7 @@ void main(void)
     // This function is found in F2806x_PieVect.c.
     //
     InitPieVectTable();
+    TRACE_INIT();
     EnableInterrupts();
     //
     // Step 4. Initialize all the Device Peripherals:
@@ -230,6 +280,7 @@ void main(void)
     //Set Interrupt of SCIB RX
     PieCtrlRegs.PIECTRL.bit.ENPIE = 1;   // Enable the PIE block
     PieCtrlRegs.PIEIER9.bit.INTx3=1;     // PIE Group 9, INTx3
+    isr_nest_add(&ScibIsr, 9, 3, 0);
     IER = 0x100;                         // Enable CPU INT
 
     //
@@ -239,6 +290,10 @@ void main(void)
     //scib_fifo_init();
     scia_echoback_init();  // Initalize SCI for console messaging
     scib_echoback_init();  // Initalize SCI for MCU communication
+    boot_done();           // the link negotiation is not part of the boot
+#if SCIB_AUTOBAUD
+    scib_link_up();        // Lock and negotiate the SCIB rate
+#endif
     show_init_msg();
 
 #ifdef GPIO_TOGGLE
@@ -248,6 +303,22 @@ void main(void)
 
     for(;;)
     {
+        if(ScibBaudRequest != 0)
+        {
+            ScibBaudStatus = scib_set_baud(ScibBaudRequest);
+            ScibBaudRequest = 0;
+        }
+#if TRACE_ENABLE
+        //
+        // scib_isr froze the trace on a receive FIFO overflow, print it
+        // on the console and start again
+        //
+        if(!Trace.on)
+        {
+            trace_dump_sci(&SciaRegs);
+            trace_init();
+        }
+#endif
         /*
         DELAY_US(1000000);
         scia_msg("\r\n I am on the loop!\0");
@@ -263,6 +334,8 @@ void main(void)
 void
 scia_echoback_init()
 {
+    Uint16 brr;
+
     //
     // Note: Clocks were turned on to the SCIA peripheral
     // in the InitSysCtrl() function
@@ -286,12 +359,12 @@ scia_echoback_init()
     // 115 200 baud @LSPCLK = 22.5MHz (90 MHz SYSCLK)
     //
 
-   //SciaRegs.SCIHBAUD    =0x0000;
-    //SciaRegs.SCILBAUD    =0x0017;
-
     //confid baud rate
-    SciaRegs.SCIHBAUD    = CONSOLE_HIGH_DATA_RATE_REG;
-    SciaRegs.SCILBAUD   = CONSOLE_LOW_DATA_RATE_REG;
+    if(rate_sci_brr(CONSOLE_BAUD, &brr) != RATE_OK)
+    {
+        ESTOP0;
+    }
+    rate_apply_sci(&SciaRegs, brr);
 
     SciaRegs.SCICTL1.all =0x0023;  // Relinquish SCI from Reset
 }
@@ -300,6 +373,13 @@ scia_echoback_init()
 void
 scib_echoback_init()
 {
+    Uint16 brr;
+
+    if(rate_sci_brr(ScibBaud, &brr) != RATE_OK)
+    {
+        ESTOP0;
+    }
+
     //
         // 1 stop bit,  No loopback, No parity,8 char bits, async mode,
         // idle-line protocol
@@ -312,8 +392,7 @@ scib_echoback_init()
         ScibRegs.SCICTL1.all =0x0003;
         ScibRegs.SCICTL2.bit.TXINTENA =1;
         ScibRegs.SCICTL2.bit.RXBKINTENA =1;
-        ScibRegs.SCIHBAUD = HIGH_DATA_RATE_REG;
-        ScibRegs.SCILBAUD = LOW_DATA_RATE_REG;
+        rate_apply_sci(&ScibRegs, brr);
         ScibRegs.SCICCR.bit.LOOPBKENA =0;   // Enable loop back
         ScibRegs.SCIFFTX.all=0xC022;
         ScibRegs.SCIFFRX.all=0x0022;
@@ -324,6 +403,89 @@ scib_echoback_init()
         ScibRegs.SCIFFRX.bit.RXFIFORESET=1;
 }
 
+//
+// scib_set_baud - Change the SCIB baud rate at run time
+//
+// Waits for the transmitter to drain so no character is sent at two
+// rates. The receiver is not synchronised, the other end has to switch
+// between frames too. The old rate is kept if baud can not be set
+// within RATE_MAX_SCI_ERROR_PPM.
+//
+Uint16
+scib_set_baud(Uint32 baud)
+{
+    Uint16 brr;
+    Uint16 status;
+
+    status = rate_sci_brr(baud, &brr);
+    if(status != RATE_OK)
+    {
+        return status;
+    }
+
+    while(ScibRegs.SCIFFTX.bit.TXFFST != 0 || !ScibRegs.SCICTL2.bit.TXEMPTY)
+    {
+    }
+    rate_apply_sci(&ScibRegs, brr);
+    ScibBaud = baud;
+    ScibCharCycles = 10 * RATE_SYSCLK_HZ / baud;
+
+    return RATE_OK;
+}
+
+#if SCIB_AUTOBAUD
+//
+// scib_link_up - Lock onto the remote SCIB rate and step up to the
+// fastest rate that passes the negotiation test. A failed negotiation
+// locks again, up to SCIB_LINK_TRIES times. No remote end within
+// SCIB_LINK_TIMEOUT_US, or no agreement, leaves the link at SCIB_BAUD so
+// the board still boots. The SCIB receive interrupt is held off
+// meanwhile, the negotiation polls the FIFO.
+//
+void
+scib_link_up(void)
+{
+    Uint16 status = SCI_BAUD_ERR_LINK;
+    Uint16 tries;
+
+    ScibRegs.SCIFFRX.bit.RXFFIENA = 0;
+    sci_baud_init(&ScibLink, &ScibRegs, SCIB_ROLE, ScibBaud);
+
+    for(tries = 0; tries < SCIB_LINK_TRIES; tries++)
+    {
+        status = sci_baud_lock(&ScibLink, SCIB_LINK_TIMEOUT_US);
+        if(status != SCI_BAUD_OK)
+        {
+            break;
+        }
+        status = sci_baud_negotiate(&ScibLink);
+        if(status == SCI_BAUD_OK)
+        {
+            break;
+        }
+    }
+
+    if(status == SCI_BAUD_OK)
+    {
+        ScibBaud = ScibLink.baud;
+        ScibCharCycles = 10 * RATE_SYSCLK_HZ / ScibBaud;
+    }
+    else
+    {
+        scib_set_baud(SCIB_BAUD);
+    }
+
+    ScibRegs.SCIFFRX.bit.RXFIFORESET = 0;
+    ScibRegs.SCIFFRX.bit.RXFIFORESET = 1;
+    ScibRegs.SCIFFRX.bit.RXFFINTCLR  = 1;
+    ScibRegs.SCIFFRX.bit.RXFFIENA    = 1;
+
+    scia_msg(status == SCI_BAUD_OK ? "\r\n SCIB link up at \0" :
+                                     "\r\n SCIB link not negotiated, at \0");
+    scia_msg_u32(ScibBaud);
+}
+#endif
+
 //
 // scia_xmit - Transmit a character from the SCI
 //
@@ -423,60 +585,6 @@ void gpio0_toggle()
 
 #endif
 
-Uint32 encode_manchester(Uint32 input)
-{
-    Uint32 clk_mask = 0xAAAA; //clock mask
-    Uint32 filter_mask = 0x00FF; //to filter first 8 bits
-    Uint32 bit_iterator = 0x0001;
-    Uint32 aux = input & filter_mask; //filters the first 8 bits
-    Uint32 result = 0x0000;
-    Uint32 i = 0;
-
-    while( i < 7)
-    {
-        //filters the bit;
-        if(aux & (bit_iterator << i))
-        {
-            result = result << 2; //appends 2 0s to result
-            result |= 0x03; //converts 0s to two 1s to result;
-        }
-        else
-        {
-            result = result << 2; //appends 2 0s to result
-        }
-        i++;
-    }
-
-    result = result ^ clk_mask; // apply xor op with clk
-
-    return result;
-}
-
-Uint32 decode_manchester(Uint32 input)
-{
-    Uint32 filter_mask = 0xFFFF; //to filter first 16 bits
-    Uint32 mask_for_1 = 0x0001;
-    Uint32 aux = input & filter_mask; //filters the first 16 bits
-    Uint32 iterator_2_bits = 0x0003;
-    Uint32 result = 0x0000;
-    Uint32 i = 0;
-
-    while(i < 7)
-    {
-        if((aux & (iterator_2_bits << 2*i)) & (mask_for_1 << 2*i))
-        {
-            result = result << 1; //append 0 to result
-            result |= 1; //transforms appended 0 into 1
-        }
-        else
-        {
-            result = result << 1; //append 0 to result
-        }
-        i++;
-    }
-    return result;
-}
-
 void show_init_msg()
 {
     char *local_msg;
@@ -487,19 +595,67 @@ void show_init_msg()
     scia_msg(local_msg);
     local_msg = "\r\n Author: Felipe Loose\0";
     scia_msg(local_msg);
+    local_msg = "\r\n Boot time (us): \0";
+    scia_msg(local_msg);
+    scia_msg_u32(BootUs);
     local_msg = "\r\n======\0";
     scia_msg(local_msg);
 }
 
+//
+// scia_msg_u32 - Send v in decimal
+//
+void
+scia_msg_u32(Uint32 v)
+{
+    char digits[11];
+    Uint16 n = 0;
+
+    do
+    {
+        digits[n++] = '0' + (char)(v % 10);
+        v /= 10;
+    } while(v != 0);
+
+    while(n != 0)
+    {
+        scia_xmit(digits[--n]);
+    }
+}
+
 __interrupt void scib_isr(void)
 {
     //tracks position of buffer
     static Uint32 pos = 0;
+    Uint32 late = 0;
+#if TRACE_ENABLE
+    Uint16 overflow;
+#endif
 
+    //
+    // The interrupt came at RXFFIL characters, every one above that
+    // arrived while it was pending. A lower bound, the time into the
+    // current character is not known.
+    //
+    if(ScibRegs.SCIFFRX.bit.RXFFST > ScibRegs.SCIFFRX.bit.RXFFIL)
+    {
+        late = (ScibRegs.SCIFFRX.bit.RXFFST - ScibRegs.SCIFFRX.bit.RXFFIL) *
+               ScibCharCycles;
+    }
+    ISR_LATENCY(&ScibIsr, late > 0xFFFF ? 0xFFFF : (Uint16)late);
+#if TRACE_ENABLE
+    TRACE_ISR_ENTER(TRACE_SRC_SCIB);
+    TRACE(TRACE_FIFO, TRACE_SRC_SCIB, ScibRegs.SCIFFRX.bit.RXFFST);
+    overflow = ScibRegs.SCIFFRX.bit.RXFFOVF;
+    if(overflow)
+    {
+        TRACE(TRACE_OVERRUN, TRACE_SRC_SCIB, 1);
+    }
+#endif
 
-    arraymessage[pos] = ScibRegs.SCIRXBUF.all;
+    BYTEBUF_PUT(arraymessage, pos, ScibRegs.SCIRXBUF.all);
     pos++;
-    arraymessage[pos] = ScibRegs.SCIRXBUF.all;
+    BYTEBUF_PUT(arraymessage, pos, ScibRegs.SCIRXBUF.all);
     pos++;
 
     if (pos == MAX_LEN)
@@ -511,6 +667,14 @@ __interrupt void scib_isr(void)
     ScibRegs.SCIFFRX.bit.RXFFINTCLR=1;   // Clear Interrupt flag
     PieCtrlRegs.PIEACK.all|=0x100;       // Issue PIE ack
     dummy++; //To check breakpoint and number of interrupts
+
+#if TRACE_ENABLE
+    TRACE_ISR_EXIT(TRACE_SRC_SCIB);
+    if(overflow)
+    {
+        TRACE_FREEZE();
+    }
+#endif
 }
 
 
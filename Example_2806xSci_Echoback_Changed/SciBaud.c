@@ -0,0 +1,351 @@
+//###########################################################################
+//
+// FILE:   SciBaud.c
+//
+// TITLE:  SCI auto-baud lock and baud rate negotiation
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "SciBaud.h"
+
+//
+// Globals
+//
+const Uint32 SciBaudLadder[] = {
+    9600, 19200, 57600, 115200, 200000, 312500, 468750, 703125, 937500
+};
+const Uint16 SciBaudLadderLen = sizeof(SciBaudLadder) / sizeof(Uint32);
+
+//
+// Test bytes sent at every new rate: all bit positions in both
+// polarities, long runs and fast toggles
+//
+static const Uint16 SciBaudTest[SCI_BAUD_TEST_LEN] = {
+    0x55, 0xAA, 0x00, 0xFF, 0x0F, 0xF0, 0x33, 0xCC,
+    0x01, 0x80, 0x7E, 0x81, 0x3C, 0xC3, 0x5A, 0xA5
+};
+
+//
+// sci_baud_putc - Send one byte, waiting for room in the FIFO
+//
+static void
+sci_baud_putc(sci_baud_t *sb, Uint16 c)
+{
+    while(sb->regs->SCIFFTX.bit.TXFFST != 0)
+    {
+    }
+    sb->regs->SCITXBUF = c & 0x00FF;
+}
+
+//
+// sci_baud_getc - Wait up to timeout_us for one byte
+//
+// Returns 1 with the byte in *c, 0 on timeout or on a receive error
+// (break, framing, overrun), which is what a wrong rate looks like. The
+// SCI is reset after an error so it can receive again.
+//
+static Uint16
+sci_baud_getc(sci_baud_t *sb, Uint16 *c, Uint32 timeout_us)
+{
+    for(;;)
+    {
+        if(sb->regs->SCIRXST.bit.RXERROR)
+        {
+            sb->regs->SCICTL1.bit.SWRESET = 0;
+            sb->regs->SCICTL1.bit.SWRESET = 1;
+            sb->regs->SCIFFRX.bit.RXFIFORESET = 0;
+            sb->regs->SCIFFRX.bit.RXFIFORESET = 1;
+            return 0;
+        }
+        if(sb->regs->SCIFFRX.bit.RXFFST != 0)
+        {
+            *c = sb->regs->SCIRXBUF.all & 0x00FF;
+            return 1;
+        }
+        if(timeout_us < SCI_BAUD_POLL_US)
+        {
+            return 0;
+        }
+        DELAY_US(SCI_BAUD_POLL_US);
+        timeout_us -= SCI_BAUD_POLL_US;
+    }
+}
+
+//
+// sci_baud_switch - Change rate once the last byte has left the shifter
+//
+static void
+sci_baud_switch(sci_baud_t *sb, Uint16 brr, Uint32 baud)
+{
+    while(sb->regs->SCIFFTX.bit.TXFFST != 0 || !sb->regs->SCICTL2.bit.TXEMPTY)
+    {
+    }
+    rate_apply_sci(sb->regs, brr);
+    sb->brr  = brr;
+    sb->baud = baud;
+
+    sb->regs->SCIFFRX.bit.RXFIFORESET = 0;
+    sb->regs->SCIFFRX.bit.RXFIFORESET = 1;
+}
+
+//
+// sci_baud_init - Set the role and the rate the SCI is running at
+//
+// Call after the SCI and its FIFO are configured. The FIFO enhancements
+// (SCIFFENA) must be on for the auto-baud hardware. The receive FIFO
+// interrupt has to stay off while the lock and negotiation run, they
+// poll the FIFO.
+//
+void
+sci_baud_init(sci_baud_t *sb, volatile struct SCI_REGS *regs, Uint16 role,
+              Uint32 baud)
+{
+    sb->regs         = regs;
+    sb->role         = role;
+    sb->baud         = baud;
+    sb->brr          = (regs->SCIHBAUD << 8) | (regs->SCILBAUD & 0x00FF);
+    sb->steps_ok     = 0;
+    sb->steps_failed = 0;
+}
+
+//
+// sci_baud_lock - Bring both ends to the same rate
+//
+// Initiator: sends 'A' at its own rate every SCI_BAUD_BEACON_US until
+// the responder answers 'A'.
+// Responder: arms the ABD hardware, which measures the 'A' start bit,
+// writes the BRR and sets ABD. The rate found is then confirmed by
+// answering 'A'. ABD needs a rate below about 500 kbit/s.
+//
+// timeout_us of 0 waits forever. Returns SCI_BAUD_OK or
+// SCI_BAUD_ERR_TIMEOUT.
+//
+Uint16
+sci_baud_lock(sci_baud_t *sb, Uint32 timeout_us)
+{
+    Uint32 waited = 0;
+    Uint16 c;
+
+    if(sb->role == SCI_BAUD_INITIATOR)
+    {
+        for(;;)
+        {
+            sci_baud_putc(sb, SCI_BAUD_CHAR_AUTO);
+            if(sci_baud_getc(sb, &c, SCI_BAUD_BEACON_US) &&
+               c == SCI_BAUD_CHAR_AUTO)
+            {
+                return SCI_BAUD_OK;
+            }
+            waited += SCI_BAUD_BEACON_US;
+            if(timeout_us != 0 && waited >= timeout_us)
+            {
+                return SCI_BAUD_ERR_TIMEOUT;
+            }
+        }
+    }
+
+    //
+    // Responder: start from BRR = 1 as the auto-baud sequence requires
+    //
+    rate_apply_sci(sb->regs, 1);
+    sb->regs->SCIFFCT.bit.ABDCLR = 1;
+    sb->regs->SCIFFCT.bit.CDC    = 1;
+    while(!sb->regs->SCIFFCT.bit.ABD)
+    {
+        if(timeout_us != 0 && waited >= timeout_us)
+        {
+            sb->regs->SCIFFCT.bit.CDC = 0;
+            rate_apply_sci(sb->regs, sb->brr);
+            return SCI_BAUD_ERR_TIMEOUT;
+        }
+        DELAY_US(SCI_BAUD_POLL_US);
+        waited += SCI_BAUD_POLL_US;
+    }
+    sb->regs->SCIFFCT.bit.ABDCLR = 1;
+    sb->regs->SCIFFCT.bit.CDC    = 0;
+
+    //
+    // Empty the receive buffer of the 'A' and any beacons behind it
+    //
+    sb->brr  = (sb->regs->SCIHBAUD << 8) | (sb->regs->SCILBAUD & 0x00FF);
+    sb->baud = RATE_LSPCLK_HZ / (((Uint32)sb->brr + 1) * 8);
+    c = sb->regs->SCIRXBUF.all;
+    sb->regs->SCIFFRX.bit.RXFIFORESET = 0;
+    sb->regs->SCIFFRX.bit.RXFIFORESET = 1;
+
+    sci_baud_putc(sb, SCI_BAUD_CHAR_AUTO);
+
+    return SCI_BAUD_OK;
+}
+
+//
+// sci_baud_step - Initiator side of one step up the ladder
+//
+// Returns 1 if the responder has committed to SciBaudLadder[n].
+//
+static Uint16
+sci_baud_step(sci_baud_t *sb, Uint16 n, Uint16 brr)
+{
+    Uint16 prev_brr  = sb->brr;
+    Uint32 prev_baud = sb->baud;
+    Uint16 c;
+    Uint16 i;
+
+    sci_baud_putc(sb, SCI_BAUD_CHAR_PROPOSE);
+    sci_baud_putc(sb, n);
+    sci_baud_putc(sb, ~n & 0x00FF);
+    if(!sci_baud_getc(sb, &c, SCI_BAUD_BYTE_US) || c != SCI_BAUD_CHAR_ACK ||
+       !sci_baud_getc(sb, &c, SCI_BAUD_BYTE_US) || c != n)
+    {
+        return 0;
+    }
+
+    sci_baud_switch(sb, brr, SciBaudLadder[n]);
+    DELAY_US(SCI_BAUD_SETTLE_US);
+
+    for(i = 0; i < SCI_BAUD_TEST_LEN; i++)
+    {
+        sci_baud_putc(sb, SciBaudTest[i]);
+        if(!sci_baud_getc(sb, &c, SCI_BAUD_BYTE_US) || c != SciBaudTest[i])
+        {
+            break;
+        }
+    }
+
+    if(i == SCI_BAUD_TEST_LEN)
+    {
+        sci_baud_putc(sb, SCI_BAUD_CHAR_COMMIT);
+        if(sci_baud_getc(sb, &c, SCI_BAUD_BYTE_US) &&
+           c == SCI_BAUD_CHAR_COMMIT)
+        {
+            return 1;
+        }
+    }
+
+    //
+    // Fall back and give the responder time to do the same
+    //
+    sci_baud_switch(sb, prev_brr, prev_baud);
+    DELAY_US(2 * SCI_BAUD_STEP_US);
+    sci_baud_switch(sb, prev_brr, prev_baud);
+
+    return 0;
+}
+
+//
+// sci_baud_follow - Responder side of one step to SciBaudLadder[n]
+//
+static void
+sci_baud_follow(sci_baud_t *sb, Uint16 n)
+{
+    Uint16 prev_brr  = sb->brr;
+    Uint32 prev_baud = sb->baud;
+    Uint16 brr;
+    Uint16 c;
+    Uint16 i;
+
+    if(n >= SciBaudLadderLen || rate_sci_brr(SciBaudLadder[n], &brr) != RATE_OK)
+    {
+        return;
+    }
+
+    sci_baud_putc(sb, SCI_BAUD_CHAR_ACK);
+    sci_baud_putc(sb, n);
+    sci_baud_switch(sb, brr, SciBaudLadder[n]);
+
+    for(i = 0; i < SCI_BAUD_TEST_LEN; i++)
+    {
+        if(!sci_baud_getc(sb, &c, SCI_BAUD_STEP_US))
+        {
+            break;
+        }
+        sci_baud_putc(sb, c);
+    }
+
+    if(i == SCI_BAUD_TEST_LEN && sci_baud_getc(sb, &c, SCI_BAUD_STEP_US) &&
+       c == SCI_BAUD_CHAR_COMMIT)
+    {
+        sci_baud_putc(sb, SCI_BAUD_CHAR_COMMIT);
+        sb->steps_ok++;
+        return;
+    }
+
+    sci_baud_switch(sb, prev_brr, prev_baud);
+    sb->steps_failed++;
+}
+
+//
+// sci_baud_negotiate - Step both ends up to the fastest working rate
+//
+// Run right after sci_baud_lock(). The initiator proposes every ladder
+// rate above the current one in turn. Each rate must echo all test
+// bytes without a receive error, else both ends fall back to the last
+// good rate and the negotiation stops there. A final 'D' exchange checks
+// both ends agree; if it fails the caller should lock again.
+//
+// Returns SCI_BAUD_OK or SCI_BAUD_ERR_LINK.
+//
+Uint16
+sci_baud_negotiate(sci_baud_t *sb)
+{
+    Uint16 brr;
+    Uint16 c;
+    Uint16 n;
+    Uint16 chk;
+
+    if(sb->role == SCI_BAUD_INITIATOR)
+    {
+        for(n = 0; n < SciBaudLadderLen; n++)
+        {
+            if(SciBaudLadder[n] <= sb->baud ||
+               rate_sci_brr(SciBaudLadder[n], &brr) != RATE_OK)
+            {
+                continue;
+            }
+            if(!sci_baud_step(sb, n, brr))
+            {
+                sb->steps_failed++;
+                break;
+            }
+            sb->steps_ok++;
+        }
+
+        sci_baud_putc(sb, SCI_BAUD_CHAR_DONE);
+        if(sci_baud_getc(sb, &c, SCI_BAUD_BYTE_US) && c == SCI_BAUD_CHAR_DONE)
+        {
+            return SCI_BAUD_OK;
+        }
+        return SCI_BAUD_ERR_LINK;
+    }
+
+    //
+    // Responder: serve proposals until 'D' or silence. Leftover 'A'
+    // beacons and noise are skipped.
+    //
+    for(;;)
+    {
+        if(!sci_baud_getc(sb, &c, SCI_BAUD_IDLE_US))
+        {
+            return SCI_BAUD_ERR_LINK;
+        }
+        if(c == SCI_BAUD_CHAR_DONE)
+        {
+            sci_baud_putc(sb, SCI_BAUD_CHAR_DONE);
+            return SCI_BAUD_OK;
+        }
+        if(c == SCI_BAUD_CHAR_PROPOSE &&
+           sci_baud_getc(sb, &n, SCI_BAUD_BYTE_US) &&
+           sci_baud_getc(sb, &chk, SCI_BAUD_BYTE_US) &&
+           (n ^ chk) == 0x00FF)
+        {
+            sci_baud_follow(sb, n);
+        }
+    }
+}
+
+//
+// End of File
+//
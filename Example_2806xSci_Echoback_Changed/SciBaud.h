@@ -0,0 +1,109 @@
+//###########################################################################
+//
+// FILE:   SciBaud.h
+//
+// TITLE:  SCI auto-baud lock and baud rate negotiation
+//
+//###########################################################################
+
+#ifndef SCI_BAUD_H
+#define SCI_BAUD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+#include "RateConfig.h"
+
+//
+// Defines
+//
+// Roles: the initiator drives the link, the responder follows it. The
+// responder locks onto the initiator's rate with the SCI auto-baud
+// detect (ABD) hardware, so only the initiator needs to know the start
+// rate.
+//
+#define SCI_BAUD_INITIATOR      0
+#define SCI_BAUD_RESPONDER      1
+
+//
+// Protocol bytes. Every command is answered by the same byte.
+//  'A'             auto-baud character, sent until the responder answers
+//  'P' n ~n        propose ladder rate n, answered 'K' n, then both
+//                  switch and the initiator sends SCI_BAUD_TEST_LEN test
+//                  bytes that the responder echoes
+//  'C'             commit the rate just tested
+//  'D'             negotiation done
+//
+#define SCI_BAUD_CHAR_AUTO      'A'
+#define SCI_BAUD_CHAR_PROPOSE   'P'
+#define SCI_BAUD_CHAR_ACK       'K'
+#define SCI_BAUD_CHAR_COMMIT    'C'
+#define SCI_BAUD_CHAR_DONE      'D'
+
+//
+// Timing, in microseconds
+// SCI_BAUD_BEACON_US       auto-baud character repeat period
+// SCI_BAUD_BYTE_US         max wait for a reply byte during a step
+// SCI_BAUD_STEP_US         responder gives up on an untested step
+// SCI_BAUD_SETTLE_US       pause after both ends switched rate
+// SCI_BAUD_IDLE_US         responder ends negotiation after this silence
+//
+#define SCI_BAUD_BEACON_US      10000UL
+#define SCI_BAUD_BYTE_US        5000UL
+#define SCI_BAUD_STEP_US        50000UL
+#define SCI_BAUD_SETTLE_US      200UL
+#define SCI_BAUD_IDLE_US        500000UL
+#define SCI_BAUD_POLL_US        5
+
+#define SCI_BAUD_TEST_LEN       16
+
+//
+// Status
+//
+#define SCI_BAUD_OK             0
+#define SCI_BAUD_ERR_TIMEOUT    1
+#define SCI_BAUD_ERR_LINK       2
+
+//
+// Typedefs
+//
+typedef struct {
+    volatile struct SCI_REGS *regs;
+    Uint16 role;
+    Uint16 brr;                 // BRR in use
+    Uint32 baud;                // baud rate in use (nominal)
+    Uint16 steps_ok;            // rates tested and committed
+    Uint16 steps_failed;        // rates that failed the test
+} sci_baud_t;
+
+//
+// Globals
+//
+// SciBaudLadder lists the rates tried by the negotiation, slowest first.
+// All of them are within RATE_MAX_SCI_ERROR_PPM at LSPCLK = 22.5 MHz.
+//
+extern const Uint32 SciBaudLadder[];
+extern const Uint16 SciBaudLadderLen;
+
+//
+// Function Prototypes
+//
+void sci_baud_init(sci_baud_t *sb, volatile struct SCI_REGS *regs,
+                   Uint16 role, Uint32 baud);
+Uint16 sci_baud_lock(sci_baud_t *sb, Uint32 timeout_us);
+Uint16 sci_baud_negotiate(sci_baud_t *sb);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of SCI_BAUD_H definition
+
+//
+// End of File
+//
@@ -0,0 +1,412 @@
+//###########################################################################
+//
+// FILE:   Bench.c
+//
+// TITLE:  Cycle count benchmarks of the hot kernels, CSV and JSON report
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Bench.h"
+#ifdef HOST_BUILD
+#include <time.h>
+#else
+#include "Boot.h"
+#endif
+
+#if BENCH_ENABLE
+
+//
+// Globals
+//
+// BenchOverhead    clock ticks of a bench_now() pair with nothing between
+//
+static Uint32 BenchOverhead;
+#ifndef HOST_BUILD
+static volatile struct SCI_REGS *BenchSci;
+#endif
+
+//
+// Function Prototypes
+//
+static void bench_puts(void (*put)(Uint16 c), const char *s);
+static void bench_putu(void (*put)(Uint16 c), Uint32 v);
+static void bench_put_fixed(void (*put)(Uint16 c), Uint64 v100);
+#ifndef HOST_BUILD
+static void bench_xmit(Uint16 c);
+#endif
+
+//
+// bench_init - Measure the cost of reading the clock
+//
+void
+bench_init(void)
+{
+    Uint32 t;
+    Uint16 i;
+
+    BenchOverhead = 0xFFFFFFFF;
+    for(i = 0; i < 16; i++)
+    {
+        t = bench_now();
+        t = bench_now() - t;
+        if(t < BenchOverhead)
+        {
+            BenchOverhead = t;
+        }
+    }
+}
+
+//
+// bench_now - Clock ticks, SYSCLKOUT cycles on the target
+//
+Uint32
+bench_now(void)
+{
+#ifdef HOST_BUILD
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Uint32)((Uint64)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+#else
+    return 0xFFFFFFFF - CpuTimer2Regs.TIM.all;
+#endif
+}
+
+//
+// bench_begin - Start a result, units is the work done by one call
+//
+void
+bench_begin(bench_result_t *r, const char *name, const char *unit,
+            Uint16 units)
+{
+    r->name  = name;
+    r->unit  = unit;
+    r->units = units;
+    r->calls = 0;
+    r->min   = 0xFFFFFFFF;
+    r->max   = 0;
+    r->total = 0;
+}
+
+//
+// bench_add - Count one call that started at bench_now() == start
+//
+void
+bench_add(bench_result_t *r, Uint32 start)
+{
+    Uint32 t;
+
+    t = bench_now() - start;
+    t = t > BenchOverhead ? t - BenchOverhead : 0;
+
+    r->calls++;
+    r->total += t;
+    if(t < r->min)
+    {
+        r->min = t;
+    }
+    if(t > r->max)
+    {
+        r->max = t;
+    }
+}
+
+//
+// bench_run - Time calls calls of fn, after one call that is not counted
+//
+// setup, if not 0, runs before every call and is not timed.
+//
+void
+bench_run(bench_result_t *r, const char *name, const char *unit,
+          Uint16 units, bench_fn_t setup, bench_fn_t fn, Uint16 calls)
+{
+    Uint32 t;
+    Uint16 i;
+
+    bench_begin(r, name, unit, units);
+    for(i = 0; i <= calls; i++)
+    {
+        if(setup != 0)
+        {
+            setup();
+        }
+        t = bench_now();
+        fn();
+        if(i != 0)
+        {
+            bench_add(r, t);
+        }
+    }
+}
+
+//
+// bench_diff - What an option costs: the figures of with less those of
+// without, both timed with the same number of calls
+//
+void
+bench_diff(bench_result_t *r, const char *name, const char *unit,
+           Uint16 units, const bench_result_t *with,
+           const bench_result_t *without)
+{
+    bench_begin(r, name, unit, units);
+    r->calls = with->calls;
+    r->min   = with->min > without->min ? with->min - without->min : 0;
+    r->max   = with->max > without->max ? with->max - without->max : 0;
+    r->total = with->total > without->total ?
+               with->total - without->total : 0;
+}
+
+#ifndef HOST_BUILD
+//
+// bench_isr - Time an ISR registered with isr_nest_add(), from raising
+// its PIE flag to the return to the caller
+//
+// This is the full cost of one interrupt: the PIE and CPU entry, the ISR
+// and the return. The ISR has to be enabled in PIEIER and IER with the
+// interrupts on, and must not run from its hardware source meanwhile.
+//
+void
+bench_isr(bench_result_t *r, const char *name, isr_nest_t *isr,
+          Uint16 calls)
+{
+    volatile Uint16 *pieifr;
+    Uint32 runs;
+    Uint32 t;
+    Uint16 i;
+
+    //
+    // PIEIFRx follows PIEIERx in the PIE control registers
+    //
+    pieifr = (volatile Uint16 *)&PieCtrlRegs.PIEIER1.all +
+             2 * (isr->group - 1) + 1;
+
+    bench_begin(r, name, "call", 1);
+    for(i = 0; i <= calls; i++)
+    {
+        runs = isr->runs;
+        t = bench_now();
+        *pieifr |= 1 << (isr->intx - 1);
+        while(*(volatile Uint32 *)&isr->runs == runs)
+        {
+        }
+        if(i != 0)
+        {
+            bench_add(r, t);
+        }
+    }
+}
+
+//
+// bench_cla_task - Time a CLA task forced from the C28x, until it is no
+// longer pending or running
+//
+// The interrupts are held off while the task runs, so its end of task
+// ISR comes after the time is taken.
+//
+void
+bench_cla_task(bench_result_t *r, const char *name, Uint16 task,
+               Uint16 calls)
+{
+    Uint16 bit = 1 << (task - 1);
+    Uint32 t;
+    Uint16 st;
+    Uint16 i;
+
+    bench_begin(r, name, "call", 1);
+    for(i = 0; i <= calls; i++)
+    {
+        st = __disable_interrupts();
+        t = bench_now();
+        EALLOW;
+        Cla1Regs.MIFRC.all = bit;
+        EDIS;
+        while((Cla1Regs.MIFR.all | Cla1Regs.MIRUN.all) & bit)
+        {
+        }
+        if(i != 0)
+        {
+            bench_add(r, t);
+        }
+        __restore_interrupts(st);
+    }
+}
+#endif
+
+//
+// bench_write - Write n results as CSV or JSON, one character at a time
+//
+void
+bench_write(const bench_result_t *r, Uint16 n, Uint16 format,
+            void (*put)(Uint16 c))
+{
+#ifdef HOST_BUILD
+    static const char clock[] = "ns";
+    const Uint32 hz = 1000000000UL;
+#else
+    static const char clock[] = "cycles";
+    const Uint32 hz = BOOT_CYCLES_PER_US * 1000000UL;
+#endif
+    Uint32 avg;
+    Uint64 per_unit;
+    Uint16 i;
+
+    if(format == BENCH_JSON)
+    {
+        bench_puts(put, "{\"clock\":\"");
+        bench_puts(put, clock);
+        bench_puts(put, "\",\"hz\":");
+        bench_putu(put, hz);
+        bench_puts(put, ",\"results\":[\r\n");
+    }
+    else
+    {
+        bench_puts(put, "name,unit,units,calls,min,avg,max,per_unit,clock"
+                        "\r\n");
+    }
+
+    for(i = 0; i < n; i++, r++)
+    {
+        avg = r->calls ? r->total / r->calls : 0;
+        per_unit = r->calls && r->units ?
+                   (Uint64)r->total * 100 / ((Uint64)r->calls * r->units) :
+                   0;
+
+        if(format == BENCH_JSON)
+        {
+            bench_puts(put, "{\"name\":\"");
+            bench_puts(put, r->name);
+            bench_puts(put, "\",\"unit\":\"");
+            bench_puts(put, r->unit);
+            bench_puts(put, "\",\"units\":");
+            bench_putu(put, r->units);
+            bench_puts(put, ",\"calls\":");
+            bench_putu(put, r->calls);
+            bench_puts(put, ",\"min\":");
+            bench_putu(put, r->calls ? r->min : 0);
+            bench_puts(put, ",\"avg\":");
+            bench_putu(put, avg);
+            bench_puts(put, ",\"max\":");
+            bench_putu(put, r->max);
+            bench_puts(put, ",\"per_unit\":");
+            bench_put_fixed(put, per_unit);
+            bench_puts(put, i + 1 < n ? "},\r\n" : "}\r\n");
+        }
+        else
+        {
+            bench_puts(put, r->name);
+            put(',');
+            bench_puts(put, r->unit);
+            put(',');
+            bench_putu(put, r->units);
+            put(',');
+            bench_putu(put, r->calls);
+            put(',');
+            bench_putu(put, r->calls ? r->min : 0);
+            put(',');
+            bench_putu(put, avg);
+            put(',');
+            bench_putu(put, r->max);
+            put(',');
+            bench_put_fixed(put, per_unit);
+            put(',');
+            bench_puts(put, clock);
+            bench_puts(put, "\r\n");
+        }
+    }
+
+    if(format == BENCH_JSON)
+    {
+        bench_puts(put, "]}\r\n");
+    }
+}
+
+#ifndef HOST_BUILD
+//
+// bench_write_sci - Write the results on an SCI, polling its transmitter
+//
+// The SCI has to be set up, with or without the FIFO. Call from the main
+// loop or at start up, a line takes about 6 ms at 115200 baud.
+//
+void
+bench_write_sci(volatile struct SCI_REGS *regs, const bench_result_t *r,
+                Uint16 n, Uint16 format)
+{
+    BenchSci = regs;
+    bench_write(r, n, format, bench_xmit);
+}
+
+//
+// bench_xmit - Send one character on BenchSci
+//
+static void
+bench_xmit(Uint16 c)
+{
+    if(BenchSci->SCIFFTX.bit.SCIFFENA)
+    {
+        while(BenchSci->SCIFFTX.bit.TXFFST >= 4)
+        {
+        }
+    }
+    else
+    {
+        while(!BenchSci->SCICTL2.bit.TXRDY)
+        {
+        }
+    }
+    BenchSci->SCITXBUF = c;
+}
+#endif
+
+//
+// bench_puts - Write a string
+//
+static void
+bench_puts(void (*put)(Uint16 c), const char *s)
+{
+    while(*s != '\0')
+    {
+        put(*s++);
+    }
+}
+
+//
+// bench_putu - Write v in decimal
+//
+static void
+bench_putu(void (*put)(Uint16 c), Uint32 v)
+{
+    char digits[10];
+    Uint16 n = 0;
+
+    do
+    {
+        digits[n++] = '0' + (char)(v % 10);
+        v /= 10;
+    } while(v != 0);
+
+    while(n != 0)
+    {
+        put(digits[--n]);
+    }
+}
+
+//
+// bench_put_fixed - Write v100 / 100 with two decimals
+//
+static void
+bench_put_fixed(void (*put)(Uint16 c), Uint64 v100)
+{
+    bench_putu(put, (Uint32)(v100 / 100));
+    put('.');
+    put('0' + (Uint16)(v100 / 10 % 10));
+    put('0' + (Uint16)(v100 % 10));
+}
+
+#endif // BENCH_ENABLE
+
+//
+// End of File
+//
@@ -0,0 +1,107 @@
+//###########################################################################
+//
+// FILE:   Bench.h
+//
+// TITLE:  Cycle count benchmarks of the hot kernels, CSV and JSON report
+//
+//###########################################################################
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+#ifndef HOST_BUILD
+#include "IsrNest.h"
+#endif
+
+//
+// Defines
+//
+// The benchmarks are built into the firmware with
+//      --define=BENCH_ENABLE=1
+// for the whole project, as TRACE_ENABLE (Trace.h); the main file then
+// runs the suite once at start up and prints the table. The host build
+// (host/bench.c) always has them.
+//
+// Every kernel is timed call by call: the first call warms up and is not
+// counted, the minimum, mean and maximum of the others are kept. On the
+// target times are SYSCLKOUT cycles on CPU timer 2 (see Boot.h), on the
+// host nanoseconds of the monotonic clock. The cost of reading the clock
+// is measured by bench_init() and taken off. units is the work done by
+// one call (samples, bits, bytes), so per_unit is the figure to compare
+// between builds; host/bench_compare.py does that on two reports.
+//
+// CSV:     name,unit,units,calls,min,avg,max,per_unit,clock
+//          one line per kernel after the header line
+// JSON:    {"clock":"cycles","hz":90000000,"results":[{"name":..,
+//          "unit":..,"units":..,"calls":..,"min":..,"avg":..,"max":..,
+//          "per_unit":..},..]}
+//
+// per_unit has two decimals, the other figures are integers.
+//
+#ifndef BENCH_ENABLE
+#ifdef HOST_BUILD
+#define BENCH_ENABLE            1
+#else
+#define BENCH_ENABLE            0
+#endif
+#endif
+
+#define BENCH_CSV               0
+#define BENCH_JSON              1
+
+//
+// Typedefs
+//
+typedef struct {
+    const char *name;
+    const char *unit;
+    Uint16 units;                   // work done by one call
+    Uint16 calls;                   // calls timed
+    Uint32 min;
+    Uint32 max;
+    Uint32 total;
+} bench_result_t;
+
+typedef void (*bench_fn_t)(void);
+
+//
+// Function Prototypes
+//
+void bench_init(void);
+Uint32 bench_now(void);
+void bench_begin(bench_result_t *r, const char *name, const char *unit,
+                 Uint16 units);
+void bench_add(bench_result_t *r, Uint32 start);
+void bench_run(bench_result_t *r, const char *name, const char *unit,
+               Uint16 units, bench_fn_t setup, bench_fn_t fn, Uint16 calls);
+void bench_diff(bench_result_t *r, const char *name, const char *unit,
+                Uint16 units, const bench_result_t *with,
+                const bench_result_t *without);
+void bench_write(const bench_result_t *r, Uint16 n, Uint16 format,
+                 void (*put)(Uint16 c));
+#ifndef HOST_BUILD
+void bench_isr(bench_result_t *r, const char *name, isr_nest_t *isr,
+               Uint16 calls);
+void bench_cla_task(bench_result_t *r, const char *name, Uint16 task,
+                    Uint16 calls);
+void bench_write_sci(volatile struct SCI_REGS *regs, const bench_result_t *r,
+                     Uint16 n, Uint16 format);
+#endif
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of BENCH_H definition
+
+//
+// End of File
+//
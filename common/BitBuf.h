@@ -0,0 +1,66 @@
+//###########################################################################
+//
+// FILE:   BitBuf.h
+//
+// TITLE:  Packed bit and byte buffers
+//
+//###########################################################################
+
+#ifndef BIT_BUF_H
+#define BIT_BUF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// The smallest C28x data type is 16 bits, a char included, so a buffer
+// of one bit or one byte per entry leaves most of every word unused.
+// These keep 16 bits or 2 bytes per Uint16 word instead:
+//
+//      bit vector      bit i is bit (i % 16) of word i / 16, the first
+//                      bit in bit 0 as in the CLA packed bit ring
+//      byte buffer     byte i is the low byte of word i / 2 for even i,
+//                      the high byte for odd i, as the C28x lays out
+//                      the bytes of a word with __byte()
+//
+// Declare the storage with BITVEC_WORDS() / BYTEBUF_WORDS() words. The
+// accessors are macros so they cost a shift and a mask in an ISR; they
+// evaluate the buffer and the index more than once (the value stored
+// once, so it can be a register read) and do no bounds check.
+// BITVEC_WORD() gives 16 bits at once, e.g. to skip a run of equal bits
+// in one compare.
+//
+#define BITVEC_WORDS(nbits)     (((nbits) + 15) >> 4)
+#define BITVEC_MASK(i)          (1U << ((i) & 15))
+#define BITVEC_WORD(v, i)       ((v)[(i) >> 4])
+#define BITVEC_GET(v, i)        (((v)[(i) >> 4] >> ((i) & 15)) & 1)
+#define BITVEC_SET(v, i)        ((v)[(i) >> 4] |= BITVEC_MASK(i))
+#define BITVEC_CLR(v, i)        ((v)[(i) >> 4] &= ~BITVEC_MASK(i))
+#define BITVEC_PUT(v, i, bit)                                               \
+    ((v)[(i) >> 4] = ((v)[(i) >> 4] & ~BITVEC_MASK(i)) |                    \
+                     ((bit) ? BITVEC_MASK(i) : 0))
+
+#define BYTEBUF_WORDS(nbytes)   (((nbytes) + 1) >> 1)
+#define BYTEBUF_SHIFT(i)        (((i) & 1) << 3)
+#define BYTEBUF_GET(v, i)       (((v)[(i) >> 1] >> BYTEBUF_SHIFT(i)) & 0xFF)
+#define BYTEBUF_PUT(v, i, byte)                                             \
+    ((v)[(i) >> 1] = ((v)[(i) >> 1] & ~(0xFFU << BYTEBUF_SHIFT(i))) |       \
+                     (((byte) & 0xFFU) << BYTEBUF_SHIFT(i)))
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of BIT_BUF_H definition
+
+//
+// End of File
+//
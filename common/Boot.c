@@ -0,0 +1,72 @@
+//###########################################################################
+//
+// FILE:   Boot.c
+//
+// TITLE:  Start up for RAM and flash builds, boot time measurement
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Boot.h"
+#include <string.h>
+
+//
+// Globals
+//
+Uint32 BootCycles;
+Uint32 BootUs;
+
+//
+// These are defined by the flash linker files and used to copy the
+// ramfuncs section from its load address in flash to RAM
+//
+#ifdef _FLASH
+extern Uint16 RamfuncsLoadStart;
+extern Uint16 RamfuncsLoadEnd;
+extern Uint16 RamfuncsRunStart;
+extern Uint16 RamfuncsLoadSize;
+#endif
+
+//
+// boot_start - Start the boot timer, copy ramfuncs and set up the flash
+// wait states in flash builds
+//
+// Call right after InitSysCtrl(), so the timer runs at the final
+// SYSCLKOUT and the flash is set up for it. InitFlash() itself is in
+// ramfuncs and must not run before the copy.
+//
+void
+boot_start(void)
+{
+    CpuTimer2Regs.TCR.bit.TSS = 1;
+    CpuTimer2Regs.PRD.all     = 0xFFFFFFFF;
+    CpuTimer2Regs.TPR.all     = 0;
+    CpuTimer2Regs.TPRH.all    = 0;
+    CpuTimer2Regs.TCR.bit.TRB = 1;
+    CpuTimer2Regs.TCR.bit.TSS = 0;
+
+#ifdef _FLASH
+    memcpy(&RamfuncsRunStart, &RamfuncsLoadStart, (Uint32)&RamfuncsLoadSize);
+    InitFlash();
+#endif
+}
+
+//
+// boot_done - Store the boot time, call just before entering the main
+// loop
+//
+// The timer is left running as the time base of Trace.c; it wraps after
+// 47 s.
+//
+void
+boot_done(void)
+{
+    BootCycles = 0xFFFFFFFF - CpuTimer2Regs.TIM.all;
+    BootUs     = BootCycles / BOOT_CYCLES_PER_US;
+}
+
+//
+// End of File
+//
@@ -0,0 +1,62 @@
+//###########################################################################
+//
+// FILE:   Boot.h
+//
+// TITLE:  Start up for RAM and flash builds, boot time measurement
+//
+//###########################################################################
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// The Flash build configuration defines _FLASH and links F28069.cmd (or
+// F28069_CLA_FLASH_lnk.cmd). Code placed with
+//      #pragma CODE_SECTION(func, "ramfuncs");
+// is loaded to flash and copied to RAML0 by boot_start(), so it runs with
+// no wait states. The RAM linker files link "ramfuncs" straight to RAM,
+// the pragma is harmless in the Debug configuration.
+//
+// Boot time is counted on CPU timer 2 at SYSCLKOUT from boot_start() to
+// boot_done(). Call InitCpuTimers() before boot_start(), not after. The
+// timer keeps counting down from 0xFFFFFFFF afterwards, the trace
+// (Trace.h) takes its timestamps from it; do not reprogram it.
+// BOOT_CYCLES_PER_US is SYSCLKOUT in MHz after InitSysCtrl().
+//
+#define BOOT_CYCLES_PER_US      90
+
+//
+// Globals
+//
+// BootCycles   SYSCLKOUT cycles from boot_start() to boot_done()
+// BootUs       the same in microseconds
+//
+extern Uint32 BootCycles;
+extern Uint32 BootUs;
+
+//
+// Function Prototypes
+//
+void boot_start(void);
+void boot_done(void);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of BOOT_H definition
+
+//
+// End of File
+//
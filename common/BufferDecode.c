@@ -0,0 +1,185 @@
+//###########################################################################
+//
+// FILE:   BufferDecode.c
+//
+// TITLE:  Manchester decoding of a buffer of ADC samples
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "BufferDecode.h"
+
+//
+// Defines
+//
+#define BUFFER_DECODE_MAX_HALF  16      // samples summed per half bit
+#define BUFFER_DECODE_GAIN_SHIFT 2      // clock pull, as ManchesterRx.h
+
+//
+// Function Prototypes
+//
+static Uint16 buffer_ones(const volatile Uint16 *levels, Uint16 first,
+                          Uint16 n);
+
+//
+// buffer_decode - Bits of the n sliced samples in levels (a bit vector,
+// 1 above the threshold), into the bit vector bits, the first one in bit
+// 0. Returns the number of bits found, at most max_bits.
+//
+// A crossing of the threshold is a mid-bit edge when it comes at least
+// 3/4 bit after the last one; crossings in between are bit boundaries.
+// The buffer is decoded on its own: until two crossings a full bit apart
+// show where the middle of the bits is, nothing is decoded. Each mid-bit
+// edge then moves the recovered edge a bit on plus a part of its error
+// (BUFFER_DECODE_GAIN_SHIFT), so a crossing moved by noise does not move
+// the bit clock by as much.
+//
+// The crossings only give the timing. Each bit is decided by integrate
+// and dump on the samples about its recovered mid-bit edge: a 1 (IEEE
+// 802.3, low then high) if the half bit after the edge has more samples
+// above the threshold than the half bit before it, a 0 if it has fewer,
+// else the direction of the edge. A noise spike that crosses the
+// threshold is outvoted by the rest of the half bits instead of setting
+// the bit. Up to BUFFER_DECODE_MAX_HALF samples are summed on each side,
+// fewer where the buffer ends.
+//
+// A word of the vector that stays at the current level holds no
+// crossing and is passed over in one step.
+//
+Uint16
+buffer_decode(const volatile Uint16 *levels, Uint16 n,
+              Uint16 samples_per_bit, Uint16 *bits, Uint16 max_bits)
+{
+    Uint16 edge_window = (3 * samples_per_bit + 2) / 4;
+    Uint16 half = samples_per_bit / 2 < BUFFER_DECODE_MAX_HALF ?
+                  samples_per_bit / 2 : BUFFER_DECODE_MAX_HALF;
+    Uint16 edge, span;
+    Uint16 early, late;
+    Uint16 since = 0;               // samples since the last crossing
+    int32 phase = 0;                // samples since the mid-bit edge, Q8
+    int32 err;
+    Uint16 locked = 0;
+    Uint16 crossed = 0;
+    Uint16 nbits = 0;
+    Uint16 level;
+    Uint16 now;
+    Uint16 i;
+
+    if(n == 0)
+    {
+        return 0;
+    }
+
+    level = BITVEC_GET(levels, 0);
+    i = 1;
+    while(i < n)
+    {
+        if((i & 15) == 0 && n - i >= 16 &&
+           BITVEC_WORD(levels, i) == (level ? 0xFFFF : 0))
+        {
+            since += 16;
+            phase += (int32)16 << 8;
+            i += 16;
+            continue;
+        }
+
+        since++;
+        phase += 0x100;
+        now = BITVEC_GET(levels, i);
+        i++;
+        if(now == level)
+        {
+            continue;
+        }
+        level = now;
+
+        if(!locked)
+        {
+            //
+            // Boundary edges are half a bit from a mid-bit edge, so a
+            // crossing a full bit after the previous one is mid-bit
+            //
+            locked = crossed && since >= edge_window;
+            crossed = 1;
+            since = 0;
+            if(!locked)
+            {
+                continue;
+            }
+            phase = 0;
+        }
+        else if(phase < (int32)edge_window << 8)
+        {
+            since = 0;
+            continue;
+        }
+        else
+        {
+            err = phase - ((int32)samples_per_bit << 8);
+            phase -= ((int32)samples_per_bit << 8) +
+                     (err >> BUFFER_DECODE_GAIN_SHIFT);
+        }
+        since = 0;
+
+        if(nbits < max_bits)
+        {
+            //
+            // Sample i - 1 is the first at the new level, the recovered
+            // edge phase samples before it (after it if phase < 0)
+            //
+            err  = (int32)(i - 1) - ((phase + 0x80) >> 8);
+            edge = err < 0 ? 0 : (err > n ? n : (Uint16)err);
+            span = n - edge < half ? n - edge : half;
+            span = edge < span ? edge : span;
+            early = buffer_ones(levels, edge - span, span);
+            late  = buffer_ones(levels, edge, span);
+            BITVEC_PUT(bits, nbits, late == early ? level : late > early);
+            nbits++;
+        }
+    }
+
+    return nbits;
+}
+
+//
+// buffer_ones - Number of samples above the threshold among the n
+// (at most 16) from sample first on
+//
+// The samples are 16 to a word, so the sum of a half bit is a shift, a
+// mask and a bit count of one or two words rather than an add per
+// sample.
+//
+static Uint16
+buffer_ones(const volatile Uint16 *levels, Uint16 first, Uint16 n)
+{
+    Uint16 shift = first & 15;
+    Uint16 w;
+
+    if(n == 0)
+    {
+        return 0;
+    }
+    w = BITVEC_WORD(levels, first) >> shift;
+    if(shift + n > 16)
+    {
+        w |= BITVEC_WORD(levels, first + 16) << (16 - shift);
+    }
+    if(n < 16)
+    {
+        w &= (1U << n) - 1;
+    }
+
+    //
+    // Bits set in w, two, four, eight then sixteen bits at a time
+    //
+    w = w - ((w >> 1) & 0x5555);
+    w = (w & 0x3333) + ((w >> 2) & 0x3333);
+    w = (w + (w >> 4)) & 0x0F0F;
+    return (w + (w >> 8)) & 0x001F;
+}
+
+//
+// End of File
+//
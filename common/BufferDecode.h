@@ -0,0 +1,36 @@
+//###########################################################################
+//
+// FILE:   BufferDecode.h
+//
+// TITLE:  Manchester decoding of a buffer of ADC samples
+//
+//###########################################################################
+
+#ifndef BUFFER_DECODE_H
+#define BUFFER_DECODE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+#include "BitBuf.h"
+
+//
+// Function Prototypes
+//
+Uint16 buffer_decode(const volatile Uint16 *levels, Uint16 n,
+                     Uint16 samples_per_bit, Uint16 *bits, Uint16 max_bits);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of BUFFER_DECODE_H definition
+
+//
+// End of File
+//
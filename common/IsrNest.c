@@ -0,0 +1,183 @@
+//###########################################################################
+//
+// FILE:   IsrNest.c
+//
+// TITLE:  Software prioritized interrupt nesting and latency measurement
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "IsrNest.h"
+
+//
+// Called at the start and end of every nesting ISR, keep them in RAM
+// (Boot.h)
+//
+#pragma CODE_SECTION(isr_nest_enter, "ramfuncs");
+#pragma CODE_SECTION(isr_nest_exit, "ramfuncs");
+
+//
+// Globals
+//
+static isr_nest_t *IsrNest[ISR_NEST_MAX];
+static Uint16 IsrNestCount;
+
+//
+// Function Prototypes
+//
+static volatile Uint16 *isr_nest_pieier(Uint16 group);
+static void isr_nest_masks(isr_nest_t *n);
+
+//
+// isr_nest_add - Register an ISR with its PIE position and level
+//
+// Registering it again changes the level. The masks of all registered
+// ISRs are worked out again, so call it from the main loop only with the
+// interrupts disabled, or before they are enabled.
+//
+void
+isr_nest_add(isr_nest_t *n, Uint16 group, Uint16 intx, Uint16 level)
+{
+    Uint16 i;
+
+    n->group = group;
+    n->intx  = intx;
+    n->level = level;
+
+    for(i = 0; i < IsrNestCount && IsrNest[i] != n; i++)
+    {
+    }
+    if(i == IsrNestCount)
+    {
+        if(IsrNestCount == ISR_NEST_MAX)
+        {
+            n->level = 0;
+            n->ier   = 0;
+            return;
+        }
+        IsrNest[IsrNestCount++] = n;
+        n->lat_last = 0;
+        n->lat_max  = 0;
+        n->runs     = 0;
+    }
+
+    for(i = 0; i < IsrNestCount; i++)
+    {
+        isr_nest_masks(IsrNest[i]);
+    }
+}
+
+//
+// isr_nest_clear - Restart the worst case latencies, e.g. after changing
+// a level
+//
+void
+isr_nest_clear(void)
+{
+    Uint16 i;
+
+    for(i = 0; i < IsrNestCount; i++)
+    {
+        IsrNest[i]->lat_max = 0;
+        IsrNest[i]->runs    = 0;
+    }
+}
+
+//
+// isr_nest_enter - Let the higher level interrupts in, call first thing
+// in the ISR
+//
+// Acknowledges the ISR's PIE group, so a higher level member of the same
+// group can be taken, and returns the PIEIER value to hand back to
+// isr_nest_exit().
+//
+Uint16
+isr_nest_enter(isr_nest_t *n)
+{
+    volatile Uint16 *pieier;
+    Uint16 saved;
+
+    if(n->ier == 0)
+    {
+        return 0;
+    }
+
+    pieier = isr_nest_pieier(n->group);
+    saved = *pieier;
+
+    IER = (IER | (1 << (n->group - 1))) & n->ier;
+    *pieier = saved & n->pieier;
+    PieCtrlRegs.PIEACK.all = 1 << (n->group - 1);
+
+    //
+    // Let the PIEIER write settle before INTM is cleared
+    //
+    __asm(" NOP");
+    EINT;
+
+    return saved;
+}
+
+//
+// isr_nest_exit - Block the interrupts again and restore the PIE group,
+// call last thing in the ISR
+//
+void
+isr_nest_exit(const isr_nest_t *n, Uint16 pieier)
+{
+    if(n->ier == 0)
+    {
+        return;
+    }
+
+    DINT;
+    *isr_nest_pieier(n->group) = pieier;
+}
+
+//
+// isr_nest_pieier - PIEIER register of a group, PIEIERx and PIEIFRx
+// alternate in the PIE control registers
+//
+static volatile Uint16 *
+isr_nest_pieier(Uint16 group)
+{
+    return (volatile Uint16 *)&PieCtrlRegs.PIEIER1.all + 2 * (group - 1);
+}
+
+//
+// isr_nest_masks - IER and PIEIER masks of n from the levels of all
+// registered ISRs
+//
+static void
+isr_nest_masks(isr_nest_t *n)
+{
+    isr_nest_t *m;
+    Uint16 i;
+
+    n->ier    = 0;
+    n->pieier = 0;
+    if(n->level == 0)
+    {
+        return;
+    }
+
+    for(i = 0; i < IsrNestCount; i++)
+    {
+        m = IsrNest[i];
+        if(m == n || m->level == 0 || m->level >= n->level)
+        {
+            continue;
+        }
+        n->ier |= 1 << (m->group - 1);
+        if(m->group == n->group)
+        {
+            n->pieier |= 1 << (m->intx - 1);
+        }
+    }
+}
+
+//
+// End of File
+//
@@ -0,0 +1,100 @@
+//###########################################################################
+//
+// FILE:   IsrNest.h
+//
+// TITLE:  Software prioritized interrupt nesting and latency measurement
+//
+//###########################################################################
+
+#ifndef ISR_NEST_H
+#define ISR_NEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// The PIE never nests by itself: an ISR runs with INTM set, so whatever
+// comes in meanwhile waits for it to return. With a level given to each
+// ISR (1 is the highest), isr_nest_enter() re-enables the interrupts
+// while the ISR runs, but only those of a higher level:
+//
+//      IER     the CPU groups (PIE groups) of the higher level ISRs
+//      PIEIER  the higher level members of the ISR's own group
+//
+// The CPU restores IER on return; isr_nest_exit() restores PIEIER with
+// INTM set again. Interrupts not registered with isr_nest_add() count as
+// the lowest level, except that another group let in through IER comes
+// in as a whole. Level 0 keeps the default behaviour, and so does an
+// ISR with nothing above it.
+//
+// An ISR that nests is written as
+//
+//      __interrupt void some_isr(void)
+//      {
+//          Uint16 pieier;
+//
+//          ISR_LATENCY(&SomeIsr, <cycles since the interrupt event>);
+//          pieier = isr_nest_enter(&SomeIsr);
+//          ...
+//          isr_nest_exit(&SomeIsr, pieier);
+//      }
+//
+// The latency comes from the hardware that raised the interrupt (ePWM
+// TBCTR, CPU timer TIM, XINTnCTR) and is kept in SYSCLKOUT cycles, so
+// the worst case of every ISR can be compared with nesting on and off.
+//
+#define ISR_NEST_MAX            8
+
+#define ISR_LATENCY(n, cycles)                                              \
+    do                                                                      \
+    {                                                                       \
+        (n)->lat_last = (cycles);                                           \
+        if((n)->lat_last > (n)->lat_max)                                    \
+        {                                                                   \
+            (n)->lat_max = (n)->lat_last;                                   \
+        }                                                                   \
+        (n)->runs++;                                                        \
+    } while(0)
+
+//
+// Typedefs
+//
+// ier and pieier are worked out by isr_nest_add() from the levels of
+// all registered ISRs.
+//
+typedef struct {
+    Uint16 group;                   // PIE group, 1..12 (CPU INT1..INT12)
+    Uint16 intx;                    // 1..8 within the group
+    Uint16 level;                   // 1 is the highest, 0 never nests
+    Uint16 ier;                     // IER while the ISR runs
+    Uint16 pieier;                  // PIEIER mask of the own group
+    Uint16 lat_last;                // latency of the last run, cycles
+    Uint16 lat_max;                 // worst case latency, cycles
+    Uint32 runs;
+} isr_nest_t;
+
+//
+// Function Prototypes
+//
+void isr_nest_add(isr_nest_t *n, Uint16 group, Uint16 intx, Uint16 level);
+void isr_nest_clear(void);
+Uint16 isr_nest_enter(isr_nest_t *n);
+void isr_nest_exit(const isr_nest_t *n, Uint16 pieier);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of ISR_NEST_H definition
+
+//
+// End of File
+//
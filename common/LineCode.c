@@ -0,0 +1,475 @@
+//###########################################################################
+//
+// FILE:   LineCode.c
+//
+// TITLE:  Line code library for a byte stream, selected at run time
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "LineCode.h"
+
+//
+// Defines
+//
+// Flags of the 8B10B tables. An encoder entry is the code, abcdei or
+// fghj with a or f in the MSB, plus a flag when the code is unbalanced
+// and turns the running disparity over. A decoder entry, indexed by the
+// received code, is the 5 or 3 data bits plus the running disparities
+// the code may be sent at and the one it leaves; 0 is not a code.
+//
+#define LINE_6B_FLIP            0x40
+#define LINE_4B_FLIP            0x10
+#define LINE_6B_MASK            0x3F
+#define LINE_4B_MASK            0x0F
+
+#define LINE_DEC_DATA           0x1F
+#define LINE_AT_MINUS           0x100
+#define LINE_AT_PLUS            0x200
+#define LINE_TO_PLUS            0x400
+#define LINE_TO_MINUS           0x800
+
+#define LINE_5B_VALID           0x100
+
+//
+// Globals
+//
+// 4B5B, FDDI data symbols 0 to F and their decoding
+//
+static const Uint16 LineEnc5[16] = {
+    0x1E, 0x09, 0x14, 0x15, 0x0A, 0x0B, 0x0E, 0x0F,
+    0x12, 0x13, 0x16, 0x17, 0x1A, 0x1B, 0x1C, 0x1D
+};
+
+static const Uint16 LineDec5[32] = {
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x101, 0x104, 0x105, 0x000, 0x000, 0x106, 0x107,
+    0x000, 0x000, 0x108, 0x109, 0x102, 0x103, 0x10A, 0x10B,
+    0x000, 0x000, 0x10C, 0x10D, 0x10E, 0x10F, 0x100, 0x000
+};
+
+//
+// 8B10B 5b/6b codes of EDCBA at running disparity -1 and +1
+//
+static const Uint16 LineEnc6[2][32] = {
+    {
+        0x67, 0x5D, 0x6D, 0x31, 0x75, 0x29, 0x19, 0x38,
+        0x79, 0x25, 0x15, 0x34, 0x0D, 0x2C, 0x1C, 0x57,
+        0x5B, 0x23, 0x13, 0x32, 0x0B, 0x2A, 0x1A, 0x7A,
+        0x73, 0x26, 0x16, 0x76, 0x0E, 0x6E, 0x5E, 0x6B
+    },
+    {
+        0x58, 0x62, 0x52, 0x31, 0x4A, 0x29, 0x19, 0x07,
+        0x46, 0x25, 0x15, 0x34, 0x0D, 0x2C, 0x1C, 0x68,
+        0x64, 0x23, 0x13, 0x32, 0x0B, 0x2A, 0x1A, 0x45,
+        0x4C, 0x26, 0x16, 0x49, 0x0E, 0x51, 0x61, 0x54
+    }
+};
+
+//
+// 8B10B 3b/4b codes of HGF at running disparity -1 and +1, D.x.P7 for
+// HGF = 7; LineEncA7 is the alternate D.x.A7
+//
+static const Uint16 LineEnc4[2][8] = {
+    { 0x1B, 0x09, 0x05, 0x0C, 0x1D, 0x0A, 0x06, 0x1E },
+    { 0x14, 0x09, 0x05, 0x03, 0x12, 0x0A, 0x06, 0x11 }
+};
+
+static const Uint16 LineEncA7[2] = { 0x17, 0x18 };
+
+static const Uint16 LineDec6[64] = {
+    0x000, 0x000, 0x000, 0x000, 0x000, 0xA17, 0xA08, 0x207,
+    0x000, 0xA1B, 0xA04, 0x314, 0xA18, 0x30C, 0x31C, 0x000,
+    0x000, 0xA1D, 0xA02, 0x312, 0xA1F, 0x30A, 0x31A, 0x50F,
+    0xA00, 0x306, 0x316, 0x510, 0x30E, 0x501, 0x51E, 0x000,
+    0x000, 0xA1E, 0xA01, 0x311, 0xA10, 0x309, 0x319, 0x500,
+    0xA0F, 0x305, 0x315, 0x51F, 0x30D, 0x502, 0x51D, 0x000,
+    0x000, 0x303, 0x313, 0x518, 0x30B, 0x504, 0x51B, 0x000,
+    0x107, 0x508, 0x517, 0x000, 0x000, 0x000, 0x000, 0x000
+};
+
+static const Uint16 LineDec4[16] = {
+    0x000, 0xA07, 0xA04, 0x203, 0xA00, 0x302, 0x306, 0x507,
+    0xA07, 0x301, 0x305, 0x500, 0x103, 0x504, 0x507, 0x000
+};
+
+static const Uint16 LineChipsPerByte[LINE_CODES] = {
+    16, 10, 10, 8 * LINE_VPPM_SLOTS
+};
+
+//
+// Longest runs of equal chips, VPPM is worked out from the pulse width
+//
+static const Uint16 LineMaxRun[LINE_CODES] = {
+    2, 4, 5, 0
+};
+
+//
+// Function Prototypes
+//
+static Uint16 line_put(line_code_t *lc, Uint16 *chips, Uint16 n,
+                       Uint16 code, Uint16 len);
+static Uint16 line_get(line_code_t *lc, const Uint16 *chips, Uint16 n,
+                       Uint16 len);
+static Uint16 line_encode_8b10b(line_code_t *lc, Uint16 byte);
+static Uint16 line_decode_8b10b(line_code_t *lc, Uint16 c6, Uint16 c4);
+static void line_rd_check(line_code_t *lc, Uint16 entry);
+
+//
+// line_code_init - Select the line code of one direction and clear its
+// state and counts
+//
+// vppm_width is the pulse length in slots for LINE_VPPM, the dimming
+// level, and is not used by the other codes. Returns LINE_OK, or the
+// reason the selection is refused, in which case lc is left as it was.
+//
+Uint16
+line_code_init(line_code_t *lc, Uint16 code, Uint16 vppm_width)
+{
+    if(code >= LINE_CODES)
+    {
+        return LINE_ERR_CODE;
+    }
+    if(code == LINE_VPPM &&
+       (vppm_width == 0 || vppm_width >= LINE_VPPM_SLOTS))
+    {
+        return LINE_ERR_VPPM_WIDTH;
+    }
+
+    lc->code             = code;
+    lc->vppm_width       = vppm_width;
+    lc->chips_per_byte   = LineChipsPerByte[code];
+    lc->max_run          = LineMaxRun[code];
+    if(code == LINE_VPPM)
+    {
+        //
+        // The gap between a 0 and a following 1, or the pulses of a 1
+        // and a following 0
+        //
+        lc->max_run = 2 * (vppm_width > LINE_VPPM_SLOTS / 2 ?
+                           vppm_width : LINE_VPPM_SLOTS - vppm_width);
+    }
+    lc->disparity        = 0;
+    lc->code_errors      = 0;
+    lc->disparity_errors = 0;
+    line_code_restart(lc);
+
+    return LINE_OK;
+}
+
+//
+// line_code_restart - Back to the line state of the start of a frame,
+// the counts are kept
+//
+// 8B10B starts at running disparity -1 and 4B5B NRZI from a low line;
+// both ends of a link restart on the same frame boundary.
+//
+void
+line_code_restart(line_code_t *lc)
+{
+    lc->rd    = -1;
+    lc->level = 0;
+}
+
+//
+// line_encode - Chips of nbytes bytes into the bit vector chips, from
+// chip 0. Returns the number of chips, nbytes * lc->chips_per_byte.
+//
+// chips needs LINE_CHIP_WORDS(nbytes) words for any code.
+//
+Uint16
+line_encode(line_code_t *lc, const Uint16 *data, Uint16 nbytes,
+            Uint16 *chips)
+{
+    Uint16 slots = (1U << lc->vppm_width) - 1;
+    Uint16 n = 0;
+    Uint16 byte, code, levels;
+    Uint16 i, j, k;
+
+    for(i = 0; i < nbytes; i++)
+    {
+        byte = data[i] & 0xFF;
+        switch(lc->code)
+        {
+            case LINE_MANCHESTER:
+                code = 0;
+                for(j = 0; j < 8; j++)
+                {
+                    code = (code << 2) | ((byte >> j) & 1 ? 0x1 : 0x2);
+                }
+                n = line_put(lc, chips, n, code, 16);
+                break;
+
+            case LINE_4B5B:
+                for(j = 0; j < 8; j += 4)
+                {
+                    code = LineEnc5[(byte >> j) & 0xF];
+                    levels = 0;
+                    for(k = 5; k-- != 0;)
+                    {
+                        lc->level ^= (code >> k) & 1;
+                        levels = (levels << 1) | lc->level;
+                    }
+                    n = line_put(lc, chips, n, levels, 5);
+                }
+                break;
+
+            case LINE_8B10B:
+                code = line_encode_8b10b(lc, byte);
+                n = line_put(lc, chips, n, code, 10);
+                break;
+
+            default:
+                for(j = 0; j < 8; j++)
+                {
+                    code = (byte >> j) & 1 ?
+                           slots : slots << (LINE_VPPM_SLOTS -
+                                             lc->vppm_width);
+                    n = line_put(lc, chips, n, code, LINE_VPPM_SLOTS);
+                }
+                break;
+        }
+    }
+
+    return n;
+}
+
+//
+// line_decode - Bytes of the first nchips chips of the bit vector chips
+// into data, one per word. Returns the number of bytes, the whole ones
+// in nchips.
+//
+Uint16
+line_decode(line_code_t *lc, const Uint16 *chips, Uint16 nchips,
+            Uint16 *data)
+{
+    Uint16 nbytes = nchips / lc->chips_per_byte;
+    Uint16 slots = (1U << lc->vppm_width) - 1;
+    Uint16 half = LINE_VPPM_SLOTS / 2;
+    Uint16 n = 0;
+    Uint16 byte, code, entry, bits, first, second;
+    Uint16 i, j, k;
+
+    for(i = 0; i < nbytes; i++)
+    {
+        byte = 0;
+        switch(lc->code)
+        {
+            case LINE_MANCHESTER:
+                for(j = 0; j < 8; j++)
+                {
+                    code = line_get(lc, chips, n, 2);
+                    n += 2;
+                    if(code == 0x1)
+                    {
+                        byte |= 1U << j;
+                    }
+                    else if(code != 0x2)
+                    {
+                        lc->code_errors++;
+                    }
+                }
+                break;
+
+            case LINE_4B5B:
+                for(j = 0; j < 8; j += 4)
+                {
+                    bits = 0;
+                    for(k = 0; k < 5; k++)
+                    {
+                        code = BITVEC_GET(chips, n);
+                        n++;
+                        bits = (bits << 1) | (code ^ lc->level);
+                        lc->level = code;
+                        lc->disparity += code ? 1 : -1;
+                    }
+                    entry = LineDec5[bits];
+                    if(entry & LINE_5B_VALID)
+                    {
+                        byte |= (entry & 0xF) << j;
+                    }
+                    else
+                    {
+                        lc->code_errors++;
+                    }
+                }
+                break;
+
+            case LINE_8B10B:
+                code = line_get(lc, chips, n, 6);
+                byte = line_decode_8b10b(lc, code,
+                                         line_get(lc, chips, n + 6, 4));
+                n += 10;
+                break;
+
+            default:
+                for(j = 0; j < 8; j++)
+                {
+                    first = 0;
+                    second = 0;
+                    code = 0;
+                    for(k = 0; k < LINE_VPPM_SLOTS; k++)
+                    {
+                        code = (code << 1) | BITVEC_GET(chips, n);
+                        if(code & 1)
+                        {
+                            if(k < half)
+                            {
+                                first++;
+                            }
+                            else
+                            {
+                                second++;
+                            }
+                            lc->disparity++;
+                        }
+                        else
+                        {
+                            lc->disparity--;
+                        }
+                        n++;
+                    }
+                    if(second > first)
+                    {
+                        byte |= 1U << j;
+                    }
+                    if(code != slots &&
+                       code != slots << (LINE_VPPM_SLOTS - lc->vppm_width))
+                    {
+                        lc->code_errors++;
+                    }
+                }
+                break;
+        }
+        data[i] = byte;
+    }
+
+    return nbytes;
+}
+
+//
+// line_put - Write the low len bits of code, MSB first, as chips n on;
+// returns the next chip
+//
+static Uint16
+line_put(line_code_t *lc, Uint16 *chips, Uint16 n, Uint16 code, Uint16 len)
+{
+    Uint16 chip;
+
+    while(len-- != 0)
+    {
+        chip = (code >> len) & 1;
+        BITVEC_PUT(chips, n, chip);
+        lc->disparity += chip ? 1 : -1;
+        n++;
+    }
+
+    return n;
+}
+
+//
+// line_get - Read len chips from chip n, the first into the MSB of the
+// result
+//
+static Uint16
+line_get(line_code_t *lc, const Uint16 *chips, Uint16 n, Uint16 len)
+{
+    Uint16 code = 0;
+    Uint16 chip;
+
+    while(len-- != 0)
+    {
+        chip = BITVEC_GET(chips, n);
+        code = (code << 1) | chip;
+        lc->disparity += chip ? 1 : -1;
+        n++;
+    }
+
+    return code;
+}
+
+//
+// line_encode_8b10b - The 10 chips of one byte, abcdei fghj, at the
+// running disparity of lc, which is updated
+//
+// D.x.A7 replaces D.x.P7 where P7 would make a run of 5 equal chips
+// across the 6b/4b boundary, x = 17, 18, 20 at -1 and 11, 13, 14 at +1.
+//
+static Uint16
+line_encode_8b10b(line_code_t *lc, Uint16 byte)
+{
+    Uint16 x = byte & 0x1F;
+    Uint16 y = byte >> 5;
+    Uint16 c6, c4;
+
+    c6 = LineEnc6[lc->rd > 0][x];
+    if(c6 & LINE_6B_FLIP)
+    {
+        lc->rd = -lc->rd;
+    }
+
+    c4 = LineEnc4[lc->rd > 0][y];
+    if(y == 7 &&
+       (lc->rd < 0 ? x == 17 || x == 18 || x == 20 :
+                     x == 11 || x == 13 || x == 14))
+    {
+        c4 = LineEncA7[lc->rd > 0];
+    }
+    if(c4 & LINE_4B_FLIP)
+    {
+        lc->rd = -lc->rd;
+    }
+
+    return ((c6 & LINE_6B_MASK) << 4) | (c4 & LINE_4B_MASK);
+}
+
+//
+// line_decode_8b10b - The byte of the 6b code c6 and the 4b code c4
+//
+static Uint16
+line_decode_8b10b(line_code_t *lc, Uint16 c6, Uint16 c4)
+{
+    Uint16 e6 = LineDec6[c6];
+    Uint16 e4;
+
+    line_rd_check(lc, e6);
+    e4 = LineDec4[c4];
+    line_rd_check(lc, e4);
+
+    return (e6 & LINE_DEC_DATA) | ((e4 & 0x7) << 5);
+}
+
+//
+// line_rd_check - Count a code or disparity error of a decoder entry and
+// follow the running disparity it leaves
+//
+// An unbalanced code sets the disparity whether or not it was allowed,
+// so a single wrong chip does not make every later code wrong too.
+//
+static void
+line_rd_check(line_code_t *lc, Uint16 entry)
+{
+    if((entry & (LINE_AT_MINUS | LINE_AT_PLUS)) == 0)
+    {
+        lc->code_errors++;
+        return;
+    }
+    if((entry & (lc->rd < 0 ? LINE_AT_MINUS : LINE_AT_PLUS)) == 0)
+    {
+        lc->disparity_errors++;
+    }
+    if(entry & LINE_TO_PLUS)
+    {
+        lc->rd = 1;
+    }
+    else if(entry & LINE_TO_MINUS)
+    {
+        lc->rd = -1;
+    }
+}
+
+//
+// End of File
+//
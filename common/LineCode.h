@@ -0,0 +1,121 @@
+//###########################################################################
+//
+// FILE:   LineCode.h
+//
+// TITLE:  Line code library for a byte stream, selected at run time
+//
+//###########################################################################
+
+#ifndef LINE_CODE_H
+#define LINE_CODE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+#include "BitBuf.h"
+
+//
+// Defines
+//
+// A byte goes on the line as a run of chips, line levels of equal length
+// (1 is light on), held in a bit vector (BitBuf.h). Bytes are one per
+// Uint16 word and sent LSB first, as on the SCI and by ManchesterTx.c.
+//
+//      LINE_MANCHESTER 16 chips a byte, a 1 is 0 then 1 (ManchesterRx.h).
+//                      A clock edge in every bit, 50 % of the chip rate
+//                      is data.
+//      LINE_4B5B       10 chips a byte, the low nibble then the high one,
+//                      each as its FDDI 5 bit code MSB first, sent NRZI
+//                      (a 1 toggles the line). Runs of at most 4 equal
+//                      chips, 80 % data, but only about DC balanced.
+//      LINE_8B10B      10 chips a byte, the 5b/6b and 3b/4b codes of
+//                      Widmer and Franaszek sent abcdei fghj, a (the
+//                      byte LSB) first. Runs of at most 5 equal chips and
+//                      a running disparity of +-1 at the end of every
+//                      code: DC balanced at 80 % data.
+//      LINE_VPPM       8 * LINE_VPPM_SLOTS chips a byte. A bit is a pulse
+//                      of vppm_width slots at the start of the bit for a
+//                      0 and at its end for a 1 (IEEE 802.15.7 VPPM), so
+//                      the mean light level is vppm_width / slots
+//                      whatever the data and can be dimmed at run time.
+//
+// On one chip rate, 4B5B and 8B10B carry 60 % more data than Manchester.
+// They leave longer runs without an edge, so the receiver needs a chip
+// clock recovery that holds over 4 or 5 chips, where Manchester has an
+// edge in every bit.
+//
+// The BER link carries them at run time (set_line_code() of the CLA
+// project): ePWM3 (ManchesterTx.c) sends the chips of any code two to a
+// bit period, so a Manchester bit keeps its timing, and ChipRx.c
+// recovers the chip clock and the bytes of the other codes. max_run of
+// each code tells the receiver how long it has to hold its clock.
+//
+// A decoder counts the chip groups that are not a code as code_errors
+// and decodes them as 0; 8B10B also counts a code of the wrong running
+// disparity as a disparity_error. VPPM decodes every bit by its larger
+// half, but still counts a bit that is not exactly one pulse as a code
+// error. Both counts mean the chips were received wrongly, or out of
+// step with the bytes.
+//
+#define LINE_MANCHESTER         0
+#define LINE_4B5B               1
+#define LINE_8B10B              2
+#define LINE_VPPM               3
+#define LINE_CODES              4
+
+#define LINE_OK                 0       // line_code_init() results
+#define LINE_ERR_CODE           1
+#define LINE_ERR_VPPM_WIDTH     2
+#define LINE_ERR_LINK           3       // refused by the link, not here
+
+#define LINE_VPPM_SLOTS         8
+#define LINE_CHIPS_MAX          (8 * LINE_VPPM_SLOTS)   // per byte
+
+//
+// Size of a chip buffer for nbytes bytes in any code, in words
+//
+#define LINE_CHIP_WORDS(nbytes) BITVEC_WORDS((Uint32)(nbytes) * LINE_CHIPS_MAX)
+
+//
+// Typedefs
+//
+// One per direction, the encoder and the decoder of a link each keep
+// their own line state. disparity is the ones minus the zeros of all the
+// chips seen, the DC balance of the stream.
+//
+typedef struct {
+    Uint16 code;                // LINE_xxx
+    Uint16 vppm_width;          // LINE_VPPM pulse, 1 to LINE_VPPM_SLOTS - 1
+    Uint16 chips_per_byte;
+    Uint16 max_run;             // longest run of equal chips of the code
+    int16 rd;                   // 8B10B running disparity, -1 or +1
+    Uint16 level;               // 4B5B NRZI line level
+    int32 disparity;
+    Uint32 code_errors;
+    Uint32 disparity_errors;
+} line_code_t;
+
+//
+// Function Prototypes
+//
+Uint16 line_code_init(line_code_t *lc, Uint16 code, Uint16 vppm_width);
+void line_code_restart(line_code_t *lc);
+Uint16 line_encode(line_code_t *lc, const Uint16 *data, Uint16 nbytes,
+                   Uint16 *chips);
+Uint16 line_decode(line_code_t *lc, const Uint16 *chips, Uint16 nchips,
+                   Uint16 *data);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of LINE_CODE_H definition
+
+//
+// End of File
+//
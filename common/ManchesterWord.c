@@ -0,0 +1,80 @@
+//###########################################################################
+//
+// FILE:   ManchesterWord.c
+//
+// TITLE:  Manchester encoding of SCI words between the boards
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "ManchesterWord.h"
+
+//
+// encode_manchester - Manchester symbols of the low byte of input, two
+// bits per data bit, XORed with the clock
+//
+// The MSB comes out in the low symbol; decode_manchester() reverses it.
+//
+Uint32 encode_manchester(Uint32 input)
+{
+    Uint32 clk_mask = 0xAAAA; //clock mask
+    Uint32 filter_mask = 0x00FF; //to filter first 8 bits
+    Uint32 bit_iterator = 0x0001;
+    Uint32 aux = input & filter_mask; //filters the first 8 bits
+    Uint32 result = 0x0000;
+    Uint32 i = 0;
+
+    while( i < 8)
+    {
+        //filters the bit;
+        if(aux & (bit_iterator << i))
+        {
+            result = result << 2; //appends 2 0s to result
+            result |= 0x03; //converts 0s to two 1s to result;
+        }
+        else
+        {
+            result = result << 2; //appends 2 0s to result
+        }
+        i++;
+    }
+
+    result = result ^ clk_mask; // apply xor op with clk
+
+    return result;
+}
+
+//
+// decode_manchester - Data bits of the Manchester symbols in the low 16
+// bits of input, the first half of every symbol
+//
+Uint32 decode_manchester(Uint32 input)
+{
+    Uint32 filter_mask = 0xFFFF; //to filter first 16 bits
+    Uint32 mask_for_1 = 0x0001;
+    Uint32 aux = input & filter_mask; //filters the first 16 bits
+    Uint32 iterator_2_bits = 0x0003;
+    Uint32 result = 0x0000;
+    Uint32 i = 0;
+
+    while(i < 8)
+    {
+        if((aux & (iterator_2_bits << 2*i)) & (mask_for_1 << 2*i))
+        {
+            result = result << 1; //append 0 to result
+            result |= 1; //transforms appended 0 into 1
+        }
+        else
+        {
+            result = result << 1; //append 0 to result
+        }
+        i++;
+    }
+    return result;
+}
+
+//
+// End of File
+//
@@ -0,0 +1,35 @@
+//###########################################################################
+//
+// FILE:   ManchesterWord.h
+//
+// TITLE:  Manchester encoding of SCI words between the boards
+//
+//###########################################################################
+
+#ifndef MANCHESTER_WORD_H
+#define MANCHESTER_WORD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Function Prototypes
+//
+Uint32 encode_manchester(Uint32 input);
+Uint32 decode_manchester(Uint32 input);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of MANCHESTER_WORD_H definition
+
+//
+// End of File
+//
@@ -0,0 +1,200 @@
+//###########################################################################
+//
+// FILE:   Power.c
+//
+// TITLE:  Low power modes between frames, wake up latency against the
+//         preamble
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Power.h"
+#include "Trace.h"
+
+//
+// Globals
+//
+// PowerWake    the power_t the wake ISRs report to
+//
+static power_t *PowerWake;
+
+//
+// The wake up path runs from RAM in flash builds
+//
+#pragma CODE_SECTION(power_idle, "ramfuncs");
+#pragma CODE_SECTION(power_edge_isr, "ramfuncs");
+#pragma CODE_SECTION(power_wake_isr, "ramfuncs");
+
+//
+// power_init - Set up the wake pin, XINT1 and WAKEINT, call with the
+// interrupts off after InitPieVectTable()
+//
+void
+power_init(power_t *p, Uint16 wake_gpio, Uint16 preamble_bits,
+           Uint32 bit_cycles)
+{
+    p->gated         = 0;
+    p->mode          = POWER_IDLE;
+    p->waiting       = 0;
+    p->preamble_bits = preamble_bits;
+    p->bit_cycles    = bit_cycles;
+    p->gates         = 0;
+    p->wake_stamp    = 0;
+    p->wake_cycles   = 0;
+    p->wake_max      = 0;
+    p->lock_cycles   = 0;
+    p->lock_max      = 0;
+    p->lock_bits     = 0;
+    p->margin_bits   = preamble_bits;
+    p->late          = 0;
+    PowerWake = p;
+
+    EALLOW;
+    GpioIntRegs.GPIOLPMSEL.all = 1UL << wake_gpio;
+    SysCtrlRegs.LPMCR0.bit.QUALSTDBY = POWER_QUALSTDBY;
+    SysCtrlRegs.LPMCR0.bit.LPM = POWER_IDLE;
+    GpioIntRegs.GPIOXINT1SEL.bit.GPIOSEL = wake_gpio;
+    PieVectTable.XINT1 = &power_edge_isr;
+    PieVectTable.WAKEINT = &power_wake_isr;
+    EDIS;
+
+    //
+    // Both edges, enabled only while gated
+    //
+    XIntruptRegs.XINT1CR.bit.POLARITY = 3;
+    XIntruptRegs.XINT1CR.bit.ENABLE = 0;
+
+    PieCtrlRegs.PIEIER1.bit.INTx4 = 1;
+    PieCtrlRegs.PIEIER1.bit.INTx8 = 1;
+    IER |= M_INT1;
+}
+
+//
+// power_idle - Sleep until the next enabled interrupt
+//
+void
+power_idle(void)
+{
+    __asm(" IDLE");
+}
+
+//
+// power_gate - Stop the clocks of pclkcr0 and pclkcr1 (PCLKCR0/1 bit
+// masks) and sleep in mode until the wake pin changes
+//
+// Call from the main loop with the interrupts on, once the receiver has
+// seen no carrier for a while and there is nothing to transmit. The
+// clocks are back on when it returns and wake_stamp is set; call
+// power_locked() when the decoder locks.
+//
+void
+power_gate(power_t *p, Uint16 mode, Uint16 pclkcr0, Uint16 pclkcr1)
+{
+    Uint16 clk0, clk1;
+
+    p->mode = mode;
+    p->gates++;
+    p->gated = 1;
+    TRACE(TRACE_STATE, TRACE_SRC_POWER, 1 + mode);
+
+    EALLOW;
+    clk0 = SysCtrlRegs.PCLKCR0.all;
+    clk1 = SysCtrlRegs.PCLKCR1.all;
+    SysCtrlRegs.PCLKCR0.all = clk0 & ~pclkcr0;
+    SysCtrlRegs.PCLKCR1.all = clk1 & ~pclkcr1;
+    SysCtrlRegs.LPMCR0.bit.LPM = mode;
+    EDIS;
+    XIntruptRegs.XINT1CR.bit.ENABLE = 1;
+
+    //
+    // An edge between enabling XINT1 and IDLE clears gated first
+    //
+    while(p->gated)
+    {
+        __asm(" IDLE");
+    }
+
+    EALLOW;
+    SysCtrlRegs.LPMCR0.bit.LPM = POWER_IDLE;
+    SysCtrlRegs.PCLKCR0.all = clk0;
+    SysCtrlRegs.PCLKCR1.all = clk1;
+    EDIS;
+
+    p->wake_stamp = 0xFFFFFFFF - CpuTimer2Regs.TIM.all;
+    p->waiting = 1;
+    TRACE(TRACE_STATE, TRACE_SRC_POWER, 0);
+}
+
+//
+// power_locked - The decoder has locked, account the wake against the
+// preamble
+//
+void
+power_locked(power_t *p)
+{
+    if(!p->waiting)
+    {
+        return;
+    }
+    p->waiting = 0;
+
+    p->lock_cycles = p->wake_cycles +
+                     (0xFFFFFFFF - CpuTimer2Regs.TIM.all) - p->wake_stamp;
+    if(p->lock_cycles > p->lock_max)
+    {
+        p->lock_max = p->lock_cycles;
+    }
+    p->lock_bits = (p->lock_cycles + p->bit_cycles - 1) / p->bit_cycles;
+    if(p->lock_bits > p->preamble_bits)
+    {
+        p->late++;
+    }
+    p->margin_bits = (int16)p->preamble_bits -
+                     (int16)((p->lock_max + p->bit_cycles - 1) /
+                             p->bit_cycles);
+}
+
+//
+// power_edge_isr - XINT1, first edge on the wake pin
+//
+__interrupt void
+power_edge_isr(void)
+{
+    Uint32 cycles;
+
+    cycles = XIntruptRegs.XINT1CTR;
+    if(SysCtrlRegs.LPMCR0.bit.LPM == POWER_STANDBY)
+    {
+        cycles += POWER_STANDBY_CYCLES;
+    }
+    XIntruptRegs.XINT1CR.bit.ENABLE = 0;
+
+    PowerWake->wake_cycles = cycles;
+    if(cycles > PowerWake->wake_max)
+    {
+        PowerWake->wake_max = cycles;
+    }
+    PowerWake->gated = 0;
+
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+}
+
+//
+// power_wake_isr - WAKEINT, the device left STANDBY
+//
+// XINT1 normally comes in first and clears gated; this one makes sure
+// the C28x does not go back to STANDBY if it missed the edge.
+//
+__interrupt void
+power_wake_isr(void)
+{
+    PowerWake->gated = 0;
+
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+}
+
+//
+// End of File
+//
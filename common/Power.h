@@ -0,0 +1,115 @@
+//###########################################################################
+//
+// FILE:   Power.h
+//
+// TITLE:  Low power modes between frames, wake up latency against the
+//         preamble
+//
+//###########################################################################
+
+#ifndef POWER_H
+#define POWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// Two levels of saving:
+//
+//      power_idle()    the C28x executes IDLE until the next enabled
+//                      interrupt, e.g. the CLA end of task of the next
+//                      sample. Call it from the main loop when there is
+//                      nothing left to do; nothing is stopped.
+//      power_gate()    no carrier: the receive peripherals are clock
+//                      gated (ADC, the sampling ePWM) and the C28x sleeps
+//                      in IDLE or STANDBY until the first edge on the
+//                      wake pin. In STANDBY SYSCLKOUT stops altogether,
+//                      the CLA, CPU timers and every peripheral with it,
+//                      and only a port A GPIO (GPIOLPMSEL) wakes the
+//                      device; in IDLE the other interrupts keep running
+//                      and the C28x goes back to sleep after each one.
+//
+// The wake pin is a port A GPIO that sees the light, e.g. a comparator
+// output (COMPxOUT on its GPIO mux). XINT1 watches it on both edges
+// while gated and measures the wake latency, the SYSCLKOUT cycles from
+// the edge to the C28x running again: XINT1CTR, plus in STANDBY the
+// qualification of the pin on OSCCLK (POWER_QUALSTDBY) that runs before
+// SYSCLKOUT starts. The project must not use XINT1 or WAKEINT itself.
+//
+// After a wake the receiver needs to restart and lock before the frame
+// data begins. power_locked(), called when the decoder locks, adds the
+// time from the wake to the lock and compares it with the preamble:
+// lock_bits is the preamble taken by the last wake, margin_bits what the
+// worst wake so far left of it, late counts wakes that locked after the
+// preamble was over, so the frame was lost. margin_bits must stay above
+// 0; if not, lengthen the preamble or sleep in IDLE instead of STANDBY.
+//
+// The CPU timer 2 time base (Boot.h, Trace.h) stops in STANDBY, trace
+// timestamps do not count the time asleep.
+//
+#define POWER_IDLE              0       // LPMCR0.LPM values
+#define POWER_STANDBY           1
+
+//
+// Clock enable bits for power_gate()
+//
+#define POWER_PCLKCR0_ADC       0x0008  // ADCENCLK
+#define POWER_PCLKCR1_EPWM(n)   (1 << ((n) - 1))
+
+//
+// The wake pin has to stay at its new level for POWER_QUALSTDBY + 2
+// OSCCLK cycles (10 MHz internal oscillator, 9 SYSCLKOUT cycles each)
+//
+#define POWER_QUALSTDBY         6
+#define POWER_STANDBY_CYCLES    ((POWER_QUALSTDBY + 2) * 9UL)
+
+//
+// Typedefs
+//
+typedef struct {
+    volatile Uint16 gated;      // 1 while asleep in power_gate()
+    Uint16 mode;                // POWER_IDLE or POWER_STANDBY of the last
+                                // power_gate()
+    Uint16 waiting;             // woken, decoder not locked yet
+    Uint16 preamble_bits;
+    Uint32 bit_cycles;          // SYSCLKOUT cycles per bit, keep it up to
+                                // date with the bit rate
+    Uint32 gates;               // power_gate() calls
+    Uint32 wake_stamp;          // CPU timer 2 time of the last wake
+    Uint32 wake_cycles;         // last wake latency
+    Uint32 wake_max;
+    Uint32 lock_cycles;         // last time from the edge to the lock
+    Uint32 lock_max;
+    Uint16 lock_bits;           // lock_cycles in bits
+    int16 margin_bits;          // preamble_bits - lock_max in bits
+    Uint32 late;                // wakes that locked after the preamble
+} power_t;
+
+//
+// Function Prototypes
+//
+void power_init(power_t *p, Uint16 wake_gpio, Uint16 preamble_bits,
+                Uint32 bit_cycles);
+void power_idle(void);
+void power_gate(power_t *p, Uint16 mode, Uint16 pclkcr0, Uint16 pclkcr1);
+void power_locked(power_t *p);
+__interrupt void power_edge_isr(void);
+__interrupt void power_wake_isr(void);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of POWER_H definition
+
+//
+// End of File
+//
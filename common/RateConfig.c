@@ -0,0 +1,209 @@
+//###########################################################################
+//
+// FILE:   RateConfig.c
+//
+// TITLE:  Run-time sample, bit and baud rate configuration
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "RateConfig.h"
+
+//
+// rate_div_round - Rounded unsigned division
+//
+static Uint32
+rate_div_round(Uint32 num, Uint32 den)
+{
+    return (num + den / 2) / den;
+}
+
+//
+// rate_sci_brr - SCI baud rate register value for baud
+//
+// BRR = LSPCLK / (baud * 8) - 1. Returns RATE_OK or the reason the baud
+// rate can not be set within RATE_MAX_SCI_ERROR_PPM.
+//
+Uint16
+rate_sci_brr(Uint32 baud, Uint16 *brr)
+{
+    Uint32 div;
+    Uint32 actual;
+    Uint32 err;
+
+    if(baud == 0)
+    {
+        return RATE_ERR_SCI_RANGE;
+    }
+
+    div = rate_div_round(RATE_LSPCLK_HZ, baud * 8);
+    if(div < 2 || div > 0x10000UL)
+    {
+        return RATE_ERR_SCI_RANGE;
+    }
+
+    actual = RATE_LSPCLK_HZ / (div * 8);
+    err = actual > baud ? actual - baud : baud - actual;
+    if(err * 1000000UL / baud > RATE_MAX_SCI_ERROR_PPM)
+    {
+        return RATE_ERR_SCI_ERROR;
+    }
+
+    *brr = (Uint16)(div - 1);
+    return RATE_OK;
+}
+
+//
+// rate_compute - Work out the register values for a rate request
+//
+// The sample period is rounded to whole clock counts and the bit period
+// is made an exact multiple of it, so the bit rate actually used can be
+// slightly off the request; see cfg->bit_rate. Nothing is written to the
+// hardware. Returns RATE_OK or the first check that failed, in which case
+// cfg is only partly filled and must not be applied.
+//
+Uint16
+rate_compute(const rate_request_t *req, rate_config_t *cfg)
+{
+    Uint32 sample_rate;
+    Uint32 counts;
+    Uint16 status;
+
+    cfg->req = *req;
+    cfg->adc_tbprd = 0;
+    cfg->bit_tbprd = 0;
+    cfg->timer_period = 0;
+    cfg->sci_brr = 0;
+
+    if(req->samples_per_bit < RATE_MIN_SAMPLES_PER_BIT || req->bit_rate == 0)
+    {
+        return RATE_ERR_SAMPLES_PER_BIT;
+    }
+    sample_rate = req->bit_rate * req->samples_per_bit;
+
+    if(req->sample_clock == RATE_CLOCK_EPWM)
+    {
+        //
+        // Up count mode: one period is TBPRD + 1 TBCLK counts
+        //
+        counts = rate_div_round(RATE_TBCLK_HZ, sample_rate);
+        if(counts < 2 || counts * req->samples_per_bit > 0x10000UL)
+        {
+            return RATE_ERR_TBPRD_RANGE;
+        }
+        cfg->adc_tbprd    = (Uint16)(counts - 1);
+        cfg->bit_tbprd    = (Uint16)(counts * req->samples_per_bit - 1);
+        cfg->timer_period = counts * (RATE_SYSCLK_HZ / RATE_TBCLK_HZ);
+    }
+    else
+    {
+        cfg->timer_period = rate_div_round(RATE_SYSCLK_HZ, sample_rate);
+        if(cfg->timer_period < RATE_MIN_TIMER_CYCLES)
+        {
+            return RATE_ERR_TIMER_TOO_FAST;
+        }
+    }
+
+    //
+    // All SOCs of one sample have to be converted before the next trigger
+    //
+    if((Uint32)req->adc_socs * RATE_ADC_SOC_CLOCKS *
+       (RATE_SYSCLK_HZ / RATE_ADCCLK_HZ) > cfg->timer_period)
+    {
+        return RATE_ERR_ADC_TOO_SLOW;
+    }
+
+    cfg->sample_rate = (float32)RATE_SYSCLK_HZ / (float32)cfg->timer_period;
+    cfg->bit_rate    = cfg->sample_rate / (float32)req->samples_per_bit;
+
+    if(req->sci_baud != 0)
+    {
+        status = rate_sci_brr(req->sci_baud, &cfg->sci_brr);
+        if(status != RATE_OK)
+        {
+            return status;
+        }
+        cfg->sci_baud = (float32)RATE_LSPCLK_HZ /
+                        ((float32)(cfg->sci_brr + 1) * 8.0f);
+    }
+    else
+    {
+        cfg->sci_baud = 0.0f;
+    }
+
+    return RATE_OK;
+}
+
+//
+// rate_sync_begin - Stop all ePWM time base clocks
+//
+void
+rate_sync_begin(void)
+{
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.TBCLKSYNC = 0;
+    EDIS;
+}
+
+//
+// rate_sync_end - Restart all ePWM time base clocks together
+//
+void
+rate_sync_end(void)
+{
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.TBCLKSYNC = 1;
+    EDIS;
+}
+
+//
+// rate_apply_epwm - Set a new period and restart the counter from zero
+//
+// The period is written straight to the active register, the shadow
+// would only be loaded at the next CTR = 0 which never comes while the
+// clocks are stopped. Call between rate_sync_begin() and rate_sync_end()
+// so all ePWMs restart in phase.
+//
+void
+rate_apply_epwm(volatile struct EPWM_REGS *pwm, Uint16 tbprd)
+{
+    Uint16 prdld = pwm->TBCTL.bit.PRDLD;
+
+    pwm->TBCTL.bit.PRDLD = TB_IMMEDIATE;
+    pwm->TBPRD           = tbprd;
+    pwm->TBCTL.bit.PRDLD = prdld;
+    pwm->TBCTR           = 0x0000;
+}
+
+//
+// rate_apply_sci - Set the SCI baud rate register
+//
+// Characters in flight are corrupted, call between frames.
+//
+void
+rate_apply_sci(volatile struct SCI_REGS *sci, Uint16 brr)
+{
+    sci->SCIHBAUD = brr >> 8;
+    sci->SCILBAUD = brr & 0x00FF;
+}
+
+//
+// rate_apply_cpu_timer - Set a CPU timer period in SYSCLKOUT cycles
+//
+// Call after ConfigCpuTimer(), which leaves the prescaler at /1. The
+// counter is reloaded right away and the timer keeps its run state.
+//
+void
+rate_apply_cpu_timer(struct CPUTIMER_VARS *timer, Uint32 period)
+{
+    timer->RegsAddr->PRD.all     = period - 1;
+    timer->RegsAddr->TCR.bit.TRB = 1;
+    timer->CPUFreqInMHz = (float)RATE_SYSCLK_HZ / 1000000.0f;
+    timer->PeriodInUSec = (float)period / timer->CPUFreqInMHz;
+}
+
+//
+// End of File
+//
@@ -0,0 +1,125 @@
+//###########################################################################
+//
+// FILE:   RateConfig.h
+//
+// TITLE:  Run-time sample, bit and baud rate configuration
+//
+//###########################################################################
+
+#ifndef RATE_CONFIG_H
+#define RATE_CONFIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// Clock tree after InitSysCtrl() on the F2806x:
+//      SYSCLKOUT = 90 MHz, also the CPU timer clock
+//      LSPCLK    = SYSCLKOUT / 4 (LOSPCP = 2), the SCI clock
+//      TBCLK     = SYSCLKOUT / 2 (HSPCLKDIV = /2, CLKDIV = /1), ePWM clock
+//      ADCCLK    = SYSCLKOUT / 2 (CLKDIV2EN = 1)
+//
+#define RATE_SYSCLK_HZ          90000000UL
+#define RATE_LSPCLK_HZ          (RATE_SYSCLK_HZ / 4)
+#define RATE_TBCLK_HZ           (RATE_SYSCLK_HZ / 2)
+#define RATE_ADCCLK_HZ          (RATE_SYSCLK_HZ / 2)
+
+//
+// One SOC takes ACQPS + 1 + 13 ADC clocks in non-overlap mode (ACQPS = 6)
+//
+#define RATE_ADC_SOC_CLOCKS     20
+
+//
+// Limits used to validate a request:
+// RATE_MIN_SAMPLES_PER_BIT   the Manchester decoder needs 2 per half bit
+// RATE_MAX_SCI_ERROR_PPM     baud error tolerated by both SCI ends
+// RATE_MIN_TIMER_CYCLES      CPU cycles per timer interrupt, leaves the
+//                            ISR and the main loop room to run
+//
+#define RATE_MIN_SAMPLES_PER_BIT 4
+#define RATE_MAX_SCI_ERROR_PPM  20000
+#define RATE_MIN_TIMER_CYCLES   300
+
+//
+// Sample clock source of a request
+//
+#define RATE_CLOCK_EPWM         0
+#define RATE_CLOCK_CPU_TIMER    1
+
+//
+// rate_compute() status, RATE_OK or the first check that failed
+//
+#define RATE_OK                 0
+#define RATE_ERR_SAMPLES_PER_BIT 1
+#define RATE_ERR_TBPRD_RANGE    2
+#define RATE_ERR_ADC_TOO_SLOW   3
+#define RATE_ERR_SCI_RANGE      4
+#define RATE_ERR_SCI_ERROR      5
+#define RATE_ERR_TIMER_TOO_FAST 6
+
+//
+// Typedefs
+//
+// bit_rate         requested Manchester bit rate in bit/s
+// samples_per_bit  samples per Manchester bit
+// sample_clock     RATE_CLOCK_EPWM or RATE_CLOCK_CPU_TIMER
+// adc_socs         SOCs converted on every sample, 0 if no ADC
+// sci_baud         requested SCI baud rate, 0 to leave the SCI alone
+//
+typedef struct {
+    Uint32 bit_rate;
+    Uint16 samples_per_bit;
+    Uint16 sample_clock;
+    Uint16 adc_socs;
+    Uint32 sci_baud;
+} rate_request_t;
+
+//
+// adc_tbprd        ePWM TBPRD (up count) for one sample period
+// bit_tbprd        ePWM TBPRD (up count) for one Manchester bit, an exact
+//                  multiple of the sample period so TX and RX stay locked
+// timer_period     CPU timer counts (SYSCLKOUT) for one sample period
+// sci_brr          SCI baud rate register value
+// sample_rate      actual sample rate in Hz
+// bit_rate         actual bit rate in bit/s
+// sci_baud         actual SCI baud rate
+//
+typedef struct {
+    rate_request_t req;
+    Uint16 adc_tbprd;
+    Uint16 bit_tbprd;
+    Uint32 timer_period;
+    Uint16 sci_brr;
+    float32 sample_rate;
+    float32 bit_rate;
+    float32 sci_baud;
+} rate_config_t;
+
+//
+// Function Prototypes
+//
+Uint16 rate_compute(const rate_request_t *req, rate_config_t *cfg);
+Uint16 rate_sci_brr(Uint32 baud, Uint16 *brr);
+void rate_sync_begin(void);
+void rate_sync_end(void);
+void rate_apply_epwm(volatile struct EPWM_REGS *pwm, Uint16 tbprd);
+void rate_apply_sci(volatile struct SCI_REGS *sci, Uint16 brr);
+void rate_apply_cpu_timer(struct CPUTIMER_VARS *timer, Uint32 period);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of RATE_CONFIG_H definition
+
+//
+// End of File
+//
@@ -0,0 +1,234 @@
+//###########################################################################
+//
+// FILE:   Telemetry.c
+//
+// TITLE:  COBS framed binary telemetry over an SCI port
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Telemetry.h"
+#include "RateConfig.h"
+
+//
+// telemetry_poll() runs on every main loop pass, in RAM for flash
+// builds (Boot.h)
+//
+#pragma CODE_SECTION(telemetry_poll, "ramfuncs");
+
+//
+// telemetry_put - Append one encoded byte, space was checked by the caller
+//
+static void
+telemetry_put(telemetry_t *t, Uint16 b)
+{
+    t->buf[t->tail] = b;
+    t->tail++;
+    if(t->tail == TELEMETRY_BUF_LEN)
+    {
+        t->tail = 0;
+    }
+}
+
+//
+// telemetry_cobs - Feed one frame byte to the COBS encoder
+//
+// A code byte is reserved in front of every run of non-zero bytes and
+// filled in with the run length + 1 when the run ends, at a zero or
+// after 254 bytes.
+//
+static void
+telemetry_cobs(telemetry_t *t, Uint16 b)
+{
+    if(b != 0)
+    {
+        telemetry_put(t, b);
+        t->code++;
+    }
+    if(b == 0 || t->code == 0xFF)
+    {
+        t->buf[t->code_pos] = t->code;
+        t->code_pos = t->tail;
+        telemetry_put(t, 0);
+        t->code = 1;
+    }
+}
+
+//
+// telemetry_init - Set up the SCI for transmit only, 8N1 at brr
+//
+// The receiver is left off, the FIFO is used for transmit.
+//
+void
+telemetry_init(telemetry_t *t, volatile struct SCI_REGS *regs, Uint16 brr)
+{
+    t->regs   = regs;
+    t->head   = 0;
+    t->tail   = 0;
+    t->seq    = 0;
+    t->frames = 0;
+    t->drops  = 0;
+    t->bytes  = 0;
+
+    //
+    // 1 stop bit, no loopback, no parity, 8 char bits, async mode
+    // Enable TX and the internal SCICLK, no interrupts
+    //
+    regs->SCICCR.all  = 0x0007;
+    regs->SCICTL1.all = 0x0002;
+    regs->SCICTL2.all = 0x0000;
+    rate_apply_sci(regs, brr);
+    regs->SCIFFTX.all = 0xE040;
+    regs->SCIFFCT.all = 0x0000;
+    regs->SCICTL1.all = 0x0022;     // Relinquish SCI from Reset
+}
+
+//
+// telemetry_room - Returns 1 if a frame with len payload bytes fits in
+// the buffer now
+//
+Uint16
+telemetry_room(const telemetry_t *t, Uint16 len)
+{
+    Uint16 used;
+
+    //
+    // Worst case: type, seq, CRC, one code byte per 254 bytes plus the
+    // first one, and the delimiter
+    //
+    used = (t->tail + TELEMETRY_BUF_LEN - t->head) % TELEMETRY_BUF_LEN;
+    return len <= TELEMETRY_MAX_PAYLOAD &&
+           len + 4 + (len + 4) / 254 + 2 <= TELEMETRY_BUF_LEN - 1 - used;
+}
+
+//
+// telemetry_send - Frame and queue one telemetry record
+//
+// payload holds one byte per word. Returns 1 if the frame was queued,
+// 0 if it was dropped because the buffer is full; the telemetry must
+// never hold up the main loop.
+//
+Uint16
+telemetry_send(telemetry_t *t, Uint16 type, const Uint16 *payload,
+               Uint16 len)
+{
+    Uint16 crc = 0xFFFF;
+    Uint16 i;
+
+    if(!telemetry_room(t, len))
+    {
+        t->drops++;
+        return 0;
+    }
+
+    t->code_pos = t->tail;
+    telemetry_put(t, 0);
+    t->code = 1;
+
+    type &= 0x00FF;
+    crc = telemetry_crc16(crc, type);
+    telemetry_cobs(t, type);
+    crc = telemetry_crc16(crc, t->seq);
+    telemetry_cobs(t, t->seq);
+    for(i = 0; i < len; i++)
+    {
+        crc = telemetry_crc16(crc, payload[i] & 0x00FF);
+        telemetry_cobs(t, payload[i] & 0x00FF);
+    }
+    telemetry_cobs(t, crc & 0x00FF);
+    telemetry_cobs(t, crc >> 8);
+
+    t->buf[t->code_pos] = t->code;
+    telemetry_put(t, 0);
+
+    t->seq = (t->seq + 1) & 0x00FF;
+    t->frames++;
+    return 1;
+}
+
+//
+// telemetry_poll - Move queued bytes into the SCI transmit FIFO
+//
+// Never waits. Call from the main loop often enough to keep the 4 word
+// FIFO from running dry, about every 28 us at TELEMETRY_BAUD.
+//
+void
+telemetry_poll(telemetry_t *t)
+{
+    while(t->head != t->tail && t->regs->SCIFFTX.bit.TXFFST < 4)
+    {
+        t->regs->SCITXBUF = t->buf[t->head];
+        t->head++;
+        if(t->head == TELEMETRY_BUF_LEN)
+        {
+            t->head = 0;
+        }
+        t->bytes++;
+    }
+}
+
+//
+// telemetry_pack16 - Store v little endian, returns the next free byte
+//
+Uint16 *
+telemetry_pack16(Uint16 *p, Uint16 v)
+{
+    *p++ = v & 0x00FF;
+    *p++ = v >> 8;
+    return p;
+}
+
+//
+// telemetry_pack32 - Store v little endian, returns the next free byte
+//
+Uint16 *
+telemetry_pack32(Uint16 *p, Uint32 v)
+{
+    p = telemetry_pack16(p, (Uint16)(v & 0xFFFF));
+    return telemetry_pack16(p, (Uint16)(v >> 16));
+}
+
+//
+// telemetry_packf - Store the IEEE 754 bits of v, returns the next free
+// byte
+//
+Uint16 *
+telemetry_packf(Uint16 *p, float32 v)
+{
+    union {
+        float32 f;
+        Uint32 u;
+    } bits;
+
+    bits.f = v;
+    return telemetry_pack32(p, bits.u);
+}
+
+//
+// telemetry_crc16 - CRC-16/CCITT, one byte at a time
+//
+Uint16
+telemetry_crc16(Uint16 crc, Uint16 byte)
+{
+    Uint16 i;
+
+    crc ^= (byte & 0x00FF) << 8;
+    for(i = 0; i < 8; i++)
+    {
+        if(crc & 0x8000)
+        {
+            crc = (crc << 1) ^ 0x1021;
+        }
+        else
+        {
+            crc <<= 1;
+        }
+    }
+    return crc;
+}
+
+//
+// End of File
+//
@@ -0,0 +1,110 @@
+//###########################################################################
+//
+// FILE:   Telemetry.h
+//
+// TITLE:  COBS framed binary telemetry over an SCI port
+//
+//###########################################################################
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// On the wire every frame is
+//      COBS(type, seq, payload..., crc_lo, crc_hi) 0x00
+// COBS removes all zero bytes so 0x00 only ever marks the end of a
+// frame and a receiver can start at any point of the stream. The CRC is
+// CRC-16/CCITT (poly 0x1021, init 0xFFFF) over type, seq and payload.
+// seq counts frames of all types, a gap means frames were dropped.
+// Multi-byte fields are little endian, floats are IEEE 754 single.
+//
+// TELEMETRY_BAUD is the fastest SCI rate at LSPCLK = 22.5 MHz,
+// LSPCLK / 16 with BRR = 1.
+//
+#define TELEMETRY_BAUD          1406250UL
+#define TELEMETRY_BUF_LEN       512
+#define TELEMETRY_MAX_PAYLOAD   250
+
+//
+// Frame types and their payloads
+//
+// TELEMETRY_SAMPLES        decimation (u16), index of the first sample
+//                          (u32), n (u8), then n x (raw u16, filtered u16)
+// TELEMETRY_COUNTERS       rx bits, rx sync losses, BER bits, BER errors,
+//                          BER resyncs, TX frames (all u32), best channel
+//                          (u8), channels (u8), then SNR per channel (f32)
+// TELEMETRY_PROFILE        main loop passes (u32), max decoder backlog in
+//                          samples (u16), telemetry drops (u32),
+//                          telemetry bytes sent (u32), sample buffer
+//                          overruns (u32)
+// TELEMETRY_EYE            windows (u32), sample rate (f32), phases (u8),
+//                          best phase (u8), opening (i16), Q (f32),
+//                          SNR dB (f32), edge period (f32), jitter (f32),
+//                          the last two in samples
+// TELEMETRY_EYE_ROW        window (u32), phase (u8), bins (u8), then
+//                          bins x count (u16), one frame per phase
+// TELEMETRY_TRACE          records written (u32), index of the first
+//                          record (u16), n (u8), then n x (time u32,
+//                          type u8, source u8, data u16), see Trace.h
+//
+#define TELEMETRY_SAMPLES       0x01
+#define TELEMETRY_COUNTERS      0x02
+#define TELEMETRY_PROFILE       0x03
+#define TELEMETRY_EYE           0x04
+#define TELEMETRY_EYE_ROW       0x05
+#define TELEMETRY_TRACE         0x06
+
+//
+// Typedefs
+//
+// buf holds encoded bytes (one per word) waiting for the SCI FIFO.
+// telemetry_send() appends at tail, telemetry_poll() sends from head;
+// both are called from the main loop only.
+//
+typedef struct {
+    volatile struct SCI_REGS *regs;
+    Uint16 buf[TELEMETRY_BUF_LEN];
+    Uint16 head;
+    Uint16 tail;
+    Uint16 code_pos;            // COBS code byte being filled
+    Uint16 code;
+    Uint16 seq;
+    Uint32 frames;
+    Uint32 drops;               // frames not queued, buffer full
+    Uint32 bytes;               // bytes written to the SCI
+} telemetry_t;
+
+//
+// Function Prototypes
+//
+void telemetry_init(telemetry_t *t, volatile struct SCI_REGS *regs,
+                    Uint16 brr);
+Uint16 telemetry_room(const telemetry_t *t, Uint16 len);
+Uint16 telemetry_send(telemetry_t *t, Uint16 type, const Uint16 *payload,
+                      Uint16 len);
+void telemetry_poll(telemetry_t *t);
+Uint16 *telemetry_pack16(Uint16 *p, Uint16 v);
+Uint16 *telemetry_pack32(Uint16 *p, Uint32 v);
+Uint16 *telemetry_packf(Uint16 *p, float32 v);
+Uint16 telemetry_crc16(Uint16 crc, Uint16 byte);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of TELEMETRY_H definition
+
+//
+// End of File
+//
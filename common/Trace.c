@@ -0,0 +1,207 @@
+//###########################################################################
+//
+// FILE:   Trace.c
+//
+// TITLE:  Timestamped ISR and event trace ring
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "Trace.h"
+
+#if TRACE_ENABLE
+
+//
+// trace_put is called from the ISRs, keep it in RAM (Boot.h)
+//
+#pragma CODE_SECTION(trace_put, "ramfuncs");
+
+//
+// Globals
+//
+volatile trace_t Trace;
+
+//
+// Function Prototypes
+//
+static void trace_xmit(volatile struct SCI_REGS *regs, Uint16 c);
+static void trace_xmit_u32(volatile struct SCI_REGS *regs, Uint32 v);
+
+//
+// trace_init - Empty the ring and start recording
+//
+// Call before the interrupts are enabled. The time base is CPU timer 2,
+// started by boot_start() and left running by boot_done().
+//
+void
+trace_init(void)
+{
+    Trace.on    = 0;
+    Trace.count = 0;
+    Trace.len   = TRACE_LEN;
+    Trace.on    = 1;
+}
+
+//
+// trace_put - Record one event, use the TRACE macros rather than calling
+// it directly
+//
+// Safe from any ISR and the main loop: the slot is taken and the time
+// read with the interrupts held off for a few cycles, so a nested
+// interrupt gets the next slot and a later time. No-op once frozen.
+//
+void
+trace_put(Uint16 event, Uint16 data)
+{
+    volatile trace_rec_t *r;
+    Uint16 st;
+
+    if(!Trace.on)
+    {
+        return;
+    }
+
+    st = __disable_interrupts();
+    r = &Trace.rec[(Uint16)Trace.count & (TRACE_LEN - 1)];
+    Trace.count++;
+    r->time = 0xFFFFFFFF - CpuTimer2Regs.TIM.all;
+    __restore_interrupts(st);
+
+    r->event = event;
+    r->data  = data;
+}
+
+//
+// trace_freeze - Stop recording, the ring keeps the last TRACE_LEN events
+//
+void
+trace_freeze(void)
+{
+    Trace.on = 0;
+}
+
+//
+// trace_records - Number of records in the ring
+//
+Uint16
+trace_records(void)
+{
+    return Trace.count < TRACE_LEN ? (Uint16)Trace.count : TRACE_LEN;
+}
+
+//
+// trace_get - Copy record n, 0 is the oldest one in the ring
+//
+// Only meaningful while frozen, a running trace overwrites the oldest
+// records.
+//
+void
+trace_get(Uint16 n, trace_rec_t *rec)
+{
+    Uint16 i;
+
+    i = ((Uint16)Trace.count - trace_records() + n) & (TRACE_LEN - 1);
+    rec->time  = Trace.rec[i].time;
+    rec->event = Trace.rec[i].event;
+    rec->data  = Trace.rec[i].data;
+}
+
+//
+// trace_dump_sci - Freeze the trace and send it as text, polling the SCI
+//
+//      # trace <count>
+//      time,type,src,data
+//      ...
+//      # end
+//
+// one record per line in decimal, oldest first. A record takes about
+// 2 ms at 115200 baud; call from the main loop, not from an ISR.
+//
+void
+trace_dump_sci(volatile struct SCI_REGS *regs)
+{
+    static const char head[] = "# trace ";
+    static const char end[]  = "# end\r\n";
+    trace_rec_t rec;
+    Uint16 n, i;
+
+    trace_freeze();
+
+    for(i = 0; head[i] != '\0'; i++)
+    {
+        trace_xmit(regs, head[i]);
+    }
+    trace_xmit_u32(regs, Trace.count);
+    trace_xmit(regs, '\r');
+    trace_xmit(regs, '\n');
+
+    n = trace_records();
+    for(i = 0; i < n; i++)
+    {
+        trace_get(i, &rec);
+        trace_xmit_u32(regs, rec.time);
+        trace_xmit(regs, ',');
+        trace_xmit_u32(regs, rec.event >> 8);
+        trace_xmit(regs, ',');
+        trace_xmit_u32(regs, rec.event & 0xFF);
+        trace_xmit(regs, ',');
+        trace_xmit_u32(regs, rec.data);
+        trace_xmit(regs, '\r');
+        trace_xmit(regs, '\n');
+    }
+
+    for(i = 0; end[i] != '\0'; i++)
+    {
+        trace_xmit(regs, end[i]);
+    }
+}
+
+//
+// trace_xmit - Send one character, with or without the SCI FIFO
+//
+static void
+trace_xmit(volatile struct SCI_REGS *regs, Uint16 c)
+{
+    if(regs->SCIFFTX.bit.SCIFFENA)
+    {
+        while(regs->SCIFFTX.bit.TXFFST >= 4)
+        {
+        }
+    }
+    else
+    {
+        while(!regs->SCICTL2.bit.TXRDY)
+        {
+        }
+    }
+    regs->SCITXBUF = c;
+}
+
+//
+// trace_xmit_u32 - Send v in decimal
+//
+static void
+trace_xmit_u32(volatile struct SCI_REGS *regs, Uint32 v)
+{
+    char digits[10];
+    Uint16 n = 0;
+
+    do
+    {
+        digits[n++] = '0' + (char)(v % 10);
+        v /= 10;
+    } while(v != 0);
+
+    while(n != 0)
+    {
+        trace_xmit(regs, digits[--n]);
+    }
+}
+
+#endif // TRACE_ENABLE
+
+//
+// End of File
+//
@@ -0,0 +1,146 @@
+//###########################################################################
+//
+// FILE:   Trace.h
+//
+// TITLE:  Timestamped ISR and event trace ring
+//
+//###########################################################################
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// The trace is off unless the project is built with
+//      --define=TRACE_ENABLE=1
+// (Properties > Build > Compiler > Predefined Symbols). Set it for the
+// whole project, not per file, the TRACE_* macros then record into the
+// ring and Trace.c is compiled; without it they expand to nothing and
+// Trace.c is empty.
+//
+// Every record is 4 words: the time in SYSCLKOUT cycles since
+// boot_start() (CPU timer 2, see Boot.h), the event type and source and
+// 16 bits of data. The ring keeps the last TRACE_LEN records (a power
+// of 2). trace_freeze() stops recording so the events leading up to a
+// fault stay in the ring, e.g. for a missed sample deadline.
+//
+// A record takes about 25 cycles with the call. host/isr_timeline.py
+// reads a dump (trace_dump_sci(), the TELEMETRY_TRACE frames of
+// telemetry_decode or a CCS memory save of Trace) and prints the timeline
+// and the deadline misses.
+//
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE            0
+#endif
+
+#define TRACE_LEN               256
+
+//
+// Event types, data is
+// TRACE_ENTER      0, ISR entry
+// TRACE_EXIT       0, ISR exit
+// TRACE_FIFO       entries waiting in a FIFO or buffer
+// TRACE_OVERRUN    entries or samples lost
+// TRACE_STATE      the new state
+// TRACE_MARK       anything
+//
+#define TRACE_ENTER             1
+#define TRACE_EXIT              2
+#define TRACE_FIFO              3
+#define TRACE_OVERRUN           4
+#define TRACE_STATE             5
+#define TRACE_MARK              6
+
+//
+// Event sources, shared by all projects so the host script can name them
+//
+#define TRACE_SRC_ADC           1   // cla1_isr7 / adc_isr7, one per sample
+#define TRACE_SRC_TX            2   // manchester_tx_isr / pam4_tx_isr
+#define TRACE_SRC_SCIB          3   // scib_isr
+#define TRACE_SRC_XINT1         4
+#define TRACE_SRC_XINT2         5
+#define TRACE_SRC_TIMER0        6   // timerCLK_isr
+#define TRACE_SRC_TIMER1        7   // timerWIN_isr
+#define TRACE_SRC_MAIN          8   // main loop
+#define TRACE_SRC_RX            9   // Manchester decoder lock
+#define TRACE_SRC_RATE          10  // rate changes
+#define TRACE_SRC_POWER         11  // power_gate(), 1 + mode asleep, 0 awake
+#define TRACE_SRC_CARRIER       12  // carrier detector, 1 receive, 0 detect
+#define TRACE_SRC_LINK          13  // link mode, 0 Manchester, 1 PAM-4
+#define TRACE_SRC_EQ            14  // equalizer, 0 reset, else EqMode
+#define TRACE_SRC_LINE          15  // line code, LINE_xxx (LineCode.h)
+
+#if TRACE_ENABLE
+#define TRACE(type, src, data)  trace_put(((type) << 8) | (src), (data))
+#define TRACE_INIT()            trace_init()
+#define TRACE_FREEZE()          trace_freeze()
+#else
+#define TRACE(type, src, data)
+#define TRACE_INIT()
+#define TRACE_FREEZE()
+#endif
+
+#define TRACE_ISR_ENTER(src)    TRACE(TRACE_ENTER, src, 0)
+#define TRACE_ISR_EXIT(src)     TRACE(TRACE_EXIT, src, 0)
+
+#if TRACE_ENABLE
+
+//
+// Typedefs
+//
+// event is type << 8 | source
+//
+typedef struct {
+    Uint32 time;
+    Uint16 event;
+    Uint16 data;
+} trace_rec_t;
+
+//
+// count is the number of records written since trace_init(), the next
+// one goes to rec[count % TRACE_LEN]. The layout is read by
+// host/isr_timeline.py from a memory save, keep it in step.
+//
+typedef struct {
+    Uint32 count;
+    Uint16 on;
+    Uint16 len;
+    trace_rec_t rec[TRACE_LEN];
+} trace_t;
+
+//
+// Globals
+//
+extern volatile trace_t Trace;
+
+//
+// Function Prototypes
+//
+void trace_init(void);
+void trace_put(Uint16 event, Uint16 data);
+void trace_freeze(void);
+Uint16 trace_records(void);
+void trace_get(Uint16 n, trace_rec_t *rec);
+void trace_dump_sci(volatile struct SCI_REGS *regs);
+
+#endif // TRACE_ENABLE
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of TRACE_H definition
+
+//
+// End of File
+//
@@ -0,0 +1,44 @@
+//###########################################################################
+//
+// FILE:   DSP28x_Project.h
+//
+// TITLE:  Host stand-in for the device header
+//
+// Only the C2000 integer and float types, so the hardware independent
+// firmware modules and the shared protocol headers compile on the PC.
+// Anything that touches a peripheral register does not build here.
+//
+//###########################################################################
+
+#ifndef DSP28x_PROJECT_H
+#define DSP28x_PROJECT_H
+
+#include <stdint.h>
+
+typedef int16_t     int16;
+typedef int32_t     int32;
+typedef int64_t     int64;
+typedef uint16_t    Uint16;
+typedef uint32_t    Uint32;
+typedef uint64_t    Uint64;
+typedef float       float32;
+typedef double      float64;
+
+#define __interrupt
+
+//
+// Shared modules test HOST_BUILD for the parts that differ on the PC,
+// e.g. the clock of Bench.c
+//
+#define HOST_BUILD
+
+//
+// The firmware places its hot paths with #pragma CODE_SECTION
+//
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+
+#endif  // end of DSP28x_PROJECT_H definition
+
+//
+// End of File
+//
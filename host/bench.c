@@ -0,0 +1,145 @@
+//###########################################################################
+//
+// FILE:   bench.c
+//
+// TITLE:  Host build of the firmware kernel benchmarks
+//
+// Build (Linux):
+//      gcc -O2 -Wall -I. -I../common -I../Example_2806xClaAdcFir
+//          -o bench bench.c ../common/Bench.c ../common/BufferDecode.c
+//          ../common/LineCode.c ../common/ManchesterWord.c
+//          ../Example_2806xClaAdcFir/BenchSuite.c
+//          ../Example_2806xClaAdcFir/Eye.c
+//          ../Example_2806xClaAdcFir/ManchesterRx.c
+//          ../Example_2806xClaAdcFir/Pam4Rx.c
+//          ../Example_2806xClaAdcFir/Prbs.c -lm
+//
+// Usage:
+//      bench [-f csv|json] [-n calls] [-o file]
+//      -f csv|json     report format (default csv)
+//      -n calls        timed calls per kernel (default 1000)
+//      -o file         report file, default stdout
+//
+// Runs the cases of BenchSuite.c that build on the PC with the same
+// code as the firmware and writes the table of Bench.h, in nanoseconds.
+// The figures only compare builds on the same machine; the target runs
+// the suite in cycles with BENCH_ENABLE=1. Compare two reports with
+// bench_compare.py.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP28x_Project.h"
+#include "Bench.h"
+#include "BenchSuite.h"
+
+//
+// Globals
+//
+static FILE *Out;
+
+//
+// Function Prototypes
+//
+static void put(Uint16 c);
+static void usage(void);
+
+//
+// main
+//
+int
+main(int argc, char **argv)
+{
+    bench_result_t res[BENCH_SUITE_CASES];
+    Uint16 format = BENCH_CSV;
+    long calls = 1000;
+    const char *path = 0;
+    Uint16 n;
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        if(i + 1 >= argc || argv[i][0] != '-' || argv[i][2] != '\0')
+        {
+            usage();
+        }
+        switch(argv[i][1])
+        {
+            case 'f':
+                if(strcmp(argv[++i], "csv") == 0)
+                {
+                    format = BENCH_CSV;
+                }
+                else if(strcmp(argv[i], "json") == 0)
+                {
+                    format = BENCH_JSON;
+                }
+                else
+                {
+                    usage();
+                }
+                break;
+            case 'n':
+                calls = strtol(argv[++i], 0, 0);
+                if(calls < 1 || calls > 65535)
+                {
+                    usage();
+                }
+                break;
+            case 'o':
+                path = argv[++i];
+                break;
+            default:
+                usage();
+        }
+    }
+
+    Out = stdout;
+    if(path != 0 && (Out = fopen(path, "w")) == 0)
+    {
+        perror(path);
+        return 1;
+    }
+
+    n = bench_suite_run(res, (Uint16)calls);
+    bench_write(res, n, format, put);
+
+    if(Out != stdout && fclose(Out) != 0)
+    {
+        perror(path);
+        return 1;
+    }
+    return 0;
+}
+
+//
+// put - Write one report character, the firmware line ends become '\n'
+//
+static void
+put(Uint16 c)
+{
+    if(c != '\r')
+    {
+        fputc(c, Out);
+    }
+}
+
+//
+// usage - Print the options and exit
+//
+static void
+usage(void)
+{
+    fprintf(stderr, "usage: bench [-f csv|json] [-n calls] [-o file]\n");
+    exit(2);
+}
+
+//
+// End of File
+//
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+#############################################################################
+#
+# FILE:   bench_compare.py
+#
+# TITLE:  Compare two benchmark reports (Bench.h) and flag regressions
+#
+# Usage:
+#       bench_compare.py [-f min|avg|max] [-t PCT] old.csv|json new.csv|json
+#
+# Reads two reports written by the firmware (BENCH_ENABLE=1, captured off
+# SCI-A) or by host/bench, in CSV or JSON, and prints per kernel the cost
+# per unit (sample, bit, byte or call) in both and the change. The cost
+# is the -f figure of a call divided by its units, by default the minimum
+# which is the least disturbed by interrupts and the host scheduler.
+#
+# A kernel more than -t percent (default 10) slower in the new report is
+# a regression. Kernels found in only one report are listed. Reports on
+# different clocks (cycles and ns) are compared anyway, with a warning.
+#
+# The exit status is 1 if there was a regression, 2 if a report could
+# not be read.
+#
+#############################################################################
+
+import argparse
+import csv
+import json
+import sys
+
+
+def load(path):
+    """clock name and {kernel: row} of a CSV or JSON report"""
+    with open(path, errors='replace') as f:
+        text = f.read()
+    start = text.find('{"clock"')
+    if start >= 0:
+        rep = json.JSONDecoder().raw_decode(text[start:])[0]
+        return rep['clock'], {r['name']: r for r in rep['results']}
+    start = text.find('name,unit,units')
+    if start < 0:
+        raise ValueError('no benchmark report found')
+    rows = {}
+    clock = None
+    for r in csv.DictReader(text[start:].splitlines()):
+        if r.get('clock') is None:
+            break
+        clock = r['clock']
+        rows[r['name']] = {k: r[k] if k in ('name', 'unit', 'clock')
+                           else float(r[k]) for k in r}
+    return clock, rows
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Compare two benchmark reports')
+    ap.add_argument('old')
+    ap.add_argument('new')
+    ap.add_argument('-f', '--field', choices=('min', 'avg', 'max'),
+                    default='min', help='figure compared (default min)')
+    ap.add_argument('-t', '--threshold', type=float, default=10.0,
+                    metavar='PCT', help='regression threshold in percent')
+    args = ap.parse_args()
+
+    reports = []
+    for path in (args.old, args.new):
+        try:
+            reports.append(load(path))
+        except (OSError, ValueError, KeyError) as e:
+            print('%s: %s' % (path, e), file=sys.stderr)
+            return 2
+    (old_clock, old), (new_clock, new) = reports
+    if old_clock != new_clock:
+        print('warning: comparing %s with %s' % (old_clock, new_clock),
+              file=sys.stderr)
+
+    worse = 0
+    print('%-24s %-6s %10s %10s %8s' % ('kernel', 'unit', 'old', 'new',
+                                        'change'))
+    for name in list(old) + [n for n in new if n not in old]:
+        if name not in new or name not in old:
+            print('%-24s only in %s' % (name,
+                                       args.old if name in old else args.new))
+            continue
+        a = float(old[name][args.field]) / max(float(old[name]['units']), 1)
+        b = float(new[name][args.field]) / max(float(new[name]['units']), 1)
+        change = (b - a) * 100.0 / a if a else 0.0
+        flag = ''
+        if change > args.threshold:
+            flag = '  REGRESSION'
+            worse += 1
+        print('%-24s %-6s %10.2f %10.2f %+7.1f%%%s' %
+              (name, new[name]['unit'], a, b, change, flag))
+
+    print('%d regression(s) over %.1f%%' % (worse, args.threshold))
+    return 1 if worse else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
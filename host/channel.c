@@ -0,0 +1,246 @@
+//###########################################################################
+//
+// FILE:   channel.c
+//
+// TITLE:  Synthetic Manchester waveforms in ADC codes for the host tools
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <math.h>
+
+#include "channel.h"
+
+//
+// Defines
+//
+// CHANNEL_FLICKER_MEAN is the mean of a rectified sine, 2/pi in Q15
+//
+#define CHANNEL_FLICKER_MEAN    20861
+
+//
+// Function Prototypes
+//
+static Uint32 channel_rand(channel_t *ch);
+static int32 channel_flicker(channel_t *ch);
+
+//
+// channel_init - A clean channel, set the other fields before
+// channel_start()
+//
+void
+channel_init(channel_t *ch, Uint16 samples_per_bit, Uint16 high,
+             Uint16 low)
+{
+    Uint16 i;
+
+    ch->samples_per_bit = samples_per_bit;
+    ch->sample_rate = 1000000;
+    ch->high = high;
+    ch->low = low;
+    ch->noise = 0;
+    ch->wander = 0;
+    ch->wander_hz = 1.0;
+    ch->flicker = 0;
+    ch->mains_hz = 50;
+    ch->impulse = 0;
+    ch->impulse_len = 20;
+    ch->impulse_rate = 0.0;
+    ch->taps = 0;
+    for(i = 0; i < CHANNEL_FIR_MAX; i++)
+    {
+        ch->fir[i] = 0;
+    }
+    ch->drift_ppm = 0;
+    ch->levels = 0;
+    ch->seed = 1;
+    channel_start(ch);
+}
+
+//
+// channel_start - Restart the waveform and the generator at the seed
+//
+void
+channel_start(channel_t *ch)
+{
+    float64 alpha;
+    Uint16 i;
+
+    ch->rng = ch->seed != 0 ? ch->seed : 1;
+    ch->pos = 0;
+    ch->step = ((Uint64)65536 * 1000000) / (Uint64)(1000000 + ch->drift_ppm);
+
+    for(i = 0; i < CHANNEL_FIR_MAX; i++)
+    {
+        ch->line[i] = (ch->high + ch->low) / 2;
+    }
+    ch->head = 0;
+
+    //
+    // A one pole low pass y += alpha * (x - y) keeps alpha / (2 - alpha)
+    // of the power of white noise x
+    //
+    alpha = 2.0 * 3.14159265358979 * ch->wander_hz / ch->sample_rate;
+    alpha = alpha < 1.0 ? alpha : 1.0;
+    ch->wander_alpha = (Uint32)(alpha * 4294967295.0);
+    ch->wander_in = ch->wander_alpha != 0 ?
+                    (Uint32)(ch->wander * sqrt((2.0 - alpha) / alpha)) : 0;
+    ch->wander_y = 0;
+
+    ch->flicker_phase = 0;
+    ch->flicker_step = (Uint32)(2.0 * ch->mains_hz / ch->sample_rate *
+                                4294967296.0);
+
+    ch->impulse_p = (Uint32)(ch->impulse_rate / ch->sample_rate *
+                             4294967296.0);
+    ch->impulse_env = 0;
+    ch->impulse_decay = ch->impulse_len > 1 ?
+                        65536 - 65536 / ch->impulse_len : 0;
+}
+
+//
+// channel_bits - Sample nbits bits into out, returns the number of
+// samples written, at most max
+//
+// The bits continue where the last call stopped, so a long stream can
+// be written in pieces. A call cut short by max drops the rest of its
+// bits.
+//
+Uint32
+channel_bits(channel_t *ch, const Uint16 *bits, Uint32 nbits, Uint16 *out,
+             Uint32 max)
+{
+    Uint64 end = ((Uint64)nbits * ch->samples_per_bit) << 16;
+    Uint32 bit, phase;
+    Uint32 n = 0;
+    int64 acc;
+    int32 code, impulse;
+    Uint16 i, j;
+
+    for(; ch->pos < end && n < max; ch->pos += ch->step)
+    {
+        bit = (Uint32)(ch->pos >> 16) / ch->samples_per_bit;
+        phase = (Uint32)(ch->pos >> 16) % ch->samples_per_bit;
+        if(ch->levels != 0)
+        {
+            code = ch->low + ((int32)ch->high - ch->low) * bits[bit] /
+                             (ch->levels - 1);
+        }
+        else if((phase < ch->samples_per_bit / 2) == (bits[bit] != 0))
+        {
+            code = ch->low;
+        }
+        else
+        {
+            code = ch->high;
+        }
+
+        if(ch->taps != 0)
+        {
+            ch->head = ch->head ? ch->head - 1 : CHANNEL_FIR_MAX - 1;
+            ch->line[ch->head] = code;
+            acc = 0;
+            for(i = 0, j = ch->head; i < ch->taps; i++)
+            {
+                acc += (int64)ch->fir[i] * ch->line[j];
+                j = j + 1 < CHANNEL_FIR_MAX ? j + 1 : 0;
+            }
+            code = (int32)(acc >> 15);
+        }
+        if(ch->wander_in != 0)
+        {
+            acc = ((int64)channel_gauss(ch, ch->wander_in) << 16) -
+                  ch->wander_y;
+            ch->wander_y += ((acc >> 16) * ch->wander_alpha) >> 16;
+            code += (int32)(ch->wander_y >> 16);
+        }
+        if(ch->flicker != 0)
+        {
+            code += channel_flicker(ch);
+        }
+        if(ch->impulse_p != 0)
+        {
+            if(channel_rand(ch) < ch->impulse_p)
+            {
+                ch->impulse_env = (Uint32)ch->impulse << 16;
+            }
+            if(ch->impulse_env != 0)
+            {
+                impulse = (int32)(ch->impulse_env >> 16);
+                code += (channel_rand(ch) & 1) ? impulse : -impulse;
+                ch->impulse_env = (Uint32)(((Uint64)ch->impulse_env *
+                                            ch->impulse_decay) >> 16);
+            }
+        }
+        if(ch->noise != 0)
+        {
+            code += channel_gauss(ch, ch->noise);
+        }
+        out[n++] = code < 0 ? 0 :
+                   code > CHANNEL_CODE_MAX ? CHANNEL_CODE_MAX : (Uint16)code;
+    }
+
+    //
+    // pos is kept relative to the next call's first bit
+    //
+    ch->pos = ch->pos >= end ? ch->pos - end : 0;
+    return n;
+}
+
+//
+// channel_gauss - Gaussian number of the given rms, the sum of twelve
+// uniform numbers (Irwin-Hall)
+//
+int32
+channel_gauss(channel_t *ch, Uint32 rms)
+{
+    int64 sum = 0;
+    Uint16 i;
+
+    for(i = 0; i < 12; i++)
+    {
+        sum += channel_rand(ch) >> 16;
+    }
+    sum -= 6 * 65536;
+    return (int32)((sum * rms) / 65536);
+}
+
+//
+// channel_flicker - Next sample of the mains flicker
+//
+// |sin| over a half mains cycle x in [0, 1) is sin(pi x), taken from
+// Bhaskara's 16 x (1 - x) / (5 - 4 x (1 - x)), within 0.2 % of full
+// scale.
+//
+static int32
+channel_flicker(channel_t *ch)
+{
+    Uint32 x = ch->flicker_phase >> 16;
+    Uint32 p = (x * (65536 - x)) >> 16;
+    int32 s;
+
+    s = (int32)(((Uint64)16 * p * 32768) / (5 * 65536 - 4 * p));
+    ch->flicker_phase += ch->flicker_step;
+    return ((s - CHANNEL_FLICKER_MEAN) * (int32)ch->flicker) >> 15;
+}
+
+//
+// channel_rand - 32 bit xorshift generator
+//
+static Uint32
+channel_rand(channel_t *ch)
+{
+    Uint32 x = ch->rng;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ch->rng = x;
+    return x;
+}
+
+//
+// End of File
+//
@@ -0,0 +1,119 @@
+//###########################################################################
+//
+// FILE:   channel.h
+//
+// TITLE:  Synthetic Manchester waveforms in ADC codes for the host tools
+//
+//###########################################################################
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Included Files
+//
+#include "DSP28x_Project.h"
+
+//
+// Defines
+//
+// The waveform is what the ADC of the receiver sees: a 1 is low then
+// high, a 0 high then low (ManchesterRx.h), in 12 bit codes. With levels
+// set the bits are PAM symbols instead (Pam4Rx.h). Everything is integer
+// arithmetic with its own random generator, so a seed gives the same
+// samples on every machine and compiler; the golden results of golden.c
+// depend on that. channel_start() works out the per sample
+// constants of the impairments in double precision, without any
+// transcendental function, so they are exact too.
+//
+// The impairments are applied in channel order:
+//      ISI         the clean waveform through the FIR fir[0..taps-1]
+//                  (Q15, fir[0] on the newest sample)
+//      wander      ambient light baseline, Gaussian noise low pass
+//                  filtered to wander_hz
+//      flicker     lamps on the mains, a rectified sine at twice
+//                  mains_hz, zero mean
+//      impulses    power line switching noise, bursts of random sign
+//                  starting impulse_rate times a second on average, of
+//                  peak impulse decaying in impulse_len samples
+//      noise       white Gaussian noise
+// Set a level to 0 to leave an impairment out. Clock drift is in the
+// sample times, it moves the edges and not the levels.
+//
+#define CHANNEL_CODE_MAX        4095
+#define CHANNEL_FIR_MAX         16
+
+//
+// Typedefs
+//
+// samples_per_bit  receiver samples per bit at the nominal clock
+// sample_rate      receiver sample rate in Hz, for the impairments in time
+// high, low        levels of the two half bits in ADC codes
+// noise            rms of the added Gaussian noise in ADC codes
+// wander           rms of the baseline wander in ADC codes
+// flicker          peak to peak of the mains flicker in ADC codes
+// impulse          peak of an impulse in ADC codes
+// drift_ppm        receiver sample clock error, > 0 is fast (more samples
+//                  per bit)
+// levels           0 for Manchester, else the bits are symbols 0 to
+//                  levels - 1, each held for a whole bit at low + (high -
+//                  low) * symbol / (levels - 1)
+// seed             random generator seed, not 0
+//
+typedef struct {
+    Uint16 samples_per_bit;
+    Uint32 sample_rate;
+    Uint16 high;
+    Uint16 low;
+    Uint16 noise;
+    Uint16 wander;
+    float64 wander_hz;
+    Uint16 flicker;
+    Uint16 mains_hz;
+    Uint16 impulse;
+    Uint16 impulse_len;
+    float64 impulse_rate;
+    Uint16 taps;
+    int16 fir[CHANNEL_FIR_MAX];
+    int32 drift_ppm;
+    Uint16 levels;
+    Uint32 seed;
+
+    Uint32 rng;             // generator state
+    Uint64 pos;             // position in the bits, nominal samples Q16
+    Uint64 step;            // pos increment per sample, Q16
+    int32 line[CHANNEL_FIR_MAX];    // FIR delay line, newest at head
+    Uint16 head;
+    Uint32 wander_alpha;    // low pass coefficient, Q32
+    Uint32 wander_in;       // rms of the noise into the low pass
+    int64 wander_y;         // low pass output, Q16 codes
+    Uint32 flicker_phase;   // half mains cycles, Q32
+    Uint32 flicker_step;
+    Uint32 impulse_p;       // chance of an impulse per sample, Q32
+    Uint32 impulse_env;     // envelope of the current impulse, Q16 codes
+    Uint32 impulse_decay;   // envelope factor per sample, Q16
+} channel_t;
+
+//
+// Function Prototypes
+//
+void channel_init(channel_t *ch, Uint16 samples_per_bit, Uint16 high,
+                  Uint16 low);
+void channel_start(channel_t *ch);
+Uint32 channel_bits(channel_t *ch, const Uint16 *bits, Uint32 nbits,
+                    Uint16 *out, Uint32 max);
+int32 channel_gauss(channel_t *ch, Uint32 rms);
+
+#ifdef __cplusplus
+}
+#endif /* extern "C" */
+
+#endif  // end of CHANNEL_H definition
+
+//
+// End of File
+//
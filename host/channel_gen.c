@@ -0,0 +1,285 @@
+//###########################################################################
+//
+// FILE:   channel_gen.c
+//
+// TITLE:  Synthetic channel generator, Manchester ADC code streams for
+//         load and stress tests of the decoders
+//
+// Build (Linux):
+//      gcc -O2 -Wall -I. -I../Example_2806xClaAdcFir -o channel_gen
+//          channel_gen.c channel.c ../Example_2806xClaAdcFir/Prbs.c -lm
+//
+// Usage:
+//      channel_gen [options] [-o file]
+//      -b bit/s        bit rate (default 100000, as the CLA project)
+//      -s n            samples per bit (default 10)
+//      -T s            seconds of signal (default 1), or
+//      -n bits         number of bits
+//      -p 7|15         PRBS order of the data (default 7)
+//      -L code, -H code    levels of the half bits (default 1000, 3000)
+//      -a code         rms of the white Gaussian noise
+//      -w code         rms of the ambient light baseline wander
+//      -W hz           bandwidth of the wander (default 1)
+//      -f code         peak to peak of the lamp flicker
+//      -m hz           mains frequency of the flicker, 50 or 60 (default 50)
+//      -i rate         power line impulses per second
+//      -I code         peak of an impulse (default 1000)
+//      -l n            samples for an impulse to decay (default 20)
+//      -d ppm          receiver sample clock error, > 0 is fast
+//      -h taps         ISI channel FIR, comma separated, e.g. 0.2,0.6,0.2
+//      -S seed         random seed (default 1)
+//      -F bin|csv      output format (default bin)
+//      -o file         output, default stdout
+//
+// The samples are 12 bit ADC codes at bit rate * samples per bit, the
+// impairments are described in channel.h. bin is little endian Uint16
+// as read by trace_decode and golden -r, csv one code per line for
+// trace_decode -t csv. The same options and seed give the same file on
+// every machine. Every impairment is left out unless its level is given.
+//
+// The data is a PRBS, so the decoders report the bit error rate. The
+// signal is made and written in blocks, an hour at 1 MHz is about 7 GB
+// of bin and takes a few minutes; the rate is reported on stderr.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "DSP28x_Project.h"
+#include "Prbs.h"
+#include "channel.h"
+
+//
+// Defines
+//
+#define GEN_BLOCK_BITS      4096
+
+//
+// Globals
+//
+static Uint16 Bits[GEN_BLOCK_BITS];
+static Uint16 Samples[GEN_BLOCK_BITS * 64 * 2];
+static unsigned char Out[sizeof(Samples) * 3];
+
+//
+// Function Prototypes
+//
+static double arg_num(const char *s, double min, double max);
+static Uint16 parse_taps(channel_t *ch, const char *s);
+static void usage(void);
+
+//
+// main
+//
+int
+main(int argc, char **argv)
+{
+    channel_t ch;
+    prbs_t prbs;
+    Uint32 bit_rate = 100000;
+    Uint16 spb = 10;
+    double seconds = 1.0;
+    Uint64 nbits = 0;
+    Uint16 order = PRBS_ORDER_7;
+    Uint16 low = 1000, high = 3000;
+    const char *fmt = "bin";
+    int csv;
+    const char *path = 0;
+    const char *taps = 0;
+    FILE *f;
+    Uint64 done = 0, samples = 0;
+    Uint32 block, n, i;
+    size_t len;
+    struct timespec t0, t1;
+    double elapsed;
+    int c;
+
+    channel_init(&ch, spb, high, low);
+    ch.impulse = 1000;
+    while((c = getopt(argc, argv,
+                      "b:s:T:n:p:L:H:a:w:W:f:m:i:I:l:d:h:S:F:o:")) != -1)
+    {
+        switch(c)
+        {
+        case 'b': bit_rate = arg_num(optarg, 1, 1e7); break;
+        case 's': spb = arg_num(optarg, 2, 64); break;
+        case 'T': seconds = arg_num(optarg, 0, 1e7); break;
+        case 'n': nbits = arg_num(optarg, 1, 1e15); break;
+        case 'p': order = arg_num(optarg, 7, 15); break;
+        case 'L': low = arg_num(optarg, 0, 4095); break;
+        case 'H': high = arg_num(optarg, 0, 4095); break;
+        case 'a': ch.noise = arg_num(optarg, 0, 65535); break;
+        case 'w': ch.wander = arg_num(optarg, 0, 65535); break;
+        case 'W': ch.wander_hz = arg_num(optarg, 1e-3, 1e6); break;
+        case 'f': ch.flicker = arg_num(optarg, 0, 65535); break;
+        case 'm': ch.mains_hz = arg_num(optarg, 1, 1000); break;
+        case 'i': ch.impulse_rate = arg_num(optarg, 0, 1e6); break;
+        case 'I': ch.impulse = arg_num(optarg, 0, 65535); break;
+        case 'l': ch.impulse_len = arg_num(optarg, 1, 65535); break;
+        case 'd': ch.drift_ppm = arg_num(optarg, -1e5, 1e5); break;
+        case 'h': taps = optarg; break;
+        case 'S': ch.seed = arg_num(optarg, 1, 4294967295.0); break;
+        case 'F': fmt = optarg; break;
+        case 'o': path = optarg; break;
+        default: usage();
+        }
+    }
+    if(optind != argc)
+    {
+        usage();
+    }
+    csv = strcmp(fmt, "csv") == 0;
+    if(!csv && strcmp(fmt, "bin") != 0)
+    {
+        usage();
+    }
+    if(order != PRBS_ORDER_7 && order != PRBS_ORDER_15)
+    {
+        usage();
+    }
+    if(taps != 0 && parse_taps(&ch, taps) == 0)
+    {
+        usage();
+    }
+    if(nbits == 0)
+    {
+        nbits = (Uint64)(seconds * bit_rate + 0.5);
+    }
+
+    ch.samples_per_bit = spb;
+    ch.sample_rate = bit_rate * spb;
+    ch.low = low;
+    ch.high = high;
+    channel_start(&ch);
+    prbs_init(&prbs, order);
+
+    f = stdout;
+    if(path != 0 && (f = fopen(path, "wb")) == 0)
+    {
+        perror(path);
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while(done < nbits)
+    {
+        block = nbits - done < GEN_BLOCK_BITS ? (Uint32)(nbits - done) :
+                                                GEN_BLOCK_BITS;
+        for(i = 0; i < block; i++)
+        {
+            Bits[i] = prbs_next_bit(&prbs);
+        }
+        n = channel_bits(&ch, Bits, block, Samples,
+                         sizeof(Samples) / sizeof(Samples[0]));
+
+        len = 0;
+        for(i = 0; i < n; i++)
+        {
+            if(csv)
+            {
+                len += sprintf((char *)Out + len, "%u\n", Samples[i]);
+            }
+            else
+            {
+                Out[len++] = Samples[i] & 0xFF;
+                Out[len++] = Samples[i] >> 8;
+            }
+        }
+        if(fwrite(Out, 1, len, f) != len)
+        {
+            perror(path != 0 ? path : "stdout");
+            return 1;
+        }
+        done += block;
+        samples += n;
+    }
+    if(fflush(f) != 0 || (f != stdout && fclose(f) != 0))
+    {
+        perror(path != 0 ? path : "stdout");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    elapsed = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    fprintf(stderr, "%llu bits, %llu samples, %.1f s of signal in %.1f s "
+            "(%.1f Msample/s)\n", (unsigned long long)nbits,
+            (unsigned long long)samples, (double)samples / ch.sample_rate,
+            elapsed, elapsed > 0 ? samples / elapsed * 1e-6 : 0.0);
+    return 0;
+}
+
+//
+// arg_num - A number option within min and max
+//
+static double
+arg_num(const char *s, double min, double max)
+{
+    char *end;
+    double v = strtod(s, &end);
+
+    if(*s == '\0' || *end != '\0' || v < min || v > max)
+    {
+        usage();
+    }
+    return v;
+}
+
+//
+// parse_taps - The FIR of -h into ch, Q15, returns the number of taps or
+// 0 if there are too many or one is out of range
+//
+static Uint16
+parse_taps(channel_t *ch, const char *s)
+{
+    char *end;
+    double v;
+
+    ch->taps = 0;
+    for(;;)
+    {
+        v = strtod(s, &end);
+        if(end == s || v <= -1.0 || v >= 1.0 || ch->taps == CHANNEL_FIR_MAX)
+        {
+            return 0;
+        }
+        ch->fir[ch->taps++] = (int16)(v * 32768.0 + (v < 0 ? -0.5 : 0.5));
+        if(*end == '\0')
+        {
+            return ch->taps;
+        }
+        if(*end != ',')
+        {
+            return 0;
+        }
+        s = end + 1;
+    }
+}
+
+//
+// usage - Print the options and exit
+//
+static void
+usage(void)
+{
+    fprintf(stderr,
+            "usage: channel_gen [-b bit/s] [-s spb] [-T s | -n bits] "
+            "[-p 7|15]\n"
+            "                   [-L code] [-H code] [-a rms] [-w rms] "
+            "[-W hz]\n"
+            "                   [-f p-p] [-m hz] [-i rate] [-I code] "
+            "[-l n] [-d ppm]\n"
+            "                   [-h taps] [-S seed] [-F bin|csv] "
+            "[-o file]\n");
+    exit(2);
+}
+
+//
+// End of File
+//
@@ -0,0 +1,796 @@
+//###########################################################################
+//
+// FILE:   golden.c
+//
+// TITLE:  Golden vector regression test of the firmware decoders
+//
+// Build (Linux):
+//      gcc -O2 -Wall -I. -I../common -I../Example_2806xClaAdcFir
+//          -I../Example_2806xExternalInterrupt_GPIOTOGGLING
+//          -o golden golden.c channel.c ../common/BufferDecode.c
+//          ../common/LineCode.c ../common/ManchesterWord.c
+//          ../Example_2806xClaAdcFir/ChipRx.c
+//          ../Example_2806xClaAdcFir/ManchesterRx.c
+//          ../Example_2806xClaAdcFir/Pam4Rx.c
+//          ../Example_2806xClaAdcFir/Prbs.c -lm
+//
+// Usage:
+//      golden [-g file] [-u] [-v] [-r trace.bin]...
+//      -g file         expected results (default golden_vectors.txt)
+//      -u              write the results to the file instead of checking
+//      -v              print every result, not only the mismatches
+//      -r trace.bin    add a recorded waveform, little endian Uint16 ADC
+//                      codes as read by trace_decode (repeat for more)
+//
+// Every vector is run through every decoder the firmware has:
+//      rx      ManchesterRx.c, the slicer, clock recovery and half bit
+//              sums of the CLA project, sample by sample
+//      edge    buffer_decode() of the CLONE project (process_buffer), on
+//              consecutive MSG_SIZE (1280) sample buffers
+//      xint    the XINT1/XINT2 bit assembly of the GPIO project
+//              (XintBits.h), one bit per edge of the sliced waveform
+//      word    encode_manchester() and decode_manchester() on every byte,
+//              clean and with one symbol bit flipped
+//      line    every line code of LineCode.c (VPPM at GOLDEN_VPPM_WIDTH)
+//              on a frame of every byte, clean and with one chip of
+//              every byte flipped
+//      pam4    Pam4Rx.c on the same PRBS sent as PAM-4, two bits per
+//              symbol (synthetic vectors only)
+//      chip    ChipRx.c on the same PRBS sent in each line code but
+//              Manchester, two chips per bit period (synthetic vectors
+//              only)
+//
+// The synthetic vectors are PRBS-7 (Prbs.h) at 10 samples per bit or
+// symbol from channel.c: clean, noisy, weak (noise at a quarter of the
+// swing), drifted (sample clock off) and truncated (starting and ending
+// inside a bit). Recorded ones are named after the
+// file. A result is one line
+//      vector decoder bits=N errors=E resyncs=S crc=XXXXXXXX
+// with the bits decoded, the PRBS checker errors and resyncs on them,
+// and the CRC-32 of the bits packed MSB first (for word and line, of the
+// decoded bytes). Any line that differs from the expected file fails the run.
+// After a change that is meant to alter the results, check the new ones
+// and rewrite the file with -u.
+//
+// The exit status is 1 on a mismatch, 2 if a file could not be read.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP28x_Project.h"
+#include "BufferDecode.h"
+#include "ChipRx.h"
+#include "LineCode.h"
+#include "ManchesterRx.h"
+#include "ManchesterWord.h"
+#include "Pam4Rx.h"
+#include "Prbs.h"
+#include "XintBits.h"
+#include "channel.h"
+
+//
+// Defines
+//
+#define GOLDEN_FILE         "golden_vectors.txt"
+#define GOLDEN_BITS         4000
+#define GOLDEN_SPB          10
+#define GOLDEN_HIGH         3000
+#define GOLDEN_LOW          1000
+#define GOLDEN_THRESHOLD    2048
+#define GOLDEN_HYSTERESIS   64
+#define GOLDEN_BUFFER       1280        // MSG_SIZE of the CLONE project
+#define GOLDEN_VPPM_WIDTH   3           // slots of LINE_VPPM_SLOTS
+#define GOLDEN_MAX_RESULTS  64
+#define GOLDEN_LINE         128
+
+//
+// Typedefs
+//
+typedef struct {
+    const char *name;
+    Uint16 noise;
+    int32 drift_ppm;
+    Uint32 skip;                // samples dropped at the start
+    Uint32 cut;                 // samples dropped at the end
+} vector_t;
+
+typedef struct {
+    prbs_checker_t chk;
+    Uint32 bits;
+    Uint32 wrong;               // word: bits that differ from the byte sent
+    Uint32 crc;
+    Uint16 byte;
+    Uint16 fill;
+} sink_t;
+
+//
+// Globals
+//
+static const char *const LineNames[LINE_CODES] = {
+    "line-manchester", "line-4b5b", "line-8b10b", "line-vppm"
+};
+
+static const char *const ChipNames[LINE_CODES] = {
+    "chip-manchester", "chip-4b5b", "chip-8b10b", "chip-vppm"
+};
+
+static const vector_t Vectors[] = {
+    { "clean",     0,   0,     0,  0 },
+    { "noisy",     300, 0,     0,  0 },
+    { "weak",      500, 0,     0,  0 },
+    { "drifted",   0,   20000, 0,  0 },
+    { "truncated", 0,   0,     37, 23 },
+};
+
+static char Results[GOLDEN_MAX_RESULTS][GOLDEN_LINE];
+static Uint16 ResultCount;
+
+//
+// Function Prototypes
+//
+static void run_vector(const char *name, const Uint16 *s, Uint32 n);
+static void run_pam4(const char *name, const Uint16 *s, Uint32 n);
+static void run_chip(const char *name, Uint16 code, const Uint16 *s,
+                     Uint32 n);
+static void run_word(void);
+static void run_line(void);
+static void sink_init(sink_t *k);
+static void sink_bit(sink_t *k, Uint16 bit);
+static void sink_byte(sink_t *k, Uint16 byte, Uint16 sent);
+static void sink_crc(sink_t *k, Uint16 byte);
+static void result(const char *vector, const char *decoder,
+                   const sink_t *k);
+static Uint16 *synth(const vector_t *v, Uint16 levels, Uint32 *n);
+static Uint16 *synth_chips(const vector_t *v, Uint16 code, Uint32 *n);
+static Uint16 *render(const vector_t *v, const Uint16 *symbols,
+                      Uint32 nsymbols, Uint16 samples_per_symbol,
+                      Uint16 levels, Uint32 *n);
+static Uint16 *load(const char *path, Uint32 *n);
+static int check(const char *path, int verbose);
+static int update(const char *path);
+static void usage(void);
+
+//
+// main
+//
+int
+main(int argc, char **argv)
+{
+    const char *path = GOLDEN_FILE;
+    int write = 0;
+    int verbose = 0;
+    Uint16 *s;
+    Uint32 n;
+    const char *base;
+    Uint16 code;
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "-u") == 0)
+        {
+            write = 1;
+        }
+        else if(strcmp(argv[i], "-v") == 0)
+        {
+            verbose = 1;
+        }
+        else if(strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+        {
+            path = argv[++i];
+        }
+        else if(strcmp(argv[i], "-r") != 0 || i + 1 >= argc)
+        {
+            usage();
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    for(i = 0; i < (int)(sizeof(Vectors) / sizeof(Vectors[0])); i++)
+    {
+        s = synth(&Vectors[i], 0, &n);
+        run_vector(Vectors[i].name, s, n);
+        free(s);
+        s = synth(&Vectors[i], PAM4_RX_LEVELS, &n);
+        run_pam4(Vectors[i].name, s, n);
+        free(s);
+        for(code = LINE_4B5B; code < LINE_CODES; code++)
+        {
+            s = synth_chips(&Vectors[i], code, &n);
+            run_chip(Vectors[i].name, code, s, n);
+            free(s);
+        }
+    }
+    for(i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "-g") == 0)
+        {
+            i++;
+        }
+        else if(strcmp(argv[i], "-r") == 0)
+        {
+            if((s = load(argv[++i], &n)) == 0)
+            {
+                return 2;
+            }
+            base = strrchr(argv[i], '/');
+            run_vector(base != 0 ? base + 1 : argv[i], s, n);
+            free(s);
+        }
+    }
+    run_word();
+    run_line();
+
+    return write ? update(path) : check(path, verbose);
+}
+
+//
+// run_vector - Decode n samples with rx, edge and xint
+//
+static void
+run_vector(const char *name, const Uint16 *s, Uint32 n)
+{
+    manchester_rx_t rx;
+    volatile Uint16 buf[BITVEC_WORDS(GOLDEN_BUFFER)];
+    Uint16 bits[BITVEC_WORDS(GOLDEN_BUFFER)];
+    sink_t k;
+    Uint32 i, w;
+    Uint16 nbits, b, level;
+    int16 bit;
+
+    //
+    // ManchesterRx, as on the CLA
+    //
+    sink_init(&k);
+    manchester_rx_init(&rx, GOLDEN_THRESHOLD, GOLDEN_HYSTERESIS,
+                       GOLDEN_SPB);
+    for(i = 0; i < n; i++)
+    {
+        bit = manchester_rx_sample(&rx, s[i]);
+        if(bit != MANCHESTER_RX_NO_BIT)
+        {
+            sink_bit(&k, (Uint16)bit);
+        }
+    }
+    result(name, "rx", &k);
+
+    //
+    // process_buffer() of the CLONE project, one full buffer at a time
+    //
+    sink_init(&k);
+    for(i = 0; i + GOLDEN_BUFFER <= n; i += GOLDEN_BUFFER)
+    {
+        for(b = 0; b < GOLDEN_BUFFER; b++)
+        {
+            BITVEC_PUT(buf, b, s[i + b] > GOLDEN_THRESHOLD);
+        }
+        nbits = buffer_decode(buf, GOLDEN_BUFFER, GOLDEN_SPB, bits,
+                              GOLDEN_BUFFER);
+        for(b = 0; b < nbits; b++)
+        {
+            sink_bit(&k, BITVEC_GET(bits, b));
+        }
+    }
+    result(name, "edge", &k);
+
+    //
+    // The GPIO project, XINT1 on rising and XINT2 on falling edges of a
+    // comparator with the slicer hysteresis
+    //
+    sink_init(&k);
+    level = n != 0 && s[0] > GOLDEN_THRESHOLD;
+    w = 0;
+    for(i = 1; i < n; i++)
+    {
+        if(!level && s[i] > GOLDEN_THRESHOLD + GOLDEN_HYSTERESIS)
+        {
+            level = 1;
+            w = XINT_BITS_PUSH(w, XINT_BIT_RISING);
+        }
+        else if(level && s[i] < GOLDEN_THRESHOLD - GOLDEN_HYSTERESIS)
+        {
+            level = 0;
+            w = XINT_BITS_PUSH(w, XINT_BIT_FALLING);
+        }
+        else
+        {
+            continue;
+        }
+        sink_bit(&k, (Uint16)(w & 1));
+    }
+    result(name, "xint", &k);
+}
+
+//
+// run_pam4 - Decode n PAM-4 samples with Pam4Rx, the first bit of a
+// symbol first
+//
+static void
+run_pam4(const char *name, const Uint16 *s, Uint32 n)
+{
+    pam4_rx_t rx;
+    sink_t k;
+    Uint32 i;
+    int16 sym;
+
+    sink_init(&k);
+    pam4_rx_init(&rx, 0, CHANNEL_CODE_MAX, GOLDEN_HYSTERESIS, GOLDEN_SPB);
+    for(i = 0; i < n; i++)
+    {
+        sym = pam4_rx_sample(&rx, s[i]);
+        if(sym != PAM4_RX_NO_SYMBOL)
+        {
+            sink_bit(&k, (Uint16)(sym >> 1));
+            sink_bit(&k, (Uint16)(sym & 1));
+        }
+    }
+    result(name, "pam4", &k);
+}
+
+//
+// run_chip - Decode n chip samples of the line code code with ChipRx,
+// the bytes LSB first
+//
+static void
+run_chip(const char *name, Uint16 code, const Uint16 *s, Uint32 n)
+{
+    chip_rx_t rx;
+    sink_t k;
+    Uint32 i;
+    Uint16 j;
+    int16 byte;
+
+    sink_init(&k);
+    chip_rx_init(&rx, GOLDEN_THRESHOLD, GOLDEN_HYSTERESIS, GOLDEN_SPB,
+                 code, GOLDEN_VPPM_WIDTH);
+    for(i = 0; i < n; i++)
+    {
+        byte = chip_rx_sample(&rx, s[i]);
+        if(byte != CHIP_RX_NO_BYTE)
+        {
+            for(j = 0; j < 8; j++)
+            {
+                sink_bit(&k, (Uint16)(byte >> j) & 1);
+            }
+        }
+    }
+    result(name, ChipNames[code], &k);
+}
+
+//
+// run_word - Round trip every byte through the word codec, then again
+// with one symbol bit flipped per byte
+//
+static void
+run_word(void)
+{
+    sink_t k;
+    Uint32 sym;
+    Uint16 i, errors;
+
+    for(errors = 0; errors < 2; errors++)
+    {
+        sink_init(&k);
+        for(i = 0; i < 256; i++)
+        {
+            sym = encode_manchester(i);
+            if(errors)
+            {
+                sym ^= (Uint32)1 << (i % 16);
+            }
+            sink_byte(&k, (Uint16)decode_manchester(sym), i);
+        }
+        result("bytes", errors ? "word-flip" : "word", &k);
+    }
+}
+
+//
+// run_line - Round trip a frame of every byte through every line code,
+// then again with one chip of every byte flipped
+//
+static void
+run_line(void)
+{
+    line_code_t tx, rx;
+    Uint16 data[256];
+    Uint16 out[256];
+    Uint16 chips[LINE_CHIP_WORDS(256)];
+    char name[GOLDEN_LINE];
+    sink_t k;
+    Uint16 code, errors, nchips, nbytes, chip, i;
+
+    for(i = 0; i < 256; i++)
+    {
+        data[i] = i;
+    }
+
+    for(code = 0; code < LINE_CODES; code++)
+    {
+        for(errors = 0; errors < 2; errors++)
+        {
+            line_code_init(&tx, code, GOLDEN_VPPM_WIDTH);
+            line_code_init(&rx, code, GOLDEN_VPPM_WIDTH);
+            nchips = line_encode(&tx, data, 256, chips);
+            if(errors)
+            {
+                for(i = 0; i < 256; i++)
+                {
+                    chip = i * tx.chips_per_byte + i % tx.chips_per_byte;
+                    BITVEC_PUT(chips, chip, !BITVEC_GET(chips, chip));
+                }
+            }
+            nbytes = line_decode(&rx, chips, nchips, out);
+
+            sink_init(&k);
+            for(i = 0; i < nbytes; i++)
+            {
+                sink_byte(&k, out[i], data[i]);
+            }
+            snprintf(name, sizeof(name), "%s%s", LineNames[code],
+                     errors ? "-flip" : "");
+            result("bytes", name, &k);
+        }
+    }
+}
+
+//
+// sink_init - Start counting the bits of one decoder
+//
+static void
+sink_init(sink_t *k)
+{
+    prbs_checker_init(&k->chk, PRBS_ORDER_7);
+    k->bits = 0;
+    k->wrong = 0;
+    k->crc = 0xFFFFFFFF;
+    k->byte = 0;
+    k->fill = 0;
+}
+
+//
+// sink_bit - One decoded bit, into the PRBS checker and the CRC
+//
+static void
+sink_bit(sink_t *k, Uint16 bit)
+{
+    prbs_checker_push(&k->chk, bit);
+    k->bits++;
+    k->byte = (k->byte << 1) | bit;
+    if(++k->fill == 8)
+    {
+        sink_crc(k, k->byte);
+        k->byte = 0;
+        k->fill = 0;
+    }
+}
+
+//
+// sink_byte - One byte of the word codec, decoded from sent
+//
+static void
+sink_byte(sink_t *k, Uint16 byte, Uint16 sent)
+{
+    Uint16 diff = (byte ^ sent) & 0xFF;
+
+    k->bits += 8;
+    for(; diff != 0; diff &= diff - 1)
+    {
+        k->wrong++;
+    }
+    sink_crc(k, byte);
+}
+
+//
+// sink_crc - CRC-32 (IEEE 802.3, reflected) of one byte
+//
+static void
+sink_crc(sink_t *k, Uint16 byte)
+{
+    Uint16 i;
+
+    k->crc ^= byte & 0xFF;
+    for(i = 0; i < 8; i++)
+    {
+        k->crc = (k->crc >> 1) ^ (0xEDB88320 & -(k->crc & 1));
+    }
+}
+
+//
+// result - Record the line of one vector and decoder, the bits of an
+// unfinished byte go into the CRC padded with zeros
+//
+static void
+result(const char *vector, const char *decoder, const sink_t *k)
+{
+    Uint32 crc = k->crc;
+
+    if(ResultCount == GOLDEN_MAX_RESULTS)
+    {
+        fprintf(stderr, "golden: too many results\n");
+        exit(2);
+    }
+    if(k->fill != 0)
+    {
+        sink_t last = *k;
+
+        sink_crc(&last, k->byte << (8 - k->fill));
+        crc = last.crc;
+    }
+
+    //
+    // The word codec carries no PRBS, its errors are the wrong bits
+    //
+    snprintf(Results[ResultCount++], GOLDEN_LINE,
+             "%s %s bits=%lu errors=%lu resyncs=%lu crc=%08lX", vector,
+             decoder, (unsigned long)k->bits,
+             (unsigned long)(k->chk.errors + k->wrong),
+             (unsigned long)k->chk.resyncs, (unsigned long)~crc);
+}
+
+//
+// synth - The samples of a synthetic vector, malloc'ed
+//
+// With levels 0 it is GOLDEN_BITS Manchester bits, with PAM4_RX_LEVELS
+// the same bits two to a Gray coded symbol (Pam4Rx.h).
+//
+static Uint16 *
+synth(const vector_t *v, Uint16 levels, Uint32 *n)
+{
+    Uint16 bits[GOLDEN_BITS];
+    Uint32 nbits = GOLDEN_BITS;
+    prbs_t prbs;
+    Uint32 i;
+    Uint16 pair;
+
+    prbs_init(&prbs, PRBS_ORDER_7);
+    if(levels == 0)
+    {
+        for(i = 0; i < GOLDEN_BITS; i++)
+        {
+            bits[i] = prbs_next_bit(&prbs);
+        }
+    }
+    else
+    {
+        nbits = GOLDEN_BITS / 2;
+        for(i = 0; i < nbits; i++)
+        {
+            pair  = prbs_next_bit(&prbs) << 1;
+            pair |= prbs_next_bit(&prbs);
+            bits[i] = pair ^ (pair >> 1);
+        }
+    }
+
+    return render(v, bits, nbits, GOLDEN_SPB, levels, n);
+}
+
+//
+// synth_chips - The samples of a synthetic vector in the line code code,
+// malloc'ed
+//
+// The GOLDEN_BITS PRBS bits, packed LSB first as by the BER test, are
+// line_encode()d and each chip held for half of GOLDEN_SPB.
+//
+static Uint16 *
+synth_chips(const vector_t *v, Uint16 code, Uint32 *n)
+{
+    static Uint16 data[GOLDEN_BITS / 8];
+    static Uint16 chips[LINE_CHIP_WORDS(GOLDEN_BITS / 8)];
+    static Uint16 symbols[GOLDEN_BITS * LINE_VPPM_SLOTS];
+    line_code_t lc;
+    prbs_t prbs;
+    Uint32 i, nchips;
+    Uint16 j;
+
+    prbs_init(&prbs, PRBS_ORDER_7);
+    for(i = 0; i < GOLDEN_BITS / 8; i++)
+    {
+        data[i] = 0;
+        for(j = 0; j < 8; j++)
+        {
+            data[i] |= prbs_next_bit(&prbs) << j;
+        }
+    }
+
+    line_code_init(&lc, code, GOLDEN_VPPM_WIDTH);
+    nchips = line_encode(&lc, data, GOLDEN_BITS / 8, chips);
+    for(i = 0; i < nchips; i++)
+    {
+        symbols[i] = BITVEC_GET(chips, i);
+    }
+
+    return render(v, symbols, nchips, GOLDEN_SPB / 2, 2, n);
+}
+
+//
+// render - nsymbols symbols through the channel of vector v, malloc'ed
+//
+static Uint16 *
+render(const vector_t *v, const Uint16 *symbols, Uint32 nsymbols,
+       Uint16 samples_per_symbol, Uint16 levels, Uint32 *n)
+{
+    Uint32 max = nsymbols * samples_per_symbol * 2;
+    Uint16 *s;
+    channel_t ch;
+
+    if((s = malloc(max * sizeof(*s))) == 0)
+    {
+        fprintf(stderr, "golden: out of memory\n");
+        exit(2);
+    }
+    channel_init(&ch, samples_per_symbol, GOLDEN_HIGH, GOLDEN_LOW);
+    ch.noise = v->noise;
+    ch.drift_ppm = v->drift_ppm;
+    ch.levels = levels;
+    ch.seed = 12345;
+    channel_start(&ch);
+    *n = channel_bits(&ch, symbols, nsymbols, s, max);
+
+    *n -= v->cut + v->skip;
+    memmove(s, s + v->skip, *n * sizeof(*s));
+    return s;
+}
+
+//
+// load - The samples of a recorded waveform, malloc'ed, 0 on error
+//
+static Uint16 *
+load(const char *path, Uint32 *n)
+{
+    FILE *f;
+    Uint16 *s = 0;
+    unsigned char b[2];
+    Uint32 max = 0;
+
+    if((f = fopen(path, "rb")) == 0)
+    {
+        perror(path);
+        return 0;
+    }
+    *n = 0;
+    while(fread(b, 1, 2, f) == 2)
+    {
+        if(*n == max)
+        {
+            max = max ? max * 2 : 65536;
+            if((s = realloc(s, max * sizeof(*s))) == 0)
+            {
+                fprintf(stderr, "golden: out of memory\n");
+                exit(2);
+            }
+        }
+        s[(*n)++] = b[0] | (b[1] << 8);
+    }
+    if(ferror(f) || *n == 0)
+    {
+        fprintf(stderr, "%s: no samples\n", path);
+        free(s);
+        s = 0;
+    }
+    fclose(f);
+    return s;
+}
+
+//
+// check - Compare the results with the expected file
+//
+static int
+check(const char *path, int verbose)
+{
+    char line[GOLDEN_LINE];
+    char seen[GOLDEN_MAX_RESULTS] = { 0 };
+    Uint16 fail = 0;
+    Uint16 expected = 0;
+    FILE *f;
+    size_t len;
+    Uint16 i;
+
+    if((f = fopen(path, "r")) == 0)
+    {
+        perror(path);
+        return 2;
+    }
+    while(fgets(line, sizeof(line), f) != 0)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if(line[0] == '#' || line[0] == '\0')
+        {
+            continue;
+        }
+        expected++;
+
+        //
+        // Match on the vector and decoder names
+        //
+        len = strchr(line, '=') != 0 ? strchr(line, '=') - line : 0;
+        while(len != 0 && line[len - 1] != ' ')
+        {
+            len--;
+        }
+        for(i = 0; i < ResultCount; i++)
+        {
+            if(len != 0 && strncmp(Results[i], line, len) == 0)
+            {
+                break;
+            }
+        }
+        if(i == ResultCount)
+        {
+            printf("MISSING  %s\n", line);
+            fail++;
+            continue;
+        }
+        seen[i] = 1;
+        if(strcmp(Results[i], line) != 0)
+        {
+            printf("FAIL     %s\n  expect %s\n", Results[i], line);
+            fail++;
+        }
+        else if(verbose)
+        {
+            printf("ok       %s\n", Results[i]);
+        }
+    }
+    fclose(f);
+
+    for(i = 0; i < ResultCount; i++)
+    {
+        if(!seen[i])
+        {
+            printf("NEW      %s\n", Results[i]);
+        }
+    }
+    printf("%u of %u expected results differ\n", fail, expected);
+    return fail ? 1 : 0;
+}
+
+//
+// update - Write the results as the new expected file
+//
+static int
+update(const char *path)
+{
+    FILE *f;
+    Uint16 i;
+
+    if((f = fopen(path, "w")) == 0)
+    {
+        perror(path);
+        return 2;
+    }
+    fprintf(f, "# Expected results of golden.c, rewrite with golden -u\n");
+    for(i = 0; i < ResultCount; i++)
+    {
+        fprintf(f, "%s\n", Results[i]);
+    }
+    if(fclose(f) != 0)
+    {
+        perror(path);
+        return 2;
+    }
+    printf("%u results written to %s\n", ResultCount, path);
+    return 0;
+}
+
+//
+// usage - Print the options and exit
+//
+static void
+usage(void)
+{
+    fprintf(stderr, "usage: golden [-g file] [-u] [-v] [-r trace.bin]...\n");
+    exit(2);
+}
+
+//
+// End of File
+//
@@ -0,0 +1,313 @@
+#!/usr/bin/env python3
+#############################################################################
+#
+# FILE:   isr_timeline.py
+#
+# TITLE:  Timeline and deadline check of a firmware trace dump (Trace.h)
+#
+# Usage:
+#       isr_timeline.py [-c HZ] [-p US] [-s SRC] [-d N] [-t] [--vcd FILE]
+#                       dump.txt|<prefix>_trace.csv|Trace.dat
+#
+# Reads a trace as
+#
+#   - text from trace_dump_sci() captured off the console, or the
+#     <prefix>_trace.csv of telemetry_decode: "# trace <count>" starts a
+#     dump, then one "time,type,src,data" line per record; other lines
+#     are skipped
+#   - a CCS memory save of the Trace variable (File > Save Memory, TI
+#     data format, 16-bit hex, length sizeof(Trace))
+#
+# and prints, for every event source, the number of ISR runs, their
+# duration (entry to exit, and without the ISRs nested in them) and the
+# time between entries, followed by the deadline check of the -s source
+# (default adc, one ISR per sample):
+#
+#   - a gap between two entries of more than 1.5 periods is a missed
+#     sample, reported with the number of periods lost
+#   - an ISR run longer than one period is late
+#   - every TRACE_OVERRUN record
+#
+# The period is -p in microseconds, or the median time between entries.
+# -t prints every record with its time in us; --vcd writes a value change
+# dump (one signal per ISR, 1 while it runs, and the FIFO levels) for a
+# waveform viewer such as GTKWave. Times are SYSCLKOUT cycles, -c sets
+# the clock (default 90 MHz).
+#
+# The exit status is 1 if a deadline was missed, 2 if the file could not
+# be read.
+#
+#############################################################################
+
+import argparse
+import re
+import sys
+
+#
+# Keep in step with Trace.h
+#
+TYPES = {1: 'enter', 2: 'exit', 3: 'fifo', 4: 'overrun', 5: 'state',
+         6: 'mark'}
+SOURCES = {1: 'adc', 2: 'tx', 3: 'scib', 4: 'xint1', 5: 'xint2',
+           6: 'timer0', 7: 'timer1', 8: 'main', 9: 'rx', 10: 'rate',
+           11: 'power', 12: 'carrier', 13: 'link', 14: 'eq', 15: 'line'}
+TRACE_ENTER = 1
+TRACE_EXIT = 2
+TRACE_FIFO = 3
+TRACE_OVERRUN = 4
+
+RECORD_RE = re.compile(r'^\s*(\d+),(\d+),(\d+),(\d+)\s*$')
+HEAD_RE = re.compile(r'^\s*#\s*trace\s+(\d+)')
+
+#
+# Offset of the records in trace_t and words per record, in 16-bit words
+#
+DAT_HEADER = 4
+DAT_RECORD = 4
+
+
+def src_name(src):
+    return SOURCES.get(src, 'src%d' % src)
+
+
+def src_id(name):
+    for k, v in SOURCES.items():
+        if v == name:
+            return k
+    try:
+        return int(name, 0)
+    except ValueError:
+        raise argparse.ArgumentTypeError('unknown source: %s' % name)
+
+
+def load_text(path):
+    """Dumps in a text or CSV file, a list of record lists"""
+    dumps = []
+    cur = None
+    with open(path, errors='replace') as f:
+        for line in f:
+            if HEAD_RE.match(line):
+                cur = []
+                dumps.append(cur)
+                continue
+            m = RECORD_RE.match(line)
+            if m is None:
+                continue
+            if cur is None:
+                cur = []
+                dumps.append(cur)
+            cur.append(tuple(int(v) for v in m.groups()))
+    return dumps
+
+
+def load_dat(path):
+    """The one dump in a CCS memory save of Trace"""
+    with open(path) as f:
+        lines = f.read().split()
+    # header: magic, format, start address, page, length
+    words = [int(w, 16) & 0xFFFF for w in lines[5:]]
+    if len(words) < DAT_HEADER:
+        raise ValueError('too short for a trace_t')
+    count = words[0] | words[1] << 16
+    size = words[3]
+    if size == 0 or len(words) < DAT_HEADER + size * DAT_RECORD:
+        raise ValueError('memory save shorter than Trace.len records')
+    n = min(count, size)
+    recs = []
+    for k in range(n):
+        i = (count - n + k) % size
+        w = words[DAT_HEADER + i * DAT_RECORD:][:DAT_RECORD]
+        recs.append((w[0] | w[1] << 16, w[2] >> 8, w[2] & 0xFF, w[3]))
+    return [recs]
+
+
+def unwrap(recs):
+    """Records with 64-bit times, CPU timer 2 wraps every 2^32 cycles"""
+    out = []
+    base = 0
+    last = None
+    for t, typ, src, data in recs:
+        if last is not None and t < last and last - t > 1 << 31:
+            base += 1 << 32
+        last = t
+        out.append((t + base, typ, src, data))
+    return out
+
+
+def runs(recs):
+    """ISR runs as (src, enter, exit, exclusive cycles), oldest first"""
+    stack = []
+    done = []
+    for t, typ, src, data in recs:
+        if typ == TRACE_ENTER:
+            if stack:
+                stack[-1][3] += t - stack[-1][4]
+            stack.append([src, t, None, 0, t])
+        elif typ == TRACE_EXIT:
+            # an exit without its entry (ring start) is dropped
+            if not stack or stack[-1][0] != src:
+                continue
+            run = stack.pop()
+            run[3] += t - run[4]
+            done.append((run[0], run[1], t, run[3]))
+            if stack:
+                stack[-1][4] = t
+    done.sort(key=lambda r: r[1])
+    return done
+
+
+def median(vals):
+    vals = sorted(vals)
+    return vals[len(vals) // 2] if vals else 0
+
+
+def fmt(cycles, us):
+    return '%9.3f' % (cycles * us)
+
+
+def report(recs, clock, period_us, dl_src):
+    us = 1e6 / clock
+    t0 = recs[0][0]
+    all_runs = runs(recs)
+    missed = 0
+
+    print('%d records, %.1f us' % (len(recs), (recs[-1][0] - t0) * us))
+    print('%-8s %6s %9s %9s %9s %9s %9s %9s %6s' %
+          ('source', 'runs', 'dur min', 'dur avg', 'dur max', 'self max',
+           'gap min', 'gap max', 'fifo'))
+    sources = sorted(set(r[2] for r in recs))
+    for src in sources:
+        mine = [r for r in all_runs if r[0] == src]
+        fifo = [r[3] for r in recs if r[2] == src and r[1] == TRACE_FIFO]
+        gaps = [b[1] - a[1] for a, b in zip(mine, mine[1:])]
+        if mine:
+            durs = [r[2] - r[1] for r in mine]
+            print('%-8s %6d %s %s %s %s %s %s %6s' %
+                  (src_name(src), len(mine), fmt(min(durs), us),
+                   fmt(sum(durs) / len(durs), us), fmt(max(durs), us),
+                   fmt(max(r[3] for r in mine), us),
+                   fmt(min(gaps), us) if gaps else '%9s' % '-',
+                   fmt(max(gaps), us) if gaps else '%9s' % '-',
+                   max(fifo) if fifo else '-'))
+        else:
+            print('%-8s %6s %9s %9s %9s %9s %9s %9s %6s' %
+                  (src_name(src), '-', '-', '-', '-', '-', '-', '-',
+                   max(fifo) if fifo else '-'))
+
+    mine = [r for r in all_runs if r[0] == dl_src]
+    gaps = [b[1] - a[1] for a, b in zip(mine, mine[1:])]
+    period = period_us / us if period_us else median(gaps)
+    print()
+    if not period:
+        print('%s: too few runs for a deadline check' % src_name(dl_src))
+    else:
+        print('%s deadline: period %.3f us' % (src_name(dl_src),
+                                               period * us))
+        for a, b in zip(mine, mine[1:]):
+            gap = b[1] - a[1]
+            if gap > 1.5 * period:
+                lost = int(round(gap / period)) - 1
+                missed += lost
+                print('  %10.3f us  missed %d sample(s), gap %.3f us' %
+                      ((a[1] - t0) * us, lost, gap * us))
+        for r in mine:
+            if r[2] - r[1] > period:
+                missed += 1
+                print('  %10.3f us  late, ran %.3f us' %
+                      ((r[1] - t0) * us, (r[2] - r[1]) * us))
+
+    for t, typ, src, data in recs:
+        if typ == TRACE_OVERRUN:
+            missed += 1
+            print('  %10.3f us  overrun in %s, %d lost' %
+                  ((t - t0) * us, src_name(src), data))
+
+    print('%d deadline problem(s)' % missed)
+    return missed
+
+
+def timeline(recs, clock):
+    us = 1e6 / clock
+    t0 = recs[0][0]
+    depth = 0
+    for t, typ, src, data in recs:
+        if typ == TRACE_EXIT:
+            depth = max(depth - 1, 0)
+        print('%12.3f %s%-7s %-6s %d' % ((t - t0) * us, '  ' * depth,
+                                         TYPES.get(typ, str(typ)),
+                                         src_name(src), data))
+        if typ == TRACE_ENTER:
+            depth += 1
+
+
+def write_vcd(path, recs, clock):
+    ns = 1e9 / clock
+    t0 = recs[0][0]
+    ids = {}
+    sources = sorted(set(r[2] for r in recs))
+    with open(path, 'w') as f:
+        f.write('$timescale 1 ns $end\n$scope module trace $end\n')
+        for k, src in enumerate(sources):
+            ids[src] = (chr(33 + 2 * k), chr(34 + 2 * k))
+            f.write('$var wire 1 %s %s $end\n' % (ids[src][0],
+                                                  src_name(src)))
+            f.write('$var integer 16 %s %s_data $end\n' %
+                    (ids[src][1], src_name(src)))
+        f.write('$upscope $end\n$enddefinitions $end\n#0\n')
+        for src in sources:
+            f.write('0%s\n' % ids[src][0])
+        last = 0
+        for t, typ, src, data in recs:
+            stamp = int((t - t0) * ns)
+            if stamp != last:
+                f.write('#%d\n' % stamp)
+                last = stamp
+            if typ == TRACE_ENTER:
+                f.write('1%s\n' % ids[src][0])
+            elif typ == TRACE_EXIT:
+                f.write('0%s\n' % ids[src][0])
+            else:
+                f.write('b%s %s\n' % (format(data, 'b'), ids[src][1]))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Timeline and deadline check '
+                                 'of a trace dump')
+    ap.add_argument('dump', help='text dump, _trace.csv or CCS .dat save')
+    ap.add_argument('-c', '--clock', type=float, default=90e6, metavar='HZ',
+                    help='timer 2 clock (default 90e6)')
+    ap.add_argument('-p', '--period', type=float, default=0.0, metavar='US',
+                    help='deadline period in us (default: median gap)')
+    ap.add_argument('-s', '--source', type=src_id, default=1, metavar='SRC',
+                    help='source with the deadline (default adc)')
+    ap.add_argument('-d', '--dump-index', type=int, default=-1, metavar='N',
+                    help='dump in the file, 0 is the first (default last)')
+    ap.add_argument('-t', '--timeline', action='store_true',
+                    help='print every record')
+    ap.add_argument('--vcd', metavar='FILE', help='write a value change dump')
+    args = ap.parse_args()
+
+    try:
+        if args.dump.lower().endswith('.dat'):
+            dumps = load_dat(args.dump)
+        else:
+            dumps = load_text(args.dump)
+        recs = unwrap(dumps[args.dump_index])
+    except (OSError, ValueError, IndexError) as e:
+        print('%s: %s' % (args.dump, e), file=sys.stderr)
+        return 2
+    if not recs:
+        print('%s: empty trace' % args.dump, file=sys.stderr)
+        return 2
+
+    if args.timeline:
+        timeline(recs, args.clock)
+        print()
+    missed = report(recs, args.clock, args.period, args.source)
+    if args.vcd:
+        write_vcd(args.vcd, recs, args.clock)
+    return 1 if missed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
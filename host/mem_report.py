@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+#############################################################################
+#
+# FILE:   mem_report.py
+#
+# TITLE:  Memory budget report and checks from the linker link info XML
+#
+# Usage:
+#       mem_report.py [-s N] [--hot SECTION]... [--msgram-limit PCT]
+#                     [--limit AREA=PCT]... <project>_linkInfo.xml
+#
+# Reads the --xml_link_info output of the C2000 linker (written next to
+# the .map on every build) and prints
+#
+#   - used / free space of each RAM, CLA and flash memory range
+#   - every output section with its run and load address and range
+#   - the N largest global symbols of each RAM range (-s, default 8);
+#     sizes are the distance to the next symbol in the same section, so
+#     they include padding and any static data that follows
+#
+# and then checks the budget. The exit status is 1, which fails the CCS
+# post-build step, when
+#
+#   - a --hot section (default ramfuncs and Cla1Prog) does not run from
+#     RAM, e.g. after a linker file change moved it to flash
+#   - a CLA message RAM is more than --msgram-limit percent used
+#     (default 90)
+#   - a --limit AREA=PCT range is more than PCT percent used
+#
+# Missing hot sections are not an error, not every project has a CLA.
+# Exit status 2 means the file could not be read.
+#
+#############################################################################
+
+import argparse
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+#
+# Memory ranges worth reporting, the rest of the MEMORY directive are the
+# peripheral register frames. RAM_RE are the ones code may run from.
+#
+MEMORY_RE = re.compile(r'^(RAM|CLARAM|CLA1_MSGRAM|USB_RAM|FLASH[A-H]|OTP|'
+                       r'BEGIN|CSM_RSVD)')
+RAM_RE = re.compile(r'^(RAM|CLARAM|CLA1_MSGRAM|USB_RAM)')
+MSGRAM_RE = re.compile(r'^CLA1_MSGRAM')
+
+#
+# Sections whose symbols are not variables or functions (copy tables)
+#
+NO_SYMBOLS = ('.cinit', '.pinit')
+
+
+def num(elem, tag, default=None):
+    """Integer value of a child element, hex or decimal"""
+    child = elem.find(tag)
+    if child is None or child.text is None:
+        return default
+    return int(child.text, 0)
+
+
+class Area(object):
+    def __init__(self, elem):
+        self.name = elem.findtext('name')
+        self.page = num(elem, 'page_id', 0)
+        self.origin = num(elem, 'origin')
+        self.length = num(elem, 'length')
+        self.used = num(elem, 'used_space', 0)
+        self.groups = set(ref.get('idref') for ref in
+                          elem.iter('logical_group_ref'))
+
+    def contains(self, addr):
+        return self.origin <= addr < self.origin + self.length
+
+    def percent(self):
+        return 100.0 * self.used / self.length if self.length else 0.0
+
+
+class Section(object):
+    def __init__(self, elem):
+        self.id = elem.get('id')
+        self.name = elem.findtext('name')
+        self.run = num(elem, 'run_address')
+        self.load = num(elem, 'load_address', self.run)
+        self.size = num(elem, 'size', 0)
+        self.run_area = None
+        self.load_area = None
+
+
+def find_area(areas, sec, addr):
+    """The range that holds addr, preferring the one the linker lists the
+    section in (the RAM linker files overlap some ranges)"""
+    hits = [a for a in areas if a.contains(addr)]
+    for a in hits:
+        if sec.id in a.groups:
+            return a
+    return hits[0] if hits else None
+
+
+def load(path):
+    root = ET.parse(path).getroot()
+    areas = [Area(e) for e in root.iter('memory_area')]
+    sections = [Section(e) for e in root.iter('logical_group')
+                if e.find('run_address') is not None]
+    sections = [s for s in sections
+                if s.size != 0 and not s.name.startswith('.debug')]
+    for sec in sections:
+        sec.run_area = find_area(areas, sec, sec.run)
+        sec.load_area = find_area(areas, sec, sec.load)
+    symbols = [(num(e, 'value'), e.findtext('name'))
+               for e in root.iter('symbol')]
+    return areas, sections, symbols
+
+
+def symbol_sizes(sections, symbols):
+    """Estimate symbol sizes inside each section, returns a list of
+    (size, name, section) with aliases at one address joined"""
+    result = []
+    by_addr = {}
+    for value, name in symbols:
+        by_addr.setdefault(value, []).append(name.lstrip('_'))
+    addrs = sorted(by_addr)
+    for sec in sections:
+        if sec.name in NO_SYMBOLS:
+            continue
+        end = sec.run + sec.size
+        inside = [a for a in addrs if sec.run <= a < end]
+        for i, a in enumerate(inside):
+            nxt = inside[i + 1] if i + 1 < len(inside) else end
+            result.append((nxt - a, '/'.join(sorted(by_addr[a])), sec))
+    return result
+
+
+def report(areas, sections, symbols, top):
+    mem = [a for a in areas if MEMORY_RE.match(a.name)]
+
+    print('MEMORY RANGES')
+    print('  %-16s %4s %8s %8s %8s %8s %6s' %
+          ('name', 'page', 'origin', 'length', 'used', 'free', 'used%'))
+    for a in mem:
+        print('  %-16s %4d %08x %8d %8d %8d %5.1f%%' %
+              (a.name, a.page, a.origin, a.length, a.used,
+               a.length - a.used, a.percent()))
+
+    print('')
+    print('SECTIONS')
+    print('  %-20s %8s %8s %6s  %s' %
+          ('name', 'run', 'load', 'size', 'run range (load range)'))
+    for sec in sorted(sections, key=lambda s: (s.run, s.name)):
+        if sec.run_area is None or not MEMORY_RE.match(sec.run_area.name):
+            continue
+        where = sec.run_area.name
+        if sec.load != sec.run and sec.load_area is not None:
+            where += ' (%s)' % sec.load_area.name
+        print('  %-20s %08x %08x %6d  %s' %
+              (sec.name, sec.run, sec.load, sec.size, where))
+
+    if top <= 0:
+        return
+    sizes = symbol_sizes(sections, symbols)
+    print('')
+    print('LARGEST SYMBOLS')
+    for a in mem:
+        if not RAM_RE.match(a.name):
+            continue
+        rows = sorted([s for s in sizes if s[2].run_area is a],
+                      key=lambda s: -s[0])[:top]
+        if not rows:
+            continue
+        print('  %s' % a.name)
+        for size, name, sec in rows:
+            print('    %6d  %-32s %s' % (size, name, sec.name))
+
+
+def check(areas, sections, hot, msgram_limit, limits):
+    errors = []
+
+    for name in hot:
+        for sec in [s for s in sections if s.name == name]:
+            if sec.run_area is None or not RAM_RE.match(sec.run_area.name):
+                errors.append('%s runs from %s, not RAM' %
+                              (name, sec.run_area.name if sec.run_area
+                               else 'unmapped memory'))
+
+    for a in areas:
+        if MSGRAM_RE.match(a.name) and a.percent() > msgram_limit:
+            errors.append('%s is %.1f%% used, limit %g%%' %
+                          (a.name, a.percent(), msgram_limit))
+
+    for name, pct in limits:
+        match = [a for a in areas if a.name == name]
+        if not match:
+            errors.append('no memory range %s' % name)
+        for a in match:
+            if a.percent() > pct:
+                errors.append('%s is %.1f%% used, limit %g%%' %
+                              (a.name, a.percent(), pct))
+    return errors
+
+
+def parse_limit(text):
+    name, sep, pct = text.partition('=')
+    if not sep:
+        raise argparse.ArgumentTypeError('expected AREA=PCT: %s' % text)
+    return name, float(pct)
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Memory budget report from a '
+                                 'C2000 linker link info XML file')
+    ap.add_argument('xml', help='<project>_linkInfo.xml')
+    ap.add_argument('-s', '--symbols', type=int, default=8, metavar='N',
+                    help='largest symbols listed per RAM range (0: none)')
+    ap.add_argument('--hot', action='append', metavar='SECTION',
+                    help='section that must run from RAM (repeatable, '
+                    'default ramfuncs and Cla1Prog)')
+    ap.add_argument('--msgram-limit', type=float, default=90.0, metavar='PCT',
+                    help='max CLA message RAM use in percent')
+    ap.add_argument('--limit', type=parse_limit, action='append', default=[],
+                    metavar='AREA=PCT', help='max use of a memory range')
+    args = ap.parse_args()
+
+    try:
+        areas, sections, symbols = load(args.xml)
+    except (IOError, ET.ParseError) as e:
+        sys.stderr.write('mem_report: %s: %s\n' % (args.xml, e))
+        return 2
+
+    report(areas, sections, symbols, args.symbols)
+
+    errors = check(areas, sections, args.hot or ['ramfuncs', 'Cla1Prog'],
+                   args.msgram_limit, args.limit)
+    print('')
+    for e in errors:
+        print('mem_report: error: %s' % e)
+    if errors:
+        return 1
+    print('mem_report: memory budget OK')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
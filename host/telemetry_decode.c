@@ -0,0 +1,463 @@
+//###########################################################################
+//
+// FILE:   telemetry_decode.c
+//
+// TITLE:  Host decoder for the SCI telemetry stream, writes CSV files
+//
+// Build (Linux):
+//      gcc -O2 -Wall -I../common -I. -o telemetry_decode telemetry_decode.c
+//
+// Usage:
+//      telemetry_decode [-d /dev/ttyUSB0] [-b 1406250] [-f capture.bin]
+//                       [-o prefix]
+//
+// Reads the stream from a serial port (raw 8N1 at any baud rate) or from
+// a capture file and writes <prefix>_samples.csv, <prefix>_counters.csv,
+// <prefix>_profile.csv, <prefix>_eye.csv (eye figures per window),
+// <prefix>_eye_hist.csv (one histogram row per window and phase) and
+// <prefix>_trace.csv (trace dumps, each one starting with a "# trace"
+// line, the input of isr_timeline.py). Frames with a bad CRC are counted
+// and skipped. Stop with Ctrl-C; a summary goes to stderr.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+
+#include "DSP28x_Project.h"
+#include "Telemetry.h"
+
+//
+// Defines
+//
+#define FRAME_MAX       (TELEMETRY_MAX_PAYLOAD + 8)
+
+//
+// Typedefs
+//
+typedef struct {
+    FILE *samples;
+    FILE *counters;
+    FILE *profile;
+    FILE *eye;
+    FILE *eye_hist;
+    FILE *trace;
+    unsigned long frames;
+    unsigned long crc_errors;
+    unsigned long seq_gaps;
+    unsigned long bad_frames;
+    int last_seq;
+} decoder_t;
+
+//
+// Globals
+//
+static volatile sig_atomic_t Stop;
+
+//
+// on_signal - Ctrl-C ends the capture
+//
+static void
+on_signal(int sig)
+{
+    (void)sig;
+    Stop = 1;
+}
+
+//
+// open_serial - Open a tty raw 8N1 at any baud rate (termios2/BOTHER)
+//
+static int
+open_serial(const char *dev, unsigned long baud)
+{
+    struct termios2 tio;
+    int fd;
+
+    fd = open(dev, O_RDONLY | O_NOCTTY);
+    if(fd < 0)
+    {
+        perror(dev);
+        return -1;
+    }
+    if(ioctl(fd, TCGETS2, &tio) < 0)
+    {
+        perror("TCGETS2");
+        close(fd);
+        return -1;
+    }
+    tio.c_iflag = 0;
+    tio.c_oflag = 0;
+    tio.c_lflag = 0;
+    tio.c_cflag = CS8 | CREAD | CLOCAL | BOTHER;
+    tio.c_ispeed = baud;
+    tio.c_ospeed = baud;
+    tio.c_cc[VMIN]  = 1;
+    tio.c_cc[VTIME] = 0;
+    if(ioctl(fd, TCSETS2, &tio) < 0)
+    {
+        perror("TCSETS2");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+//
+// crc16 - CRC-16/CCITT, same as telemetry_crc16() on the target
+//
+static uint16_t
+crc16(const uint8_t *p, size_t n)
+{
+    uint16_t crc = 0xFFFF;
+    size_t i;
+    int b;
+
+    for(i = 0; i < n; i++)
+    {
+        crc ^= (uint16_t)p[i] << 8;
+        for(b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) :
+                                   (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+//
+// cobs_decode - Decode one frame (delimiter removed), returns the length
+// or -1 if the frame is malformed
+//
+static int
+cobs_decode(const uint8_t *in, size_t n, uint8_t *out, size_t max)
+{
+    size_t i = 0;
+    size_t o = 0;
+    unsigned code;
+    unsigned k;
+
+    while(i < n)
+    {
+        code = in[i++];
+        if(code == 0 || i + code - 1 > n)
+        {
+            return -1;
+        }
+        for(k = 1; k < code; k++)
+        {
+            if(o == max)
+            {
+                return -1;
+            }
+            out[o++] = in[i++];
+        }
+        if(code < 0xFF && i < n)
+        {
+            if(o == max)
+            {
+                return -1;
+            }
+            out[o++] = 0;
+        }
+    }
+    return (int)o;
+}
+
+static uint16_t
+get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t
+get32(const uint8_t *p)
+{
+    return (uint32_t)get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+static float
+getf(const uint8_t *p)
+{
+    uint32_t u = get32(p);
+    float f;
+
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+//
+// handle_frame - Check and dispatch one decoded frame
+//
+static void
+handle_frame(decoder_t *d, const uint8_t *f, int n)
+{
+    const uint8_t *p;
+    unsigned i, cnt;
+    uint32_t first;
+    uint16_t decim;
+
+    if(n < 4)
+    {
+        d->bad_frames++;
+        return;
+    }
+    if(crc16(f, n - 2) != get16(f + n - 2))
+    {
+        d->crc_errors++;
+        return;
+    }
+    if(d->last_seq >= 0 && f[1] != ((d->last_seq + 1) & 0xFF))
+    {
+        d->seq_gaps++;
+    }
+    d->last_seq = f[1];
+    d->frames++;
+
+    p = f + 2;
+    n -= 4;
+    switch(f[0])
+    {
+    case TELEMETRY_SAMPLES:
+        if(n < 7)
+        {
+            break;
+        }
+        decim = get16(p);
+        first = get32(p + 2);
+        cnt   = p[6];
+        if(n < 7 + 4 * (int)cnt)
+        {
+            d->bad_frames++;
+            break;
+        }
+        for(i = 0; i < cnt; i++)
+        {
+            fprintf(d->samples, "%u,%u,%u,%u\n", f[1],
+                    (unsigned)(first + i * decim), get16(p + 7 + 4 * i),
+                    get16(p + 9 + 4 * i));
+        }
+        break;
+
+    case TELEMETRY_COUNTERS:
+        if(n < 26 || n < 26 + 4 * p[25])
+        {
+            d->bad_frames++;
+            break;
+        }
+        fprintf(d->counters, "%u,%u,%u,%u,%u,%u,%u,%u", f[1], get32(p),
+                get32(p + 4), get32(p + 8), get32(p + 12), get32(p + 16),
+                get32(p + 20), p[24]);
+        for(i = 0; i < p[25]; i++)
+        {
+            fprintf(d->counters, ",%g", getf(p + 26 + 4 * i));
+        }
+        fputc('\n', d->counters);
+        break;
+
+    case TELEMETRY_PROFILE:
+        if(n < 18)
+        {
+            d->bad_frames++;
+            break;
+        }
+        fprintf(d->profile, "%u,%u,%u,%u,%u,%u\n", f[1], get32(p),
+                get16(p + 4), get32(p + 6), get32(p + 10), get32(p + 14));
+        break;
+
+    case TELEMETRY_EYE:
+        if(n < 28)
+        {
+            d->bad_frames++;
+            break;
+        }
+        fprintf(d->eye, "%u,%u,%g,%u,%u,%d,%g,%g,%g,%g\n", f[1], get32(p),
+                getf(p + 4), p[8], p[9], (int16_t)get16(p + 10),
+                getf(p + 12), getf(p + 16), getf(p + 20), getf(p + 24));
+        break;
+
+    case TELEMETRY_EYE_ROW:
+        if(n < 6 || n < 6 + 2 * p[5])
+        {
+            d->bad_frames++;
+            break;
+        }
+        fprintf(d->eye_hist, "%u,%u", get32(p), p[4]);
+        for(i = 0; i < p[5]; i++)
+        {
+            fprintf(d->eye_hist, ",%u", get16(p + 6 + 2 * i));
+        }
+        fputc('\n', d->eye_hist);
+        break;
+
+    case TELEMETRY_TRACE:
+        if(n < 7 || n < 7 + 8 * p[6])
+        {
+            d->bad_frames++;
+            break;
+        }
+        if(get16(p + 4) == 0)
+        {
+            fprintf(d->trace, "# trace %u\n", get32(p));
+        }
+        for(i = 0; i < p[6]; i++)
+        {
+            fprintf(d->trace, "%u,%u,%u,%u\n", get32(p + 7 + 8 * i),
+                    p[11 + 8 * i], p[12 + 8 * i], get16(p + 13 + 8 * i));
+        }
+        break;
+
+    default:
+        d->bad_frames++;
+        break;
+    }
+}
+
+static FILE *
+open_csv(const char *prefix, const char *name, const char *header)
+{
+    char path[512];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s_%s.csv", prefix, name);
+    f = fopen(path, "w");
+    if(f == NULL)
+    {
+        perror(path);
+        exit(1);
+    }
+    fprintf(f, "%s\n", header);
+    return f;
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *dev = "/dev/ttyUSB0";
+    const char *file = NULL;
+    const char *prefix = "telemetry";
+    unsigned long baud = TELEMETRY_BAUD;
+    uint8_t rx[4096];
+    uint8_t enc[2 * FRAME_MAX];
+    uint8_t dec[2 * FRAME_MAX];
+    size_t elen = 0;
+    int overflow = 0;
+    decoder_t d;
+    ssize_t got;
+    ssize_t i;
+    int fd;
+    int n;
+    int c;
+
+    while((c = getopt(argc, argv, "d:b:f:o:")) != -1)
+    {
+        switch(c)
+        {
+        case 'd': dev = optarg; break;
+        case 'b': baud = strtoul(optarg, NULL, 0); break;
+        case 'f': file = optarg; break;
+        case 'o': prefix = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-d tty] [-b baud] [-f capture] "
+                    "[-o prefix]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    fd = file ? open(file, O_RDONLY) : open_serial(dev, baud);
+    if(fd < 0)
+    {
+        if(file)
+        {
+            perror(file);
+        }
+        return 1;
+    }
+
+    memset(&d, 0, sizeof(d));
+    d.last_seq = -1;
+    d.samples  = open_csv(prefix, "samples", "seq,index,raw,filtered");
+    d.counters = open_csv(prefix, "counters",
+                          "seq,rx_bits,rx_sync_losses,ber_bits,ber_errors,"
+                          "ber_resyncs,tx_frames,best,snr...");
+    d.profile  = open_csv(prefix, "profile",
+                          "seq,loops,max_backlog,drops,bytes,overruns");
+    d.eye      = open_csv(prefix, "eye",
+                          "seq,window,sample_rate,phases,best_phase,"
+                          "opening,q,snr_db,period,jitter");
+    d.eye_hist = open_csv(prefix, "eye_hist", "window,phase,bins...");
+    d.trace    = open_csv(prefix, "trace", "time,type,src,data");
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    while(!Stop)
+    {
+        got = read(fd, rx, sizeof(rx));
+        if(got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(got <= 0)
+        {
+            break;
+        }
+        for(i = 0; i < got; i++)
+        {
+            if(rx[i] != 0)
+            {
+                if(elen < sizeof(enc))
+                {
+                    enc[elen++] = rx[i];
+                }
+                else
+                {
+                    overflow = 1;
+                }
+                continue;
+            }
+            if(elen != 0 && !overflow)
+            {
+                n = cobs_decode(enc, elen, dec, sizeof(dec));
+                if(n < 0)
+                {
+                    d.bad_frames++;
+                }
+                else
+                {
+                    handle_frame(&d, dec, n);
+                }
+            }
+            else if(overflow)
+            {
+                d.bad_frames++;
+            }
+            elen = 0;
+            overflow = 0;
+        }
+    }
+
+    fprintf(stderr, "frames %lu, crc errors %lu, seq gaps %lu, bad %lu\n",
+            d.frames, d.crc_errors, d.seq_gaps, d.bad_frames);
+    fclose(d.samples);
+    fclose(d.counters);
+    fclose(d.profile);
+    fclose(d.eye);
+    fclose(d.eye_hist);
+    fclose(d.trace);
+    close(fd);
+    return 0;
+}
+
+//
+// End of File
+//
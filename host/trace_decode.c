@@ -0,0 +1,660 @@
+//###########################################################################
+//
+// FILE:   trace_decode.c
+//
+// TITLE:  Batch decoder for recorded ADC traces using the firmware decoder
+//
+// Build (Linux):
+//      gcc -O2 -Wall -pthread -I. -I../Example_2806xClaAdcFir
+//          -o trace_decode trace_decode.c
+//          ../Example_2806xClaAdcFir/ManchesterRx.c
+//          ../Example_2806xClaAdcFir/Prbs.c -lm
+//
+// Usage:
+//      trace_decode [options] trace.bin|trace.csv
+//      -t bin|csv      input format, default from the file extension.
+//                      bin is little endian Uint16 ADC codes, csv is one
+//                      sample per line (lines that do not start with a
+//                      number, e.g. a header, are skipped)
+//      -c col          csv column, 0 based (default 0)
+//      -O n            oversampling, n consecutive codes are summed into
+//                      one sample as on the CLA (default 1)
+//      -s n            samples per bit (default 10)
+//      -T code         slicer threshold (default 2048 * oversampling)
+//      -H code         slicer hysteresis (default 64 * oversampling)
+//      -p 7|15|0       PRBS order for the BER check, 0 for none (default 7)
+//      -r hz           sample rate, to report bit rate and jitter in time
+//      -j n            threads (default: all CPUs)
+//      -o file         decoded frames, default stdout
+//
+// The input is memory mapped and cut into one chunk per thread. Every
+// chunk is decoded with the firmware FIR (same taps as A[] in
+// Example_2806xClaAdcFir.c), ManchesterRx.c and Prbs.c. A chunk starts
+// WARMUP samples early so the filter, the clock recovery and the PRBS
+// checker are locked when its own range begins; statistics only count
+// bits inside the range. A frame is the run of bits from a lock to the
+// next sync loss. It belongs to the chunk it starts in, and that chunk
+// keeps decoding past its end until the frame is over.
+//
+// Output: one line per frame, "start,end,bits,hex" with the sample
+// indexes of the first and the last bit and the bits packed LSB first.
+// A summary goes to stderr.
+//
+// Every bit follows a lock, so bits with no lock or no frame mean the
+// frame tracking has gone out of step with ManchesterRx.c: that is
+// reported and the exit status is 1.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "DSP28x_Project.h"
+#include "ManchesterRx.h"
+#include "Prbs.h"
+
+//
+// Defines
+//
+#define WARMUP          4096
+#define FILTER_LEN      5           // as in CLAShared.h
+#define MAX_THREADS     256
+
+//
+// Typedefs
+//
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+    uint32_t nbits;
+    uint8_t *bytes;
+} frame_t;
+
+typedef struct {
+    const uint16_t *x;          // ADC codes
+    size_t n;                   // samples after oversampling
+    size_t begin;               // first sample owned by this chunk
+    size_t end;                 // one past the last owned sample
+
+    frame_t *frames;
+    size_t nframes;
+    size_t cap;
+
+    uint64_t bits;
+    uint64_t locks;
+    uint64_t sync_losses;
+    int64_t ber_bits;
+    int64_t ber_errors;
+    int64_t ber_resyncs;
+    uint64_t per_n;             // bit to bit intervals while locked
+    double per_sum;
+    double per_sq;
+    uint32_t per_min;
+    uint32_t per_max;
+} chunk_t;
+
+typedef struct {
+    uint16_t *vals;
+    size_t n;
+    size_t cap;
+    const char *p;
+    const char *e;
+} csv_part_t;
+
+//
+// Globals
+//
+static unsigned Oversample = 1;
+static unsigned SamplesPerBit = 10;
+static unsigned Threshold;
+static unsigned Hysteresis;
+static unsigned PrbsOrder = PRBS_ORDER_7;
+static unsigned CsvColumn;
+
+//
+// Same low pass taps as A[] in Example_2806xClaAdcFir.c
+//
+static const float FirTaps[FILTER_LEN] = {
+    0.033869f, 0.24015f, 0.45197f, 0.24015f, 0.033869f
+};
+
+static void *
+xrealloc(void *p, size_t n)
+{
+    p = realloc(p, n);
+    if(p == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+//
+// fir_sample - One CLA Task 7 FIR step for a single channel: sum the
+// oversampled codes, run the 5 taps in float, truncate to Uint16
+//
+static uint16_t
+fir_sample(float *dl, const uint16_t *x, size_t i)
+{
+    float in = 0.0f;
+    float y = 0.0f;
+    unsigned k;
+
+    for(k = 0; k < Oversample; k++)
+    {
+        in += (float)x[i * Oversample + k];
+    }
+    for(k = FILTER_LEN - 1; k > 0; k--)
+    {
+        dl[k] = dl[k - 1];
+    }
+    dl[0] = in;
+    for(k = 0; k < FILTER_LEN; k++)
+    {
+        y += FirTaps[k] * dl[k];
+    }
+    if(y <= 0.0f)
+    {
+        return 0;
+    }
+    return y >= 65535.0f ? 65535 : (uint16_t)y;
+}
+
+static void
+frame_bit(frame_t *f, int bit)
+{
+    if((f->nbits & 7) == 0)
+    {
+        f->bytes = xrealloc(f->bytes, f->nbits / 8 + 1);
+        f->bytes[f->nbits / 8] = 0;
+    }
+    f->bytes[f->nbits / 8] |= (uint8_t)(bit << (f->nbits & 7));
+    f->nbits++;
+}
+
+static void
+frame_close(chunk_t *c, frame_t *f)
+{
+    if(c->nframes == c->cap)
+    {
+        c->cap = c->cap ? 2 * c->cap : 64;
+        c->frames = xrealloc(c->frames, c->cap * sizeof(frame_t));
+    }
+    c->frames[c->nframes++] = *f;
+    memset(f, 0, sizeof(*f));
+}
+
+//
+// decode_chunk - Thread body, decode c->begin .. c->end
+//
+static void *
+decode_chunk(void *arg)
+{
+    chunk_t *c = arg;
+    manchester_rx_t rx;
+    prbs_checker_t chk;
+    float dl[FILTER_LEN] = {0};
+    frame_t f;
+    int in_frame = 0;
+    size_t last_bit = 0;
+    int have_last = 0;
+    size_t i;
+    int owned;
+    int was_locked;
+    int16 bit;
+    uint32_t b0, e0, r0;
+    uint32_t per;
+
+    memset(&f, 0, sizeof(f));
+    manchester_rx_init(&rx, Threshold, Hysteresis, SamplesPerBit);
+    if(PrbsOrder)
+    {
+        prbs_checker_init(&chk, PrbsOrder);
+    }
+    c->per_min = UINT32_MAX;
+
+    for(i = c->begin > WARMUP ? c->begin - WARMUP : 0; i < c->n; i++)
+    {
+        if(i >= c->end && !in_frame)
+        {
+            break;
+        }
+        owned = i >= c->begin && i < c->end;
+
+        was_locked = rx.locked;
+        bit = manchester_rx_sample(&rx, fir_sample(dl, c->x, i));
+
+        //
+        // The decoder locks on a mid-bit edge and puts out the bit of that
+        // edge half a bit later, the frame starts with that bit
+        //
+        if(!was_locked && rx.locked)
+        {
+            have_last = 0;
+            if(owned)
+            {
+                c->locks++;
+                in_frame = 1;
+            }
+        }
+
+        if(bit != MANCHESTER_RX_NO_BIT)
+        {
+            if(have_last && owned)
+            {
+                per = (uint32_t)(i - last_bit);
+                c->per_n++;
+                c->per_sum += per;
+                c->per_sq  += (double)per * per;
+                if(per < c->per_min)
+                {
+                    c->per_min = per;
+                }
+                if(per > c->per_max)
+                {
+                    c->per_max = per;
+                }
+            }
+            last_bit = i;
+            have_last = 1;
+
+            if(in_frame)
+            {
+                if(f.nbits == 0)
+                {
+                    f.start = i;
+                }
+                frame_bit(&f, bit);
+                f.end = i;
+            }
+            if(owned)
+            {
+                c->bits++;
+            }
+            if(PrbsOrder)
+            {
+                b0 = chk.bits;
+                e0 = chk.errors;
+                r0 = chk.resyncs;
+                prbs_checker_push(&chk, (Uint16)bit);
+                if(owned)
+                {
+                    c->ber_bits    += (int64_t)chk.bits - b0;
+                    c->ber_errors  += (int64_t)chk.errors - e0;
+                    c->ber_resyncs += (int64_t)chk.resyncs - r0;
+                }
+            }
+        }
+        else if(was_locked && !rx.locked)
+        {
+            if(owned)
+            {
+                c->sync_losses++;
+            }
+            if(in_frame)
+            {
+                if(f.nbits != 0)
+                {
+                    frame_close(c, &f);
+                }
+                in_frame = 0;
+            }
+        }
+    }
+    if(in_frame && f.nbits != 0)
+    {
+        frame_close(c, &f);
+    }
+    return NULL;
+}
+
+//
+// csv_parse_part - Thread body, parse one newline aligned part of a csv
+//
+static void *
+csv_parse_part(void *arg)
+{
+    csv_part_t *cp = arg;
+    const char *p = cp->p;
+    const char *q;
+    unsigned col;
+    long v;
+
+    while(p < cp->e)
+    {
+        q = p;
+        for(col = 0; col < CsvColumn && q < cp->e && *q != '\n'; q++)
+        {
+            if(*q == ',')
+            {
+                col++;
+            }
+        }
+        while(q < cp->e && (*q == ' ' || *q == '\t'))
+        {
+            q++;
+        }
+        if(col == CsvColumn && q < cp->e &&
+           ((*q >= '0' && *q <= '9') || *q == '-'))
+        {
+            v = 0;
+            if(*q == '-')
+            {
+                q++;
+            }
+            else
+            {
+                while(q < cp->e && *q >= '0' && *q <= '9')
+                {
+                    v = v * 10 + (*q++ - '0');
+                }
+            }
+            if(cp->n == cp->cap)
+            {
+                cp->cap = cp->cap ? 2 * cp->cap : 1 << 16;
+                cp->vals = xrealloc(cp->vals, cp->cap * sizeof(uint16_t));
+            }
+            cp->vals[cp->n++] = v > 65535 ? 65535 : (uint16_t)v;
+        }
+        while(p < cp->e && *p != '\n')
+        {
+            p++;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+//
+// csv_load - Parse a mapped csv file in parallel, returns the codes
+//
+static uint16_t *
+csv_load(const char *buf, size_t len, unsigned nthreads, size_t *count)
+{
+    csv_part_t parts[MAX_THREADS];
+    pthread_t tid[MAX_THREADS];
+    uint16_t *out;
+    size_t pos = 0;
+    size_t cut;
+    unsigned t;
+
+    for(t = 0; t < nthreads; t++)
+    {
+        memset(&parts[t], 0, sizeof(parts[t]));
+        parts[t].p = buf + pos;
+        cut = (t == nthreads - 1) ? len : len * (t + 1) / nthreads;
+        if(cut < pos)
+        {
+            cut = pos;
+        }
+        while(cut > 0 && cut < len && buf[cut - 1] != '\n')
+        {
+            cut++;
+        }
+        parts[t].e = buf + cut;
+        pos = cut;
+        pthread_create(&tid[t], NULL, csv_parse_part, &parts[t]);
+    }
+
+    *count = 0;
+    for(t = 0; t < nthreads; t++)
+    {
+        pthread_join(tid[t], NULL);
+        *count += parts[t].n;
+    }
+    out = xrealloc(NULL, (*count ? *count : 1) * sizeof(uint16_t));
+    pos = 0;
+    for(t = 0; t < nthreads; t++)
+    {
+        memcpy(out + pos, parts[t].vals, parts[t].n * sizeof(uint16_t));
+        pos += parts[t].n;
+        free(parts[t].vals);
+    }
+    return out;
+}
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *fmt = NULL;
+    const char *outname = NULL;
+    double rate = 0.0;
+    unsigned nthreads = (unsigned)sysconf(_SC_NPROCESSORS_ONLN);
+    chunk_t chunks[MAX_THREADS];
+    pthread_t tid[MAX_THREADS];
+    const uint16_t *codes;
+    uint16_t *parsed = NULL;
+    struct stat st;
+    FILE *out = stdout;
+    void *map;
+    size_t ncodes;
+    size_t n;
+    size_t i;
+    unsigned t;
+    uint64_t bits = 0, locks = 0, losses = 0, nframes = 0, per_n = 0;
+    int64_t ber_bits = 0, ber_errors = 0, ber_resyncs = 0;
+    double per_sum = 0.0, per_sq = 0.0, mean, sd;
+    uint32_t per_min = UINT32_MAX, per_max = 0;
+    double t0, t1;
+    uint32_t k;
+    int fd;
+    int c;
+
+    Threshold = 0;
+    Hysteresis = 0;
+    while((c = getopt(argc, argv, "t:c:O:s:T:H:p:r:j:o:")) != -1)
+    {
+        switch(c)
+        {
+        case 't': fmt = optarg; break;
+        case 'c': CsvColumn = (unsigned)atoi(optarg); break;
+        case 'O': Oversample = (unsigned)atoi(optarg); break;
+        case 's': SamplesPerBit = (unsigned)atoi(optarg); break;
+        case 'T': Threshold = (unsigned)atoi(optarg); break;
+        case 'H': Hysteresis = (unsigned)atoi(optarg); break;
+        case 'p': PrbsOrder = (unsigned)atoi(optarg); break;
+        case 'r': rate = atof(optarg); break;
+        case 'j': nthreads = (unsigned)atoi(optarg); break;
+        case 'o': outname = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-t bin|csv] [-c col] [-O n] [-s n] "
+                    "[-T code] [-H code] [-p 7|15|0] [-r hz] [-j n] "
+                    "[-o file] trace\n", argv[0]);
+            return 1;
+        }
+    }
+    if(optind != argc - 1)
+    {
+        fprintf(stderr, "%s: no trace file\n", argv[0]);
+        return 1;
+    }
+    if(nthreads < 1)
+    {
+        nthreads = 1;
+    }
+    if(nthreads > MAX_THREADS)
+    {
+        nthreads = MAX_THREADS;
+    }
+    if(Oversample < 1 || SamplesPerBit < 4 ||
+       (PrbsOrder != 0 && PrbsOrder != 7 && PrbsOrder != 15))
+    {
+        fprintf(stderr, "%s: bad -O, -s or -p\n", argv[0]);
+        return 1;
+    }
+    if(Threshold == 0)
+    {
+        Threshold = 2048 * Oversample;
+    }
+    if(Hysteresis == 0)
+    {
+        Hysteresis = 64 * Oversample;
+    }
+    if(fmt == NULL)
+    {
+        n = strlen(argv[optind]);
+        fmt = (n > 4 && strcmp(argv[optind] + n - 4, ".csv") == 0) ?
+              "csv" : "bin";
+    }
+
+    fd = open(argv[optind], O_RDONLY);
+    if(fd < 0 || fstat(fd, &st) < 0)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+    if(st.st_size == 0)
+    {
+        fprintf(stderr, "%s: empty\n", argv[optind]);
+        return 1;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(map == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    t0 = now();
+    if(strcmp(fmt, "csv") == 0)
+    {
+        parsed = csv_load(map, st.st_size, nthreads, &ncodes);
+        codes = parsed;
+    }
+    else
+    {
+        codes = map;
+        ncodes = st.st_size / sizeof(uint16_t);
+    }
+
+    //
+    // Decode, one chunk per thread
+    //
+    n = ncodes / Oversample;
+    for(t = 0; t < nthreads; t++)
+    {
+        memset(&chunks[t], 0, sizeof(chunks[t]));
+        chunks[t].x     = codes;
+        chunks[t].n     = n;
+        chunks[t].begin = n * t / nthreads;
+        chunks[t].end   = n * (t + 1) / nthreads;
+        pthread_create(&tid[t], NULL, decode_chunk, &chunks[t]);
+    }
+
+    if(outname != NULL && (out = fopen(outname, "w")) == NULL)
+    {
+        perror(outname);
+        return 1;
+    }
+    fprintf(out, "start,end,bits,hex\n");
+    for(t = 0; t < nthreads; t++)
+    {
+        pthread_join(tid[t], NULL);
+        for(i = 0; i < chunks[t].nframes; i++)
+        {
+            frame_t *f = &chunks[t].frames[i];
+
+            fprintf(out, "%llu,%llu,%u,", (unsigned long long)f->start,
+                    (unsigned long long)f->end, f->nbits);
+            for(k = 0; k < (f->nbits + 7) / 8; k++)
+            {
+                fprintf(out, "%02x", f->bytes[k]);
+            }
+            fputc('\n', out);
+            free(f->bytes);
+        }
+        free(chunks[t].frames);
+        nframes += chunks[t].nframes;
+        bits    += chunks[t].bits;
+        locks   += chunks[t].locks;
+        losses  += chunks[t].sync_losses;
+        ber_bits    += chunks[t].ber_bits;
+        ber_errors  += chunks[t].ber_errors;
+        ber_resyncs += chunks[t].ber_resyncs;
+        per_n   += chunks[t].per_n;
+        per_sum += chunks[t].per_sum;
+        per_sq  += chunks[t].per_sq;
+        if(chunks[t].per_n && chunks[t].per_min < per_min)
+        {
+            per_min = chunks[t].per_min;
+        }
+        if(chunks[t].per_max > per_max)
+        {
+            per_max = chunks[t].per_max;
+        }
+    }
+    t1 = now();
+    if(out != stdout)
+    {
+        fclose(out);
+    }
+
+    //
+    // Summary
+    //
+    fprintf(stderr, "samples %zu (%zu codes), %u threads, %.3f s, "
+            "%.1f Msample/s\n", n, ncodes, nthreads, t1 - t0,
+            n / (t1 - t0) * 1e-6);
+    fprintf(stderr, "frames %llu, bits %llu, locks %llu, sync losses %llu\n",
+            (unsigned long long)nframes, (unsigned long long)bits,
+            (unsigned long long)locks, (unsigned long long)losses);
+    if(PrbsOrder)
+    {
+        fprintf(stderr, "PRBS-%u: bits %lld, errors %lld, BER %.3e, "
+                "resyncs %lld\n", PrbsOrder, (long long)ber_bits,
+                (long long)ber_errors,
+                ber_bits ? (double)ber_errors / ber_bits : 0.0,
+                (long long)ber_resyncs);
+    }
+    if(per_n)
+    {
+        mean = per_sum / per_n;
+        sd   = sqrt(per_sq / per_n - mean * mean > 0.0 ?
+                    per_sq / per_n - mean * mean : 0.0);
+        fprintf(stderr, "bit period %.3f samples, sd %.3f, min %u, max %u\n",
+                mean, sd, per_min, per_max);
+        if(rate > 0.0)
+        {
+            fprintf(stderr, "bit rate %.1f bit/s, jitter rms %.1f ns\n",
+                    rate / mean, sd / rate * 1e9);
+        }
+    }
+
+    free(parsed);
+    munmap(map, st.st_size);
+    close(fd);
+
+    if(bits != 0 && (locks == 0 || nframes == 0))
+    {
+        fprintf(stderr, "trace_decode: %llu bits but no lock or frame\n",
+                (unsigned long long)bits);
+        return 1;
+    }
+    return 0;
+}
+
+//
+// End of File
+//